@@ -65,17 +65,44 @@ void CodeController::handleMessage(MessageActivateFullTextSearch* message)
 
 	saveOrRestoreViewMode(message);
 
-	m_collection = m_storageAccess->getFullTextSearchLocations(
-		message->searchTerm, message->caseSensitive);
-
 	CodeView::CodeParams params;
 	params.clearSnippets = true;
 	params.useSingleFileCache = false;
 
-	m_files = getFilesForCollection(m_collection);
-	createReferences();
-	expandVisibleFiles(params.useSingleFileCache);
-	showFiles(params, firstReferenceScrollParams(), !message->isReplayed());
+	m_collection = std::make_shared<SourceLocationCollection>();
+	m_files.clear();
+
+	// files are shown batch by batch while the search continues
+	bool firstBatch = true;
+	m_storageAccess->getFullTextSearchLocations(
+		message->searchTerm,
+		message->caseSensitive,
+		[&](std::shared_ptr<SourceLocationCollection> batch) {
+			for (const CodeFileParams& file: getFilesForCollection(batch))
+			{
+				m_collection->addSourceLocationFile(file.locationFile);
+				m_files.push_back(file);
+			}
+
+			createReferences();
+			if (firstBatch)
+			{
+				expandVisibleFiles(params.useSingleFileCache);
+			}
+			showFiles(
+				params,
+				firstBatch ? firstReferenceScrollParams() : CodeScrollParams(),
+				!message->isReplayed());
+
+			params.clearSnippets = false;
+			firstBatch = false;
+		});
+
+	if (firstBatch)
+	{
+		createReferences();
+		showFiles(params, firstReferenceScrollParams(), !message->isReplayed());
+	}
 }
 
 void CodeController::handleMessage(MessageActivateLegend* message)
@@ -222,7 +222,8 @@ void GraphController::handleMessage(MessageActivateTrail* message)
 		message->edgeTypes,
 		message->nodeNonIndexed,
 		message->depth,
-		true /* !message->custom || (message->originId && message->targetId) */);
+		true /* !message->custom || (message->originId && message->targetId) */,
+		message->shortestPath);
 
 	// remove non-indexed files from include graph if indexed file is origin
 	if (!message->custom && message->edgeTypes & Edge::EDGE_INCLUDE)
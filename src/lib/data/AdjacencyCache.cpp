@@ -0,0 +1,322 @@
+#include "AdjacencyCache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <tuple>
+
+#include "FilePath.h"
+#include "MappedFile.h"
+#include "logging.h"
+
+namespace
+{
+const char s_cacheFileMagic[8] = {'S', 'R', 'C', 'T', 'R', 'L', 'A', 'C'};
+const uint32_t s_cacheFileVersion = 2;
+
+struct CacheFileHeader
+{
+	uint32_t idSize;
+	uint32_t edgeSize;
+	uint32_t nodeCount;
+	uint32_t edgeCount;
+};
+}	 // namespace
+
+const int AdjacencyCache::s_unknownNodeType = -1;
+const uint32_t AdjacencyCache::s_noIndex = ~uint32_t(0);
+
+AdjacencyCache::AdjacencyCache()
+{
+	clear();
+}
+
+void AdjacencyCache::clear()
+{
+	m_nodeIds = std::vector<Id>();
+	m_nodeTypes = std::vector<int32_t>();
+	m_outOffsets = std::vector<uint32_t>(1, 0);
+	m_edges = std::vector<AdjacencyEdge>();
+	m_inOffsets = std::vector<uint32_t>(1, 0);
+	m_inEdges = std::vector<uint32_t>();
+
+	m_buildNodes = std::vector<std::pair<Id, int>>();
+	m_buildEdges = std::vector<StorageEdge>();
+
+	useOwnedData();
+}
+
+bool AdjacencyCache::isEmpty() const
+{
+	return m_nodeCount == 0;
+}
+
+void AdjacencyCache::addNode(Id nodeId, int type)
+{
+	m_buildNodes.emplace_back(nodeId, type);
+}
+
+void AdjacencyCache::addEdge(Id edgeId, int type, Id sourceId, Id targetId)
+{
+	m_buildEdges.emplace_back(edgeId, type, sourceId, targetId);
+}
+
+void AdjacencyCache::finishSetup()
+{
+	std::vector<std::pair<Id, int>> buildNodes = std::move(m_buildNodes);
+	std::vector<StorageEdge> buildEdges = std::move(m_buildEdges);
+	clear();
+
+	// edge endpoints that were not added as nodes are kept with unknown type
+	for (const StorageEdge& edge: buildEdges)
+	{
+		buildNodes.emplace_back(edge.sourceNodeId, s_unknownNodeType);
+		buildNodes.emplace_back(edge.targetNodeId, s_unknownNodeType);
+	}
+
+	// known types sort first, so they are kept when removing duplicates
+	std::sort(
+		buildNodes.begin(),
+		buildNodes.end(),
+		[](const std::pair<Id, int>& a, const std::pair<Id, int>& b) {
+			const bool aKnown = a.second != s_unknownNodeType;
+			const bool bKnown = b.second != s_unknownNodeType;
+			return a.first < b.first || (a.first == b.first && aKnown && !bKnown);
+		});
+
+	for (const std::pair<Id, int>& node: buildNodes)
+	{
+		if (m_nodeIds.empty() || m_nodeIds.back() != node.first)
+		{
+			m_nodeIds.push_back(node.first);
+			m_nodeTypes.push_back(node.second);
+		}
+	}
+	buildNodes = std::vector<std::pair<Id, int>>();
+
+	useOwnedData();
+
+	m_edges.reserve(buildEdges.size());
+	for (const StorageEdge& edge: buildEdges)
+	{
+		m_edges.push_back(
+			{edge.id,
+			 edge.type,
+			 getNodeIndex(edge.sourceNodeId),
+			 getNodeIndex(edge.targetNodeId),
+			 0});
+	}
+	buildEdges = std::vector<StorageEdge>();
+
+	// edges of one source are grouped by type
+	std::sort(m_edges.begin(), m_edges.end(), [](const AdjacencyEdge& a, const AdjacencyEdge& b) {
+		return std::tie(a.source, a.type, a.id) < std::tie(b.source, b.type, b.id);
+	});
+	m_edges.erase(
+		std::unique(
+			m_edges.begin(),
+			m_edges.end(),
+			[](const AdjacencyEdge& a, const AdjacencyEdge& b) { return a.id == b.id; }),
+		m_edges.end());
+
+	const size_t nodeCount = m_nodeIds.size();
+	m_outOffsets.assign(nodeCount + 1, 0);
+	m_inOffsets.assign(nodeCount + 1, 0);
+	for (const AdjacencyEdge& edge: m_edges)
+	{
+		m_outOffsets[edge.source + 1]++;
+		m_inOffsets[edge.target + 1]++;
+	}
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		m_outOffsets[i + 1] += m_outOffsets[i];
+		m_inOffsets[i + 1] += m_inOffsets[i];
+	}
+
+	// counting sort keeps the source order within the incoming edges of each target
+	m_inEdges.resize(m_edges.size());
+	std::vector<uint32_t> inPositions(m_inOffsets.begin(), m_inOffsets.end() - 1);
+	for (size_t i = 0; i < m_edges.size(); i++)
+	{
+		m_inEdges[inPositions[m_edges[i].target]++] = static_cast<uint32_t>(i);
+	}
+
+	useOwnedData();
+}
+
+bool AdjacencyCache::load(const FilePath& cacheFilePath, std::string* key)
+{
+	MappedFile reader(cacheFilePath);
+	if (!reader.isMapped())
+	{
+		return false;
+	}
+
+	std::string storedKey;
+	if (!reader.readHeader(s_cacheFileMagic, s_cacheFileVersion, &storedKey))
+	{
+		return false;
+	}
+
+	const CacheFileHeader* header = reader.read<CacheFileHeader>(1);
+	if (!header || header->idSize != sizeof(Id) || header->edgeSize != sizeof(AdjacencyEdge))
+	{
+		return false;
+	}
+
+	const size_t nodeCount = header->nodeCount;
+	const size_t edgeCount = header->edgeCount;
+
+	const Id* nodeIds = reader.read<Id>(nodeCount);
+	const int32_t* nodeTypes = reader.read<int32_t>(nodeCount);
+	const uint32_t* outOffsets = reader.read<uint32_t>(nodeCount + 1);
+	const AdjacencyEdge* edges = reader.read<AdjacencyEdge>(edgeCount);
+	const uint32_t* inOffsets = reader.read<uint32_t>(nodeCount + 1);
+	const uint32_t* inEdges = reader.read<uint32_t>(edgeCount);
+
+	// ranges are checked once, so queries can rely on them
+	bool valid = !reader.failed() && outOffsets[0] == 0 && inOffsets[0] == 0 &&
+		outOffsets[nodeCount] == edgeCount && inOffsets[nodeCount] == edgeCount;
+	for (size_t i = 0; i < nodeCount && valid; i++)
+	{
+		valid = (i == 0 || nodeIds[i - 1] < nodeIds[i]) && outOffsets[i] <= outOffsets[i + 1] &&
+			inOffsets[i] <= inOffsets[i + 1];
+	}
+	for (size_t i = 0; i < edgeCount && valid; i++)
+	{
+		valid = edges[i].source < nodeCount && edges[i].target < nodeCount &&
+			inEdges[i] < edgeCount;
+	}
+
+	if (!valid)
+	{
+		LOG_WARNING(L"Adjacency cache \"" + cacheFilePath.wstr() + L"\" is corrupted.");
+		return false;
+	}
+
+	clear();
+
+	m_dataOwner = reader.getDataOwner();
+	m_nodeIdData = nodeIds;
+	m_nodeTypeData = nodeTypes;
+	m_nodeCount = nodeCount;
+	m_outOffsetData = outOffsets;
+	m_edgeData = edges;
+	m_edgeCount = edgeCount;
+	m_inOffsetData = inOffsets;
+	m_inEdgeData = inEdges;
+
+	*key = storedKey;
+	return true;
+}
+
+bool AdjacencyCache::save(const FilePath& cacheFilePath, const std::string& key) const
+{
+	return MappedFile::save(
+		cacheFilePath, s_cacheFileMagic, s_cacheFileVersion, key, [this](std::ofstream& out) {
+			write(out);
+		});
+}
+
+size_t AdjacencyCache::getNodeCount() const
+{
+	return m_nodeCount;
+}
+
+size_t AdjacencyCache::getEdgeCount() const
+{
+	return m_edgeCount;
+}
+
+int AdjacencyCache::getNodeType(Id nodeId) const
+{
+	const uint32_t index = getNodeIndex(nodeId);
+	if (index == s_noIndex)
+	{
+		return s_unknownNodeType;
+	}
+	return m_nodeTypeData[index];
+}
+
+std::vector<StorageEdge> AdjacencyCache::getEdgesBySourceIds(const std::vector<Id>& sourceIds) const
+{
+	std::vector<StorageEdge> edges;
+	for (const Id sourceId: sourceIds)
+	{
+		const uint32_t index = getNodeIndex(sourceId);
+		if (index == s_noIndex)
+		{
+			continue;
+		}
+
+		for (uint32_t i = m_outOffsetData[index]; i < m_outOffsetData[index + 1]; i++)
+		{
+			edges.push_back(toStorageEdge(m_edgeData[i]));
+		}
+	}
+	return edges;
+}
+
+std::vector<StorageEdge> AdjacencyCache::getEdgesByTargetIds(const std::vector<Id>& targetIds) const
+{
+	std::vector<StorageEdge> edges;
+	for (const Id targetId: targetIds)
+	{
+		const uint32_t index = getNodeIndex(targetId);
+		if (index == s_noIndex)
+		{
+			continue;
+		}
+
+		for (uint32_t i = m_inOffsetData[index]; i < m_inOffsetData[index + 1]; i++)
+		{
+			edges.push_back(toStorageEdge(m_edgeData[m_inEdgeData[i]]));
+		}
+	}
+	return edges;
+}
+
+uint32_t AdjacencyCache::getNodeIndex(Id nodeId) const
+{
+	const Id* end = m_nodeIdData + m_nodeCount;
+	const Id* it = std::lower_bound(m_nodeIdData, end, nodeId);
+	if (it == end || *it != nodeId)
+	{
+		return s_noIndex;
+	}
+	return static_cast<uint32_t>(it - m_nodeIdData);
+}
+
+StorageEdge AdjacencyCache::toStorageEdge(const AdjacencyEdge& edge) const
+{
+	return StorageEdge(edge.id, edge.type, m_nodeIdData[edge.source], m_nodeIdData[edge.target]);
+}
+
+void AdjacencyCache::useOwnedData()
+{
+	m_dataOwner.reset();
+	m_nodeIdData = m_nodeIds.data();
+	m_nodeTypeData = m_nodeTypes.data();
+	m_nodeCount = m_nodeIds.size();
+	m_outOffsetData = m_outOffsets.data();
+	m_edgeData = m_edges.data();
+	m_edgeCount = m_edges.size();
+	m_inOffsetData = m_inOffsets.data();
+	m_inEdgeData = m_inEdges.data();
+}
+
+void AdjacencyCache::write(std::ofstream& out) const
+{
+	CacheFileHeader header;
+	header.idSize = sizeof(Id);
+	header.edgeSize = sizeof(AdjacencyEdge);
+	header.nodeCount = static_cast<uint32_t>(m_nodeCount);
+	header.edgeCount = static_cast<uint32_t>(m_edgeCount);
+
+	MappedFile::writePadded(out, &header, sizeof(header));
+	MappedFile::writePadded(out, m_nodeIdData, m_nodeCount * sizeof(Id));
+	MappedFile::writePadded(out, m_nodeTypeData, m_nodeCount * sizeof(int32_t));
+	MappedFile::writePadded(out, m_outOffsetData, (m_nodeCount + 1) * sizeof(uint32_t));
+	MappedFile::writePadded(out, m_edgeData, m_edgeCount * sizeof(AdjacencyEdge));
+	MappedFile::writePadded(out, m_inOffsetData, (m_nodeCount + 1) * sizeof(uint32_t));
+	MappedFile::writePadded(out, m_inEdgeData, m_edgeCount * sizeof(uint32_t));
+}
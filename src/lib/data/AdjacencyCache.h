@@ -0,0 +1,92 @@
+#ifndef ADJACENCY_CACHE_H
+#define ADJACENCY_CACHE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "StorageEdge.h"
+#include "types.h"
+
+class FilePath;
+
+// node kinds and edges of all nodes in compressed sparse rows, so graph traversals don't need to
+// query the database for every step. like the hierarchy cache it can be stored beside the database
+// and mapped on load.
+class AdjacencyCache
+{
+public:
+	static const int s_unknownNodeType;
+
+	AdjacencyCache();
+
+	void clear();
+	bool isEmpty() const;
+
+	void addNode(Id nodeId, int type);
+	void addEdge(Id edgeId, int type, Id sourceId, Id targetId);
+
+	// makes all added nodes and edges queryable, replaces previously flattened data
+	void finishSetup();
+
+	// maps the cache file and returns the key it was saved with
+	bool load(const FilePath& cacheFilePath, std::string* key);
+	bool save(const FilePath& cacheFilePath, const std::string& key) const;
+
+	size_t getNodeCount() const;
+	size_t getEdgeCount() const;
+
+	// returns s_unknownNodeType for nodes that were not added
+	int getNodeType(Id nodeId) const;
+
+	std::vector<StorageEdge> getEdgesBySourceIds(const std::vector<Id>& sourceIds) const;
+	std::vector<StorageEdge> getEdgesByTargetIds(const std::vector<Id>& targetIds) const;
+
+private:
+	static const uint32_t s_noIndex;
+
+	// source and target are node indices
+	struct AdjacencyEdge
+	{
+		Id id;
+		int32_t type;
+		uint32_t source;
+		uint32_t target;
+		uint32_t padding;
+	};
+
+	uint32_t getNodeIndex(Id nodeId) const;
+	StorageEdge toStorageEdge(const AdjacencyEdge& edge) const;
+
+	void useOwnedData();
+	void write(std::ofstream& out) const;
+
+	// node ids are sorted, so nodes are found by binary search
+	std::vector<Id> m_nodeIds;
+	std::vector<int32_t> m_nodeTypes;
+
+	// edges are sorted by source, the outgoing edges of node i are [outOffsets[i], outOffsets[i+1])
+	std::vector<uint32_t> m_outOffsets;
+	std::vector<AdjacencyEdge> m_edges;
+
+	// edge indices sorted by target, the incoming edges of node i are [inOffsets[i], inOffsets[i+1])
+	std::vector<uint32_t> m_inOffsets;
+	std::vector<uint32_t> m_inEdges;
+
+	std::shared_ptr<const void> m_dataOwner;
+	const Id* m_nodeIdData = nullptr;
+	const int32_t* m_nodeTypeData = nullptr;
+	size_t m_nodeCount = 0;
+	const uint32_t* m_outOffsetData = nullptr;
+	const AdjacencyEdge* m_edgeData = nullptr;
+	size_t m_edgeCount = 0;
+	const uint32_t* m_inOffsetData = nullptr;
+	const uint32_t* m_inEdgeData = nullptr;
+
+	std::vector<std::pair<Id, int>> m_buildNodes;
+	std::vector<StorageEdge> m_buildEdges;
+};
+
+#endif	  // ADJACENCY_CACHE_H
@@ -1,194 +1,242 @@
 #include "HierarchyCache.h"
 
-#include "utility.h"
+#include <algorithm>
+#include <fstream>
 
-HierarchyCache::HierarchyNode::HierarchyNode(Id nodeId)
-	: m_nodeId(nodeId), m_edgeId(0), m_parent(nullptr), m_isVisible(true), m_isImplicit(false)
-{
-}
+#include "FilePath.h"
+#include "MappedFile.h"
+#include "logging.h"
 
-Id HierarchyCache::HierarchyNode::getNodeId() const
+namespace
 {
-	return m_nodeId;
-}
+const char s_cacheFileMagic[8] = {'S', 'R', 'C', 'T', 'R', 'L', 'H', 'C'};
+const uint32_t s_cacheFileVersion = 2;
 
-Id HierarchyCache::HierarchyNode::getEdgeId() const
+struct CacheFileHeader
 {
-	return m_edgeId;
-}
+	uint32_t idSize;
+	uint32_t nodeSize;
+	uint32_t nodeCount;
+	uint32_t childCount;
+	uint32_t baseCount;
+};
+}	 // namespace
 
-void HierarchyCache::HierarchyNode::setEdgeId(Id edgeId)
-{
-	m_edgeId = edgeId;
-}
+const uint32_t HierarchyCache::s_noIndex = ~uint32_t(0);
 
-HierarchyCache::HierarchyNode* HierarchyCache::HierarchyNode::getParent() const
+HierarchyCache::HierarchyCache()
 {
-	return m_parent;
+	useOwnedData();
 }
 
-void HierarchyCache::HierarchyNode::setParent(HierarchyNode* parent)
+void HierarchyCache::clear()
 {
-	m_parent = parent;
-}
+	m_nodeIds = std::vector<Id>();
+	m_nodes = std::vector<HierarchyNode>();
+	m_children = std::vector<uint32_t>();
+	m_baseNodes = std::vector<uint32_t>();
+	m_baseEdgeIds = std::vector<Id>();
 
-void HierarchyCache::HierarchyNode::addBase(HierarchyNode* base, Id edgeId)
-{
-	m_bases.push_back(base);
-	m_baseEdgeIds.push_back(edgeId);
-}
+	m_buildConnections = std::vector<BuildConnection>();
+	m_buildInheritances = std::vector<BuildInheritance>();
 
-void HierarchyCache::HierarchyNode::addChild(HierarchyNode* child)
-{
-	m_children.push_back(child);
+	useOwnedData();
 }
 
-size_t HierarchyCache::HierarchyNode::getChildrenCount() const
-{
-	return m_children.size();
-}
-
-size_t HierarchyCache::HierarchyNode::getNonImplicitChildrenCount() const
+void HierarchyCache::createConnection(
+	Id edgeId, Id fromId, Id toId, bool sourceVisible, bool sourceImplicit, bool targetImplicit)
 {
-	size_t count = 0;
-	for (const HierarchyNode* child: m_children)
+	if (fromId == toId)
 	{
-		if (!child->isImplicit())
-		{
-			count++;
-		}
+		return;
 	}
-	return count;
+
+	m_buildConnections.push_back(
+		{edgeId, fromId, toId, sourceVisible, sourceImplicit, targetImplicit});
 }
 
-void HierarchyCache::HierarchyNode::addChildIds(std::vector<Id>* nodeIds, std::vector<Id>* edgeIds) const
+void HierarchyCache::createInheritance(Id edgeId, Id fromId, Id toId)
 {
-	for (const HierarchyNode* child: m_children)
+	if (fromId == toId)
 	{
-		nodeIds->push_back(child->getNodeId());
-		edgeIds->push_back(child->getEdgeId());
+		return;
 	}
+
+	m_buildInheritances.push_back({edgeId, fromId, toId});
 }
 
-void HierarchyCache::HierarchyNode::addNonImplicitChildIds(
-	std::vector<Id>* nodeIds, std::vector<Id>* edgeIds) const
+void HierarchyCache::finishSetup()
 {
-	for (const HierarchyNode* child: m_children)
+	std::vector<Id> nodeIds;
+	nodeIds.reserve(2 * (m_buildConnections.size() + m_buildInheritances.size()));
+	for (const BuildConnection& connection: m_buildConnections)
 	{
-		if (!child->isImplicit())
-		{
-			nodeIds->push_back(child->getNodeId());
-			edgeIds->push_back(child->getEdgeId());
-		}
+		nodeIds.push_back(connection.fromId);
+		nodeIds.push_back(connection.toId);
 	}
-}
-
-void HierarchyCache::HierarchyNode::addChildIdsRecursive(std::set<Id>* nodeIds, std::set<Id>* edgeIds) const
-{
-	for (const HierarchyNode* child: m_children)
+	for (const BuildInheritance& inheritance: m_buildInheritances)
 	{
-		nodeIds->insert(child->getNodeId());
-		edgeIds->insert(child->getEdgeId());
-
-		child->addChildIdsRecursive(nodeIds, edgeIds);
+		nodeIds.push_back(inheritance.fromId);
+		nodeIds.push_back(inheritance.toId);
 	}
-}
+	std::sort(nodeIds.begin(), nodeIds.end());
+	nodeIds.erase(std::unique(nodeIds.begin(), nodeIds.end()), nodeIds.end());
+
+	m_nodeIds = std::move(nodeIds);
+	m_nodes = std::vector<HierarchyNode>(
+		m_nodeIds.size(), HierarchyNode {0, s_noIndex, NODE_VISIBLE, 0, 0, 0, 0});
+	useOwnedData();
+
+	// later connections overwrite the states set by earlier ones
+	std::vector<uint32_t> childParents;
+	childParents.reserve(m_buildConnections.size());
+	for (const BuildConnection& connection: m_buildConnections)
+	{
+		const uint32_t from = getNodeIndex(connection.fromId);
+		const uint32_t to = getNodeIndex(connection.toId);
 
-bool HierarchyCache::HierarchyNode::isVisible() const
-{
-	return m_isVisible;
-}
+		HierarchyNode& fromNode = m_nodes[from];
+		fromNode.childCount++;
+		fromNode.flags = (connection.sourceVisible ? static_cast<uint32_t>(NODE_VISIBLE) : 0u) |
+			(connection.sourceImplicit ? static_cast<uint32_t>(NODE_IMPLICIT) : 0u);
 
-void HierarchyCache::HierarchyNode::setIsVisible(bool isVisible)
-{
-	m_isVisible = isVisible;
-}
+		HierarchyNode& toNode = m_nodes[to];
+		toNode.parent = from;
+		toNode.edgeId = connection.edgeId;
+		toNode.flags = (toNode.flags & NODE_VISIBLE) |
+			(connection.targetImplicit ? static_cast<uint32_t>(NODE_IMPLICIT) : 0u);
 
-bool HierarchyCache::HierarchyNode::isImplicit() const
-{
-	return m_isImplicit;
-}
+		childParents.push_back(from);
+	}
 
-void HierarchyCache::HierarchyNode::setIsImplicit(bool isImplicit)
-{
-	m_isImplicit = isImplicit;
-}
+	std::vector<uint32_t> baseSources;
+	baseSources.reserve(m_buildInheritances.size());
+	for (const BuildInheritance& inheritance: m_buildInheritances)
+	{
+		const uint32_t from = getNodeIndex(inheritance.fromId);
+		m_nodes[from].baseCount++;
+		baseSources.push_back(from);
+	}
 
-std::map</*target*/ Id, std::vector<std::pair</*source*/ Id, /*edge*/ Id>>>
-HierarchyCache::HierarchyNode::getReverseReachableInheritanceSubgraph() const
-{
-	std::map<Id, std::vector<std::pair<Id, Id>>> reverseGraph;
-	reverseGraph.try_emplace(getNodeId());  // mark start node as visited
-	getReverseReachableInheritanceSubgraphHelper(reverseGraph);
-	return reverseGraph;
-}
+	uint32_t childOffset = 0;
+	uint32_t baseOffset = 0;
+	for (HierarchyNode& node: m_nodes)
+	{
+		node.firstChild = childOffset;
+		node.firstBase = baseOffset;
+		childOffset += node.childCount;
+		baseOffset += node.baseCount;
+		node.childCount = 0;
+		node.baseCount = 0;
+	}
 
-void HierarchyCache::HierarchyNode::getReverseReachableInheritanceSubgraphHelper(
-	std::map</*target*/ Id, std::vector<std::pair</*source*/ Id, /*edge*/ Id>>>& reverseGraph) const
-{
-	for (size_t i = 0; i < m_bases.size(); ++i)
+	// children and bases keep the order in which they were created
+	m_children = std::vector<uint32_t>(childParents.size());
+	for (size_t i = 0; i < childParents.size(); i++)
 	{
-		HierarchyNode* base = m_bases[i];
-		auto emplacedBase = reverseGraph.try_emplace(base->getNodeId());
-		emplacedBase.first->second.push_back({getNodeId(), m_baseEdgeIds[i]});
-		if (emplacedBase.second)
-		{
-			base->getReverseReachableInheritanceSubgraphHelper(reverseGraph);
-		}
+		HierarchyNode& node = m_nodes[childParents[i]];
+		m_children[node.firstChild + node.childCount++] = getNodeIndex(m_buildConnections[i].toId);
 	}
-}
 
+	m_baseNodes = std::vector<uint32_t>(baseSources.size());
+	m_baseEdgeIds = std::vector<Id>(baseSources.size());
+	for (size_t i = 0; i < baseSources.size(); i++)
+	{
+		HierarchyNode& node = m_nodes[baseSources[i]];
+		const uint32_t pos = node.firstBase + node.baseCount++;
+		m_baseNodes[pos] = getNodeIndex(m_buildInheritances[i].toId);
+		m_baseEdgeIds[pos] = m_buildInheritances[i].edgeId;
+	}
 
-void HierarchyCache::clear()
-{
-	m_nodes.clear();
+	m_buildConnections = std::vector<BuildConnection>();
+	m_buildInheritances = std::vector<BuildInheritance>();
+
+	useOwnedData();
 }
 
-void HierarchyCache::createConnection(
-	Id edgeId, Id fromId, Id toId, bool sourceVisible, bool sourceImplicit, bool targetImplicit)
+bool HierarchyCache::load(const FilePath& cacheFilePath, std::string* key)
 {
-	if (fromId == toId)
+	MappedFile reader(cacheFilePath);
+	if (!reader.isMapped())
 	{
-		return;
+		return false;
 	}
 
-	HierarchyNode* from = createNode(fromId);
-	HierarchyNode* to = createNode(toId);
+	std::string storedKey;
+	if (!reader.readHeader(s_cacheFileMagic, s_cacheFileVersion, &storedKey))
+	{
+		return false;
+	}
 
-	from->addChild(to);
-	to->setParent(from);
+	const CacheFileHeader* header = reader.read<CacheFileHeader>(1);
+	if (!header || header->idSize != sizeof(Id) || header->nodeSize != sizeof(HierarchyNode))
+	{
+		return false;
+	}
 
-	from->setIsVisible(sourceVisible);
-	from->setIsImplicit(sourceImplicit);
+	const Id* nodeIds = reader.read<Id>(header->nodeCount);
+	const HierarchyNode* nodes = reader.read<HierarchyNode>(header->nodeCount);
+	const uint32_t* children = reader.read<uint32_t>(header->childCount);
+	const uint32_t* baseNodes = reader.read<uint32_t>(header->baseCount);
+	const Id* baseEdgeIds = reader.read<Id>(header->baseCount);
 
-	to->setEdgeId(edgeId);
-	to->setIsImplicit(targetImplicit);
-}
+	// ranges are checked once, so queries can rely on them
+	const size_t nodeCount = header->nodeCount;
+	bool valid = !reader.failed();
+	for (size_t i = 0; i < nodeCount && valid; i++)
+	{
+		const HierarchyNode& node = nodes[i];
+		valid = (i == 0 || nodeIds[i - 1] < nodeIds[i]) &&
+			(node.parent == s_noIndex || node.parent < nodeCount) &&
+			size_t(node.firstChild) + node.childCount <= header->childCount &&
+			size_t(node.firstBase) + node.baseCount <= header->baseCount;
+	}
+	for (size_t i = 0; i < header->childCount && valid; i++)
+	{
+		valid = children[i] < nodeCount;
+	}
+	for (size_t i = 0; i < header->baseCount && valid; i++)
+	{
+		valid = baseNodes[i] < nodeCount;
+	}
 
-void HierarchyCache::createInheritance(Id edgeId, Id fromId, Id toId)
-{
-	if (fromId == toId)
+	if (!valid)
 	{
-		return;
+		LOG_WARNING(L"Hierarchy cache \"" + cacheFilePath.wstr() + L"\" is corrupted.");
+		return false;
 	}
 
-	HierarchyNode* from = createNode(fromId);
-	HierarchyNode* to = createNode(toId);
+	clear();
+
+	m_dataOwner = reader.getDataOwner();
+	m_nodeIdData = nodeIds;
+	m_nodeData = nodes;
+	m_nodeCount = nodeCount;
+	m_childData = children;
+	m_childCount = header->childCount;
+	m_baseNodeData = baseNodes;
+	m_baseEdgeIdData = baseEdgeIds;
+	m_baseCount = header->baseCount;
 
-	from->addBase(to, edgeId);
+	*key = storedKey;
+	return true;
 }
 
-Id HierarchyCache::getLastVisibleParentNodeId(Id nodeId) const
+bool HierarchyCache::save(const FilePath& cacheFilePath, const std::string& key) const
 {
-	HierarchyNode* node = nullptr;
-	HierarchyNode* parent = getNode(nodeId);
+	return MappedFile::save(
+		cacheFilePath, s_cacheFileMagic, s_cacheFileVersion, key, [this](std::ofstream& out) {
+			write(out);
+		});
+}
 
-	while (parent && parent->isVisible())
+Id HierarchyCache::getLastVisibleParentNodeId(Id nodeId) const
+{
+	uint32_t index = getNodeIndex(nodeId);
+	while (index != s_noIndex && (m_nodeData[index].flags & NODE_VISIBLE))
 	{
-		node = parent;
-		parent = node->getParent();
-
-		nodeId = node->getNodeId();
+		nodeId = m_nodeIdData[index];
+		index = m_nodeData[index].parent;
 	}
 
 	return nodeId;
@@ -196,18 +244,17 @@ Id HierarchyCache::getLastVisibleParentNodeId(Id nodeId) const
 
 size_t HierarchyCache::getIndexOfLastVisibleParentNode(Id nodeId) const
 {
-	HierarchyNode* node = nullptr;
-	HierarchyNode* parent = getNode(nodeId);
+	uint32_t index = getNodeIndex(nodeId);
 
 	size_t idx = 0;
 	bool visible = false;
 
-	while (parent)
+	while (index != s_noIndex)
 	{
-		node = parent;
-		parent = node->getParent();
+		const HierarchyNode& node = m_nodeData[index];
+		index = node.parent;
 
-		if (node->isVisible() && !idx)
+		if ((node.flags & NODE_VISIBLE) && !idx)
 		{
 			visible = true;
 		}
@@ -223,79 +270,99 @@ size_t HierarchyCache::getIndexOfLastVisibleParentNode(Id nodeId) const
 void HierarchyCache::addAllVisibleParentIdsForNodeId(
 	Id nodeId, std::set<Id>* nodeIds, std::set<Id>* edgeIds) const
 {
-	HierarchyNode* node = getNode(nodeId);
+	uint32_t index = getNodeIndex(nodeId);
 	Id edgeId = 0;
-	while (node && node->isVisible())
+	while (index != s_noIndex && (m_nodeData[index].flags & NODE_VISIBLE))
 	{
 		if (edgeId)
 		{
 			edgeIds->insert(edgeId);
 		}
 
-		nodeIds->insert(node->getNodeId());
-		edgeId = node->getEdgeId();
+		nodeIds->insert(m_nodeIdData[index]);
+		edgeId = m_nodeData[index].edgeId;
 
-		node = node->getParent();
+		index = m_nodeData[index].parent;
 	}
 }
 
 void HierarchyCache::addAllChildIdsForNodeId(Id nodeId, std::set<Id>* nodeIds, std::set<Id>* edgeIds) const
 {
-	HierarchyNode* node = getNode(nodeId);
-	if (node && node->isVisible())
+	const uint32_t index = getNodeIndex(nodeId);
+	if (index == s_noIndex || !(m_nodeData[index].flags & NODE_VISIBLE))
+	{
+		return;
+	}
+
+	std::vector<uint32_t> stack(1, index);
+	while (!stack.empty())
 	{
-		node->addChildIdsRecursive(nodeIds, edgeIds);
+		const HierarchyNode& node = m_nodeData[stack.back()];
+		stack.pop_back();
+
+		for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; i++)
+		{
+			const uint32_t child = m_childData[i];
+			nodeIds->insert(m_nodeIdData[child]);
+			edgeIds->insert(m_nodeData[child].edgeId);
+			stack.push_back(child);
+		}
 	}
 }
 
 void HierarchyCache::addFirstChildIdsForNodeId(
 	Id nodeId, std::vector<Id>* nodeIds, std::vector<Id>* edgeIds) const
 {
-	HierarchyNode* node = getNode(nodeId);
-	if (node)
+	const uint32_t index = getNodeIndex(nodeId);
+	if (index == s_noIndex)
 	{
-		if (node->isImplicit())
-		{
-			node->addChildIds(nodeIds, edgeIds);
-		}
-		else
+		return;
+	}
+
+	const HierarchyNode& node = m_nodeData[index];
+	const bool addImplicit = node.flags & NODE_IMPLICIT;
+	for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; i++)
+	{
+		const HierarchyNode& child = m_nodeData[m_childData[i]];
+		if (addImplicit || !(child.flags & NODE_IMPLICIT))
 		{
-			node->addNonImplicitChildIds(nodeIds, edgeIds);
+			nodeIds->push_back(m_nodeIdData[m_childData[i]]);
+			edgeIds->push_back(child.edgeId);
 		}
 	}
 }
 
 size_t HierarchyCache::getFirstChildIdsCountForNodeId(Id nodeId) const
 {
-	HierarchyNode* node = getNode(nodeId);
-	if (node)
+	const uint32_t index = getNodeIndex(nodeId);
+	if (index == s_noIndex)
 	{
-		if (node->isImplicit())
-		{
-			return node->getChildrenCount();
-		}
-		else
-		{
-			return node->getNonImplicitChildrenCount();
-		}
+		return 0;
 	}
-	return 0;
+
+	const HierarchyNode& node = m_nodeData[index];
+	if (node.flags & NODE_IMPLICIT)
+	{
+		return node.childCount;
+	}
+	return getNonImplicitChildCount(node);
 }
 
 bool HierarchyCache::isChildOfVisibleNodeOrInvisible(Id nodeId) const
 {
-	HierarchyNode* node = getNode(nodeId);
-	if (!node)
+	const uint32_t index = getNodeIndex(nodeId);
+	if (index == s_noIndex)
 	{
 		return false;
 	}
 
-	if (!node->isVisible())
+	const HierarchyNode& node = m_nodeData[index];
+	if (!(node.flags & NODE_VISIBLE))
 	{
 		return true;
 	}
 
-	if (node->getParent() && node->getParent()->isVisible())
+	if (node.parent != s_noIndex && (m_nodeData[node.parent].flags & NODE_VISIBLE))
 	{
 		return true;
 	}
@@ -305,35 +372,20 @@ bool HierarchyCache::isChildOfVisibleNodeOrInvisible(Id nodeId) const
 
 bool HierarchyCache::nodeHasChildren(Id nodeId) const
 {
-	HierarchyNode* node = getNode(nodeId);
-	if (node)
-	{
-		return node->getChildrenCount();
-	}
-
-	return false;
+	const uint32_t index = getNodeIndex(nodeId);
+	return index != s_noIndex && m_nodeData[index].childCount;
 }
 
 bool HierarchyCache::nodeIsVisible(Id nodeId) const
 {
-	HierarchyNode* node = getNode(nodeId);
-	if (node)
-	{
-		return node->isVisible();
-	}
-
-	return false;
+	const uint32_t index = getNodeIndex(nodeId);
+	return index != s_noIndex && (m_nodeData[index].flags & NODE_VISIBLE);
 }
 
 bool HierarchyCache::nodeIsImplicit(Id nodeId) const
 {
-	HierarchyNode* node = getNode(nodeId);
-	if (node)
-	{
-		return node->isImplicit();
-	}
-
-	return false;
+	const uint32_t index = getNodeIndex(nodeId);
+	return index != s_noIndex && (m_nodeData[index].flags & NODE_IMPLICIT);
 }
 
 std::vector<std::tuple</*source*/ Id, /*target*/ Id, std::vector</*edge*/ Id>>>
@@ -369,20 +421,26 @@ HierarchyCache::getInheritanceEdgesForNodeId(
 		return inheritanceEdges;
 	}
 
-	HierarchyNode* sourceNode = getNode(sourceId);
-	if (!sourceNode)
+	const uint32_t sourceIndex = getNodeIndex(sourceId);
+	if (sourceIndex == s_noIndex)
 	{
 		return inheritanceEdges;
 	}
 
-	std::map<Id, std::vector<std::pair<Id, Id>>> reverseGraph
-		= sourceNode->getReverseReachableInheritanceSubgraph();
+	std::map<uint32_t, std::vector<std::pair<uint32_t, Id>>> reverseGraph =
+		getReverseReachableInheritanceSubgraph(sourceIndex);
 
-	for (Id targetId : targetIds)
+	for (Id targetId: targetIds)
 	{
-		std::set<Id> nodes;
+		const uint32_t targetIndex = getNodeIndex(targetId);
+		if (targetIndex == s_noIndex)
+		{
+			continue;
+		}
+
+		std::set<uint32_t> nodes;
 		std::vector<Id> edges;
-		getReverseReachable(targetId, reverseGraph, nodes, edges);
+		getReverseReachable(targetIndex, reverseGraph, nodes, edges);
 
 		if (!edges.empty())
 		{
@@ -393,52 +451,107 @@ HierarchyCache::getInheritanceEdgesForNodeId(
 	return inheritanceEdges;
 }
 
+std::map</*target*/ uint32_t, std::vector<std::pair</*source*/ uint32_t, /*edge*/ Id>>>
+HierarchyCache::getReverseReachableInheritanceSubgraph(uint32_t nodeIndex) const
+{
+	std::map<uint32_t, std::vector<std::pair<uint32_t, Id>>> reverseGraph;
+	reverseGraph.try_emplace(nodeIndex);  // mark start node as visited
+	getReverseReachableInheritanceSubgraphHelper(nodeIndex, reverseGraph);
+	return reverseGraph;
+}
+
+void HierarchyCache::getReverseReachableInheritanceSubgraphHelper(
+	uint32_t nodeIndex,
+	std::map</*target*/ uint32_t, std::vector<std::pair</*source*/ uint32_t, /*edge*/ Id>>>&
+		reverseGraph) const
+{
+	const HierarchyNode& node = m_nodeData[nodeIndex];
+	for (uint32_t i = node.firstBase; i < node.firstBase + node.baseCount; i++)
+	{
+		const uint32_t base = m_baseNodeData[i];
+		auto emplacedBase = reverseGraph.try_emplace(base);
+		emplacedBase.first->second.push_back({nodeIndex, m_baseEdgeIdData[i]});
+		if (emplacedBase.second)
+		{
+			getReverseReachableInheritanceSubgraphHelper(base, reverseGraph);
+		}
+	}
+}
+
 void HierarchyCache::getReverseReachable(
-	Id nodeId,
-	const std::map</*target*/ Id, std::vector<std::pair</*source*/ Id, /*edge*/ Id>>>& reverseGraph,
-	std::set<Id>& nodes,
+	uint32_t nodeIndex,
+	const std::map</*target*/ uint32_t, std::vector<std::pair</*source*/ uint32_t, /*edge*/ Id>>>&
+		reverseGraph,
+	std::set<uint32_t>& nodes,
 	std::vector<Id>& edges)
 {
-	if (!nodes.insert(nodeId).second)
+	if (!nodes.insert(nodeIndex).second)
 	{
 		return;
 	}
 
-	auto search = reverseGraph.find(nodeId);
+	auto search = reverseGraph.find(nodeIndex);
 	if (search == reverseGraph.end())
 	{
 		return;
 	}
 
-	for (const std::pair<Id, Id>& nodeAndEdge : search->second)
+	for (const std::pair<uint32_t, Id>& nodeAndEdge: search->second)
 	{
-		Id node = nodeAndEdge.first;
-		Id edge = nodeAndEdge.second;
-		edges.push_back(edge);
-		getReverseReachable(node, reverseGraph, nodes, edges);
+		edges.push_back(nodeAndEdge.second);
+		getReverseReachable(nodeAndEdge.first, reverseGraph, nodes, edges);
 	}
 }
 
-HierarchyCache::HierarchyNode* HierarchyCache::getNode(Id nodeId) const
+uint32_t HierarchyCache::getNodeIndex(Id nodeId) const
 {
-	auto it = m_nodes.find(nodeId);
-
-	if (it != m_nodes.end())
+	const Id* it = std::lower_bound(m_nodeIdData, m_nodeIdData + m_nodeCount, nodeId);
+	if (it != m_nodeIdData + m_nodeCount && *it == nodeId)
 	{
-		return it->second.get();
+		return static_cast<uint32_t>(it - m_nodeIdData);
 	}
-
-	return nullptr;
+	return s_noIndex;
 }
 
-HierarchyCache::HierarchyNode* HierarchyCache::createNode(Id nodeId)
+size_t HierarchyCache::getNonImplicitChildCount(const HierarchyNode& node) const
 {
-	auto it = m_nodes.find(nodeId);
-
-	if (it == m_nodes.end())
+	size_t count = 0;
+	for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; i++)
 	{
-		it = m_nodes.emplace(nodeId, std::make_unique<HierarchyNode>(nodeId)).first;
+		if (!(m_nodeData[m_childData[i]].flags & NODE_IMPLICIT))
+		{
+			count++;
+		}
 	}
+	return count;
+}
+
+void HierarchyCache::useOwnedData()
+{
+	m_dataOwner.reset();
+	m_nodeIdData = m_nodeIds.data();
+	m_nodeData = m_nodes.data();
+	m_nodeCount = m_nodes.size();
+	m_childData = m_children.data();
+	m_childCount = m_children.size();
+	m_baseNodeData = m_baseNodes.data();
+	m_baseEdgeIdData = m_baseEdgeIds.data();
+	m_baseCount = m_baseNodes.size();
+}
+
+void HierarchyCache::write(std::ofstream& out) const
+{
+	CacheFileHeader header;
+	header.idSize = sizeof(Id);
+	header.nodeSize = sizeof(HierarchyNode);
+	header.nodeCount = static_cast<uint32_t>(m_nodeCount);
+	header.childCount = static_cast<uint32_t>(m_childCount);
+	header.baseCount = static_cast<uint32_t>(m_baseCount);
 
-	return it->second.get();
+	MappedFile::writePadded(out, &header, sizeof(header));
+	MappedFile::writePadded(out, m_nodeIdData, m_nodeCount * sizeof(Id));
+	MappedFile::writePadded(out, m_nodeData, m_nodeCount * sizeof(HierarchyNode));
+	MappedFile::writePadded(out, m_childData, m_childCount * sizeof(uint32_t));
+	MappedFile::writePadded(out, m_baseNodeData, m_baseCount * sizeof(uint32_t));
+	MappedFile::writePadded(out, m_baseEdgeIdData, m_baseCount * sizeof(Id));
 }
@@ -1,22 +1,39 @@
 #ifndef HIERARCHY_CACHE_H
 #define HIERARCHY_CACHE_H
 
+#include <cstdint>
+#include <iosfwd>
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #include "types.h"
 
+class FilePath;
+
+// member and inheritance hierarchy of all nodes, that is flattened into contiguous arrays by
+// finishSetup, so it can be stored beside the database and mapped on load
 class HierarchyCache
 {
 public:
+	HierarchyCache();
+
 	void clear();
 
 	void createConnection(
 		Id edgeId, Id fromId, Id toId, bool sourceVisible, bool sourceImplicit, bool targetImplicit);
 	void createInheritance(Id edgeId, Id fromId, Id toId);
 
+	// makes all created connections and inheritances queryable, replaces previously flattened data
+	void finishSetup();
+
+	// maps the cache file and returns the key it was saved with
+	bool load(const FilePath& cacheFilePath, std::string* key);
+	bool save(const FilePath& cacheFilePath, const std::string& key) const;
+
 	Id getLastVisibleParentNodeId(Id nodeId) const;
 	size_t getIndexOfLastVisibleParentNode(Id nodeId) const;
 
@@ -37,90 +54,106 @@ public:
 		getInheritanceEdgesForNodeId(Id sourceId, const std::set<Id>& targetIds) const;
 
 private:
+	static const uint32_t s_noIndex;
+
+	enum HierarchyNodeFlag : uint32_t
+	{
+		NODE_VISIBLE = 1,
+		NODE_IMPLICIT = 2
+	};
+
+	// children and bases of a node are consecutive ranges of the child and base arrays
+	struct HierarchyNode
+	{
+		Id edgeId;	  // member edge from the parent
+		uint32_t parent;
+		uint32_t flags;
+		uint32_t firstChild;
+		uint32_t childCount;
+		uint32_t firstBase;
+		uint32_t baseCount;
+	};
+
+	struct BuildConnection
+	{
+		Id edgeId;
+		Id fromId;
+		Id toId;
+		bool sourceVisible;
+		bool sourceImplicit;
+		bool targetImplicit;
+	};
+
+	struct BuildInheritance
+	{
+		Id edgeId;
+		Id fromId;
+		Id toId;
+	};
+
+	/**
+	 * Determine the reversed subgraph of all nodes and edges that are reachable from a node.
+	 *
+	 * The subgraph is represented by a map that maps a node index *t* to a set of pairs where each
+	 * pair consists of a node index *s* and and edge ID *e* such that *e* refers to an edge from
+	 * *s* to *t*. Note that the mapping is reversed compared to the edges.
+	 */
+	std::map</*target*/ uint32_t, std::vector<std::pair</*source*/ uint32_t, /*edge*/ Id>>>
+		getReverseReachableInheritanceSubgraph(uint32_t nodeIndex) const;
+
+	/**
+	 * Helper for getReverseReachableInheritanceSubgraph().
+	 */
+	void getReverseReachableInheritanceSubgraphHelper(
+		uint32_t nodeIndex,
+		std::map</*target*/ uint32_t, std::vector<std::pair</*source*/ uint32_t, /*edge*/ Id>>>&
+			reverseGraph) const;
+
 	/**
 	 * Determine nodes and edges from which a specific node can be reached in a reversed graph.
 	 *
-	 * A reversed graph can be produced by HierarchyNode::getReverseReachableInheritanceSubgraph().
+	 * A reversed graph can be produced by getReverseReachableInheritanceSubgraph().
 	 *
-	 * @param[in]  nodeId        ID of the target node.
+	 * @param[in]  nodeIndex     Index of the target node.
 	 * @param[in]  reverseGraph  The reversed graph.
-	 * @param[out] nodes         The nodes from which the node @p nodeId can be reached.
-	 * @param[out] edges         The edges from which the node @p nodeId can be reached.
+	 * @param[out] nodes         The nodes from which the node @p nodeIndex can be reached.
+	 * @param[out] edges         The edges from which the node @p nodeIndex can be reached.
 	 *
 	 * @pre The arguments for @p nodes and @p edges must be provided empty.
 	 */
 	static void getReverseReachable(
-		Id nodeId,
-		const std::map</*target*/ Id, std::vector<std::pair</*source*/ Id, /*edge*/ Id>>>&
+		uint32_t nodeIndex,
+		const std::map</*target*/ uint32_t, std::vector<std::pair</*source*/ uint32_t, Id>>>&
 			reverseGraph,
-		std::set<Id>& nodes,
+		std::set<uint32_t>& nodes,
 		std::vector<Id>& edges);
 
-	class HierarchyNode
-	{
-	public:
-		HierarchyNode(Id nodeId);
-
-		Id getNodeId() const;
-
-		Id getEdgeId() const;
-		void setEdgeId(Id edgeId);
-
-		HierarchyNode* getParent() const;
-		void setParent(HierarchyNode* parent);
-
-		void addBase(HierarchyNode* base, Id edgeId);
-
-		void addChild(HierarchyNode* child);
-
-		size_t getChildrenCount() const;
-		size_t getNonImplicitChildrenCount() const;
-
-		void addChildIds(std::vector<Id>* nodeIds, std::vector<Id>* edgeIds) const;
-		void addNonImplicitChildIds(std::vector<Id>* nodeIds, std::vector<Id>* edgeIds) const;
-		void addChildIdsRecursive(std::set<Id>* nodeIds, std::set<Id>* edgeIds) const;
-
-		bool isVisible() const;
-		void setIsVisible(bool isVisible);
-
-		bool isImplicit() const;
-		void setIsImplicit(bool isImplicit);
-
-		/**
-		 * Determine the reversed subgraph of all nodes and edges that are reachable from this node.
-		 *
-		 * The subgraph is represented by a map that maps a node ID *t* to a set of pairs where each
-		 * pair consists of a node ID *s* and and edge ID *e* such that *e* refers to an edge from
-		 * *s* to *t*. Note that the mapping is reversed compared to the edges.
-		 */
-		std::map</*target*/ Id, std::vector<std::pair</*source*/ Id, /*edge*/ Id>>>
-			getReverseReachableInheritanceSubgraph() const;
-
-	private:
-		/**
-		 * Helper for getReverseReachableInheritanceSubgraph().
-		 */
-		void getReverseReachableInheritanceSubgraphHelper(
-			std::map</*target*/ Id, std::vector<std::pair</*source*/ Id, /*edge*/ Id>>>&) const;
-
-		const Id m_nodeId;
-		Id m_edgeId;
-
-		HierarchyNode* m_parent;
-
-		std::vector<HierarchyNode*> m_bases;
-		std::vector<Id> m_baseEdgeIds;
-
-		std::vector<HierarchyNode*> m_children;
-
-		bool m_isVisible;
-		bool m_isImplicit;
-	};
-
-	HierarchyNode* getNode(Id nodeId) const;
-	HierarchyNode* createNode(Id nodeId);
-
-	std::map<Id, std::unique_ptr<HierarchyNode>> m_nodes;
+	uint32_t getNodeIndex(Id nodeId) const;
+	size_t getNonImplicitChildCount(const HierarchyNode& node) const;
+
+	void useOwnedData();
+	void write(std::ofstream& out) const;
+
+	// node ids are sorted, so nodes are found by binary search
+	std::vector<Id> m_nodeIds;
+	std::vector<HierarchyNode> m_nodes;
+	std::vector<uint32_t> m_children;
+	std::vector<uint32_t> m_baseNodes;
+	std::vector<Id> m_baseEdgeIds;
+
+	// refer to the owned data above or to a mapped cache file
+	std::shared_ptr<const void> m_dataOwner;
+	const Id* m_nodeIdData = nullptr;
+	const HierarchyNode* m_nodeData = nullptr;
+	size_t m_nodeCount = 0;
+	const uint32_t* m_childData = nullptr;
+	size_t m_childCount = 0;
+	const uint32_t* m_baseNodeData = nullptr;
+	const Id* m_baseEdgeIdData = nullptr;
+	size_t m_baseCount = 0;
+
+	std::vector<BuildConnection> m_buildConnections;
+	std::vector<BuildInheritance> m_buildInheritances;
 };
 
 #endif	  // HIERARCHY_CACHE_H
@@ -34,6 +34,8 @@ Task::TaskState TaskFinishParsing::doUpdate(std::shared_ptr<Blackboard> blackboa
 
 	m_dialogView->showUnknownProgressDialog(L"Finish Indexing", L"Optimizing database");
 	m_storage->optimizeMemory();
+	m_dialogView->showUnknownProgressDialog(L"Finish Indexing", L"Storing symbol hierarchy");
+	m_storage->saveHierarchyCache();
 	m_dialogView->hideUnknownProgressDialog();
 
 	double time = TimeStamp::durationSeconds(start);
@@ -77,6 +79,27 @@ Task::TaskState TaskFinishParsing::doUpdate(std::shared_ptr<Blackboard> blackboa
 	{
 		status += L" (" + std::to_wstring(errorInfo.fatal) + L" fatal)";
 	}
+	if (blackboard->exists("automatic_pch_total_command_count"))
+	{
+		int reusedCount = 0;
+		int builtCount = 0;
+		int skippedCount = 0;
+		int failedCount = 0;
+		int commandCount = 0;
+		int totalCommandCount = 0;
+		blackboard->get("automatic_pch_reused_count", reusedCount);
+		blackboard->get("automatic_pch_built_count", builtCount);
+		blackboard->get("automatic_pch_skipped_count", skippedCount);
+		blackboard->get("automatic_pch_failed_count", failedCount);
+		blackboard->get("automatic_pch_command_count", commandCount);
+		blackboard->get("automatic_pch_total_command_count", totalCommandCount);
+
+		status += L"; automatic precompiled headers: " + std::to_wstring(reusedCount) +
+			L" reused, " + std::to_wstring(builtCount) + L" built, " +
+			std::to_wstring(skippedCount) + L" skipped, " + std::to_wstring(failedCount) +
+			L" failed, used by " + std::to_wstring(commandCount) + L"/" +
+			std::to_wstring(totalCommandCount) + L" source files";
+	}
 	MessageStatus(status, false, false).dispatch();
 
 	StorageStats stats = m_storage->getStorageStats();
@@ -1,5 +1,6 @@
 #include "TaskInjectStorage.h"
 
+#include "Blackboard.h"
 #include "Storage.h"
 #include "StorageProvider.h"
 
@@ -21,6 +22,7 @@ Task::TaskState TaskInjectStorage::doUpdate(std::shared_ptr<Blackboard> blackboa
 			if (std::shared_ptr<Storage> target = m_target.lock())
 			{
 				target->inject(source.get());
+				blackboard->notifyChange();
 				return STATE_SUCCESS;
 			}
 		}
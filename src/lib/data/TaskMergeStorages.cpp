@@ -1,6 +1,8 @@
 #include "TaskMergeStorages.h"
 
+#include "Blackboard.h"
 #include "StorageProvider.h"
+#include "TimeStamp.h"
 
 TaskMergeStorages::TaskMergeStorages(std::shared_ptr<StorageProvider> storageProvider)
 	: m_storageProvider(storageProvider)
@@ -11,27 +13,36 @@ void TaskMergeStorages::doEnter(std::shared_ptr<Blackboard> blackboard) {}
 
 Task::TaskState TaskMergeStorages::doUpdate(std::shared_ptr<Blackboard> blackboard)
 {
-	if (m_storageProvider->getStorageCount() > 2)	 // largest storage won't be touched here
+	bool merged = false;
+
+	// several of these tasks may run in parallel, each one keeps merging pairs as long as there
+	// are enough storages available instead of waiting for the next repetition
+	while (true)
 	{
-		std::shared_ptr<IntermediateStorage> target = m_storageProvider->consumeSecondLargestStorage();
-		std::shared_ptr<IntermediateStorage> source = m_storageProvider->consumeSecondLargestStorage();
-		if (target && source)
-		{
-			target->inject(source.get());
-			m_storageProvider->insert(target);
-			return STATE_SUCCESS;
-		}
-		else
+		std::pair<std::shared_ptr<IntermediateStorage>, std::shared_ptr<IntermediateStorage>> storages =
+			m_storageProvider->consumeSmallestStoragePair();
+
+		std::shared_ptr<IntermediateStorage> target = storages.first;
+		std::shared_ptr<IntermediateStorage> source = storages.second;
+		if (!target || !source)
 		{
-			if (target)
-			{
-				m_storageProvider->insert(target);
-			}
-			if (source)
-			{
-				m_storageProvider->insert(source);
-			}
+			break;
 		}
+
+		TimeStamp t = TimeStamp::now();
+		target->inject(source.get());
+		m_storageProvider->addMergeStats(
+			source->getSourceLocationCount(), static_cast<float>(TimeStamp::durationSeconds(t)));
+		m_storageProvider->insert(target);
+
+		merged = true;
+	}
+
+	if (merged)
+	{
+		// wakes the injection, which may be waiting for the merged storages
+		blackboard->notifyChange();
+		return STATE_SUCCESS;
 	}
 
 	return STATE_FAILURE;
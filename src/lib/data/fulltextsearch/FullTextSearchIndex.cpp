@@ -1,60 +1,617 @@
 #include "FullTextSearchIndex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <limits>
+#include <unordered_set>
 
+#include "FilePath.h"
+#include "FileSystem.h"
+#include "MappedFile.h"
 #include "logging.h"
 #include "tracing.h"
+#include "utilityString.h"
+
+namespace
+{
+const char s_indexFileMagic[8] = {'S', 'R', 'C', 'T', 'R', 'L', 'F', 'T'};
+const uint32_t s_indexFileVersion = 4;
+
+// suffix array positions are ints, so the text of one segment needs to stay below that
+const size_t s_maxSegmentTextSize = static_cast<size_t>(std::numeric_limits<int>::max());
+
+static_assert(sizeof(int) == sizeof(int32_t), "suffix array positions are stored as 32 bit");
+
+struct IndexFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t charSize;
+	uint32_t segmentCount;
+	uint32_t codecNameLength;
+};
+
+struct IndexFileSegment
+{
+	uint32_t fileCount;
+	uint32_t textLength;
+	uint32_t charOffsetCount;
+	uint32_t lineStartCount;
+};
 
-void FullTextSearchIndex::addFile(Id fileId, const std::wstring& fileContent)
+struct IndexFileEntry
 {
-	if (fileContent.empty())
+	uint32_t filePathLength;
+	uint32_t modificationTimeLength;
+	uint32_t charStart;
+	uint32_t charLength;
+	uint32_t byteStart;
+	uint32_t byteLength;
+	uint32_t lineStart;
+	uint32_t lineCount;
+};
+
+size_t getFileBytes(const FullTextSearchSegment& segment)
+{
+	size_t bytes = 0;
+	for (const FullTextSearchFile& file: segment.files)
 	{
-		LOG_ERROR("empty file not added to fulltextsearch index");
+		bytes += file.byteLength;
 	}
+	return bytes;
+}
+}	 // namespace
+
+FullTextSearchSegment::FullTextSearchSegment(
+	SuffixArray array, std::vector<FullTextSearchFile> files, std::vector<int> lineStarts)
+	: array(std::move(array)), files(std::move(files)), m_lineStarts(std::move(lineStarts))
+{
+}
+
+FullTextSearchSegment::FullTextSearchSegment(
+	SuffixArray array,
+	std::vector<FullTextSearchFile> files,
+	std::shared_ptr<const void> dataOwner,
+	const int* lineStarts,
+	size_t lineStartCount)
+	: array(std::move(array))
+	, files(std::move(files))
+	, m_dataOwner(dataOwner)
+	, m_dataLineStarts(lineStarts)
+	, m_dataLineStartCount(lineStartCount)
+{
+}
+
+const int* FullTextSearchSegment::getLineStarts() const
+{
+	return m_dataOwner ? m_dataLineStarts : m_lineStarts.data();
+}
+
+size_t FullTextSearchSegment::getLineStartCount() const
+{
+	return m_dataOwner ? m_dataLineStartCount : m_lineStarts.size();
+}
+
+const size_t FullTextSearchIndex::s_maxSegmentCount = 4;
 
-	if (static_cast<int>(fileContent.size()) >= std::numeric_limits<int>::max())
+void FullTextSearchIndex::addFile(const StorageFile& file, const std::wstring& fileContent)
+{
+	const std::string text = SuffixArray::getSearchableText(fileContent);
+	if (text.size() >= s_maxSegmentTextSize)
 	{
 		LOG_ERROR("file too big not added to fulltextsearch index");
+		return;
+	}
+
+	// lines are split after each newline, like in TextAccess
+	std::vector<int> lineStarts = {0};
+	for (size_t i = 0; i + 1 < fileContent.size(); i++)
+	{
+		if (fileContent[i] == L'\n')
+		{
+			lineStarts.push_back(static_cast<int>(i + 1));
+		}
 	}
 
-	FullTextSearchFile fts_file(fileId, SuffixArray(fileContent));
+	std::lock_guard<std::mutex> lock(m_filesMutex);
 
+	if (m_addedText.size() + text.size() >= s_maxSegmentTextSize)
 	{
-		std::lock_guard<std::mutex> lock(m_filesMutex);
-		m_files.push_back(fts_file);
+		addSegment(std::move(m_addedFiles), std::move(m_addedText), std::move(m_addedLineStarts));
+		m_addedFiles.clear();
+		m_addedText.clear();
+		m_addedLineStarts.clear();
 	}
+
+	const int charStart = m_addedFiles.empty()
+		? 0
+		: m_addedFiles.back().charStart + m_addedFiles.back().charLength;
+
+	m_addedFiles.emplace_back(
+		file.id,
+		file.filePath,
+		file.modificationTime,
+		charStart,
+		static_cast<int>(fileContent.size()),
+		static_cast<int>(m_addedText.size()),
+		static_cast<int>(text.size()),
+		static_cast<int>(m_addedLineStarts.size()),
+		static_cast<int>(lineStarts.size()));
+	m_addedText += text;
+	m_addedLineStarts.insert(m_addedLineStarts.end(), lineStarts.begin(), lineStarts.end());
+	m_hasUnsavedChanges = true;
+}
+
+void FullTextSearchIndex::finishAdding()
+{
+	TRACE();
+
+	std::lock_guard<std::mutex> lock(m_filesMutex);
+
+	if (!m_addedFiles.empty())
+	{
+		addSegment(std::move(m_addedFiles), std::move(m_addedText), std::move(m_addedLineStarts));
+		m_addedFiles.clear();
+		m_addedText.clear();
+		m_addedLineStarts.clear();
+	}
+
+	mergeSegments();
 }
 
 std::vector<FullTextSearchResult> FullTextSearchIndex::searchForTerm(const std::wstring& term) const
 {
 	TRACE();
 
+	const int termLength = static_cast<int>(term.size());
+	if (!termLength)
+	{
+		return {};
+	}
+
 	std::vector<FullTextSearchResult> ret;
 	{
 		std::lock_guard<std::mutex> lock(m_filesMutex);
-		for (auto& f: m_files)
+		for (const FullTextSearchSegment& segment: m_segments)
 		{
-			FullTextSearchResult hit;
-			hit.fileId = f.fileId;
-			hit.positions = f.array.searchForTerm(term);
-			std::sort(hit.positions.begin(), hit.positions.end());
-			if (!hit.positions.empty())
+			const std::vector<FullTextSearchFile>& files = segment.files;
+			const int* lineStarts = segment.getLineStarts();
+
+			// positions are sorted, so all matches of a file are next to each other
+			for (int pos: segment.array.searchForTerm(term))
 			{
-				ret.push_back(hit);
+				auto it = std::upper_bound(
+					files.begin(), files.end(), pos, [](int pos, const FullTextSearchFile& file) {
+						return pos < file.charStart;
+					});
+				if (it == files.begin())
+				{
+					continue;
+				}
+				it--;
+
+				// skip matches in gaps of removed files or reaching into the next file
+				if (pos + termLength > it->charStart + it->charLength)
+				{
+					continue;
+				}
+
+				if (ret.empty() || ret.back().fileId != it->fileId)
+				{
+					ret.push_back({it->fileId, it->filePath, {}});
+				}
+
+				FullTextSearchMatch match;
+				match.position = pos - it->charStart;
+
+				const int* fileLineStarts = lineStarts + it->lineStart;
+				const int* fileLineEnd = fileLineStarts + it->lineCount;
+				const int* startLine =
+					std::upper_bound(fileLineStarts, fileLineEnd, match.position) - 1;
+				const int* endLine =
+					std::upper_bound(startLine, fileLineEnd, match.position + termLength - 1) - 1;
+
+				match.startLineNumber = static_cast<int>(startLine - fileLineStarts) + 1;
+				match.startColumnNumber = match.position - *startLine + 1;
+				match.endLineNumber = static_cast<int>(endLine - fileLineStarts) + 1;
+				match.endColumnNumber = match.position + termLength - *endLine;
+
+				ret.back().matches.push_back(match);
 			}
 		}
 	}
 
+	std::stable_sort(
+		ret.begin(), ret.end(), [](const FullTextSearchResult& a, const FullTextSearchResult& b) {
+			return a.matches.size() > b.matches.size();
+		});
+
 	return ret;
 }
 
 size_t FullTextSearchIndex::fileCount() const
 {
 	std::lock_guard<std::mutex> lock(m_filesMutex);
-	return m_files.size();
+
+	size_t count = m_addedFiles.size();
+	for (const FullTextSearchSegment& segment: m_segments)
+	{
+		count += segment.files.size();
+	}
+	return count;
+}
+
+size_t FullTextSearchIndex::segmentCount() const
+{
+	std::lock_guard<std::mutex> lock(m_filesMutex);
+	return m_segments.size();
 }
 
 void FullTextSearchIndex::clear()
 {
 	std::lock_guard<std::mutex> lock(m_filesMutex);
-	m_files.clear();
+	m_segments.clear();
+	m_addedFiles.clear();
+	m_addedText.clear();
+	m_addedLineStarts.clear();
+	m_hasUnsavedChanges = false;
+}
+
+std::vector<StorageFile> FullTextSearchIndex::load(
+	const FilePath& indexFilePath,
+	const std::string& codecName,
+	const std::vector<StorageFile>& files)
+{
+	TRACE();
+
+	MappedFile reader(indexFilePath);
+
+	std::unordered_map<std::wstring, const StorageFile*> filesByPath;
+	for (const StorageFile& file: files)
+	{
+		filesByPath.emplace(file.filePath, &file);
+	}
+
+	std::vector<FullTextSearchSegment> loadedSegments;
+	std::unordered_set<std::wstring> loadedFilePaths;
+	size_t storedFileCount = 0;
+	if (reader.isMapped())
+	{
+		const IndexFileHeader* header = reader.read<IndexFileHeader>(1);
+		const char* storedCodecName = header ? reader.read<char>(header->codecNameLength) : nullptr;
+
+		if (storedCodecName &&
+			std::memcmp(header->magic, s_indexFileMagic, sizeof(s_indexFileMagic)) == 0 &&
+			header->version == s_indexFileVersion && header->charSize == sizeof(wchar_t) &&
+			std::string(storedCodecName, header->codecNameLength) == codecName)
+		{
+			for (uint32_t i = 0; i < header->segmentCount && !reader.failed(); i++)
+			{
+				const IndexFileSegment* segment = reader.read<IndexFileSegment>(1);
+				if (!segment)
+				{
+					break;
+				}
+
+				const char* text = reader.read<char>(segment->textLength);
+				const int* array = reader.read<int>(segment->textLength);
+				const int* lcp = reader.read<int>(segment->textLength);
+				const int* charOffsets = reader.read<int>(segment->charOffsetCount);
+				const int* lineStarts = reader.read<int>(segment->lineStartCount);
+
+				std::vector<FullTextSearchFile> segmentFiles;
+				for (uint32_t j = 0; j < segment->fileCount && !reader.failed(); j++)
+				{
+					const IndexFileEntry* entry = reader.read<IndexFileEntry>(1);
+					const wchar_t* filePath = entry ? reader.read<wchar_t>(entry->filePathLength)
+													: nullptr;
+					const char* modificationTime = entry
+						? reader.read<char>(entry->modificationTimeLength)
+						: nullptr;
+					if (reader.failed())
+					{
+						break;
+					}
+
+					if (size_t(entry->byteStart) + entry->byteLength > segment->textLength ||
+						size_t(entry->charStart) + entry->charLength > segment->textLength ||
+						size_t(entry->lineStart) + entry->lineCount > segment->lineStartCount ||
+						entry->lineCount == 0)
+					{
+						reader.fail();
+						break;
+					}
+
+					storedFileCount++;
+
+					auto it = filesByPath.find(std::wstring(filePath, entry->filePathLength));
+					if (it != filesByPath.end() &&
+						it->second->modificationTime ==
+							std::string(modificationTime, entry->modificationTimeLength) &&
+						loadedFilePaths.insert(it->second->filePath).second)
+					{
+						segmentFiles.emplace_back(
+							it->second->id,
+							it->second->filePath,
+							it->second->modificationTime,
+							entry->charStart,
+							entry->charLength,
+							entry->byteStart,
+							entry->byteLength,
+							entry->lineStart,
+							entry->lineCount);
+					}
+				}
+
+				if (!reader.failed() && !segmentFiles.empty())
+				{
+					loadedSegments.emplace_back(
+						SuffixArray(
+							reader.getDataOwner(),
+							text,
+							array,
+							lcp,
+							segment->textLength,
+							charOffsets,
+							segment->charOffsetCount),
+						std::move(segmentFiles),
+						reader.getDataOwner(),
+						lineStarts,
+						segment->lineStartCount);
+				}
+			}
+
+			if (reader.failed())
+			{
+				LOG_WARNING(
+					L"Fulltext search index \"" + indexFilePath.wstr() + L"\" is corrupted.");
+				loadedSegments.clear();
+				loadedFilePaths.clear();
+			}
+		}
+	}
+
+	std::vector<StorageFile> missingFiles;
+	for (const StorageFile& file: files)
+	{
+		if (loadedFilePaths.find(file.filePath) == loadedFilePaths.end())
+		{
+			missingFiles.push_back(file);
+		}
+	}
+
+	LOG_INFO(
+		"Loaded " + std::to_string(loadedFilePaths.size()) + " of " +
+		std::to_string(files.size()) + " files from fulltext search index");
+
+	{
+		std::lock_guard<std::mutex> lock(m_filesMutex);
+		// stored files that changed or got removed need to be dropped from the index file
+		m_hasUnsavedChanges = loadedFilePaths.size() != storedFileCount;
+		m_segments = std::move(loadedSegments);
+		m_addedFiles.clear();
+		m_addedText.clear();
+		m_addedLineStarts.clear();
+	}
+
+	return missingFiles;
+}
+
+bool FullTextSearchIndex::save(const FilePath& indexFilePath, const std::string& codecName)
+{
+	TRACE();
+
+	finishAdding();
+
+	const FilePath tempIndexFilePath(indexFilePath.wstr() + L"_tmp");
+
+	std::vector<StorageFile> files;
+	{
+		std::lock_guard<std::mutex> lock(m_filesMutex);
+		if (!m_hasUnsavedChanges)
+		{
+			return true;
+		}
+
+		if (!write(tempIndexFilePath, codecName))
+		{
+			LOG_ERROR(
+				L"Unable to write fulltext search index \"" + tempIndexFilePath.wstr() + L"\"");
+			FileSystem::remove(tempIndexFilePath);
+			return false;
+		}
+
+		for (const FullTextSearchSegment& segment: m_segments)
+		{
+			for (const FullTextSearchFile& file: segment.files)
+			{
+				files.emplace_back(
+					file.fileId, file.filePath, L"", file.modificationTime, true, true);
+			}
+		}
+
+		// releases the mapping of the old index file, which cannot be replaced while it is mapped
+		m_segments.clear();
+	}
+
+	if (!FileSystem::replace(tempIndexFilePath, indexFilePath))
+	{
+		LOG_ERROR(L"Unable to replace fulltext search index \"" + indexFilePath.wstr() + L"\"");
+		return load(tempIndexFilePath, codecName, files).empty();
+	}
+
+	return load(indexFilePath, codecName, files).empty();
+}
+
+void FullTextSearchIndex::addSegment(
+	std::vector<FullTextSearchFile> files, std::string text, std::vector<int> lineStarts)
+{
+	if (files.empty())
+	{
+		return;
+	}
+
+	m_segments.emplace_back(SuffixArray(std::move(text)), std::move(files), std::move(lineStarts));
+	m_hasUnsavedChanges = true;
+}
+
+void FullTextSearchIndex::mergeSegments()
+{
+	if (m_segments.empty())
+	{
+		return;
+	}
+
+	std::vector<size_t> fileBytes;
+	size_t largestIndex = 0;
+	for (size_t i = 0; i < m_segments.size(); i++)
+	{
+		fileBytes.push_back(getFileBytes(m_segments[i]));
+		if (fileBytes[i] > fileBytes[largestIndex])
+		{
+			largestIndex = i;
+		}
+	}
+
+	// the largest segment is only rebuilt once most of its text belongs to removed files, all
+	// others get merged when there are too many segments to search
+	std::vector<bool> merge(m_segments.size(), false);
+	size_t mergeCount = 0;
+	bool hasRemovedText = false;
+	for (size_t i = 0; i < m_segments.size(); i++)
+	{
+		const bool mostlyRemoved = fileBytes[i] * 2 < m_segments[i].array.size();
+		if (mostlyRemoved || (i != largestIndex && m_segments.size() > s_maxSegmentCount))
+		{
+			merge[i] = true;
+			mergeCount++;
+			hasRemovedText = hasRemovedText || mostlyRemoved;
+		}
+	}
+
+	if (mergeCount < 2 && !hasRemovedText)
+	{
+		return;
+	}
+
+	TRACE();
+
+	std::vector<FullTextSearchSegment> segments;
+	std::vector<FullTextSearchFile> files;
+	std::string text;
+	std::vector<int> lineStarts;
+	int charStart = 0;
+	for (size_t i = 0; i < m_segments.size(); i++)
+	{
+		if (!merge[i])
+		{
+			segments.push_back(std::move(m_segments[i]));
+			continue;
+		}
+
+		const char* segmentText = m_segments[i].array.getText();
+		const int* segmentLineStarts = m_segments[i].getLineStarts();
+		for (const FullTextSearchFile& file: m_segments[i].files)
+		{
+			if (text.size() + file.byteLength >= s_maxSegmentTextSize)
+			{
+				segments.emplace_back(
+					SuffixArray(std::move(text)), std::move(files), std::move(lineStarts));
+				files.clear();
+				text.clear();
+				lineStarts.clear();
+				charStart = 0;
+			}
+
+			files.emplace_back(
+				file.fileId,
+				file.filePath,
+				file.modificationTime,
+				charStart,
+				file.charLength,
+				static_cast<int>(text.size()),
+				file.byteLength,
+				static_cast<int>(lineStarts.size()),
+				file.lineCount);
+			text.append(segmentText + file.byteStart, file.byteLength);
+			lineStarts.insert(
+				lineStarts.end(),
+				segmentLineStarts + file.lineStart,
+				segmentLineStarts + file.lineStart + file.lineCount);
+			charStart += file.charLength;
+		}
+	}
+
+	if (!files.empty())
+	{
+		segments.emplace_back(
+			SuffixArray(std::move(text)), std::move(files), std::move(lineStarts));
+	}
+
+	m_segments = std::move(segments);
+	m_hasUnsavedChanges = true;
+}
+
+bool FullTextSearchIndex::write(const FilePath& indexFilePath, const std::string& codecName) const
+{
+	std::ofstream out(indexFilePath.str(), std::ios::binary | std::ios::trunc);
+	if (!out)
+	{
+		return false;
+	}
+
+	IndexFileHeader header;
+	std::memcpy(header.magic, s_indexFileMagic, sizeof(s_indexFileMagic));
+	header.version = s_indexFileVersion;
+	header.charSize = sizeof(wchar_t);
+	header.segmentCount = static_cast<uint32_t>(m_segments.size());
+	header.codecNameLength = static_cast<uint32_t>(codecName.size());
+
+	MappedFile::writePadded(out, &header, sizeof(header));
+	MappedFile::writePadded(out, codecName.data(), codecName.size());
+
+	for (const FullTextSearchSegment& segment: m_segments)
+	{
+		const SuffixArray& array = segment.array;
+		const size_t size = array.size();
+
+		IndexFileSegment segmentHeader;
+		segmentHeader.fileCount = static_cast<uint32_t>(segment.files.size());
+		segmentHeader.textLength = static_cast<uint32_t>(size);
+		segmentHeader.charOffsetCount = static_cast<uint32_t>(array.getCharOffsetCount());
+		segmentHeader.lineStartCount = static_cast<uint32_t>(segment.getLineStartCount());
+
+		MappedFile::writePadded(out, &segmentHeader, sizeof(segmentHeader));
+		MappedFile::writePadded(out, array.getText(), size);
+		MappedFile::writePadded(out, array.getArray(), size * sizeof(int));
+		MappedFile::writePadded(out, array.getLCP(), size * sizeof(int));
+		MappedFile::writePadded(
+			out, array.getCharOffsets(), array.getCharOffsetCount() * sizeof(int));
+		MappedFile::writePadded(
+			out, segment.getLineStarts(), segment.getLineStartCount() * sizeof(int));
+
+		for (const FullTextSearchFile& file: segment.files)
+		{
+			IndexFileEntry entry;
+			entry.filePathLength = static_cast<uint32_t>(file.filePath.size());
+			entry.modificationTimeLength = static_cast<uint32_t>(file.modificationTime.size());
+			entry.charStart = static_cast<uint32_t>(file.charStart);
+			entry.charLength = static_cast<uint32_t>(file.charLength);
+			entry.byteStart = static_cast<uint32_t>(file.byteStart);
+			entry.byteLength = static_cast<uint32_t>(file.byteLength);
+			entry.lineStart = static_cast<uint32_t>(file.lineStart);
+			entry.lineCount = static_cast<uint32_t>(file.lineCount);
+
+			MappedFile::writePadded(out, &entry, sizeof(entry));
+			MappedFile::writePadded(
+				out, file.filePath.data(), file.filePath.size() * sizeof(wchar_t));
+			MappedFile::writePadded(
+				out, file.modificationTime.data(), file.modificationTime.size());
+		}
+	}
+
+	out.close();
+	return !out.fail();
 }
@@ -5,38 +5,135 @@
 #include <unordered_map>
 #include <vector>
 
+#include "StorageFile.h"
 #include "SuffixArray.h"
 #include "types.h"
 
+class FilePath;
 class StorageAccess;
 
+// character position of a match within its file, lines and columns start at 1
+struct FullTextSearchMatch
+{
+	int position;
+	int startLineNumber;
+	int startColumnNumber;
+	int endLineNumber;
+	int endColumnNumber;
+};
+
 // contains all fulltextsearch results of one file
 struct FullTextSearchResult
 {
 	Id fileId;
-	std::vector<int> positions;
+	std::wstring filePath;
+	std::vector<FullTextSearchMatch> matches;
 };
 
+// range of one file within the concatenated text of a segment
 struct FullTextSearchFile
 {
-	FullTextSearchFile(Id fileId, SuffixArray array): fileId(fileId), array(array) {};
+	FullTextSearchFile(
+		Id fileId,
+		std::wstring filePath,
+		std::string modificationTime,
+		int charStart,
+		int charLength,
+		int byteStart,
+		int byteLength,
+		int lineStart,
+		int lineCount)
+		: fileId(fileId)
+		, filePath(std::move(filePath))
+		, modificationTime(std::move(modificationTime))
+		, charStart(charStart)
+		, charLength(charLength)
+		, byteStart(byteStart)
+		, byteLength(byteLength)
+		, lineStart(lineStart)
+		, lineCount(lineCount) {};
 	Id fileId;
+	std::wstring filePath;
+	std::string modificationTime;
+	int charStart;
+	int charLength;
+	int byteStart;
+	int byteLength;
+	int lineStart;
+	int lineCount;
+};
+
+// one suffix array over the texts of many files, files are ordered by their start position and
+// ranges of removed files are left as unreferenced gaps in the text
+class FullTextSearchSegment
+{
+public:
+	FullTextSearchSegment(
+		SuffixArray array, std::vector<FullTextSearchFile> files, std::vector<int> lineStarts);
+	// refers to line starts within mapped data, that needs to be kept alive by the owner
+	FullTextSearchSegment(
+		SuffixArray array,
+		std::vector<FullTextSearchFile> files,
+		std::shared_ptr<const void> dataOwner,
+		const int* lineStarts,
+		size_t lineStartCount);
+
+	// character positions of all line starts relative to their file, files refer to their range
+	const int* getLineStarts() const;
+	size_t getLineStartCount() const;
+
 	SuffixArray array;
+	std::vector<FullTextSearchFile> files;
+
+private:
+	std::vector<int> m_lineStarts;
+
+	std::shared_ptr<const void> m_dataOwner;
+	const int* m_dataLineStarts = nullptr;
+	size_t m_dataLineStartCount = 0;
 };
 
 class FullTextSearchIndex
 {
 public:
-	void addFile(Id fileId, const std::wstring& file);
+	// can be called from several threads, files become searchable after finishAdding
+	void addFile(const StorageFile& file, const std::wstring& fileContent);
+	// builds one segment for all added files and merges small or mostly removed segments
+	void finishAdding();
+
+	// results are ranked by their number of matches
 	std::vector<FullTextSearchResult> searchForTerm(const std::wstring& term) const;
 
 	size_t fileCount() const;
+	size_t segmentCount() const;
 
 	void clear();
 
+	// maps the index file and keeps all stored files that still have the same modification time,
+	// returns the files that need to be added again
+	std::vector<StorageFile> load(
+		const FilePath& indexFilePath,
+		const std::string& codecName,
+		const std::vector<StorageFile>& files);
+
+	// finishes adding and rewrites the index file if files were added or removed since loading,
+	// maps it afterwards so built arrays don't need to stay in memory
+	bool save(const FilePath& indexFilePath, const std::string& codecName);
+
 private:
+	static const size_t s_maxSegmentCount;
+
+	void addSegment(
+		std::vector<FullTextSearchFile> files, std::string text, std::vector<int> lineStarts);
+	void mergeSegments();
+	bool write(const FilePath& indexFilePath, const std::string& codecName) const;
+
 	mutable std::mutex m_filesMutex;
-	std::vector<FullTextSearchFile> m_files;
+	std::vector<FullTextSearchSegment> m_segments;
+	std::vector<FullTextSearchFile> m_addedFiles;
+	std::string m_addedText;
+	std::vector<int> m_addedLineStarts;
+	bool m_hasUnsavedChanges = false;
 };
 
 #endif	  // FULLTEXTSEARCH_INDEX_H
@@ -1,50 +1,298 @@
 #include "SuffixArray.h"
 
 #include <algorithm>
+#include <cwctype>
 #include <iostream>
+#include <string_view>
 
-struct suffix
+namespace
 {
-	int index;
-	int rank[2];
-};
+bool isLeadByte(char c)
+{
+	return (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+}
 
-int SuffixArray::cmp(const struct suffix& a, const struct suffix& b)
+// builds the suffix array of s with values in [0, upper] by induced sorting (SA-IS) in O(n)
+std::vector<int> buildSuffixArrayInduced(const std::vector<int>& s, int upper)
 {
-	return (a.rank[0] == b.rank[0]) ? (a.rank[1] < b.rank[1] ? 1 : 0)
-									: (a.rank[0] < b.rank[0] ? 1 : 0);
+	const int n = static_cast<int>(s.size());
+	if (n < 8)
+	{
+		std::vector<int> sa(n);
+		for (int i = 0; i < n; i++)
+		{
+			sa[i] = i;
+		}
+		std::sort(sa.begin(), sa.end(), [&s](int a, int b) {
+			return std::lexicographical_compare(s.begin() + a, s.end(), s.begin() + b, s.end());
+		});
+		return sa;
+	}
+
+	// a suffix is of type S if it is smaller than the following suffix, otherwise of type L
+	std::vector<bool> isS(n, false);
+	for (int i = n - 2; i >= 0; i--)
+	{
+		isS[i] = (s[i] == s[i + 1]) ? isS[i + 1] : (s[i] < s[i + 1]);
+	}
+
+	// bucket starts for the L and S suffixes of every character
+	std::vector<int> bucketL(upper + 2, 0);
+	std::vector<int> bucketS(upper + 2, 0);
+	for (int i = 0; i < n; i++)
+	{
+		if (!isS[i])
+		{
+			bucketS[s[i]]++;
+		}
+		else
+		{
+			bucketL[s[i] + 1]++;
+		}
+	}
+	for (int i = 0; i <= upper; i++)
+	{
+		bucketS[i] += bucketL[i];
+		bucketL[i + 1] += bucketS[i];
+	}
+
+	std::vector<int> sa(n);
+	std::vector<int> buckets(upper + 2);
+	const auto induce = [&](const std::vector<int>& lms) {
+		std::fill(sa.begin(), sa.end(), -1);
+
+		std::copy(bucketS.begin(), bucketS.end(), buckets.begin());
+		for (int d: lms)
+		{
+			sa[buckets[s[d]]++] = d;
+		}
+
+		std::copy(bucketL.begin(), bucketL.end(), buckets.begin());
+		sa[buckets[s[n - 1]]++] = n - 1;
+		for (int i = 0; i < n; i++)
+		{
+			const int v = sa[i];
+			if (v >= 1 && !isS[v - 1])
+			{
+				sa[buckets[s[v - 1]]++] = v - 1;
+			}
+		}
+
+		std::copy(bucketL.begin(), bucketL.end(), buckets.begin());
+		for (int i = n - 1; i >= 0; i--)
+		{
+			const int v = sa[i];
+			if (v >= 1 && isS[v - 1])
+			{
+				sa[--buckets[s[v - 1] + 1]] = v - 1;
+			}
+		}
+	};
+
+	// leftmost S suffixes (LMS) are sorted first, everything else is induced from them
+	std::vector<int> lmsIndex(n + 1, -1);
+	std::vector<int> lms;
+	for (int i = 1; i < n; i++)
+	{
+		if (!isS[i - 1] && isS[i])
+		{
+			lmsIndex[i] = static_cast<int>(lms.size());
+			lms.push_back(i);
+		}
+	}
+	const int m = static_cast<int>(lms.size());
+
+	induce(lms);
+
+	if (m)
+	{
+		std::vector<int> sortedLms;
+		sortedLms.reserve(m);
+		for (int v: sa)
+		{
+			if (lmsIndex[v] != -1)
+			{
+				sortedLms.push_back(v);
+			}
+		}
+
+		// name the LMS substrings and sort them recursively if names are not unique yet
+		std::vector<int> reduced(m);
+		int reducedUpper = 0;
+		reduced[lmsIndex[sortedLms[0]]] = 0;
+		for (int i = 1; i < m; i++)
+		{
+			int l = sortedLms[i - 1];
+			int r = sortedLms[i];
+			const int endL = (lmsIndex[l] + 1 < m) ? lms[lmsIndex[l] + 1] : n;
+			const int endR = (lmsIndex[r] + 1 < m) ? lms[lmsIndex[r] + 1] : n;
+
+			bool same = true;
+			if (endL - l != endR - r)
+			{
+				same = false;
+			}
+			else
+			{
+				while (l < endL && s[l] == s[r])
+				{
+					l++;
+					r++;
+				}
+				if (l == n || s[l] != s[r])
+				{
+					same = false;
+				}
+			}
+
+			if (!same)
+			{
+				reducedUpper++;
+			}
+			reduced[lmsIndex[sortedLms[i]]] = reducedUpper;
+		}
+
+		const std::vector<int> reducedArray = buildSuffixArrayInduced(reduced, reducedUpper);
+		for (int i = 0; i < m; i++)
+		{
+			sortedLms[i] = lms[reducedArray[i]];
+		}
+		induce(sortedLms);
+	}
+
+	return sa;
 }
+}	 // namespace
+
+const size_t SuffixArray::s_charOffsetBlockSize = 64;
 
-SuffixArray::SuffixArray(const std::wstring& text): m_text(text)
+SuffixArray::SuffixArray(const std::wstring& text): SuffixArray(getSearchableText(text)) {}
+
+SuffixArray::SuffixArray(std::string searchableText): m_text(std::move(searchableText))
 {
-	std::transform(m_text.begin(), m_text.end(), m_text.begin(), ::towlower);
 	m_array = buildSuffixArray();
 	m_lcp = buildLCP();
+	m_charOffsets = buildCharOffsets();
+}
+
+SuffixArray::SuffixArray(
+	std::shared_ptr<const void> dataOwner,
+	const char* text,
+	const int* array,
+	const int* lcp,
+	size_t size,
+	const int* charOffsets,
+	size_t charOffsetCount)
+	: m_dataOwner(dataOwner)
+	, m_dataText(text)
+	, m_dataArray(array)
+	, m_dataLCP(lcp)
+	, m_dataSize(size)
+	, m_dataCharOffsets(charOffsets)
+	, m_dataCharOffsetCount(charOffsetCount)
+{
+}
+
+size_t SuffixArray::size() const
+{
+	return m_dataOwner ? m_dataSize : m_text.size();
+}
+
+const char* SuffixArray::getText() const
+{
+	return m_dataOwner ? m_dataText : m_text.data();
+}
+
+const int* SuffixArray::getArray() const
+{
+	return m_dataOwner ? m_dataArray : m_array.data();
+}
+
+const int* SuffixArray::getLCP() const
+{
+	return m_dataOwner ? m_dataLCP : m_lcp.data();
+}
+
+size_t SuffixArray::getCharOffsetCount() const
+{
+	return m_dataOwner ? m_dataCharOffsetCount : m_charOffsets.size();
+}
+
+const int* SuffixArray::getCharOffsets() const
+{
+	return m_dataOwner ? m_dataCharOffsets : m_charOffsets.data();
 }
 
 void SuffixArray::printArray() const
 {
+	const std::string text(getText(), size());
+	const std::vector<int> array(getArray(), getArray() + size());
+
 	std::cout << "Suffix Array : \n";
-	printArr(m_array);
-	for (size_t i = 0; i < m_array.size(); i++)
+	printArr(array);
+	for (size_t i = 0; i < array.size(); i++)
 	{
-		std::wstring suffix = m_text.substr(m_array[i]);
-		std::wcout << i << ": \"" << suffix << "\"" << std::endl;
+		std::string suffix = text.substr(array[i]);
+		std::cout << i << ": \"" << suffix << "\"" << std::endl;
 	}
 }
 
 void SuffixArray::printLCP() const
 {
+	const std::string text(getText(), size());
+	const std::vector<int> array(getArray(), getArray() + size());
+	const std::vector<int> lcp(getLCP(), getLCP() + size());
+
 	std::cout << "\nLCP Array : \n";
-	printArr(m_lcp);
-	for (size_t i = 0; i < m_array.size(); i++)
+	printArr(lcp);
+	for (size_t i = 0; i < array.size(); i++)
 	{
-		std::wstring prefix = m_text.substr(m_array[i], m_lcp[i]);
-		std::wcout << i << ": \"" << prefix << "\"" << std::endl;
+		std::string prefix = text.substr(array[i], lcp[i]);
+		std::cout << i << ": \"" << prefix << "\"" << std::endl;
 	}
 }
 
-std::vector<int> SuffixArray::buildLCP()
+std::string SuffixArray::getSearchableText(const std::wstring& text)
+{
+	std::string bytes;
+	bytes.reserve(text.size());
+
+	for (wchar_t c: text)
+	{
+		unsigned long codePoint = static_cast<unsigned long>(::towlower(c));
+		if (codePoint > 0x10FFFF)
+		{
+			codePoint = 0xFFFD;
+		}
+
+		if (codePoint < 0x80)
+		{
+			bytes.push_back(static_cast<char>(codePoint));
+		}
+		else if (codePoint < 0x800)
+		{
+			bytes.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+			bytes.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+		else if (codePoint < 0x10000)
+		{
+			bytes.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+			bytes.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+			bytes.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+		else
+		{
+			bytes.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+			bytes.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+			bytes.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+			bytes.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+	}
+
+	return bytes;
+}
+
+std::vector<int> SuffixArray::buildLCP() const
 {
 	const int n = static_cast<int>(m_array.size());
 
@@ -86,11 +334,14 @@ std::vector<int> SuffixArray::buildLCP()
 
 std::vector<int> SuffixArray::searchForTerm(const std::wstring& searchTerm) const
 {
-	std::wstring term = searchTerm;
-	std::transform(term.begin(), term.end(), term.begin(), ::towlower);
+	const std::string term = getSearchableText(searchTerm);
+
+	const std::string_view text(getText(), size());
+	const int* array = getArray();
+	const int* lcp = getLCP();
 
 	const int termLength = static_cast<int>(term.length());
-	const int textLength = static_cast<int>(m_text.length());
+	const int textLength = static_cast<int>(text.length());
 	int l = -1;
 	int r = textLength;
 	int m;
@@ -100,7 +351,7 @@ std::vector<int> SuffixArray::searchForTerm(const std::wstring& searchTerm) cons
 	while (l + 1 < r)
 	{
 		m = (l + r + 1) / 2;
-		compareResult = term.compare(m_text.substr(m_array[m], termLength));
+		compareResult = term.compare(text.substr(array[m], termLength));
 		if (compareResult < 0)
 		{
 			r = m;
@@ -111,14 +362,14 @@ std::vector<int> SuffixArray::searchForTerm(const std::wstring& searchTerm) cons
 		}
 		else
 		{
-			matches.push_back(m_array[m]);
-			for (int lower = m - 1; lower >= 0 && m_lcp[lower] >= termLength; lower--)
+			matches.push_back(array[m]);
+			for (int lower = m - 1; lower >= 0 && lcp[lower] >= termLength; lower--)
 			{
-				matches.push_back(m_array[lower]);
+				matches.push_back(array[lower]);
 			}
-			for (int higher = m + 1; higher < textLength && m_lcp[higher - 1] >= termLength; higher++)
+			for (int higher = m + 1; higher < textLength && lcp[higher - 1] >= termLength; higher++)
 			{
-				matches.push_back(m_array[higher]);
+				matches.push_back(array[higher]);
 			}
 			break;
 		}
@@ -126,63 +377,68 @@ std::vector<int> SuffixArray::searchForTerm(const std::wstring& searchTerm) cons
 
 	std::sort(matches.begin(), matches.end());
 
+	for (int& match: matches)
+	{
+		match = getCharPosition(match);
+	}
+
 	return matches;
 }
 
-std::vector<int> SuffixArray::buildSuffixArray()
+std::vector<int> SuffixArray::buildSuffixArray() const
 {
-	const int n = static_cast<int>(m_text.length());
-	std::vector<suffix> suffixes;
-	suffixes.reserve(n);
-
-	suffix s;
-	for (int i = 0; i < n; i++)
+	std::vector<int> text(m_text.size());
+	for (size_t i = 0; i < m_text.size(); i++)
 	{
-		s.index = i;
-		s.rank[0] = m_text[i];
-		s.rank[1] = ((i + 1) < n) ? (m_text[i + 1]) : -1;
-		suffixes.push_back(s);
+		text[i] = static_cast<unsigned char>(m_text[i]);
 	}
 
-	std::sort(suffixes.begin(), suffixes.end(), SuffixArray::cmp);
+	return buildSuffixArrayInduced(text, 255);
+}
 
-	std::vector<int> ind(n, 0);
-	for (int k = 4; k < 2 * n; k = k * 2)
-	{
-		int rank = 0;
-		int prev_rank = suffixes[0].rank[0];
-		suffixes[0].rank[0] = rank;
-		ind[suffixes[0].index] = 0;
+std::vector<int> SuffixArray::buildCharOffsets() const
+{
+	std::vector<int> charOffsets;
+	charOffsets.reserve(m_text.size() / s_charOffsetBlockSize + 1);
 
-		for (int i = 1; i < n; i++)
+	int charCount = 0;
+	for (size_t i = 0; i < m_text.size(); i++)
+	{
+		if (i % s_charOffsetBlockSize == 0)
 		{
-			if (suffixes[i].rank[0] == prev_rank && suffixes[i].rank[1] == suffixes[i - 1].rank[1])
-			{
-				prev_rank = suffixes[i].rank[0];
-				suffixes[i].rank[0] = rank;
-			}
-			else
-			{
-				prev_rank = suffixes[i].rank[0];
-				suffixes[i].rank[0] = ++rank;
-			}
-			ind[suffixes[i].index] = i;
+			charOffsets.push_back(charCount);
 		}
 
-		for (int i = 0; i < n; i++)
+		if (isLeadByte(m_text[i]))
 		{
-			int nextindex = suffixes[i].index + k / 2;
-			suffixes[i].rank[1] = (nextindex < n) ? suffixes[ind[nextindex]].rank[0] : -1;
+			charCount++;
 		}
+	}
 
-		std::sort(suffixes.begin(), suffixes.end(), cmp);
+	if (static_cast<size_t>(charCount) == m_text.size())
+	{
+		return {};
 	}
+	return charOffsets;
+}
 
-	std::vector<int> suffixArr;
-	for (int i = 0; i < n; i++)
+int SuffixArray::getCharPosition(int bytePosition) const
+{
+	if (!getCharOffsetCount())
 	{
-		suffixArr.push_back(suffixes[i].index);
+		return bytePosition;
 	}
 
-	return suffixArr;
+	const size_t block = bytePosition / s_charOffsetBlockSize;
+	const char* text = getText();
+
+	int charPosition = getCharOffsets()[block];
+	for (size_t i = block * s_charOffsetBlockSize; i < static_cast<size_t>(bytePosition); i++)
+	{
+		if (isLeadByte(text[i]))
+		{
+			charPosition++;
+		}
+	}
+	return charPosition;
 }
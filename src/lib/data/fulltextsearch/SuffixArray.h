@@ -2,20 +2,51 @@
 #define SUFFIX_ARRAY_H
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
+// suffix array over the lowercase UTF-8 bytes of a text, positions passed in and out are
+// character positions of the original text
 class SuffixArray
 {
 public:
+	// lowercases the text and encodes every wchar_t as its own UTF-8 sequence, so characters can be
+	// counted by their first bytes, even for surrogates
+	static std::string getSearchableText(const std::wstring& text);
+
 	SuffixArray(const std::wstring& text);
+	explicit SuffixArray(std::string searchableText);
+	// refers to the data of an array that was stored from getText, getArray, getLCP and
+	// getCharOffsets, the data needs to be kept alive by the owner
+	SuffixArray(
+		std::shared_ptr<const void> dataOwner,
+		const char* text,
+		const int* array,
+		const int* lcp,
+		size_t size,
+		const int* charOffsets,
+		size_t charOffsetCount);
+
 	std::vector<int> searchForTerm(const std::wstring& searchTerm) const;
-	static int cmp(const struct suffix& a, const struct suffix& b);
+
+	// byte size of the text
+	size_t size() const;
+	const char* getText() const;
+	const int* getArray() const;
+	const int* getLCP() const;
+
+	// character position at the start of every block of s_charOffsetBlockSize bytes, empty if
+	// every character is encoded as a single byte
+	size_t getCharOffsetCount() const;
+	const int* getCharOffsets() const;
 
 	void printArray() const;
 	void printLCP() const;
 
 private:
+	static const size_t s_charOffsetBlockSize;
+
 	template <typename T>
 	void printArr(std::vector<T> arr) const
 	{
@@ -26,11 +57,24 @@ private:
 		std::cout << std::endl;
 	}
 
-	std::vector<int> buildLCP();
-	std::vector<int> buildSuffixArray();
+	std::vector<int> buildLCP() const;
+	std::vector<int> buildSuffixArray() const;
+	std::vector<int> buildCharOffsets() const;
+
+	int getCharPosition(int bytePosition) const;
+
 	std::vector<int> m_array;
 	std::vector<int> m_lcp;
-	std::wstring m_text;
+	std::vector<int> m_charOffsets;
+	std::string m_text;
+
+	std::shared_ptr<const void> m_dataOwner;
+	const char* m_dataText = nullptr;
+	const int* m_dataArray = nullptr;
+	const int* m_dataLCP = nullptr;
+	size_t m_dataSize = 0;
+	const int* m_dataCharOffsets = nullptr;
+	size_t m_dataCharOffsetCount = 0;
 };
 
 #endif	  // SUFFIX_ARRAY_H
@@ -1,11 +1,13 @@
 #ifndef INDEXER_BASE_H
 #define INDEXER_BASE_H
 
+#include <functional>
 #include <memory>
 #include <string>
 
 #include "IndexerCommandType.h"
 
+class FilePath;
 class FileRegister;
 class IndexerCommand;
 class IntermediateStorage;
@@ -20,6 +22,9 @@ public:
 	virtual std::shared_ptr<IntermediateStorage> index(
 		std::shared_ptr<IndexerCommand> indexerCommand) = 0;
 	virtual void interrupt() = 0;
+
+	// decides which files of a translation unit get their symbols recorded by this indexer
+	virtual void setClaimFilePathFunction(std::function<bool(const FilePath&)> claimFilePath) = 0;
 };
 
 #endif	  // INDEXER_BASE_H
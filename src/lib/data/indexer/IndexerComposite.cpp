@@ -37,3 +37,11 @@ void IndexerComposite::interrupt()
 		it.second->interrupt();
 	}
 }
+
+void IndexerComposite::setClaimFilePathFunction(std::function<bool(const FilePath&)> claimFilePath)
+{
+	for (auto& it: m_indexers)
+	{
+		it.second->setClaimFilePathFunction(claimFilePath);
+	}
+}
@@ -18,6 +18,7 @@ public:
 	std::shared_ptr<IntermediateStorage> index(std::shared_ptr<IndexerCommand> indexerCommand) override;
 
 	void interrupt() override;
+	void setClaimFilePathFunction(std::function<bool(const FilePath&)> claimFilePath) override;
 
 private:
 	std::map<IndexerCommandType, std::shared_ptr<IndexerBase>> m_indexers;
@@ -1,10 +1,15 @@
 #ifndef INDEXER_STATE_INFO_H
 #define INDEXER_STATE_INFO_H
 
+#include <functional>
+
+class FilePath;
+
 struct IndexerStateInfo
 {
 public:
 	bool indexingInterrupted;
+	std::function<bool(const FilePath&)> claimFilePath;
 };
 
 #endif	  // INDEXER_STATE_INFO_H
@@ -24,19 +24,34 @@ TaskBuildIndex::TaskBuildIndex(
 	, m_appUUID(appUUID)
 	, m_multiProcessIndexing(multiProcessIndexing)
 	, m_interprocessIndexingStatusManager(appUUID, 0, true)
+	, m_interprocessFileClaimManager(appUUID, 0, true)
 	, m_indexerCommandQueueStopped(false)
 	, m_processCount(processCount)
 	, m_interrupted(false)
 	, m_indexingFileCount(0)
+	, m_resultWaitTime(0)
+	, m_storageWaitTime(0)
 	, m_runningThreadCount(0)
 {
 }
 
+const std::map<FilePath, size_t>& TaskBuildIndex::getIndexTimes() const
+{
+	return m_indexTimes;
+}
+
+const std::vector<FilePath>& TaskBuildIndex::getIncompleteSourceFilePaths() const
+{
+	return m_incompleteSourceFilePaths;
+}
+
 void TaskBuildIndex::doEnter(std::shared_ptr<Blackboard> blackboard)
 {
 	m_interprocessIndexingStatusManager.setIndexingInterrupted(false);
 
 	m_indexingFileCount = 0;
+	m_resultWaitTime = 0;
+	m_storageWaitTime = 0;
 	updateIndexingDialog(blackboard, std::vector<FilePath>());
 
 	std::wstring logFilePath;
@@ -108,7 +123,9 @@ Task::TaskState TaskBuildIndex::doUpdate(std::shared_ptr<Blackboard> blackboard)
 		updateIndexingDialog(blackboard, std::vector<FilePath>());
 	}
 
-	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	const TimeStamp waitStartTime = TimeStamp::now();
+	m_interprocessIndexingStatusManager.waitForFinishedProcessId(50);
+	m_resultWaitTime += TimeStamp::now().deltaMS(waitStartTime);
 
 	return STATE_RUNNING;
 }
@@ -154,6 +171,22 @@ void TaskBuildIndex::doExit(std::shared_ptr<Blackboard> blackboard)
 		m_storageProvider->insert(storage);
 	}
 
+	m_indexTimes = m_interprocessIndexingStatusManager.getIndexTimes();
+
+	// the files these translation units skipped were claimed by one that crashed afterwards
+	m_incompleteSourceFilePaths.clear();
+	for (const FilePath& path:
+		 m_interprocessFileClaimManager.getSourceFilePathsMissingSkippedFiles())
+	{
+		m_incompleteSourceFilePaths.push_back(path.getCanonical());
+		LOG_INFO(L"translation unit missing skipped files: " + path.wstr());
+	}
+
+	LOG_INFO_STREAM(
+		<< "indexing wait times - results: " << m_resultWaitTime
+		<< "ms storage merges: " << m_storageWaitTime
+		<< "ms indexers: " << m_interprocessIndexingStatusManager.getIndexerWaitTime() << "ms");
+
 	blackboard->set<bool>("indexer_threads_stopped", true);
 }
 
@@ -239,12 +272,20 @@ bool TaskBuildIndex::fetchIntermediateStorages(std::shared_ptr<Blackboard> black
 {
 	int poppedStorageCount = 0;
 
-	int providerStorageCount = m_storageProvider->getStorageCount();
-	if (providerStorageCount > 10)
+	if (m_storageProvider->isOverBudget())
 	{
-		LOG_INFO_STREAM(<< "waiting, too many storages queued: " << providerStorageCount);
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		// indexers keep their results in shared memory and wait there until the queued storages
+		// were merged or injected
+		LOG_INFO_STREAM(
+			<< "waiting, storage memory budget exceeded: "
+			<< m_storageProvider->getByteSizeInFlight() / 1024 << "kB of "
+			<< m_storageProvider->getByteBudget() / 1024 << "kB"
+			<< " queued storages: " << m_storageProvider->getStorageCount()
+			<< " merge backlog: " << m_storageProvider->getMergeBacklogCount());
+
+		const TimeStamp waitStartTime = TimeStamp::now();
+		m_storageProvider->waitForByteSizeBelowBudget(100);
+		m_storageWaitTime += TimeStamp::now().deltaMS(waitStartTime);
 
 		return true;
 	}
@@ -269,8 +310,16 @@ bool TaskBuildIndex::fetchIntermediateStorages(std::shared_ptr<Blackboard> black
 		}
 
 		LOG_INFO_STREAM(<< storageManager->getProcessId() << " - storage count: " << storageCount);
-		m_storageProvider->insert(storageManager->popIntermediateStorage());
+		if (std::shared_ptr<IntermediateStorage> storage = storageManager->popIntermediateStorage())
+		{
+			m_storageProvider->insert(storage);
+		}
 		poppedStorageCount++;
+
+		if (m_storageProvider->isOverBudget())
+		{
+			break;
+		}
 	} while (TimeStamp::now().deltaMS(t) <
 			 500);	  // don't process all storages at once to allow for status updates in-between
 
@@ -1,12 +1,14 @@
 #ifndef TASK_BUILD_INDEX_H
 #define TASK_BUILD_INDEX_H
 
+#include <map>
 #include <thread>
 
 #include "MessageIndexingInterrupted.h"
 #include "MessageListener.h"
 #include "Task.h"
 
+#include "InterprocessFileClaimManager.h"
 #include "InterprocessIndexerCommandManager.h"
 #include "InterprocessIndexingStatusManager.h"
 #include "InterprocessIntermediateStorageManager.h"
@@ -27,6 +29,11 @@ public:
 		const std::string& appUUID,
 		bool multiProcessIndexing);
 
+	// milliseconds each indexed source file took, available when the task finished
+	const std::map<FilePath, size_t>& getIndexTimes() const;
+	// source files that need to be indexed again, available when the task finished
+	const std::vector<FilePath>& getIncompleteSourceFilePaths() const;
+
 protected:
 	void doEnter(std::shared_ptr<Blackboard> blackboard) override;
 	TaskState doUpdate(std::shared_ptr<Blackboard> blackboard) override;
@@ -51,10 +58,17 @@ protected:
 	bool m_multiProcessIndexing;
 
 	InterprocessIndexingStatusManager m_interprocessIndexingStatusManager;
+	InterprocessFileClaimManager m_interprocessFileClaimManager;
 	bool m_indexerCommandQueueStopped;
 	size_t m_processCount;
 	bool m_interrupted;
 	size_t m_indexingFileCount;
+	std::map<FilePath, size_t> m_indexTimes;
+	std::vector<FilePath> m_incompleteSourceFilePaths;
+
+	// milliseconds spent waiting for indexer results and for the storage merges to catch up
+	size_t m_resultWaitTime;
+	size_t m_storageWaitTime;
 
 	// store as plain pointers to avoid deallocation issues when closing app during indexing
 	std::vector<std::thread*> m_processThreads;
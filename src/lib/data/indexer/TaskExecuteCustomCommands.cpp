@@ -322,7 +322,7 @@ Task::TaskState TaskExecuteCustomCommands::doUpdate(std::shared_ptr<Blackboard>
 	{
 		std::shared_ptr<IndexerCommandCustom> indexerCommand = m_serialCommands.back();
 		m_serialCommands.pop_back();
-		runIndexerCommand(indexerCommand, blackboard, m_storage);
+		runIndexerCommand(indexerCommand, blackboard, getCustomCommandStorage(0));
 	}
 
 	executeParallelIndexerCommands(0, blackboard);
@@ -337,14 +337,25 @@ Task::TaskState TaskExecuteCustomCommands::doUpdate(std::shared_ptr<Blackboard>
 	MessageErrorCountClear().dispatch();
 
 	{
+		std::vector<FilePath> sourceDatabaseFilePaths;
+		for (const auto& it: m_customCommandStorages)
+		{
+			sourceDatabaseFilePaths.push_back(it.second->getIndexDbFilePath());
+		}
+		m_customCommandStorages.clear();
+
+		// the merged storages store their names the way the project's storage does
 		PersistentStorage targetStorage(m_targetDatabaseFilePath, FilePath());
 		targetStorage.setup();
+		targetStorage.setNameInterningEnabled(m_storage->isNameInterningEnabled());
 		targetStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
 		targetStorage.buildCaches();
-		for (const FilePath& sourceDatabaseFilePath: m_sourceDatabaseFilePaths)
+		for (const FilePath& sourceDatabaseFilePath: sourceDatabaseFilePaths)
 		{
 			{
 				PersistentStorage sourceStorage(sourceDatabaseFilePath, FilePath());
+				sourceStorage.migrateCustomCommandStorage();
+				sourceStorage.setup();
 				sourceStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
 				sourceStorage.buildCaches();
 				targetStorage.inject(&sourceStorage);
@@ -391,7 +402,6 @@ void TaskExecuteCustomCommands::handleMessage(MessageIndexingInterrupted* messag
 void TaskExecuteCustomCommands::executeParallelIndexerCommands(
 	int threadId, std::shared_ptr<Blackboard> blackboard)
 {
-	std::shared_ptr<PersistentStorage> storage;
 	while (!m_interrupted)
 	{
 		std::shared_ptr<IndexerCommandCustom> indexerCommand;
@@ -405,48 +415,33 @@ void TaskExecuteCustomCommands::executeParallelIndexerCommands(
 			m_parallelCommands.pop_back();
 		}
 
-		if (threadId == 0)
-		{
-			storage = m_storage;
-		}
-		else
-		{
-			FilePath databaseFilePath = indexerCommand->getDatabaseFilePath();
-			databaseFilePath = databaseFilePath.getParentDirectory().concatenate(
-				databaseFilePath.fileName() + L"_thread" + std::to_wstring(threadId));
-
-			bool databaseFilePathKnown = true;
-			{
-				std::lock_guard<std::mutex> lock(m_sourceDatabaseFilePathsMutex);
-				if (m_sourceDatabaseFilePaths.find(databaseFilePath) ==
-					m_sourceDatabaseFilePaths.end())
-				{
-					m_sourceDatabaseFilePaths.insert(databaseFilePath);
-					databaseFilePathKnown = false;
-				}
-			}
+		runIndexerCommand(indexerCommand, blackboard, getCustomCommandStorage(threadId));
+	}
+}
 
-			if (!databaseFilePathKnown)
-			{
-				if (databaseFilePath.exists())
-				{
-					LOG_WARNING(
-						L"Temporary storage \"" + databaseFilePath.wstr() +
-						L"\" already exists on file system. File will be removed to avoid "
-						L"conflicts.");
-					FileSystem::remove(databaseFilePath);
-				}
-				storage = std::make_shared<PersistentStorage>(databaseFilePath, FilePath());
-				storage->setup();
-				storage->setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
-				storage->buildCaches();
-			}
+std::shared_ptr<PersistentStorage> TaskExecuteCustomCommands::getCustomCommandStorage(int threadId)
+{
+	std::lock_guard<std::mutex> lock(m_customCommandStoragesMutex);
 
-			indexerCommand->setDatabaseFilePath(databaseFilePath);
+	std::shared_ptr<PersistentStorage>& storage = m_customCommandStorages[threadId];
+	if (!storage)
+	{
+		const FilePath databaseFilePath = m_targetDatabaseFilePath.getParentDirectory().concatenate(
+			m_targetDatabaseFilePath.fileName() + L"_thread" + std::to_wstring(threadId));
+		if (databaseFilePath.exists())
+		{
+			LOG_WARNING(
+				L"Temporary storage \"" + databaseFilePath.wstr() +
+				L"\" already exists on file system. File will be removed to avoid conflicts.");
+			FileSystem::remove(databaseFilePath);
 		}
 
-		runIndexerCommand(indexerCommand, blackboard, storage);
+		// custom commands never write into the project's storage, so indexers built against an
+		// older storage version get a database in the layout they know
+		storage = std::make_shared<PersistentStorage>(databaseFilePath, FilePath());
+		storage->setupCustomCommandStorage();
 	}
+	return storage;
 }
 
 void TaskExecuteCustomCommands::runIndexerCommand(
@@ -456,6 +451,8 @@ void TaskExecuteCustomCommands::runIndexerCommand(
 {
 	if (indexerCommand)
 	{
+		indexerCommand->setDatabaseFilePath(storage->getIndexDbFilePath());
+
 		int indexedSourceFileCount = 0;
 		blackboard->get("indexed_source_file_count", indexedSourceFileCount);
 
@@ -1,7 +1,7 @@
 #ifndef TASK_EXECUTE_CUSTOM_COMMANDS_H
 #define TASK_EXECUTE_CUSTOM_COMMANDS_H
 
-#include <set>
+#include <map>
 #include <vector>
 
 #include "ErrorCountInfo.h"
@@ -39,6 +39,7 @@ private:
 	void handleMessage(MessageIndexingInterrupted* message) override;
 
 	void executeParallelIndexerCommands(int threadId, std::shared_ptr<Blackboard> blackboard);
+	std::shared_ptr<PersistentStorage> getCustomCommandStorage(int threadId);
 	void runIndexerCommand(
 		std::shared_ptr<IndexerCommandCustom> indexerCommand,
 		std::shared_ptr<Blackboard> blackboard,
@@ -60,8 +61,8 @@ private:
 	std::mutex m_errorCountMutex;
 	FilePath m_targetDatabaseFilePath;
 	bool m_hasPythonCommands;
-	std::set<FilePath> m_sourceDatabaseFilePaths;
-	std::mutex m_sourceDatabaseFilePathsMutex;
+	std::map<int, std::shared_ptr<PersistentStorage>> m_customCommandStorages;
+	std::mutex m_customCommandStoragesMutex;
 };
 
 #endif	  // TASK_EXECUTE_CUSTOM_COMMANDS_H
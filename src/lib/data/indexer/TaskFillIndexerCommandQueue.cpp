@@ -9,10 +9,13 @@
 TaskFillIndexerCommandsQueue::TaskFillIndexerCommandsQueue(
 	const std::string& appUUID,
 	std::unique_ptr<IndexerCommandProvider> indexerCommandProvider,
-	size_t maximumQueueSize)
+	size_t maximumQueueSize,
+	size_t indexerCount,
+	std::map<FilePath, size_t> indexTimes)
 	: m_indexerCommandProvider(std::move(indexerCommandProvider))
-	, m_indexerCommandManager(appUUID, 0, true)
+	, m_indexerCommandManager(appUUID, 0, true, indexerCount)
 	, m_maximumQueueSize(maximumQueueSize)
+	, m_indexTimes(std::move(indexTimes))
 {
 }
 
@@ -20,8 +23,8 @@ void TaskFillIndexerCommandsQueue::doEnter(std::shared_ptr<Blackboard> blackboar
 {
 	{
 		std::lock_guard<std::mutex> lock(m_commandsMutex);
-		for (const FilePath& filePath:
-			 utility::partitionFilePathsBySize(m_indexerCommandProvider->getAllSourceFilePaths(), 2))
+		for (const FilePath& filePath: utility::orderFilePathsByIndexCost(
+				 m_indexerCommandProvider->getAllSourceFilePaths(), m_indexTimes))
 		{
 			m_filePathQueue.emplace(filePath);
 		}
@@ -49,7 +52,8 @@ Task::TaskState TaskFillIndexerCommandsQueue::doUpdate(std::shared_ptr<Blackboar
 		}
 	}
 
-	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	// indexers notify whenever they take a command, so the queue is refilled right away
+	m_indexerCommandManager.waitForIndexerCommandCountBelow(m_maximumQueueSize, 200);
 
 	return STATE_RUNNING;
 }
@@ -1,6 +1,7 @@
 #ifndef TASK_FILL_INDEXER_COMMAND_QUEUE_H
 #define TASK_FILL_INDEXER_COMMAND_QUEUE_H
 
+#include <map>
 #include <queue>
 
 #include "MessageIndexingInterrupted.h"
@@ -19,7 +20,9 @@ public:
 	TaskFillIndexerCommandsQueue(
 		const std::string& appUUID,
 		std::unique_ptr<IndexerCommandProvider> indexerCommandProvider,
-		size_t maximumQueueSize);
+		size_t maximumQueueSize,
+		size_t indexerCount,
+		std::map<FilePath, size_t> indexTimes = {});
 
 protected:
 	void doEnter(std::shared_ptr<Blackboard> blackboard) override;
@@ -38,6 +41,9 @@ private:
 
 	const size_t m_maximumQueueSize;
 
+	// index times of the previous runs, so the most expensive commands are queued first
+	const std::map<FilePath, size_t> m_indexTimes;
+
 	std::queue<FilePath> m_filePathQueue;
 	std::mutex m_commandsMutex;
 
@@ -1,5 +1,7 @@
 #include "BaseInterprocessDataManager.h"
 
+#include "TimeStamp.h"
+
 BaseInterprocessDataManager::BaseInterprocessDataManager(
 	const std::string& sharedMemoryName,
 	size_t initialSharedMemorySize,
@@ -19,3 +21,29 @@ Id BaseInterprocessDataManager::getProcessId() const
 {
 	return m_processId;
 }
+
+void BaseInterprocessDataManager::notifyChange()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+	access.notifyChange();
+}
+
+bool BaseInterprocessDataManager::waitUntil(
+	size_t timeoutMilliseconds, const std::function<bool(SharedMemory::ScopedAccess&)>& condition)
+{
+	const TimeStamp startTime = TimeStamp::now();
+
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+	while (!condition(access))
+	{
+		const size_t waitedMilliseconds = TimeStamp::now().deltaMS(startTime);
+		if (waitedMilliseconds >= timeoutMilliseconds)
+		{
+			return false;
+		}
+
+		access.waitForChange(timeoutMilliseconds - waitedMilliseconds);
+	}
+
+	return true;
+}
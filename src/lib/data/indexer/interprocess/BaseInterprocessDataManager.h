@@ -1,6 +1,7 @@
 #ifndef BASE_INTERPROCESS_DATA_MANAGER_H
 #define BASE_INTERPROCESS_DATA_MANAGER_H
 
+#include <functional>
 #include <string>
 
 #include "SharedMemory.h"
@@ -20,7 +21,16 @@ public:
 
 	Id getProcessId() const;
 
+	// wakes all processes waiting for a change of this shared memory
+	void notifyChange();
+
 protected:
+	// waits until the condition, which is checked while the memory is locked, holds or the timeout
+	// passed. returns whether the condition holds.
+	bool waitUntil(
+		size_t timeoutMilliseconds,
+		const std::function<bool(SharedMemory::ScopedAccess&)>& condition);
+
 	SharedMemory m_sharedMemory;
 
 	const std::string m_instanceUuid;
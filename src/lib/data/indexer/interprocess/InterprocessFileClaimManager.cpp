@@ -0,0 +1,238 @@
+#include "InterprocessFileClaimManager.h"
+
+#include <algorithm>
+
+#include "logging.h"
+#include "utilityString.h"
+
+const char* InterprocessFileClaimManager::s_sharedMemoryNamePrefix = "ifcl_";
+
+const char* InterprocessFileClaimManager::s_claimedFilesKeyName = "claimed_files";
+const char* InterprocessFileClaimManager::s_pendingFilesKeyName = "pending_files_";
+const char* InterprocessFileClaimManager::s_skippedFilesKeyName = "skipped_files";
+
+InterprocessFileClaimManager::InterprocessFileClaimManager(
+	const std::string& instanceUuid, Id processId, bool isOwner)
+	: BaseInterprocessDataManager(
+		  s_sharedMemoryNamePrefix + instanceUuid, 1048576 /* 1 MB */, instanceUuid, processId, isOwner)
+{
+}
+
+InterprocessFileClaimManager::~InterprocessFileClaimManager() {}
+
+bool InterprocessFileClaimManager::claimFile(const FilePath& filePath)
+{
+	const std::string path = utility::encodeToUtf8(filePath.wstr());
+
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Map<SharedMemory::String, Id>* claimedFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Map<SharedMemory::String, Id>>(
+			s_claimedFilesKeyName);
+	SharedMemory::Vector<SharedMemory::String>* pendingFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(
+			getPendingFilesKeyName());
+	if (!claimedFilesPtr || !pendingFilesPtr)
+	{
+		return true;
+	}
+
+	// paths are stored twice, in the claimed files and in the pending files that may get
+	// reallocated
+	const size_t overestimationMultiplier = 3;
+	const size_t estimatedSize = overestimationMultiplier *
+		(2 * (sizeof(SharedMemory::String) + path.size()) + sizeof(Id) + 64 +
+		 2 * pendingFilesPtr->size() * sizeof(SharedMemory::String));
+
+	if (access.getFreeMemorySize() < estimatedSize)
+	{
+		while (access.getFreeMemorySize() < estimatedSize)
+		{
+			LOG_INFO_STREAM(
+				<< "grow memory - est: " << estimatedSize << " size: " << access.getMemorySize()
+				<< " free: " << access.getFreeMemorySize());
+			access.growMemory(access.getMemorySize());
+		}
+
+		claimedFilesPtr =
+			access.accessValueWithAllocator<SharedMemory::Map<SharedMemory::String, Id>>(
+				s_claimedFilesKeyName);
+		pendingFilesPtr =
+			access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(
+				getPendingFilesKeyName());
+		if (!claimedFilesPtr || !pendingFilesPtr)
+		{
+			return true;
+		}
+	}
+
+	SharedMemory::String pathStr(path.c_str(), access.getAllocator());
+
+	SharedMemory::Map<SharedMemory::String, Id>::iterator it = claimedFilesPtr->find(pathStr);
+	if (it != claimedFilesPtr->end())
+	{
+		// a file can be included several times by the current translation unit, once its claim
+		// is finished it stays with the translation unit that indexed it
+		if (it->second == getProcessId() &&
+			std::find(pendingFilesPtr->begin(), pendingFilesPtr->end(), pathStr) !=
+				pendingFilesPtr->end())
+		{
+			return true;
+		}
+
+		m_skippedFilePaths.insert(path);
+		return false;
+	}
+
+	claimedFilesPtr->emplace(pathStr, getProcessId());
+	pendingFilesPtr->push_back(pathStr);
+	return true;
+}
+
+void InterprocessFileClaimManager::startClaims(const FilePath& sourceFilePath)
+{
+	m_sourceFilePath = utility::encodeToUtf8(sourceFilePath.wstr());
+	m_skippedFilePaths.clear();
+}
+
+void InterprocessFileClaimManager::finishClaims()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Vector<SharedMemory::String>* pendingFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(
+			getPendingFilesKeyName());
+	if (pendingFilesPtr)
+	{
+		pendingFilesPtr->clear();
+	}
+
+	if (m_skippedFilePaths.empty())
+	{
+		return;
+	}
+
+	SharedMemory::Vector<SharedSkippedFile>* skippedFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Vector<SharedSkippedFile>>(
+			s_skippedFilesKeyName);
+	if (!skippedFilesPtr)
+	{
+		return;
+	}
+
+	const size_t overestimationMultiplier = 3;
+	size_t estimatedSize = 2 * skippedFilesPtr->size() * sizeof(SharedSkippedFile);
+	for (const std::string& path: m_skippedFilePaths)
+	{
+		estimatedSize += sizeof(SharedSkippedFile) + path.size() + m_sourceFilePath.size() + 64;
+	}
+	estimatedSize *= overestimationMultiplier;
+
+	if (access.getFreeMemorySize() < estimatedSize)
+	{
+		while (access.getFreeMemorySize() < estimatedSize)
+		{
+			access.growMemory(access.getMemorySize());
+		}
+
+		skippedFilesPtr = access.accessValueWithAllocator<SharedMemory::Vector<SharedSkippedFile>>(
+			s_skippedFilesKeyName);
+		if (!skippedFilesPtr)
+		{
+			return;
+		}
+	}
+
+	for (const std::string& path: m_skippedFilePaths)
+	{
+		skippedFilesPtr->push_back(SharedSkippedFile(access.getAllocator()));
+		skippedFilesPtr->back().filePath = path.c_str();
+		skippedFilesPtr->back().sourceFilePath = m_sourceFilePath.c_str();
+	}
+	m_skippedFilePaths.clear();
+}
+
+void InterprocessFileClaimManager::releaseClaims()
+{
+	// the translation unit gets marked as crashed, so the files it skipped don't matter
+	m_skippedFilePaths.clear();
+
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Vector<SharedMemory::String>* pendingFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(
+			getPendingFilesKeyName());
+	if (!pendingFilesPtr || pendingFilesPtr->empty())
+	{
+		return;
+	}
+
+	SharedMemory::Map<SharedMemory::String, Id>* claimedFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Map<SharedMemory::String, Id>>(
+			s_claimedFilesKeyName);
+	if (claimedFilesPtr)
+	{
+		for (const SharedMemory::String& pathStr: *pendingFilesPtr)
+		{
+			claimedFilesPtr->erase(pathStr);
+		}
+	}
+
+	LOG_INFO_STREAM(<< getProcessId() << " released " << pendingFilesPtr->size() << " file claims");
+	pendingFilesPtr->clear();
+}
+
+size_t InterprocessFileClaimManager::getClaimedFileCount()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Map<SharedMemory::String, Id>* claimedFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Map<SharedMemory::String, Id>>(
+			s_claimedFilesKeyName);
+	if (claimedFilesPtr)
+	{
+		return claimedFilesPtr->size();
+	}
+
+	return 0;
+}
+
+std::vector<FilePath> InterprocessFileClaimManager::getSourceFilePathsMissingSkippedFiles()
+{
+	std::set<std::string> sourceFilePaths;
+	{
+		SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+		SharedMemory::Map<SharedMemory::String, Id>* claimedFilesPtr =
+			access.accessValueWithAllocator<SharedMemory::Map<SharedMemory::String, Id>>(
+				s_claimedFilesKeyName);
+		SharedMemory::Vector<SharedSkippedFile>* skippedFilesPtr =
+			access.accessValueWithAllocator<SharedMemory::Vector<SharedSkippedFile>>(
+				s_skippedFilesKeyName);
+		if (!claimedFilesPtr || !skippedFilesPtr)
+		{
+			return {};
+		}
+
+		// released claims are removed, so files without a claim were not finished
+		for (const SharedSkippedFile& skippedFile: *skippedFilesPtr)
+		{
+			if (claimedFilesPtr->find(skippedFile.filePath) == claimedFilesPtr->end())
+			{
+				sourceFilePaths.insert(skippedFile.sourceFilePath.c_str());
+			}
+		}
+	}
+
+	std::vector<FilePath> filePaths;
+	for (const std::string& path: sourceFilePaths)
+	{
+		filePaths.push_back(FilePath(utility::decodeFromUtf8(path)));
+	}
+	return filePaths;
+}
+
+std::string InterprocessFileClaimManager::getPendingFilesKeyName() const
+{
+	return s_pendingFilesKeyName + std::to_string(getProcessId());
+}
@@ -0,0 +1,62 @@
+#ifndef INTERPROCESS_FILE_CLAIM_MANAGER_H
+#define INTERPROCESS_FILE_CLAIM_MANAGER_H
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "BaseInterprocessDataManager.h"
+#include "FilePath.h"
+
+// keeps track of which indexer process records the symbols of a file during an indexing run, so
+// headers included by many translation units are only traversed once
+class InterprocessFileClaimManager: public BaseInterprocessDataManager
+{
+public:
+	InterprocessFileClaimManager(const std::string& instanceUuid, Id processId, bool isOwner);
+	virtual ~InterprocessFileClaimManager();
+
+	// returns true if the file was not claimed yet or was claimed by the current translation unit
+	// of this process
+	bool claimFile(const FilePath& filePath);
+
+	// files the translation unit of the source file is not given are remembered for it
+	void startClaims(const FilePath& sourceFilePath);
+
+	// keeps the claims of the current translation unit for the rest of the run
+	void finishClaims();
+
+	// drops the claims of the current translation unit, e.g. when it crashed or was interrupted
+	void releaseClaims();
+
+	size_t getClaimedFileCount();
+
+	// source files of translation units that skipped a file, which lost its claim afterwards and
+	// was not indexed by any other translation unit
+	std::vector<FilePath> getSourceFilePathsMissingSkippedFiles();
+
+private:
+	struct SharedSkippedFile
+	{
+		SharedSkippedFile(SharedMemory::Allocator* allocator)
+			: filePath("", allocator), sourceFilePath("", allocator)
+		{
+		}
+
+		SharedMemory::String filePath;
+		SharedMemory::String sourceFilePath;
+	};
+
+	static const char* s_sharedMemoryNamePrefix;
+
+	static const char* s_claimedFilesKeyName;
+	static const char* s_pendingFilesKeyName;
+	static const char* s_skippedFilesKeyName;
+
+	std::string getPendingFilesKeyName() const;
+
+	std::string m_sourceFilePath;
+	std::set<std::string> m_skippedFilePaths;
+};
+
+#endif	  // INTERPROCESS_FILE_CLAIM_MANAGER_H
@@ -1,16 +1,19 @@
 #include "InterprocessIndexer.h"
 
+#include "ApplicationSettings.h"
 #include "FileRegister.h"
 #include "IndexerCommand.h"
 #include "IndexerComposite.h"
 #include "LanguagePackageManager.h"
 #include "ScopedFunctor.h"
+#include "TimeStamp.h"
 #include "logging.h"
 
 InterprocessIndexer::InterprocessIndexer(const std::string& uuid, Id processId)
 	: m_interprocessIndexerCommandManager(uuid, processId, false)
 	, m_interprocessIndexingStatusManager(uuid, processId, false)
 	, m_interprocessIntermediateStorageManager(uuid, processId, false)
+	, m_interprocessFileClaimManager(uuid, processId, false)
 	, m_uuid(uuid)
 	, m_processId(processId)
 {
@@ -27,12 +30,18 @@ void InterprocessIndexer::work()
 		LOG_INFO_STREAM(<< m_processId << " starting up indexer");
 		indexer = LanguagePackageManager::getInstance()->instantiateSupportedIndexers();
 
+		if (ApplicationSettings::getInstance()->getHeaderClaimsEnabled())
+		{
+			indexer->setClaimFilePathFunction([this](const FilePath& filePath) {
+				return m_interprocessFileClaimManager.claimFile(filePath);
+			});
+		}
+
 		updaterThread = std::make_shared<std::thread>([&]() {
 			while (updaterThreadRunning)
 			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-
-				if (m_interprocessIndexingStatusManager.getIndexingInterrupted())
+				if (m_interprocessIndexingStatusManager.waitForIndexingInterrupted(
+						1000, [&]() { return !updaterThreadRunning; }))
 				{
 					LOG_INFO_STREAM(<< m_processId << " received indexer interrupt command.");
 					if (indexer)
@@ -48,33 +57,51 @@ void InterprocessIndexer::work()
 			updaterThreadRunning = false;
 			if (updaterThread)
 			{
+				m_interprocessIndexingStatusManager.notifyChange();
 				updaterThread->join();
 				updaterThread.reset();
 			}
 		});
 
-		while (std::shared_ptr<IndexerCommand> indexerCommand =
-				   m_interprocessIndexerCommandManager.popIndexerCommand())
+		// commands taken and files claimed by a crashed indexer process with the same id
+		m_interprocessIndexerCommandManager.releaseTakenIndexerCommands(
+			m_interprocessIndexingStatusManager.getUnfinishedSourceFilePath());
+		m_interprocessFileClaimManager.releaseClaims();
+
+		std::vector<std::shared_ptr<IndexerCommand>> indexerCommands;
+		size_t nextCommandIndex = 0;
+		while (true)
 		{
+			if (nextCommandIndex == indexerCommands.size())
+			{
+				indexerCommands = m_interprocessIndexerCommandManager.popIndexerCommands(4);
+				nextCommandIndex = 0;
+				if (indexerCommands.empty())
+				{
+					break;
+				}
+			}
+
+			std::shared_ptr<IndexerCommand> indexerCommand = indexerCommands[nextCommandIndex++];
 			LOG_INFO_STREAM(
 				<< m_processId << " fetched indexer command for \""
 				<< indexerCommand->getSourceFilePath().str() << "\"");
 			LOG_INFO_STREAM(
-				<< m_processId << " indexer commands left: "
-				<< m_interprocessIndexerCommandManager.indexerCommandCount());
+				<< m_processId << " indexer commands left in batch: "
+				<< indexerCommands.size() - nextCommandIndex);
 
-			while (updaterThreadRunning)
+			const TimeStamp waitStartTime = TimeStamp::now();
+			while (updaterThreadRunning &&
+				   !m_interprocessIntermediateStorageManager.waitForIntermediateStorageCountBelow(
+					   2, 200))
 			{
-				const size_t storageCount =
-					m_interprocessIntermediateStorageManager.getIntermediateStorageCount();
-				if (storageCount < 2)
-				{
-					break;
-				}
-
-				LOG_INFO_STREAM(<< m_processId << " waits, too many intermediate storages: " << storageCount);
+				LOG_INFO_STREAM(<< m_processId << " waits, too many intermediate storages");
+			}
 
-				std::this_thread::sleep_for(std::chrono::milliseconds(200));
+			const size_t waitTime = TimeStamp::now().deltaMS(waitStartTime);
+			if (waitTime > 0)
+			{
+				m_interprocessIndexingStatusManager.addIndexerWaitTime(waitTime);
 			}
 
 			if (!updaterThreadRunning)
@@ -82,21 +109,34 @@ void InterprocessIndexer::work()
 				break;
 			}
 
+			m_interprocessFileClaimManager.startClaims(indexerCommand->getSourceFilePath());
+
 			LOG_INFO_STREAM(<< m_processId << " updating indexer status with currently indexed filepath");
 			m_interprocessIndexingStatusManager.startIndexingSourceFile(
 				indexerCommand->getSourceFilePath());
 
 			LOG_INFO_STREAM(<< m_processId << " starting to index current file");
+			const TimeStamp startTime = TimeStamp::now();
 			std::shared_ptr<IntermediateStorage> result = indexer->index(indexerCommand);
 
 			if (result)
 			{
+				// kept for scheduling the most expensive files first in the next refresh
+				m_interprocessIndexingStatusManager.addIndexTime(
+					indexerCommand->getSourceFilePath(), TimeStamp::now().deltaMS(startTime));
+
 				LOG_INFO_STREAM(<< m_processId << " pushing index to shared memory");
 				m_interprocessIntermediateStorageManager.pushIntermediateStorage(result);
+				m_interprocessFileClaimManager.finishClaims();
+			}
+			else
+			{
+				m_interprocessFileClaimManager.releaseClaims();
 			}
 
 			LOG_INFO_STREAM(<< m_processId << " finalizing indexer status for current file");
 			m_interprocessIndexingStatusManager.finishIndexingSourceFile();
+			m_interprocessIndexerCommandManager.finishIndexerCommand();
 
 			LOG_INFO_STREAM(<< m_processId << " all done");
 		}
@@ -1,6 +1,7 @@
 #ifndef INTERPROCESS_INDEXER_H
 #define INTERPROCESS_INDEXER_H
 
+#include "InterprocessFileClaimManager.h"
 #include "InterprocessIndexerCommandManager.h"
 #include "InterprocessIndexingStatusManager.h"
 #include "InterprocessIntermediateStorageManager.h"
@@ -16,6 +17,7 @@ private:
 	InterprocessIndexerCommandManager m_interprocessIndexerCommandManager;
 	InterprocessIndexingStatusManager m_interprocessIndexingStatusManager;
 	InterprocessIntermediateStorageManager m_interprocessIntermediateStorageManager;
+	InterprocessFileClaimManager m_interprocessFileClaimManager;
 
 	const std::string m_uuid;
 	const Id m_processId;
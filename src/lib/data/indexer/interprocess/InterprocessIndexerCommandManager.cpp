@@ -1,17 +1,53 @@
 #include "InterprocessIndexerCommandManager.h"
 
+#include <algorithm>
+
 #include "IndexerCommand.h"
 #include "logging.h"
+#include "utilityString.h"
 
 const char* InterprocessIndexerCommandManager::s_sharedMemoryNamePrefix = "icmd_";
+const char* InterprocessIndexerCommandManager::s_laneSharedMemoryNamePrefix = "icml";
 
 const char* InterprocessIndexerCommandManager::s_indexerCommandsKeyName = "indexer_commands";
+const char* InterprocessIndexerCommandManager::s_takenCountKeyName = "taken_count";
+const char* InterprocessIndexerCommandManager::s_settingsKeyName = "indexer_command_settings";
+const char* InterprocessIndexerCommandManager::s_laneCountKeyName = "lane_count";
+const char* InterprocessIndexerCommandManager::s_indexerCommandCountKeyName =
+	"indexer_command_count";
 
 InterprocessIndexerCommandManager::InterprocessIndexerCommandManager(
-	const std::string& instanceUuid, Id processId, bool isOwner)
+	const std::string& instanceUuid, Id processId, bool isOwner, size_t laneCount)
 	: BaseInterprocessDataManager(
 		  s_sharedMemoryNamePrefix + instanceUuid, 1048576 /* 1 MB */, instanceUuid, processId, isOwner)
+	, m_laneIndex(0)
 {
+	{
+		SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+		size_t* laneCountPtr = access.accessValue<size_t>(s_laneCountKeyName);
+		if (laneCountPtr)
+		{
+			if (isOwner)
+			{
+				*laneCountPtr = std::max<size_t>(laneCount, 1);
+			}
+			laneCount = std::max<size_t>(*laneCountPtr, 1);
+		}
+	}
+
+	for (size_t i = 0; i < laneCount; i++)
+	{
+		m_laneMemories.push_back(std::make_shared<SharedMemory>(
+			s_laneSharedMemoryNamePrefix + std::to_string(i) + "_" + instanceUuid,
+			262144 /* 256 kB */,
+			isOwner ? SharedMemory::CREATE_AND_DELETE : SharedMemory::OPEN_ONLY));
+	}
+
+	if (processId > 0)
+	{
+		m_laneIndex = (processId - 1) % m_laneMemories.size();
+	}
 }
 
 InterprocessIndexerCommandManager::~InterprocessIndexerCommandManager() {}
@@ -19,10 +55,219 @@ InterprocessIndexerCommandManager::~InterprocessIndexerCommandManager() {}
 void InterprocessIndexerCommandManager::pushIndexerCommands(
 	const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands)
 {
+	const std::vector<size_t> settingsIds = pushSettings(indexerCommands);
+
+	std::vector<size_t> laneCounts;
+	for (size_t i = 0; i < m_laneMemories.size(); i++)
+	{
+		laneCounts.push_back(getUntakenLaneCommandCount(i));
+	}
+
+	// commands are ordered by priority, so they are spread over the lanes one by one
+	std::vector<std::vector<CommandReference>> laneReferences(m_laneMemories.size());
+	size_t pushedCount = 0;
+	for (size_t i = 0; i < indexerCommands.size(); i++)
+	{
+		if (settingsIds[i] == 0)
+		{
+			continue;
+		}
+
+		const size_t laneIndex = std::min_element(laneCounts.begin(), laneCounts.end()) -
+			laneCounts.begin();
+		laneReferences[laneIndex].emplace_back(
+			utility::encodeToUtf8(indexerCommands[i]->getSourceFilePath().wstr()), settingsIds[i]);
+		laneCounts[laneIndex]++;
+		pushedCount++;
+	}
+
+	for (size_t i = 0; i < laneReferences.size(); i++)
+	{
+		if (!laneReferences[i].empty())
+		{
+			pushLaneCommands(i, laneReferences[i]);
+		}
+	}
+
+	addIndexerCommandCount(pushedCount, 0);
+}
+
+std::vector<std::shared_ptr<IndexerCommand>> InterprocessIndexerCommandManager::popIndexerCommands(
+	size_t maximumCount)
+{
+	std::vector<CommandReference> references = takeLaneCommands(m_laneIndex, maximumCount);
+	for (size_t i = 1; references.empty() && i < m_laneMemories.size(); i++)
+	{
+		if (stealLaneCommands((m_laneIndex + i) % m_laneMemories.size()))
+		{
+			references = takeLaneCommands(m_laneIndex, maximumCount);
+		}
+	}
+
+	if (references.empty())
+	{
+		return {};
+	}
+
+	addIndexerCommandCount(0, references.size());
+
+	std::vector<std::shared_ptr<IndexerCommand>> commands;
+	for (const CommandReference& reference: references)
+	{
+		if (std::shared_ptr<IndexerCommand> settings = getSettings(reference.second))
+		{
+			commands.push_back(SharedIndexerCommand::createForSourceFilePath(
+				settings.get(), FilePath(utility::decodeFromUtf8(reference.first))));
+		}
+	}
+	return commands;
+}
+
+void InterprocessIndexerCommandManager::finishIndexerCommand()
+{
+	SharedMemory::ScopedAccess access(m_laneMemories[m_laneIndex].get());
+
+	SharedMemory::Queue<SharedIndexerCommandReference>* queue =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommandReference>>(
+			s_indexerCommandsKeyName);
+	size_t* takenCountPtr = access.accessValue<size_t>(s_takenCountKeyName);
+	if (!queue || !takenCountPtr || !*takenCountPtr || queue->empty())
+	{
+		return;
+	}
+
+	queue->pop_front();
+	(*takenCountPtr)--;
+}
+
+void InterprocessIndexerCommandManager::releaseTakenIndexerCommands(
+	const FilePath& crashedSourceFilePath)
+{
+	size_t releasedCount = 0;
+	{
+		SharedMemory::ScopedAccess access(m_laneMemories[m_laneIndex].get());
+
+		SharedMemory::Queue<SharedIndexerCommandReference>* queue =
+			access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommandReference>>(
+				s_indexerCommandsKeyName);
+		size_t* takenCountPtr = access.accessValue<size_t>(s_takenCountKeyName);
+		if (!queue || !takenCountPtr || !*takenCountPtr)
+		{
+			return;
+		}
+
+		const std::string crashedPath = utility::encodeToUtf8(crashedSourceFilePath.wstr());
+		if (!queue->empty() && queue->front().sourceFilePath.c_str() == crashedPath)
+		{
+			queue->pop_front();
+			(*takenCountPtr)--;
+		}
+
+		releasedCount = *takenCountPtr;
+		*takenCountPtr = 0;
+	}
+
+	if (releasedCount)
+	{
+		LOG_INFO_STREAM(<< m_processId << " released taken indexer commands: " << releasedCount);
+		addIndexerCommandCount(releasedCount, 0);
+	}
+}
+
+void InterprocessIndexerCommandManager::clearIndexerCommands()
+{
+	for (const std::shared_ptr<SharedMemory>& laneMemory: m_laneMemories)
+	{
+		SharedMemory::ScopedAccess access(laneMemory.get());
+
+		SharedMemory::Queue<SharedIndexerCommandReference>* queue =
+			access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommandReference>>(
+				s_indexerCommandsKeyName);
+		if (queue)
+		{
+			queue->clear();
+		}
+
+		size_t* takenCountPtr = access.accessValue<size_t>(s_takenCountKeyName);
+		if (takenCountPtr)
+		{
+			*takenCountPtr = 0;
+		}
+	}
+
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	size_t* countPtr = access.accessValue<size_t>(s_indexerCommandCountKeyName);
+	if (countPtr)
+	{
+		*countPtr = 0;
+	}
+
+	access.notifyChange();
+}
+
+size_t InterprocessIndexerCommandManager::indexerCommandCount()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	size_t* countPtr = access.accessValue<size_t>(s_indexerCommandCountKeyName);
+	if (!countPtr)
+	{
+		return 0;
+	}
+
+	return *countPtr;
+}
+
+bool InterprocessIndexerCommandManager::waitForIndexerCommandCountBelow(
+	size_t count, size_t timeoutMilliseconds)
+{
+	return waitUntil(timeoutMilliseconds, [count](SharedMemory::ScopedAccess& access) {
+		size_t* countPtr = access.accessValue<size_t>(s_indexerCommandCountKeyName);
+		return !countPtr || *countPtr < count;
+	});
+}
+
+std::vector<size_t> InterprocessIndexerCommandManager::pushSettings(
+	const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands)
+{
+	// ids start at 1, 0 marks commands without settings
+	std::vector<size_t> settingsIds;
+	std::vector<std::shared_ptr<IndexerCommand>> newSettings;
+	for (const std::shared_ptr<IndexerCommand>& command: indexerCommands)
+	{
+		const std::shared_ptr<IndexerCommand> commandSettings =
+			SharedIndexerCommand::createSettings(command.get());
+		const std::string key = commandSettings
+			? SharedIndexerCommand::getSettingsKey(commandSettings.get())
+			: "";
+		if (key.empty())
+		{
+			LOG_ERROR(
+				L"Trying to push unhandled type of IndexerCommand for file: " +
+				command->getSourceFilePath().wstr() + L". It will be ignored.");
+			settingsIds.push_back(0);
+			continue;
+		}
+
+		std::map<std::string, size_t>::const_iterator it = m_settingsIds.find(key);
+		if (it == m_settingsIds.end())
+		{
+			it = m_settingsIds.emplace(key, m_settingsIds.size() + 1).first;
+			newSettings.push_back(commandSettings);
+		}
+		settingsIds.push_back(it->second);
+	}
+
+	if (newSettings.empty())
+	{
+		return settingsIds;
+	}
+
 	size_t size = 0;
 	{
 		const size_t overestimationMultiplier = 2;
-		for (auto& command: indexerCommands)
+		for (const std::shared_ptr<IndexerCommand>& command: newSettings)
 		{
 			size += command->getByteSize(sizeof(SharedMemory::String)) + sizeof(SharedIndexerCommand);
 		}
@@ -42,69 +287,176 @@ void InterprocessIndexerCommandManager::pushIndexerCommands(
 		LOG_INFO("growing memory succeeded");
 	}
 
-	SharedMemory::Queue<SharedIndexerCommand>* queue =
-		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
-			s_indexerCommandsKeyName);
-	if (!queue)
+	SharedMemory::Vector<SharedIndexerCommand>* settings =
+		access.accessValueWithAllocator<SharedMemory::Vector<SharedIndexerCommand>>(
+			s_settingsKeyName);
+	if (!settings)
 	{
-		return;
+		return std::vector<size_t>(indexerCommands.size(), 0);
 	}
 
-	for (auto& command: indexerCommands)
+	for (const std::shared_ptr<IndexerCommand>& command: newSettings)
 	{
-		queue->push_back(SharedIndexerCommand(access.getAllocator()));
-		SharedIndexerCommand& sharedCommand = queue->back();
-		sharedCommand.fromLocal(command.get());
+		settings->push_back(SharedIndexerCommand(access.getAllocator()));
+		settings->back().fromLocal(command.get());
 	}
 
 	LOG_INFO(access.logString());
+
+	return settingsIds;
 }
 
-std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::popIndexerCommand()
+std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::getSettings(size_t settingsId)
 {
-	SharedMemory::ScopedAccess access(&m_sharedMemory);
-
-	SharedMemory::Queue<SharedIndexerCommand>* queue =
-		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
-			s_indexerCommandsKeyName);
-	if (!queue || !queue->size())
+	std::map<size_t, std::shared_ptr<IndexerCommand>>::const_iterator it = m_settings.find(
+		settingsId);
+	if (it != m_settings.end())
 	{
-		return nullptr;
+		return it->second;
 	}
 
-	std::shared_ptr<IndexerCommand> command = SharedIndexerCommand::fromShared(queue->front());
+	std::shared_ptr<IndexerCommand> command;
+	{
+		SharedMemory::ScopedAccess access(&m_sharedMemory);
 
-	queue->pop_front();
+		SharedMemory::Vector<SharedIndexerCommand>* settings =
+			access.accessValueWithAllocator<SharedMemory::Vector<SharedIndexerCommand>>(
+				s_settingsKeyName);
+		if (settings && settingsId > 0 && settingsId <= settings->size())
+		{
+			command = SharedIndexerCommand::fromShared((*settings)[settingsId - 1]);
+		}
+	}
 
+	if (command)
+	{
+		m_settings.emplace(settingsId, command);
+	}
 	return command;
 }
 
-void InterprocessIndexerCommandManager::clearIndexerCommands()
+void InterprocessIndexerCommandManager::pushLaneCommands(
+	size_t laneIndex, const std::vector<CommandReference>& references)
 {
-	SharedMemory::ScopedAccess access(&m_sharedMemory);
+	size_t size = 0;
+	{
+		const size_t overestimationMultiplier = 2;
+		for (const CommandReference& reference: references)
+		{
+			size += reference.first.size() + sizeof(SharedIndexerCommandReference) + 64;
+		}
+		size *= overestimationMultiplier;
+	}
 
-	SharedMemory::Queue<SharedIndexerCommand>* queue =
-		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
+	SharedMemory::ScopedAccess access(m_laneMemories[laneIndex].get());
+	while (access.getFreeMemorySize() < size)
+	{
+		access.growMemory(access.getMemorySize());
+	}
+
+	SharedMemory::Queue<SharedIndexerCommandReference>* queue =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommandReference>>(
 			s_indexerCommandsKeyName);
 	if (!queue)
 	{
 		return;
 	}
 
-	queue->clear();
+	for (const CommandReference& reference: references)
+	{
+		queue->push_back(SharedIndexerCommandReference(access.getAllocator()));
+		queue->back().sourceFilePath = reference.first.c_str();
+		queue->back().settingsId = reference.second;
+	}
 }
 
-size_t InterprocessIndexerCommandManager::indexerCommandCount()
+std::vector<InterprocessIndexerCommandManager::CommandReference> InterprocessIndexerCommandManager::
+	takeLaneCommands(size_t laneIndex, size_t maximumCount)
 {
-	SharedMemory::ScopedAccess access(&m_sharedMemory);
+	std::vector<CommandReference> references;
 
-	SharedMemory::Queue<SharedIndexerCommand>* queue =
-		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
+	SharedMemory::ScopedAccess access(m_laneMemories[laneIndex].get());
+
+	SharedMemory::Queue<SharedIndexerCommandReference>* queue =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommandReference>>(
 			s_indexerCommandsKeyName);
-	if (!queue)
+	size_t* takenCountPtr = access.accessValue<size_t>(s_takenCountKeyName);
+	if (!queue || !takenCountPtr || queue->size() <= *takenCountPtr)
+	{
+		return references;
+	}
+
+	// at most half of the available commands are taken, so others can still steal the rest
+	const size_t availableCount = queue->size() - *takenCountPtr;
+	const size_t count = std::max<size_t>(1, std::min(maximumCount, availableCount / 2));
+	for (size_t i = *takenCountPtr; i < *takenCountPtr + count; i++)
+	{
+		const SharedIndexerCommandReference& reference = (*queue)[i];
+		references.emplace_back(reference.sourceFilePath.c_str(), reference.settingsId);
+	}
+	*takenCountPtr += count;
+
+	return references;
+}
+
+bool InterprocessIndexerCommandManager::stealLaneCommands(size_t laneIndex)
+{
+	std::vector<CommandReference> references;
+	{
+		SharedMemory::ScopedAccess access(m_laneMemories[laneIndex].get());
+
+		SharedMemory::Queue<SharedIndexerCommandReference>* queue =
+			access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommandReference>>(
+				s_indexerCommandsKeyName);
+		size_t* takenCountPtr = access.accessValue<size_t>(s_takenCountKeyName);
+		if (!queue || !takenCountPtr || queue->size() <= *takenCountPtr)
+		{
+			return false;
+		}
+
+		// the lane's indexer takes from the front, so the back half of the available commands is
+		// stolen
+		const size_t availableCount = queue->size() - *takenCountPtr;
+		const size_t count = (availableCount + 1) / 2;
+		for (size_t i = queue->size() - count; i < queue->size(); i++)
+		{
+			const SharedIndexerCommandReference& reference = (*queue)[i];
+			references.emplace_back(reference.sourceFilePath.c_str(), reference.settingsId);
+		}
+		queue->erase(queue->end() - count, queue->end());
+	}
+
+	pushLaneCommands(m_laneIndex, references);
+	return true;
+}
+
+size_t InterprocessIndexerCommandManager::getUntakenLaneCommandCount(size_t laneIndex)
+{
+	SharedMemory::ScopedAccess access(m_laneMemories[laneIndex].get());
+
+	SharedMemory::Queue<SharedIndexerCommandReference>* queue =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommandReference>>(
+			s_indexerCommandsKeyName);
+	size_t* takenCountPtr = access.accessValue<size_t>(s_takenCountKeyName);
+	if (!queue || !takenCountPtr || queue->size() <= *takenCountPtr)
 	{
 		return 0;
 	}
 
-	return queue->size();
+	return queue->size() - *takenCountPtr;
+}
+
+void InterprocessIndexerCommandManager::addIndexerCommandCount(
+	size_t addedCount, size_t removedCount)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	size_t* countPtr = access.accessValue<size_t>(s_indexerCommandCountKeyName);
+	if (countPtr)
+	{
+		*countPtr += addedCount;
+		*countPtr -= std::min(*countPtr, removedCount);
+	}
+
+	access.notifyChange();
 }
@@ -1,26 +1,82 @@
 #ifndef INTERPROCESS_INDEXER_COMMAND_MANAGER_H
 #define INTERPROCESS_INDEXER_COMMAND_MANAGER_H
 
+#include <map>
+
 #include "BaseInterprocessDataManager.h"
 #include "SharedIndexerCommand.h"
 
 class IndexerCommand;
 
+// commands are queued in one lane per indexer process, each lane is a shared memory of its own, so
+// indexers don't contend for a single lock. an indexer takes commands from its own lane and steals
+// from the other lanes when it runs empty. the settings that commands have in common (indexed
+// paths, filters, compiler flags) are stored once and referenced by id.
 class InterprocessIndexerCommandManager: public BaseInterprocessDataManager
 {
 public:
-	InterprocessIndexerCommandManager(const std::string& instanceUuid, Id processId, bool isOwner);
+	InterprocessIndexerCommandManager(
+		const std::string& instanceUuid, Id processId, bool isOwner, size_t laneCount = 1);
 	virtual ~InterprocessIndexerCommandManager();
 
 	void pushIndexerCommands(const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands);
-	std::shared_ptr<IndexerCommand> popIndexerCommand();
+
+	// takes several commands at once, they stay in the lane until they are finished one by one, so
+	// the commands of a crashed indexer process can be given back
+	std::vector<std::shared_ptr<IndexerCommand>> popIndexerCommands(size_t maximumCount);
+	void finishIndexerCommand();
+
+	// gives back the commands taken by a crashed indexer process of the same lane, except the
+	// command it crashed on
+	void releaseTakenIndexerCommands(const FilePath& crashedSourceFilePath);
 
 	void clearIndexerCommands();
 	size_t indexerCommandCount();
 
+	// returns whether the queue holds less than the given count before the timeout passed
+	bool waitForIndexerCommandCountBelow(size_t count, size_t timeoutMilliseconds);
+
 private:
+	struct SharedIndexerCommandReference
+	{
+		SharedIndexerCommandReference(SharedMemory::Allocator* allocator)
+			: sourceFilePath("", allocator), settingsId(0)
+		{
+		}
+
+		SharedMemory::String sourceFilePath;
+		size_t settingsId;
+	};
+
+	using CommandReference = std::pair<std::string, size_t>;
+
 	static const char* s_sharedMemoryNamePrefix;
+	static const char* s_laneSharedMemoryNamePrefix;
 	static const char* s_indexerCommandsKeyName;
+	static const char* s_takenCountKeyName;
+	static const char* s_settingsKeyName;
+	static const char* s_laneCountKeyName;
+	static const char* s_indexerCommandCountKeyName;
+
+	std::vector<size_t> pushSettings(
+		const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands);
+	std::shared_ptr<IndexerCommand> getSettings(size_t settingsId);
+
+	void pushLaneCommands(size_t laneIndex, const std::vector<CommandReference>& references);
+	std::vector<CommandReference> takeLaneCommands(size_t laneIndex, size_t maximumCount);
+	bool stealLaneCommands(size_t laneIndex);
+	size_t getUntakenLaneCommandCount(size_t laneIndex);
+
+	void addIndexerCommandCount(size_t addedCount, size_t removedCount);
+
+	std::vector<std::shared_ptr<SharedMemory>> m_laneMemories;
+	size_t m_laneIndex;
+
+	// ids of the pushed settings, only used by the owner
+	std::map<std::string, size_t> m_settingsIds;
+
+	// settings that were already read from shared memory
+	std::map<size_t, std::shared_ptr<IndexerCommand>> m_settings;
 };
 
 #endif	  // INTERPROCESS_INDEXER_COMMAND_MANAGER_H
@@ -11,6 +11,8 @@ const char* InterprocessIndexingStatusManager::s_crashedFilesKeyName = "crashed_
 const char* InterprocessIndexingStatusManager::s_finishedProcessIdsKeyName = "finished_process_ids";
 const char* InterprocessIndexingStatusManager::s_indexingInterruptedKeyName =
 	"indexing_interrupted_flag";
+const char* InterprocessIndexingStatusManager::s_indexTimesKeyName = "index_times";
+const char* InterprocessIndexingStatusManager::s_indexerWaitTimeKeyName = "indexer_wait_time";
 
 InterprocessIndexingStatusManager::InterprocessIndexingStatusManager(
 	const std::string& instanceUuid, Id processId, bool isOwner)
@@ -105,6 +107,69 @@ void InterprocessIndexingStatusManager::finishIndexingSourceFile()
 	{
 		finishedProcessIdsPtr->push_back(m_processId);
 	}
+
+	access.notifyChange();
+}
+
+void InterprocessIndexingStatusManager::addIndexTime(const FilePath& filePath, size_t milliseconds)
+{
+	const std::string path = utility::encodeToUtf8(filePath.wstr());
+
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Map<SharedMemory::String, size_t>* indexTimesPtr =
+		access.accessValueWithAllocator<SharedMemory::Map<SharedMemory::String, size_t>>(
+			s_indexTimesKeyName);
+	if (!indexTimesPtr)
+	{
+		return;
+	}
+
+	const size_t overestimationMultiplier = 3;
+	const size_t estimatedSize = overestimationMultiplier *
+		(sizeof(SharedMemory::String) + path.size() + sizeof(size_t) + 64);
+
+	if (access.getFreeMemorySize() < estimatedSize)
+	{
+		while (access.getFreeMemorySize() < estimatedSize)
+		{
+			LOG_INFO_STREAM(
+				<< "grow memory - est: " << estimatedSize << " size: " << access.getMemorySize()
+				<< " free: " << access.getFreeMemorySize());
+			access.growMemory(access.getMemorySize());
+		}
+
+		indexTimesPtr =
+			access.accessValueWithAllocator<SharedMemory::Map<SharedMemory::String, size_t>>(
+				s_indexTimesKeyName);
+		if (!indexTimesPtr)
+		{
+			return;
+		}
+	}
+
+	SharedMemory::String pathStr(path.c_str(), access.getAllocator());
+	(*indexTimesPtr)[pathStr] = milliseconds;
+}
+
+std::map<FilePath, size_t> InterprocessIndexingStatusManager::getIndexTimes()
+{
+	std::map<FilePath, size_t> indexTimes;
+
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Map<SharedMemory::String, size_t>* indexTimesPtr =
+		access.accessValueWithAllocator<SharedMemory::Map<SharedMemory::String, size_t>>(
+			s_indexTimesKeyName);
+	if (indexTimesPtr)
+	{
+		for (const auto& p: *indexTimesPtr)
+		{
+			indexTimes.emplace(FilePath(utility::decodeFromUtf8(p.first.c_str())), p.second);
+		}
+	}
+
+	return indexTimes;
 }
 
 void InterprocessIndexingStatusManager::setIndexingInterrupted(bool interrupted)
@@ -116,6 +181,8 @@ void InterprocessIndexingStatusManager::setIndexingInterrupted(bool interrupted)
 	{
 		*indexingInterruptedPtr = interrupted;
 	}
+
+	access.notifyChange();
 }
 
 bool InterprocessIndexingStatusManager::getIndexingInterrupted()
@@ -131,6 +198,42 @@ bool InterprocessIndexingStatusManager::getIndexingInterrupted()
 	return false;
 }
 
+bool InterprocessIndexingStatusManager::waitForIndexingInterrupted(
+	size_t timeoutMilliseconds, const std::function<bool()>& stopWaiting)
+{
+	bool interrupted = false;
+	waitUntil(timeoutMilliseconds, [&](SharedMemory::ScopedAccess& access) {
+		bool* indexingInterruptedPtr = access.accessValue<bool>(s_indexingInterruptedKeyName);
+		interrupted = indexingInterruptedPtr && *indexingInterruptedPtr;
+		return interrupted || stopWaiting();
+	});
+	return interrupted;
+}
+
+void InterprocessIndexingStatusManager::addIndexerWaitTime(size_t milliseconds)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	size_t* indexerWaitTimePtr = access.accessValue<size_t>(s_indexerWaitTimeKeyName);
+	if (indexerWaitTimePtr)
+	{
+		*indexerWaitTimePtr += milliseconds;
+	}
+}
+
+size_t InterprocessIndexingStatusManager::getIndexerWaitTime()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	size_t* indexerWaitTimePtr = access.accessValue<size_t>(s_indexerWaitTimeKeyName);
+	if (indexerWaitTimePtr)
+	{
+		return *indexerWaitTimePtr;
+	}
+
+	return 0;
+}
+
 Id InterprocessIndexingStatusManager::getNextFinishedProcessId()
 {
 	SharedMemory::ScopedAccess access(&m_sharedMemory);
@@ -147,6 +250,15 @@ Id InterprocessIndexingStatusManager::getNextFinishedProcessId()
 	return 0;
 }
 
+bool InterprocessIndexingStatusManager::waitForFinishedProcessId(size_t timeoutMilliseconds)
+{
+	return waitUntil(timeoutMilliseconds, [](SharedMemory::ScopedAccess& access) {
+		SharedMemory::Queue<Id>* finishedProcessIdsPtr =
+			access.accessValueWithAllocator<SharedMemory::Queue<Id>>(s_finishedProcessIdsKeyName);
+		return finishedProcessIdsPtr && finishedProcessIdsPtr->size();
+	});
+}
+
 std::vector<FilePath> InterprocessIndexingStatusManager::getCurrentlyIndexedSourceFilePaths()
 {
 	SharedMemory::ScopedAccess access(&m_sharedMemory);
@@ -169,6 +281,26 @@ std::vector<FilePath> InterprocessIndexingStatusManager::getCurrentlyIndexedSour
 	return indexingFiles;
 }
 
+FilePath InterprocessIndexingStatusManager::getUnfinishedSourceFilePath()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Map<Id, SharedMemory::String>* currentFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Map<Id, SharedMemory::String>>(
+			s_currentFilesKeyName);
+	if (currentFilesPtr)
+	{
+		SharedMemory::Map<Id, SharedMemory::String>::iterator it = currentFilesPtr->find(
+			getProcessId());
+		if (it != currentFilesPtr->end())
+		{
+			return FilePath(utility::decodeFromUtf8(it->second.c_str()));
+		}
+	}
+
+	return FilePath();
+}
+
 std::vector<FilePath> InterprocessIndexingStatusManager::getCrashedSourceFilePaths()
 {
 	std::vector<FilePath> crashedFiles;
@@ -1,6 +1,8 @@
 #ifndef INTERPROCESS_INDEXING_STATUS_MANAGER_H
 #define INTERPROCESS_INDEXING_STATUS_MANAGER_H
 
+#include <functional>
+#include <map>
 #include <set>
 
 #include "BaseInterprocessDataManager.h"
@@ -15,12 +17,31 @@ public:
 	void startIndexingSourceFile(const FilePath& filePath);
 	void finishIndexingSourceFile();
 
+	void addIndexTime(const FilePath& filePath, size_t milliseconds);
+	std::map<FilePath, size_t> getIndexTimes();
+
 	void setIndexingInterrupted(bool interrupted);
 	bool getIndexingInterrupted();
 
+	// returns whether indexing got interrupted, stops waiting after the timeout or when stopWaiting
+	// returns true
+	bool waitForIndexingInterrupted(
+		size_t timeoutMilliseconds, const std::function<bool()>& stopWaiting);
+
+	// sums up the time indexer processes waited for their results to be fetched
+	void addIndexerWaitTime(size_t milliseconds);
+	size_t getIndexerWaitTime();
+
 	Id getNextFinishedProcessId();
 
+	// returns whether a finished process id is available before the timeout passed
+	bool waitForFinishedProcessId(size_t timeoutMilliseconds);
+
 	std::vector<FilePath> getCurrentlyIndexedSourceFilePaths();
+
+	// returns the file this process started indexing without finishing it, which is the file a
+	// crashed process of the same id crashed on
+	FilePath getUnfinishedSourceFilePath();
 	std::vector<FilePath> getCrashedSourceFilePaths();
 
 private:
@@ -31,6 +52,8 @@ private:
 	static const char* s_crashedFilesKeyName;
 	static const char* s_finishedProcessIdsKeyName;
 	static const char* s_indexingInterruptedKeyName;
+	static const char* s_indexTimesKeyName;
+	static const char* s_indexerWaitTimeKeyName;
 };
 
 #endif	  // INTERPROCESS_INDEXING_STATUS_MANAGER_H
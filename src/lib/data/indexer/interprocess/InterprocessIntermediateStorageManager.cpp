@@ -1,5 +1,6 @@
 #include "InterprocessIntermediateStorageManager.h"
 
+#include "FlatIntermediateStorage.h"
 #include "IntermediateStorage.h"
 #include "SharedIntermediateStorage.h"
 #include "logging.h"
@@ -26,10 +27,9 @@ void InterprocessIntermediateStorageManager::pushIntermediateStorage(
 {
 	const size_t requiredInsertsToShrink = 10;
 
-	const size_t overestimationMultiplier = 2;
-	const size_t requiredSize = (intermediateStorage->getByteSize(sizeof(SharedMemory::String)) +
-								 sizeof(SharedIntermediateStorage)) *
-			overestimationMultiplier +
+	// the storage is written as one contiguous block, so only little allocator overhead is expected
+	const size_t flatByteSize = FlatIntermediateStorage::getByteSize(*intermediateStorage);
+	const size_t requiredSize = flatByteSize + sizeof(SharedIntermediateStorage) +
 		1048576 /* 1 MB */;
 
 	SharedMemory::ScopedAccess access(&m_sharedMemory);
@@ -63,19 +63,7 @@ void InterprocessIntermediateStorageManager::pushIntermediateStorage(
 	}
 
 	queue->push_back(SharedIntermediateStorage(access.getAllocator()));
-	SharedIntermediateStorage& storage = queue->back();
-
-	storage.setStorageNodes(intermediateStorage->getStorageNodes());
-	storage.setStorageFiles(intermediateStorage->getStorageFiles());
-	storage.setStorageSymbols(intermediateStorage->getStorageSymbols());
-	storage.setStorageEdges(intermediateStorage->getStorageEdges());
-	storage.setStorageLocalSymbols(intermediateStorage->getStorageLocalSymbols());
-	storage.setStorageSourceLocations(intermediateStorage->getStorageSourceLocations());
-	storage.setStorageOccurrences(intermediateStorage->getStorageOccurrences());
-	storage.setStorageComponentAccesses(intermediateStorage->getComponentAccesses());
-	storage.setStorageErrors(intermediateStorage->getErrors());
-
-	storage.setNextId(intermediateStorage->getNextId());
+	queue->back().setIntermediateStorage(*intermediateStorage, flatByteSize);
 
 	if (m_insertsWithoutGrowth >= requiredInsertsToShrink)
 	{
@@ -93,36 +81,28 @@ void InterprocessIntermediateStorageManager::pushIntermediateStorage(
 
 std::shared_ptr<IntermediateStorage> InterprocessIntermediateStorageManager::popIntermediateStorage()
 {
-	SharedMemory::ScopedAccess access(&m_sharedMemory);
-
-	SharedMemory::Queue<SharedIntermediateStorage>* queue =
-		access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(
-			s_intermediateStoragesKeyName);
-	if (!queue || !queue->size())
+	std::vector<char> data;
 	{
-		return nullptr;
-	}
+		SharedMemory::ScopedAccess access(&m_sharedMemory);
 
-	SharedIntermediateStorage& sharedIntermediateStorage = queue->front();
+		SharedMemory::Queue<SharedIntermediateStorage>* queue =
+			access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(
+				s_intermediateStoragesKeyName);
+		if (!queue || !queue->size())
+		{
+			return nullptr;
+		}
 
-	std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
+		data = queue->front().getData();
 
-	storage->setStorageNodes(sharedIntermediateStorage.getStorageNodes());
-	storage->setStorageFiles(sharedIntermediateStorage.getStorageFiles());
-	storage->setStorageSymbols(sharedIntermediateStorage.getStorageSymbols());
-	storage->setStorageEdges(sharedIntermediateStorage.getStorageEdges());
-	storage->setStorageLocalSymbols(sharedIntermediateStorage.getStorageLocalSymbols());
-	storage->setStorageSourceLocations(sharedIntermediateStorage.getStorageSourceLocations());
-	storage->setStorageOccurrences(sharedIntermediateStorage.getStorageOccurrences());
-	storage->setComponentAccesses(sharedIntermediateStorage.getStorageComponentAccesses());
-	storage->setErrors(sharedIntermediateStorage.getStorageErrors());
-
-	storage->setNextId(sharedIntermediateStorage.getNextId());
-
-	queue->pop_front();
-	LOG_INFO(access.logString());
+		queue->pop_front();
+		access.notifyChange();
+		LOG_INFO(access.logString());
+	}
 
-	return storage;
+	// rebuilding the storage happens after releasing the shared memory, so the indexer process
+	// can already push its next storage
+	return FlatIntermediateStorage(data.data(), data.size()).createIntermediateStorage();
 }
 
 size_t InterprocessIntermediateStorageManager::getIntermediateStorageCount()
@@ -139,3 +119,14 @@ size_t InterprocessIntermediateStorageManager::getIntermediateStorageCount()
 
 	return queue->size();
 }
+
+bool InterprocessIntermediateStorageManager::waitForIntermediateStorageCountBelow(
+	size_t count, size_t timeoutMilliseconds)
+{
+	return waitUntil(timeoutMilliseconds, [count](SharedMemory::ScopedAccess& access) {
+		SharedMemory::Queue<SharedIntermediateStorage>* queue =
+			access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(
+				s_intermediateStoragesKeyName);
+		return !queue || queue->size() < count;
+	});
+}
@@ -16,6 +16,9 @@ public:
 
 	size_t getIntermediateStorageCount();
 
+	// returns whether the queue holds less than the given count before the timeout passed
+	bool waitForIntermediateStorageCountBelow(size_t count, size_t timeoutMilliseconds);
+
 private:
 	static const char* s_sharedMemoryNamePrefix;
 	static const char* s_intermediateStoragesKeyName;
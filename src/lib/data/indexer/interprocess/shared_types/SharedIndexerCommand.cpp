@@ -6,6 +6,54 @@
 #include "logging.h"
 #include "utilityString.h"
 
+namespace
+{
+// control characters don't occur in paths and flags, so replacing the placeholders again restores
+// the original strings
+const std::wstring s_sourceFilePathPlaceholder = L"\x01";
+const std::wstring s_sourceFileNamePlaceholder = L"\x02";
+
+std::wstring replaceSourceFile(const std::wstring& str, const FilePath& sourceFilePath)
+{
+	return utility::replace(
+		utility::replace(str, sourceFilePath.wstr(), s_sourceFilePathPlaceholder),
+		sourceFilePath.fileName(),
+		s_sourceFileNamePlaceholder);
+}
+
+std::wstring insertSourceFile(const std::wstring& str, const FilePath& sourceFilePath)
+{
+	return utility::replace(
+		utility::replace(str, s_sourceFileNamePlaceholder, sourceFilePath.fileName()),
+		s_sourceFilePathPlaceholder,
+		sourceFilePath.wstr());
+}
+
+template <typename Transform>
+std::set<FilePath> transformPaths(const std::set<FilePath>& paths, Transform transform)
+{
+	std::set<FilePath> result;
+	for (const FilePath& path: paths)
+	{
+		result.insert(FilePath(transform(path.wstr())));
+	}
+	return result;
+}
+
+template <typename Transform>
+std::vector<std::wstring> transformFlags(
+	const std::vector<std::wstring>& flags, Transform transform)
+{
+	std::vector<std::wstring> result;
+	result.reserve(flags.size());
+	for (const std::wstring& flag: flags)
+	{
+		result.push_back(transform(flag));
+	}
+	return result;
+}
+}	 // namespace
+
 void SharedIndexerCommand::fromLocal(IndexerCommand* indexerCommand)
 {
 	setSourceFilePath(indexerCommand->getSourceFilePath());
@@ -81,6 +129,112 @@ std::shared_ptr<IndexerCommand> SharedIndexerCommand::fromShared(const SharedInd
 	return nullptr;
 }
 
+std::shared_ptr<IndexerCommand> SharedIndexerCommand::createSettings(
+	const IndexerCommand* indexerCommand)
+{
+#if BUILD_CXX_LANGUAGE_PACKAGE
+	if (const IndexerCommandCxx* cmd = dynamic_cast<const IndexerCommandCxx*>(indexerCommand))
+	{
+		// source groups add the source file to the flags and to the indexed paths, build systems
+		// also name it in their output files
+		const FilePath& sourceFilePath = cmd->getSourceFilePath();
+		auto replace = [&sourceFilePath](const std::wstring& str) {
+			return replaceSourceFile(str, sourceFilePath);
+		};
+
+		return std::make_shared<IndexerCommandCxx>(
+			FilePath(),
+			transformPaths(cmd->getIndexedPaths(), replace),
+			cmd->getExcludeFilters(),
+			cmd->getIncludeFilters(),
+			cmd->getWorkingDirectory(),
+			transformFlags(cmd->getCompilerFlags(), replace));
+	}
+#endif	  // BUILD_CXX_LANGUAGE_PACKAGE
+#if BUILD_JAVA_LANGUAGE_PACKAGE
+	if (const IndexerCommandJava* cmd = dynamic_cast<const IndexerCommandJava*>(indexerCommand))
+	{
+		return std::make_shared<IndexerCommandJava>(
+			FilePath(), cmd->getLanguageStandard(), cmd->getClassPath());
+	}
+#endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
+
+	return nullptr;
+}
+
+std::string SharedIndexerCommand::getSettingsKey(IndexerCommand* settings)
+{
+	std::string key;
+
+#if BUILD_CXX_LANGUAGE_PACKAGE
+	if (IndexerCommandCxx* cmd = dynamic_cast<IndexerCommandCxx*>(settings))
+	{
+		key += "cxx\n";
+		for (const FilePath& indexedPath: cmd->getIndexedPaths())
+		{
+			key += "p" + utility::encodeToUtf8(indexedPath.wstr()) + "\n";
+		}
+		for (const FilePathFilter& excludeFilter: cmd->getExcludeFilters())
+		{
+			key += "e" + utility::encodeToUtf8(excludeFilter.wstr()) + "\n";
+		}
+		for (const FilePathFilter& includeFilter: cmd->getIncludeFilters())
+		{
+			key += "i" + utility::encodeToUtf8(includeFilter.wstr()) + "\n";
+		}
+		key += "w" + utility::encodeToUtf8(cmd->getWorkingDirectory().wstr()) + "\n";
+		for (const std::wstring& compilerFlag: cmd->getCompilerFlags())
+		{
+			key += "f" + utility::encodeToUtf8(compilerFlag) + "\n";
+		}
+		return key;
+	}
+#endif	  // BUILD_CXX_LANGUAGE_PACKAGE
+#if BUILD_JAVA_LANGUAGE_PACKAGE
+	if (IndexerCommandJava* cmd = dynamic_cast<IndexerCommandJava*>(settings))
+	{
+		key += "java\n";
+		key += "s" + utility::encodeToUtf8(cmd->getLanguageStandard()) + "\n";
+		for (const FilePath& classPath: cmd->getClassPath())
+		{
+			key += "c" + utility::encodeToUtf8(classPath.wstr()) + "\n";
+		}
+		return key;
+	}
+#endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
+
+	return key;
+}
+
+std::shared_ptr<IndexerCommand> SharedIndexerCommand::createForSourceFilePath(
+	const IndexerCommand* settings, const FilePath& sourceFilePath)
+{
+#if BUILD_CXX_LANGUAGE_PACKAGE
+	if (const IndexerCommandCxx* cmd = dynamic_cast<const IndexerCommandCxx*>(settings))
+	{
+		auto insert = [&sourceFilePath](const std::wstring& str) {
+			return insertSourceFile(str, sourceFilePath);
+		};
+
+		return std::make_shared<IndexerCommandCxx>(
+			sourceFilePath,
+			transformPaths(cmd->getIndexedPaths(), insert),
+			cmd->getExcludeFilters(),
+			cmd->getIncludeFilters(),
+			cmd->getWorkingDirectory(),
+			transformFlags(cmd->getCompilerFlags(), insert));
+	}
+#endif	  // BUILD_CXX_LANGUAGE_PACKAGE
+#if BUILD_JAVA_LANGUAGE_PACKAGE
+	if (const IndexerCommandJava* cmd = dynamic_cast<const IndexerCommandJava*>(settings))
+	{
+		return std::make_shared<IndexerCommandJava>(
+			sourceFilePath, cmd->getLanguageStandard(), cmd->getClassPath());
+	}
+#endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
+
+	return nullptr;
+}
 
 SharedIndexerCommand::SharedIndexerCommand(SharedMemory::Allocator* allocator)
 	: m_type(Type::UNKNOWN)
@@ -17,6 +17,16 @@ public:
 	void fromLocal(IndexerCommand* indexerCommand);
 	static std::shared_ptr<IndexerCommand> fromShared(const SharedIndexerCommand& indexerCommand);
 
+	// copies the command without its source file, the source file path and name in the paths and
+	// flags are replaced by placeholders, so commands that only differ in their source file have
+	// equal settings
+	static std::shared_ptr<IndexerCommand> createSettings(const IndexerCommand* indexerCommand);
+	static std::string getSettingsKey(IndexerCommand* settings);
+
+	// copies the settings for the given source file and puts it back in place of the placeholders
+	static std::shared_ptr<IndexerCommand> createForSourceFilePath(
+		const IndexerCommand* settings, const FilePath& sourceFilePath);
+
 	SharedIndexerCommand(SharedMemory::Allocator* allocator);
 	~SharedIndexerCommand();
 
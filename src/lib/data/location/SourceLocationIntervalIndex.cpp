@@ -0,0 +1,117 @@
+#include "SourceLocationIntervalIndex.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+void SourceLocationIntervalIndex::addSourceLocation(const StorageSourceLocation& location)
+{
+	m_locations.push_back({location, {}});
+}
+
+void SourceLocationIntervalIndex::addOccurrence(const StorageOccurrence& occurrence)
+{
+	m_buildOccurrences.push_back(occurrence);
+}
+
+void SourceLocationIntervalIndex::finishSetup()
+{
+	std::stable_sort(
+		m_locations.begin(), m_locations.end(), [](const Location& a, const Location& b) {
+			return a.location.startLine < b.location.startLine;
+		});
+
+	std::unordered_map<Id, size_t> locationIndices;
+	locationIndices.reserve(m_locations.size());
+	for (size_t i = 0; i < m_locations.size(); i++)
+	{
+		locationIndices.emplace(m_locations[i].location.id, i);
+	}
+
+	for (const StorageOccurrence& occurrence: m_buildOccurrences)
+	{
+		auto it = locationIndices.find(occurrence.sourceLocationId);
+		if (it != locationIndices.end())
+		{
+			m_locations[it->second].elementIds.push_back(occurrence.elementId);
+		}
+	}
+	m_buildOccurrences.clear();
+	m_buildOccurrences.shrink_to_fit();
+
+	m_maxEndLines.assign(m_locations.size(), 0);
+	buildMaxEndLines(0, m_locations.size());
+}
+
+size_t SourceLocationIntervalIndex::getLocationCount() const
+{
+	return m_locations.size();
+}
+
+std::vector<const SourceLocationIntervalIndex::Location*> SourceLocationIntervalIndex::
+	getLocationsInLines(size_t startLine, size_t endLine) const
+{
+	std::vector<const Location*> locations;
+	if (startLine <= endLine)
+	{
+		collectLocationsInLines(0, m_locations.size(), startLine, endLine, &locations);
+	}
+	return locations;
+}
+
+void SourceLocationIntervalIndex::buildMaxEndLines(size_t begin, size_t end)
+{
+	if (begin >= end)
+	{
+		return;
+	}
+
+	const size_t middle = begin + (end - begin) / 2;
+	buildMaxEndLines(begin, middle);
+	buildMaxEndLines(middle + 1, end);
+
+	size_t maxEndLine = m_locations[middle].location.endLine;
+	if (begin < middle)
+	{
+		maxEndLine = std::max(maxEndLine, m_maxEndLines[begin + (middle - begin) / 2]);
+	}
+	if (middle + 1 < end)
+	{
+		maxEndLine = std::max(maxEndLine, m_maxEndLines[middle + 1 + (end - middle - 1) / 2]);
+	}
+	m_maxEndLines[middle] = maxEndLine;
+}
+
+void SourceLocationIntervalIndex::collectLocationsInLines(
+	size_t begin,
+	size_t end,
+	size_t startLine,
+	size_t endLine,
+	std::vector<const Location*>* locations) const
+{
+	if (begin >= end)
+	{
+		return;
+	}
+
+	const size_t middle = begin + (end - begin) / 2;
+	if (m_maxEndLines[middle] < startLine)
+	{
+		return;
+	}
+
+	collectLocationsInLines(begin, middle, startLine, endLine, locations);
+
+	// all locations right of the middle start at or after it
+	const StorageSourceLocation& location = m_locations[middle].location;
+	if (location.startLine > endLine)
+	{
+		return;
+	}
+
+	if (location.endLine >= startLine)
+	{
+		locations->push_back(&m_locations[middle]);
+	}
+
+	collectLocationsInLines(middle + 1, end, startLine, endLine, locations);
+}
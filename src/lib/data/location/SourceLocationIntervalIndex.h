@@ -0,0 +1,51 @@
+#ifndef SOURCE_LOCATION_INTERVAL_INDEX_H
+#define SOURCE_LOCATION_INTERVAL_INDEX_H
+
+#include <vector>
+
+#include "StorageOccurrence.h"
+#include "StorageSourceLocation.h"
+#include "types.h"
+
+// source locations of one file with the ids of their elements, so the locations overlapping a range
+// of lines are found in logarithmic time. locations are sorted by start line and form an implicit
+// interval tree: the middle location of each range is the root of the range and knows the largest
+// end line within it.
+class SourceLocationIntervalIndex
+{
+public:
+	struct Location
+	{
+		StorageSourceLocation location;
+		std::vector<Id> elementIds;
+	};
+
+	void addSourceLocation(const StorageSourceLocation& location);
+	void addOccurrence(const StorageOccurrence& occurrence);
+
+	// makes all added locations queryable, occurrences of unknown locations are dropped
+	void finishSetup();
+
+	size_t getLocationCount() const;
+
+	// locations that start before the end line and end after the start line, ordered by start line
+	std::vector<const Location*> getLocationsInLines(size_t startLine, size_t endLine) const;
+
+private:
+	void buildMaxEndLines(size_t begin, size_t end);
+	void collectLocationsInLines(
+		size_t begin,
+		size_t end,
+		size_t startLine,
+		size_t endLine,
+		std::vector<const Location*>* locations) const;
+
+	std::vector<Location> m_locations;
+
+	// largest end line of the range the location at the same index is the root of
+	std::vector<size_t> m_maxEndLines;
+
+	std::vector<StorageOccurrence> m_buildOccurrences;
+};
+
+#endif	  // SOURCE_LOCATION_INTERVAL_INDEX_H
@@ -5,13 +5,10 @@
 #include "logging.h"
 #include "utilityString.h"
 
-namespace
-{
-const std::wstring META_DELIMITER = L"\tm";
-const std::wstring NAME_DELIMITER = L"\tn";
-const std::wstring PART_DELIMITER = L"\ts";
-const std::wstring SIGNATURE_DELIMITER = L"\tp";
-}	 // namespace
+const std::wstring NameHierarchy::s_metaDelimiter = L"\tm";
+const std::wstring NameHierarchy::s_nameDelimiter = L"\tn";
+const std::wstring NameHierarchy::s_partDelimiter = L"\ts";
+const std::wstring NameHierarchy::s_signatureDelimiter = L"\tp";
 
 std::wstring NameHierarchy::serialize(const NameHierarchy& nameHierarchy)
 {
@@ -22,17 +19,17 @@ std::wstring NameHierarchy::serializeRange(const NameHierarchy& nameHierarchy, s
 {
 	std::wstringstream ss;
 	ss << nameHierarchy.getDelimiter();
-	ss << META_DELIMITER;
+	ss << s_metaDelimiter;
 	for (size_t i = first; i < last && i < nameHierarchy.size(); i++)
 	{
 		if (i > 0)
 		{
-			ss << NAME_DELIMITER;
+			ss << s_nameDelimiter;
 		}
 
-		ss << nameHierarchy[i].getName() << PART_DELIMITER;
+		ss << nameHierarchy[i].getName() << s_partDelimiter;
 		ss << nameHierarchy[i].getSignature().getPrefix();
-		ss << SIGNATURE_DELIMITER;
+		ss << s_signatureDelimiter;
 		ss << nameHierarchy[i].getSignature().getPostfix();
 	}
 	return ss.str();
@@ -40,7 +37,7 @@ std::wstring NameHierarchy::serializeRange(const NameHierarchy& nameHierarchy, s
 
 NameHierarchy NameHierarchy::deserialize(const std::wstring& serializedName)
 {
-	size_t mpos = serializedName.find(META_DELIMITER);
+	size_t mpos = serializedName.find(s_metaDelimiter);
 	if (mpos == std::wstring::npos)
 	{
 		LOG_ERROR(L"unable to deserialize name hierarchy: " + serializedName);	  // todo: obfuscate
@@ -50,11 +47,11 @@ NameHierarchy NameHierarchy::deserialize(const std::wstring& serializedName)
 
 	NameHierarchy nameHierarchy(serializedName.substr(0, mpos));
 
-	size_t npos = mpos + META_DELIMITER.size();
+	size_t npos = mpos + s_metaDelimiter.size();
 	while (npos != std::wstring::npos && npos < serializedName.size())
 	{
 		// name
-		size_t spos = serializedName.find(PART_DELIMITER, npos);
+		size_t spos = serializedName.find(s_partDelimiter, npos);
 		if (spos == std::wstring::npos)
 		{
 			LOG_ERROR(
@@ -64,10 +61,10 @@ NameHierarchy NameHierarchy::deserialize(const std::wstring& serializedName)
 		}
 
 		std::wstring name = serializedName.substr(npos, spos - npos);
-		spos += PART_DELIMITER.size();
+		spos += s_partDelimiter.size();
 
 		// signature
-		size_t ppos = serializedName.find(SIGNATURE_DELIMITER, spos);
+		size_t ppos = serializedName.find(s_signatureDelimiter, spos);
 		if (ppos == std::wstring::npos)
 		{
 			LOG_ERROR(
@@ -77,10 +74,10 @@ NameHierarchy NameHierarchy::deserialize(const std::wstring& serializedName)
 		}
 
 		std::wstring prefix = serializedName.substr(spos, ppos - spos);
-		ppos += SIGNATURE_DELIMITER.size();
+		ppos += s_signatureDelimiter.size();
 
 		std::wstring postfix;
-		npos = serializedName.find(NAME_DELIMITER, ppos);
+		npos = serializedName.find(s_nameDelimiter, ppos);
 		if (npos == std::wstring::npos)
 		{
 			postfix = serializedName.substr(ppos, std::wstring::npos);
@@ -88,23 +85,27 @@ NameHierarchy NameHierarchy::deserialize(const std::wstring& serializedName)
 		else
 		{
 			postfix = serializedName.substr(ppos, npos - ppos);
-			npos += NAME_DELIMITER.size();
+			npos += s_nameDelimiter.size();
 		}
 
 		nameHierarchy.push(NameElement(std::move(name), std::move(prefix), std::move(postfix)));
 	}
 
+	fixDeserializedName(&nameHierarchy);
+	return nameHierarchy;
+}
+
+void NameHierarchy::fixDeserializedName(NameHierarchy* nameHierarchy)
+{
 	// TODO: replace duplicate main definition fix with better solution
-	if (nameHierarchy.size() == 1 && nameHierarchy.back().hasSignature() &&
-		!nameHierarchy.back().getName().empty() && nameHierarchy.back().getName()[0] == '.' &&
-		utility::isPrefix<std::wstring>(L".:main:.", nameHierarchy.back().getName()))
+	if (nameHierarchy->size() == 1 && nameHierarchy->back().hasSignature() &&
+		!nameHierarchy->back().getName().empty() && nameHierarchy->back().getName()[0] == '.' &&
+		utility::isPrefix<std::wstring>(L".:main:.", nameHierarchy->back().getName()))
 	{
-		NameElement::Signature sig = nameHierarchy.back().getSignature();
-		nameHierarchy.pop();
-		nameHierarchy.push(NameElement(L"main", sig.getPrefix(), sig.getPostfix()));
+		NameElement::Signature sig = nameHierarchy->back().getSignature();
+		nameHierarchy->pop();
+		nameHierarchy->push(NameElement(L"main", sig.getPrefix(), sig.getPostfix()));
 	}
-
-	return nameHierarchy;
 }
 
 const std::wstring& NameHierarchy::getDelimiter() const
@@ -10,9 +10,17 @@
 class NameHierarchy
 {
 public:
+	// delimiters of the serialized format
+	static const std::wstring s_metaDelimiter;
+	static const std::wstring s_nameDelimiter;
+	static const std::wstring s_partDelimiter;
+	static const std::wstring s_signatureDelimiter;
+
 	static std::wstring serialize(const NameHierarchy& nameHierarchy);
 	static std::wstring serializeRange(const NameHierarchy& nameHierarchy, size_t first, size_t last);
 	static NameHierarchy deserialize(const std::wstring& serializedName);
+	// names rebuilt from their serialized parts get the same fixes as deserialized ones
+	static void fixDeserializedName(NameHierarchy* nameHierarchy);
 
 	NameHierarchy(std::wstring delimiter);
 	NameHierarchy(std::wstring name, std::wstring delimiter);
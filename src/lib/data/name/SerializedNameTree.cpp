@@ -0,0 +1,271 @@
+#include "SerializedNameTree.h"
+
+#include <algorithm>
+
+#include "NameHierarchy.h"
+
+bool SerializedNameTree::Name::operator==(const Name& other) const
+{
+	return parentId == other.parentId && elementId == other.elementId &&
+		signatureId == other.signatureId;
+}
+
+uint32_t SerializedNameTree::addSerializedName(const std::wstring& serializedName)
+{
+	std::vector<std::wstring_view> parts;
+	if (!splitSerializedName(serializedName, &parts))
+	{
+		return 0;
+	}
+
+	uint32_t nameId = internName({0, internPart(parts[0]), 0});
+	for (size_t i = 1; i + 1 < parts.size(); i += 2)
+	{
+		nameId = internName({nameId, internPart(parts[i]), internPart(parts[i + 1])});
+	}
+	return nameId;
+}
+
+uint32_t SerializedNameTree::findSerializedName(const std::wstring& serializedName) const
+{
+	std::vector<std::wstring_view> parts;
+	if (!splitSerializedName(serializedName, &parts))
+	{
+		return 0;
+	}
+
+	uint32_t nameId = findName({0, findPart(parts[0]), 0});
+	for (size_t i = 1; i + 1 < parts.size() && nameId; i += 2)
+	{
+		nameId = findName({nameId, findPart(parts[i]), findPart(parts[i + 1])});
+	}
+	return nameId;
+}
+
+std::wstring SerializedNameTree::getSerializedName(uint32_t nameId) const
+{
+	std::vector<const Name*> names;
+	if (!getNameChain(nameId, &names))
+	{
+		return L"";
+	}
+
+	std::wstring serializedName = getPart(names.back()->elementId);
+	serializedName += NameHierarchy::s_metaDelimiter;
+	for (size_t i = names.size() - 1; i > 0; i--)
+	{
+		if (i + 1 < names.size())
+		{
+			serializedName += NameHierarchy::s_nameDelimiter;
+		}
+
+		const Name* name = names[i - 1];
+		serializedName += getPart(name->elementId);
+		serializedName += NameHierarchy::s_partDelimiter;
+		serializedName += getPart(name->signatureId);
+	}
+	return serializedName;
+}
+
+NameHierarchy SerializedNameTree::getNameHierarchy(uint32_t nameId) const
+{
+	std::vector<const Name*> names;
+	if (!getNameChain(nameId, &names))
+	{
+		return NameHierarchy(NAME_DELIMITER_UNKNOWN);
+	}
+
+	NameHierarchy nameHierarchy(getPart(names.back()->elementId));
+	for (size_t i = names.size() - 1; i > 0; i--)
+	{
+		const Name* name = names[i - 1];
+		const std::wstring& signature = getPart(name->signatureId);
+		const size_t pos = signature.find(NameHierarchy::s_signatureDelimiter);
+		if (pos == std::wstring::npos)
+		{
+			return NameHierarchy(NAME_DELIMITER_UNKNOWN);
+		}
+
+		nameHierarchy.push(NameElement(
+			getPart(name->elementId),
+			signature.substr(0, pos),
+			signature.substr(pos + NameHierarchy::s_signatureDelimiter.size())));
+	}
+
+	NameHierarchy::fixDeserializedName(&nameHierarchy);
+	return nameHierarchy;
+}
+
+void SerializedNameTree::loadPart(uint32_t partId, std::wstring text)
+{
+	if (partId >= m_parts.size())
+	{
+		m_parts.resize(partId + 1);
+	}
+
+	m_parts[partId] = std::move(text);
+	m_partIds.emplace(m_parts[partId], partId);
+}
+
+void SerializedNameTree::loadName(uint32_t nameId, const Name& name)
+{
+	if (nameId >= m_names.size())
+	{
+		m_names.resize(nameId + 1, {0, 0, 0});
+	}
+
+	m_names[nameId] = name;
+	m_nameIds.emplace(name, nameId);
+	m_nameCount++;
+}
+
+const std::wstring& SerializedNameTree::getPart(uint32_t partId) const
+{
+	static const std::wstring s_emptyPart;
+	return partId < m_parts.size() ? m_parts[partId] : s_emptyPart;
+}
+
+const SerializedNameTree::Name& SerializedNameTree::getName(uint32_t nameId) const
+{
+	static const Name s_emptyName = {0, 0, 0};
+	return nameId < m_names.size() ? m_names[nameId] : s_emptyName;
+}
+
+size_t SerializedNameTree::getNameCount() const
+{
+	return m_nameCount;
+}
+
+std::vector<uint32_t> SerializedNameTree::takeAddedPartIds()
+{
+	std::vector<uint32_t> partIds;
+	partIds.swap(m_addedPartIds);
+	return partIds;
+}
+
+std::vector<uint32_t> SerializedNameTree::takeAddedNameIds()
+{
+	std::vector<uint32_t> nameIds;
+	nameIds.swap(m_addedNameIds);
+	return nameIds;
+}
+
+void SerializedNameTree::clear()
+{
+	m_partIds.clear();
+	m_parts.clear();
+	m_nameIds.clear();
+	m_names.clear();
+	m_nameCount = 0;
+	m_addedPartIds.clear();
+	m_addedNameIds.clear();
+}
+
+size_t SerializedNameTree::NameHash::operator()(const Name& name) const
+{
+	size_t hash = name.parentId;
+	hash = hash * 1000003 ^ name.elementId;
+	hash = hash * 1000003 ^ name.signatureId;
+	return hash;
+}
+
+bool SerializedNameTree::getNameChain(uint32_t nameId, std::vector<const Name*>* names) const
+{
+	// the number of names limits the walk, in case loaded parents form a cycle
+	while (nameId != 0 && nameId < m_names.size() && names->size() < m_names.size())
+	{
+		names->push_back(&m_names[nameId]);
+		nameId = names->back()->parentId;
+	}
+
+	return !names->empty() && nameId == 0 && names->back()->elementId != 0;
+}
+
+bool SerializedNameTree::splitSerializedName(
+	const std::wstring& serializedName, std::vector<std::wstring_view>* parts)
+{
+	const std::wstring_view name(serializedName);
+
+	const size_t metaPos = name.find(NameHierarchy::s_metaDelimiter);
+	if (metaPos == std::wstring_view::npos)
+	{
+		return false;
+	}
+	parts->push_back(name.substr(0, metaPos));
+
+	// the elements are joined again with the same delimiters, so every string passing this is
+	// rebuilt exactly
+	size_t pos = metaPos + NameHierarchy::s_metaDelimiter.size();
+	while (pos < name.size())
+	{
+		size_t endPos = name.find(NameHierarchy::s_nameDelimiter, pos);
+		if (endPos == std::wstring_view::npos)
+		{
+			endPos = name.size();
+		}
+
+		const std::wstring_view element = name.substr(pos, endPos - pos);
+		const size_t partPos = element.find(NameHierarchy::s_partDelimiter);
+		if (partPos == std::wstring_view::npos)
+		{
+			return false;
+		}
+
+		parts->push_back(element.substr(0, partPos));
+		parts->push_back(element.substr(partPos + NameHierarchy::s_partDelimiter.size()));
+
+		if (endPos == name.size())
+		{
+			break;
+		}
+
+		pos = endPos + NameHierarchy::s_nameDelimiter.size();
+		if (pos == name.size())
+		{
+			// a trailing delimiter has no element to be rebuilt from
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint32_t SerializedNameTree::internPart(std::wstring_view text)
+{
+	const uint32_t partId = findPart(text);
+	if (partId)
+	{
+		return partId;
+	}
+
+	const uint32_t newPartId = static_cast<uint32_t>(std::max<size_t>(m_parts.size(), 1));
+	loadPart(newPartId, std::wstring(text));
+	m_addedPartIds.push_back(newPartId);
+	return newPartId;
+}
+
+uint32_t SerializedNameTree::internName(const Name& name)
+{
+	const uint32_t nameId = findName(name);
+	if (nameId)
+	{
+		return nameId;
+	}
+
+	const uint32_t newNameId = static_cast<uint32_t>(std::max<size_t>(m_names.size(), 1));
+	loadName(newNameId, name);
+	m_addedNameIds.push_back(newNameId);
+	return newNameId;
+}
+
+uint32_t SerializedNameTree::findPart(std::wstring_view text) const
+{
+	auto it = m_partIds.find(text);
+	return it != m_partIds.end() ? it->second : 0;
+}
+
+uint32_t SerializedNameTree::findName(const Name& name) const
+{
+	auto it = m_nameIds.find(name);
+	return it != m_nameIds.end() ? it->second : 0;
+}
@@ -0,0 +1,86 @@
+#ifndef SERIALIZED_NAME_TREE_H
+#define SERIALIZED_NAME_TREE_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "NameHierarchy.h"
+
+// serialized name hierarchies stored as a tree of interned parts. every name refers to the name of
+// its parent and to the interned name and signature of its last element, the roots are the
+// delimiters. names with a common prefix share the names of the prefix, so each element is stored
+// once and a name is rebuilt by walking up its parents.
+class SerializedNameTree
+{
+public:
+	struct Name
+	{
+		bool operator==(const Name& other) const;
+
+		uint32_t parentId;
+		uint32_t elementId;
+		// 0 for roots
+		uint32_t signatureId;
+	};
+
+	// returns 0 for strings that are not serialized name hierarchies
+	uint32_t addSerializedName(const std::wstring& serializedName);
+	uint32_t findSerializedName(const std::wstring& serializedName) const;
+
+	// returns an empty string for unknown ids
+	std::wstring getSerializedName(uint32_t nameId) const;
+	// same as deserializing the serialized name, without building it first
+	NameHierarchy getNameHierarchy(uint32_t nameId) const;
+
+	// stored parts and names are loaded with their ids
+	void loadPart(uint32_t partId, std::wstring text);
+	void loadName(uint32_t nameId, const Name& name);
+
+	const std::wstring& getPart(uint32_t partId) const;
+	const Name& getName(uint32_t nameId) const;
+
+	size_t getNameCount() const;
+
+	// ids of the parts and names added since the last call, so they can be stored
+	std::vector<uint32_t> takeAddedPartIds();
+	std::vector<uint32_t> takeAddedNameIds();
+
+	void clear();
+
+private:
+	struct NameHash
+	{
+		size_t operator()(const Name& name) const;
+	};
+
+	// the names from the given one up to its root, returns false for unknown ids
+	bool getNameChain(uint32_t nameId, std::vector<const Name*>* names) const;
+
+	// splits into the delimiter followed by name and signature of each element, returns false for
+	// strings that are not serialized name hierarchies
+	static bool splitSerializedName(
+		const std::wstring& serializedName, std::vector<std::wstring_view>* parts);
+
+	uint32_t internPart(std::wstring_view text);
+	uint32_t internName(const Name& name);
+	uint32_t findPart(std::wstring_view text) const;
+	uint32_t findName(const Name& name) const;
+
+	// indexed by id, the deque keeps the texts in place for the views of the lookup map
+	std::deque<std::wstring> m_parts;
+	std::unordered_map<std::wstring_view, uint32_t> m_partIds;
+
+	// indexed by id
+	std::vector<Name> m_names;
+	std::unordered_map<Name, uint32_t, NameHash> m_nameIds;
+	size_t m_nameCount = 0;
+
+	std::vector<uint32_t> m_addedPartIds;
+	std::vector<uint32_t> m_addedNameIds;
+};
+
+#endif	  // SERIALIZED_NAME_TREE_H
@@ -24,7 +24,7 @@ void TaskParseWrapper::doEnter(std::shared_ptr<Blackboard> blackboard)
 	{
 		if (std::shared_ptr<PersistentStorage> storage = m_storage.lock())
 		{
-			storage->setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+			storage->setMode(SqliteIndexStorage::STORAGE_MODE_BULK_LOAD);
 		}
 	}
 }
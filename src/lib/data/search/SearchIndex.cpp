@@ -2,11 +2,31 @@
 
 #include <algorithm>
 #include <ctype.h>
+#include <fstream>
 #include <iterator>
 
+#include "FilePath.h"
+#include "MappedFile.h"
+#include "logging.h"
 #include "utility.h"
 #include "utilityString.h"
 
+namespace
+{
+const char s_indexFileMagic[8] = {'S', 'R', 'C', 'T', 'R', 'L', 'S', 'I'};
+const uint32_t s_indexFileVersion = 3;
+
+struct IndexFileHeader
+{
+	uint32_t charSize;
+	uint32_t nodeSize;
+	uint32_t elementSize;
+	uint32_t textLength;
+	uint32_t nodeCount;
+	uint32_t elementCount;
+};
+}	 // namespace
+
 SearchIndex::SearchIndex()
 {
 	clear();
@@ -14,83 +34,343 @@ SearchIndex::SearchIndex()
 
 SearchIndex::~SearchIndex() {}
 
-void SearchIndex::addNode(Id id, std::wstring name, NodeType type)
+void SearchIndex::addNode(Id id, std::wstring name, NodeType type, uint64_t tag)
 {
-	SearchNode* currentNode = m_root;
+	prepareChanges();
+
+	uint32_t currentNode = 0;
+	size_t pos = 0;
 
-	while (name.size() > 0)
+	while (pos < name.size())
 	{
-		currentNode->containedTypes.add(type);
+		std::vector<uint32_t>& children = m_buildNodes[currentNode].children;
+		auto it = std::lower_bound(
+			children.begin(), children.end(), name[pos], [this](uint32_t child, wchar_t c) {
+				return m_text[m_buildNodes[child].labelOffset] < c;
+			});
 
-		auto it = currentNode->edges.find(name[0]);
-		if (it != currentNode->edges.end())
+		if (it != children.end() && m_text[m_buildNodes[*it].labelOffset] == name[pos])
 		{
-			SearchEdge* currentEdge = it->second;
-			const std::wstring& edgeString = currentEdge->s;
+			const uint32_t child = *it;
+			const uint32_t labelOffset = m_buildNodes[child].labelOffset;
+			const uint32_t labelLength = m_buildNodes[child].labelLength;
 
-			size_t matchCount = 1;
-			for (size_t j = 1; j < edgeString.size() && j < name.size(); j++)
+			uint32_t matchCount = 1;
+			while (matchCount < labelLength && pos + matchCount < name.size() &&
+				   m_text[labelOffset + matchCount] == name[pos + matchCount])
 			{
-				if (edgeString[j] != name[j])
-				{
-					break;
-				}
 				matchCount++;
 			}
 
-			if (matchCount < edgeString.size())
+			if (matchCount < labelLength)
 			{
-				// split current edge
-				m_nodes.push_back(std::make_unique<SearchNode>(currentNode->containedTypes));
-				SearchNode* n = m_nodes.back().get();
+				// split label of child, the first character stays the same so the order is kept
+				const uint32_t n = static_cast<uint32_t>(m_buildNodes.size());
+				*it = n;
 
-				m_edges.push_back(std::make_unique<SearchEdge>(
-					currentEdge->target, edgeString.substr(matchCount)));
-				SearchEdge* e = m_edges.back().get();
+				m_buildNodes.emplace_back(labelOffset, matchCount);
+				m_buildNodes.back().children.push_back(child);
 
-				n->edges.emplace(e->s[0], e);
+				m_buildNodes[child].labelOffset += matchCount;
+				m_buildNodes[child].labelLength -= matchCount;
 
-				currentEdge->s = edgeString.substr(0, matchCount);
-				currentEdge->target = n;
+				currentNode = n;
+			}
+			else
+			{
+				currentNode = child;
 			}
 
-			name = name.substr(matchCount);
-			currentNode = currentEdge->target;
+			pos += matchCount;
 		}
 		else
 		{
-			m_nodes.push_back(std::make_unique<SearchNode>(currentNode->containedTypes));
-			SearchNode* n = m_nodes.back().get();
+			const uint32_t n = static_cast<uint32_t>(m_buildNodes.size());
+			children.insert(it, n);
 
-			m_edges.push_back(std::make_unique<SearchEdge>(n, std::move(name)));
-			SearchEdge* e = m_edges.back().get();
+			m_buildNodes.emplace_back(
+				static_cast<uint32_t>(m_text.size()), static_cast<uint32_t>(name.size() - pos));
+			m_text.append(name, pos, std::wstring::npos);
 
-			currentNode->edges.emplace(e->s[0], e);
 			currentNode = n;
-
-			name.clear();
+			pos = name.size();
 		}
 	}
 
-	currentNode->elementIds.emplace(id, type);
+	m_buildElements.push_back({currentNode, SearchElement(id, type.getKind(), tag)});
+}
+
+void SearchIndex::removeNodes(const std::unordered_set<Id>& ids)
+{
+	if (ids.empty())
+	{
+		return;
+	}
+
+	prepareChanges();
+
+	m_buildElements.erase(
+		std::remove_if(
+			m_buildElements.begin(),
+			m_buildElements.end(),
+			[&ids](const BuildElement& buildElement) {
+				return ids.find(buildElement.element.id) != ids.end();
+			}),
+		m_buildElements.end());
 }
 
 void SearchIndex::finishSetup()
 {
-	for (auto& p: m_root->edges)
+	if (m_buildNodes.empty())
+	{
+		return;
+	}
+
+	// nodes without elements in their subtree are left out
+	std::vector<uint32_t> order = {0};
+	std::vector<size_t> parents = {0};
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		for (uint32_t child: m_buildNodes[order[i]].children)
+		{
+			order.push_back(child);
+			parents.push_back(i);
+		}
+	}
+
+	std::vector<bool> hasElements(m_buildNodes.size(), false);
+	for (const BuildElement& buildElement: m_buildElements)
+	{
+		hasElements[buildElement.node] = true;
+	}
+
+	std::vector<bool> used = hasElements;
+	for (size_t i = order.size() - 1; i > 0; i--)
+	{
+		if (used[order[i]])
+		{
+			used[order[parents[i]]] = true;
+		}
+	}
+
+	// order nodes breadth first, so children are consecutive and follow their parent, labels are
+	// copied in the same order
+	std::wstring text;
+	std::vector<SearchNode> nodes(1);
+	std::vector<uint32_t> flatOrder = {0};
+	std::vector<uint32_t> flatIndices(m_buildNodes.size(), 0);
+
+	for (size_t i = 0; i < flatOrder.size(); i++)
+	{
+		nodes[i].firstChild = static_cast<uint32_t>(flatOrder.size());
+
+		for (uint32_t child: m_buildNodes[flatOrder[i]].children)
+		{
+			if (!used[child])
+			{
+				continue;
+			}
+
+			SearchNode node;
+			node.parent = static_cast<uint32_t>(i);
+			node.labelOffset = static_cast<uint32_t>(text.size());
+
+			// nodes that were left with a single child by removing elements are merged with it
+			uint32_t lastChild = child;
+			while (true)
+			{
+				const BuildNode& buildNode = m_buildNodes[lastChild];
+				text.append(m_text, buildNode.labelOffset, buildNode.labelLength);
+
+				if (hasElements[lastChild] ||
+					std::count_if(
+						buildNode.children.begin(),
+						buildNode.children.end(),
+						[&used](uint32_t c) { return used[c]; }) != 1)
+				{
+					break;
+				}
+
+				lastChild = *std::find_if(
+					buildNode.children.begin(),
+					buildNode.children.end(),
+					[&used](uint32_t c) { return used[c]; });
+			}
+
+			node.labelLength = static_cast<uint32_t>(text.size()) - node.labelOffset;
+			node.textLength = nodes[i].textLength + node.labelLength;
+			nodes.push_back(node);
+
+			flatIndices[lastChild] = static_cast<uint32_t>(flatOrder.size());
+			flatOrder.push_back(lastChild);
+		}
+
+		nodes[i].childCount = static_cast<uint32_t>(flatOrder.size()) - nodes[i].firstChild;
+	}
+
+	// elements are ordered by node and id, the first element added for an id is kept
+	for (BuildElement& buildElement: m_buildElements)
+	{
+		buildElement.node = flatIndices[buildElement.node];
+	}
+	std::stable_sort(
+		m_buildElements.begin(),
+		m_buildElements.end(),
+		[](const BuildElement& a, const BuildElement& b) {
+			return a.node < b.node || (a.node == b.node && a.element.id < b.element.id);
+		});
+
+	std::vector<SearchElement> elements;
+	elements.reserve(m_buildElements.size());
+	for (size_t i = 0; i < m_buildElements.size(); i++)
+	{
+		const BuildElement& buildElement = m_buildElements[i];
+		if (i > 0 && buildElement.node == m_buildElements[i - 1].node &&
+			buildElement.element.id == m_buildElements[i - 1].element.id)
+		{
+			continue;
+		}
+
+		SearchNode& node = nodes[buildElement.node];
+		if (!node.elementCount)
+		{
+			node.firstElement = static_cast<uint32_t>(elements.size());
+		}
+		node.elementCount++;
+		elements.push_back(buildElement.element);
+	}
+
+	// collect gates and types bottom up
+	for (size_t i = nodes.size() - 1; i > 0; i--)
 	{
-		populateEdgeGate(p.second);
+		SearchNode& node = nodes[i];
+		for (uint32_t j = 0; j < node.labelLength; j++)
+		{
+			node.gate |= getCharGate(toLower(text[node.labelOffset + j]));
+		}
+		for (uint32_t j = 0; j < node.elementCount; j++)
+		{
+			node.containedTypes.add(NodeType(elements[node.firstElement + j].kind));
+		}
+
+		nodes[node.parent].gate |= node.gate;
+		nodes[node.parent].containedTypes.add(node.containedTypes);
 	}
+
+	m_text = std::move(text);
+	m_nodes = std::move(nodes);
+	m_elements = std::move(elements);
+	m_buildNodes = std::vector<BuildNode>();
+	m_buildElements = std::vector<BuildElement>();
+
+	useOwnedData();
 }
 
 void SearchIndex::clear()
 {
-	m_nodes.clear();
-	m_edges.clear();
+	m_text = std::wstring();
+	m_nodes = std::vector<SearchNode>(1);
+	m_elements = std::vector<SearchElement>();
+	m_buildNodes = {BuildNode(0, 0)};
+	m_buildElements = std::vector<BuildElement>();
 
-	m_nodes.push_back(std::make_unique<SearchNode>(NodeTypeSet()));
+	useOwnedData();
+}
 
-	m_root = m_nodes.back().get();
+void SearchIndex::forEachElement(const std::function<void(Id, NodeType, uint64_t)>& func) const
+{
+	for (size_t i = 0; i < m_elementCount; i++)
+	{
+		const SearchElement& element = m_elementData[i];
+		func(element.id, NodeType(element.kind), element.tag);
+	}
+}
+
+bool SearchIndex::load(const FilePath& indexFilePath, std::string* key)
+{
+	MappedFile reader(indexFilePath);
+	if (!reader.isMapped())
+	{
+		return false;
+	}
+
+	std::string storedKey;
+	if (!reader.readHeader(s_indexFileMagic, s_indexFileVersion, &storedKey))
+	{
+		return false;
+	}
+
+	const IndexFileHeader* header = reader.read<IndexFileHeader>(1);
+	if (!header || header->charSize != sizeof(wchar_t) || header->nodeSize != sizeof(SearchNode) ||
+		header->elementSize != sizeof(SearchElement))
+	{
+		return false;
+	}
+
+	const wchar_t* text = reader.read<wchar_t>(header->textLength);
+	const SearchNode* nodes = reader.read<SearchNode>(header->nodeCount);
+	const SearchElement* elements = reader.read<SearchElement>(header->elementCount);
+
+	// ranges are checked once, so search can rely on them
+	bool valid = !reader.failed() && header->nodeCount > 0;
+	for (size_t i = 0; i < header->nodeCount && valid; i++)
+	{
+		const SearchNode& node = nodes[i];
+		valid = size_t(node.labelOffset) + node.labelLength <= header->textLength &&
+			size_t(node.firstElement) + node.elementCount <= header->elementCount &&
+			size_t(node.firstChild) + node.childCount <= header->nodeCount &&
+			(node.childCount == 0 || node.firstChild > i) &&
+			(i == 0
+				 ? node.textLength == 0
+				 : node.parent < i &&
+					 node.textLength == nodes[node.parent].textLength + node.labelLength);
+	}
+
+	if (!valid)
+	{
+		LOG_WARNING(L"Search index \"" + indexFilePath.wstr() + L"\" is corrupted.");
+		return false;
+	}
+
+	m_text = std::wstring();
+	m_nodes = std::vector<SearchNode>();
+	m_elements = std::vector<SearchElement>();
+	m_buildNodes = std::vector<BuildNode>();
+	m_buildElements = std::vector<BuildElement>();
+
+	m_dataOwner = reader.getDataOwner();
+	m_textData = text;
+	m_textSize = header->textLength;
+	m_nodeData = nodes;
+	m_nodeCount = header->nodeCount;
+	m_elementData = elements;
+	m_elementCount = header->elementCount;
+
+	*key = storedKey;
+	return true;
+}
+
+bool SearchIndex::save(const FilePath& indexFilePath, const std::string& key)
+{
+	if (m_dataOwner)
+	{
+		// the mapped file cannot be replaced while it is mapped
+		prepareChanges();
+	}
+
+	finishSetup();
+
+	// the index stays in memory if it cannot be saved
+	if (!MappedFile::save(
+			indexFilePath, s_indexFileMagic, s_indexFileVersion, key, [this](std::ofstream& out) {
+				write(out);
+			}))
+	{
+		return false;
+	}
+
+	std::string storedKey;
+	return load(indexFilePath, &storedKey);
 }
 
 std::vector<SearchResult> SearchIndex::search(
@@ -99,10 +379,19 @@ std::vector<SearchResult> SearchIndex::search(
 	size_t maxResultCount,
 	size_t maxBestScoredResultsLength) const
 {
+	const std::wstring lowerQuery = utility::toLowerCase(query);
+
+	// gates of all remaining query parts
+	std::vector<uint64_t> queryGates(lowerQuery.size() + 1, 0);
+	for (size_t i = lowerQuery.size(); i > 0; i--)
+	{
+		queryGates[i - 1] = queryGates[i] | getCharGate(lowerQuery[i - 1]);
+	}
+
 	// find paths containing query
 	std::vector<SearchPath> paths;
-	searchRecursive(
-		SearchPath(L"", {}, m_root), utility::toLowerCase(query), acceptedNodeTypes, &paths);
+	std::vector<size_t> indices;
+	searchRecursive(0, lowerQuery, 0, queryGates, acceptedNodeTypes, &indices, &paths);
 
 	// create scored search results
 	std::multiset<SearchResult> searchResults = createScoredResults(
@@ -144,119 +433,244 @@ std::vector<SearchResult> SearchIndex::search(
 	return std::vector<SearchResult>(bestResults.begin(), it);
 }
 
-void SearchIndex::populateEdgeGate(SearchEdge* e)
+size_t SearchIndex::getNodeCount() const
 {
-	for (auto& p: e->target->edges)
+	return m_nodeCount;
+}
+
+size_t SearchIndex::getMemoryUsage() const
+{
+	return m_textSize * sizeof(wchar_t) + m_nodeCount * sizeof(SearchNode) +
+		m_elementCount * sizeof(SearchElement);
+}
+
+wchar_t SearchIndex::toLower(wchar_t c)
+{
+	if (c < 128)
 	{
-		SearchEdge* targetEdge = p.second;
-		populateEdgeGate(targetEdge);
-		utility::append(e->gate, targetEdge->gate);
+		return (c >= L'A' && c <= L'Z') ? c + (L'a' - L'A') : c;
 	}
+	return static_cast<wchar_t>(towlower(c));
+}
 
-	for (const wchar_t& c: e->s)
+uint64_t SearchIndex::getCharGate(wchar_t lowerChar)
+{
+	// letters, digits and common separators get their own bit, other characters share the rest
+	if (lowerChar >= L'a' && lowerChar <= L'z')
+	{
+		return uint64_t(1) << (lowerChar - L'a');
+	}
+	else if (lowerChar >= L'0' && lowerChar <= L'9')
 	{
-		e->gate.insert(towlower(c));
+		return uint64_t(1) << (26 + lowerChar - L'0');
 	}
+
+	switch (lowerChar)
+	{
+	case L'_':
+		return uint64_t(1) << 36;
+	case L':':
+		return uint64_t(1) << 37;
+	case L'.':
+		return uint64_t(1) << 38;
+	case L'/':
+		return uint64_t(1) << 39;
+	case L' ':
+		return uint64_t(1) << 40;
+	}
+
+	return uint64_t(1) << (41 + static_cast<uint32_t>(lowerChar) % 23);
 }
 
-void SearchIndex::searchRecursive(
-	const SearchPath& path,
-	const std::wstring& remainingQuery,
-	NodeTypeSet acceptedNodeTypes,
-	std::vector<SearchIndex::SearchPath>* results) const
+void SearchIndex::prepareChanges()
 {
-	for (const auto& p: path.node->edges)
+	if (!m_buildNodes.empty())
 	{
-		const SearchEdge* currentEdge = p.second;
+		return;
+	}
 
-		if (!acceptedNodeTypes.intersectsWith(currentEdge->target->containedTypes))
+	// build nodes get the indices of the flattened nodes
+	if (m_dataOwner)
+	{
+		m_text.assign(m_textData, m_textSize);
+	}
+
+	m_buildNodes.reserve(m_nodeCount);
+	m_buildElements.reserve(m_elementCount);
+	for (uint32_t i = 0; i < m_nodeCount; i++)
+	{
+		const SearchNode& node = m_nodeData[i];
+
+		m_buildNodes.emplace_back(node.labelOffset, node.labelLength);
+		for (uint32_t j = 0; j < node.childCount; j++)
 		{
-			continue;
+			m_buildNodes.back().children.push_back(node.firstChild + j);
 		}
 
-		// test if s passes the edge's gate.
-		bool passesGate = true;
-		for (const wchar_t& c: remainingQuery)
+		for (uint32_t j = 0; j < node.elementCount; j++)
 		{
-			if (currentEdge->gate.find(c) == currentEdge->gate.end())
-			{
-				passesGate = false;
-				break;
-			}
+			m_buildElements.push_back({i, m_elementData[node.firstElement + j]});
 		}
+	}
+
+	m_nodes = std::vector<SearchNode>(1);
+	m_elements = std::vector<SearchElement>();
+	useOwnedData();
+}
 
-		if (!passesGate)
+void SearchIndex::useOwnedData()
+{
+	m_dataOwner.reset();
+	m_textData = m_text.data();
+	m_textSize = m_text.size();
+	m_nodeData = m_nodes.data();
+	m_nodeCount = m_nodes.size();
+	m_elementData = m_elements.data();
+	m_elementCount = m_elements.size();
+}
+
+void SearchIndex::write(std::ofstream& out) const
+{
+	IndexFileHeader header;
+	header.charSize = sizeof(wchar_t);
+	header.nodeSize = sizeof(SearchNode);
+	header.elementSize = sizeof(SearchElement);
+	header.textLength = static_cast<uint32_t>(m_textSize);
+	header.nodeCount = static_cast<uint32_t>(m_nodeCount);
+	header.elementCount = static_cast<uint32_t>(m_elementCount);
+
+	MappedFile::writePadded(out, &header, sizeof(header));
+	MappedFile::writePadded(out, m_textData, m_textSize * sizeof(wchar_t));
+	MappedFile::writePadded(out, m_nodeData, m_nodeCount * sizeof(SearchNode));
+	MappedFile::writePadded(out, m_elementData, m_elementCount * sizeof(SearchElement));
+}
+
+void SearchIndex::getNodeText(uint32_t nodeIndex, std::wstring* text) const
+{
+	text->resize(m_nodeData[nodeIndex].textLength);
+	while (nodeIndex)
+	{
+		const SearchNode& node = m_nodeData[nodeIndex];
+		std::copy(
+			m_textData + node.labelOffset,
+			m_textData + node.labelOffset + node.labelLength,
+			text->begin() + (node.textLength - node.labelLength));
+		nodeIndex = node.parent;
+	}
+}
+
+void SearchIndex::searchRecursive(
+	uint32_t nodeIndex,
+	const std::wstring& lowerQuery,
+	size_t queryPos,
+	const std::vector<uint64_t>& queryGates,
+	NodeTypeSet acceptedNodeTypes,
+	std::vector<size_t>* indices,
+	std::vector<SearchPath>* results) const
+{
+	const SearchNode& node = m_nodeData[nodeIndex];
+	const uint64_t queryGate = queryGates[queryPos];
+
+	for (uint32_t childIndex = node.firstChild; childIndex < node.firstChild + node.childCount;
+		 childIndex++)
+	{
+		const SearchNode& child = m_nodeData[childIndex];
+
+		if (!acceptedNodeTypes.intersectsWith(child.containedTypes))
+		{
+			continue;
+		}
+
+		// the gate may let through a few subtrees that don't contain all query characters
+		if ((queryGate & child.gate) != queryGate)
 		{
 			continue;
 		}
 
-		// consume characters for edge
-		const std::wstring& edgeString = currentEdge->s;
-		SearchPath currentPath {path.text + edgeString, path.indices, currentEdge->target};
+		// consume characters for label
+		const size_t indicesSize = indices->size();
+		const wchar_t* label = m_textData + child.labelOffset;
 
-		size_t j = 0;
-		for (size_t i = 0; i < edgeString.size() && j < remainingQuery.size(); i++)
+		size_t j = queryPos;
+		for (size_t i = 0; i < child.labelLength && j < lowerQuery.size(); i++)
 		{
-			if (towlower(edgeString[i]) == remainingQuery[j])
+			if (toLower(label[i]) == lowerQuery[j])
 			{
-				currentPath.indices.push_back(path.text.size() + i);
+				indices->push_back(node.textLength + i);
 				j++;
 			}
 		}
 
-		if (j == remainingQuery.size())
+		if (j == lowerQuery.size())
 		{
-			results->push_back(std::move(currentPath));
+			results->emplace_back(childIndex, *indices);
 		}
 		else
 		{
-			searchRecursive(currentPath, remainingQuery.substr(j), acceptedNodeTypes, results);
+			searchRecursive(
+				childIndex, lowerQuery, j, queryGates, acceptedNodeTypes, indices, results);
 		}
+
+		indices->resize(indicesSize);
 	}
 }
 
 std::multiset<SearchResult> SearchIndex::createScoredResults(
 	const std::vector<SearchPath>& paths, NodeTypeSet acceptedNodeTypes, size_t maxResultCount) const
 {
-	// score and order initial paths
-	std::multimap<int, SearchPath, std::greater<int>> scoredPaths;
+	// score and order initial paths, paths with equal scores keep their order
+	std::vector<std::pair<int, const SearchPath*>> scoredPaths;
+	scoredPaths.reserve(paths.size());
+
+	std::wstring text;
 	for (const SearchPath& path: paths)
 	{
-		scoredPaths.emplace(scoreText(path.text, path.indices), path);
+		getNodeText(path.node, &text);
+		scoredPaths.emplace_back(scoreText(text, path.indices), &path);
 	}
+	std::stable_sort(
+		scoredPaths.begin(),
+		scoredPaths.end(),
+		[](const std::pair<int, const SearchPath*>& a, const std::pair<int, const SearchPath*>& b) {
+			return a.first > b.first;
+		});
 
 	// score paths and subpaths
 	std::multiset<SearchResult> searchResults;
-	for (const std::pair<int, SearchPath>& p: scoredPaths)
+	for (const std::pair<int, const SearchPath*>& p: scoredPaths)
 	{
-		std::vector<SearchPath> currentPaths;
-		currentPaths.push_back(p.second);
+		const SearchPath& path = *p.second;
+		std::vector<uint32_t> currentNodes = {path.node};
 
-		while (!currentPaths.empty())
+		while (!currentNodes.empty())
 		{
-			std::vector<SearchPath> nextPaths;
+			std::vector<uint32_t> nextNodes;
 
-			for (const SearchPath& path: currentPaths)
+			for (uint32_t nodeIndex: currentNodes)
 			{
-				if (!path.node->elementIds.empty() &&
-					(acceptedNodeTypes.intersectsWith(path.node->containedTypes)))
+				const SearchNode& node = m_nodeData[nodeIndex];
+
+				if (node.elementCount && acceptedNodeTypes.intersectsWith(node.containedTypes))
 				{
 					std::vector<Id> elementIds;
-					for (const auto& p: path.node->elementIds)
+					for (uint32_t i = node.firstElement; i < node.firstElement + node.elementCount;
+						 i++)
 					{
-						if (acceptedNodeTypes.contains(p.second))
+						const SearchElement& element = m_elementData[i];
+						if (acceptedNodeTypes.contains(NodeType(element.kind)))
 						{
-							elementIds.push_back(p.first);
+							elementIds.push_back(element.id);
 						}
 					}
 
 					if (!elementIds.empty())
 					{
+						getNodeText(nodeIndex, &text);
 						searchResults.emplace(
-							path.text,
+							text,
 							std::move(elementIds),
 							path.indices,
-							scoreText(path.text, path.indices));
+							scoreText(text, path.indices));
 
 						if (maxResultCount && searchResults.size() >= maxResultCount)
 						{
@@ -265,14 +679,13 @@ std::multiset<SearchResult> SearchIndex::createScoredResults(
 					}
 				}
 
-				for (auto p: path.node->edges)
+				for (uint32_t i = 0; i < node.childCount; i++)
 				{
-					const SearchEdge* edge = p.second;
-					nextPaths.emplace_back(path.text + edge->s, path.indices, edge->target);
+					nextNodes.push_back(node.firstChild + i);
 				}
 			}
 
-			currentPaths = std::move(nextPaths);
+			currentNodes = std::move(nextNodes);
 		}
 	}
 
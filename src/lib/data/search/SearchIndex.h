@@ -1,16 +1,22 @@
 #ifndef SEARCH_INDEX_H
 #define SEARCH_INDEX_H
 
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "Node.h"
 #include "NodeTypeSet.h"
 #include "types.h"
 
+class FilePath;
+
 // SearchResult is only used as an internal type in the SearchIndex and the PersistentStorage
 struct SearchResult
 {
@@ -33,16 +39,27 @@ struct SearchResult
 	int score;
 };
 
+// radix trie over all added names, that is flattened into contiguous arrays by finishSetup
 class SearchIndex
 {
 public:
 	SearchIndex();
 	virtual ~SearchIndex();
 
-	void addNode(Id id, std::wstring name, NodeType type = NodeType(NODE_SYMBOL));
+	// the tag is stored with the element, so callers can find elements that changed since saving
+	void addNode(Id id, std::wstring name, NodeType type = NodeType(NODE_SYMBOL), uint64_t tag = 0);
+	void removeNodes(const std::unordered_set<Id>& ids);
+	// makes added and removed nodes searchable, nodes can still be changed afterwards
 	void finishSetup();
 	void clear();
 
+	void forEachElement(const std::function<void(Id, NodeType, uint64_t)>& func) const;
+
+	// maps the index file and returns the key it was saved with
+	bool load(const FilePath& indexFilePath, std::string* key);
+	// finishes setup, replaces the index file and maps it afterwards
+	bool save(const FilePath& indexFilePath, const std::string& key);
+
 	// maxResultCount == 0 means "no restriction".
 	std::vector<SearchResult> search(
 		const std::wstring& query,
@@ -50,45 +67,84 @@ public:
 		size_t maxResultCount,
 		size_t maxBestScoredResultsLength = 0) const;
 
-private:
-	struct SearchEdge;
+	size_t getNodeCount() const;
+	size_t getMemoryUsage() const;
 
+private:
+	// the children of a node are stored consecutively and ordered by the first character of their
+	// label, which is the part of the name between a node and its parent
 	struct SearchNode
 	{
-		SearchNode(NodeTypeSet containedTypes): containedTypes(containedTypes) {}
-
-		std::map<Id, NodeType> elementIds;
+		uint32_t parent = 0;
+		uint32_t labelOffset = 0;
+		uint32_t labelLength = 0;
+		uint32_t textLength = 0;
+		uint32_t firstChild = 0;
+		uint32_t childCount = 0;
+		uint32_t firstElement = 0;
+		uint32_t elementCount = 0;
+
+		// character classes and node types within the label and the whole subtree
+		uint64_t gate = 0;
 		NodeTypeSet containedTypes;
-		std::map<wchar_t, SearchEdge*> edges;
 	};
 
-	struct SearchEdge
+	struct SearchElement
+	{
+		SearchElement(Id id, NodeKind kind, uint64_t tag): id(id), kind(kind), tag(tag) {}
+
+		Id id;
+		NodeKind kind;
+		uint64_t tag;
+	};
+
+	// nodes are only referenced by index while adding, so the trie can grow without copying names
+	struct BuildNode
 	{
-		SearchEdge(SearchNode* target, std::wstring s): target(target), s(std::move(s)) {}
+		BuildNode(uint32_t labelOffset, uint32_t labelLength)
+			: labelOffset(labelOffset), labelLength(labelLength)
+		{
+		}
 
-		SearchNode* target;
-		std::wstring s;
-		std::set<wchar_t> gate;
+		uint32_t labelOffset;
+		uint32_t labelLength;
+		std::vector<uint32_t> children;
+	};
+
+	struct BuildElement
+	{
+		uint32_t node;
+		SearchElement element;
 	};
 
 	struct SearchPath
 	{
-		SearchPath(std::wstring text, std::vector<size_t> indices, SearchNode* node)
-			: text(std::move(text)), indices(std::move(indices)), node(node)
+		SearchPath(uint32_t node, std::vector<size_t> indices)
+			: node(node), indices(std::move(indices))
 		{
 		}
 
-		std::wstring text;
+		uint32_t node;
 		std::vector<size_t> indices;
-		SearchNode* node;
 	};
 
-	void populateEdgeGate(SearchEdge* e);
+	static wchar_t toLower(wchar_t c);
+	static uint64_t getCharGate(wchar_t lowerChar);
+
+	void prepareChanges();
+	void useOwnedData();
+	void write(std::ofstream& out) const;
+
+	void getNodeText(uint32_t nodeIndex, std::wstring* text) const;
+
 	void searchRecursive(
-		const SearchPath& path,
-		const std::wstring& remainingQuery,
+		uint32_t nodeIndex,
+		const std::wstring& lowerQuery,
+		size_t queryPos,
+		const std::vector<uint64_t>& queryGates,
 		NodeTypeSet acceptedNodeTypes,
-		std::vector<SearchIndex::SearchPath>* results) const;
+		std::vector<size_t>* indices,
+		std::vector<SearchPath>* results) const;
 
 	std::multiset<SearchResult> createScoredResults(
 		const std::vector<SearchPath>& paths,
@@ -119,9 +175,22 @@ public:
 	static bool isNoLetter(const wchar_t c);
 
 private:
-	std::vector<std::unique_ptr<SearchNode>> m_nodes;
-	std::vector<std::unique_ptr<SearchEdge>> m_edges;
-	SearchNode* m_root;
+	// labels of all nodes refer to this text
+	std::wstring m_text;
+
+	std::vector<SearchNode> m_nodes;
+	std::vector<SearchElement> m_elements;
+
+	std::shared_ptr<const void> m_dataOwner;
+	const wchar_t* m_textData = nullptr;
+	size_t m_textSize = 0;
+	const SearchNode* m_nodeData = nullptr;
+	size_t m_nodeCount = 0;
+	const SearchElement* m_elementData = nullptr;
+	size_t m_elementCount = 0;
+
+	std::vector<BuildNode> m_buildNodes;
+	std::vector<BuildElement> m_buildElements;
 };
 
 #endif	  // SEARCH_INDEX_H
@@ -0,0 +1,505 @@
+#include "FlatIntermediateStorage.h"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "IntermediateStorage.h"
+#include "logging.h"
+
+namespace
+{
+const uint32_t s_magic = 0x53495446;	// "FTIS"
+const uint32_t s_version = 1;
+
+struct StringRef
+{
+	uint64_t offset;	// in characters
+	uint64_t length;
+};
+
+struct FlatNode
+{
+	Id id;
+	int type;
+	StringRef serializedName;
+};
+
+struct FlatFile
+{
+	Id id;
+	StringRef filePath;
+	StringRef languageIdentifier;
+	bool indexed;
+	bool complete;
+};
+
+struct FlatLocalSymbol
+{
+	Id id;
+	StringRef name;
+};
+
+struct FlatElementComponent
+{
+	Id elementId;
+	int type;
+	StringRef data;
+};
+
+struct FlatError
+{
+	Id id;
+	StringRef message;
+	StringRef translationUnit;
+	bool fatal;
+	bool indexed;
+};
+
+static_assert(std::is_trivially_copyable<StorageSymbol>::value, "record must be trivially copyable");
+static_assert(std::is_trivially_copyable<StorageEdge>::value, "record must be trivially copyable");
+static_assert(
+	std::is_trivially_copyable<StorageSourceLocation>::value, "record must be trivially copyable");
+static_assert(std::is_trivially_copyable<StorageOccurrence>::value, "record must be trivially copyable");
+static_assert(
+	std::is_trivially_copyable<StorageComponentAccess>::value, "record must be trivially copyable");
+
+enum SectionType
+{
+	SECTION_STRINGS = 0,
+	SECTION_NODES,
+	SECTION_FILES,
+	SECTION_SYMBOLS,
+	SECTION_EDGES,
+	SECTION_LOCAL_SYMBOLS,
+	SECTION_SOURCE_LOCATIONS,
+	SECTION_OCCURRENCES,
+	SECTION_COMPONENT_ACCESSES,
+	SECTION_ELEMENT_COMPONENTS,
+	SECTION_ERRORS,
+	SECTION_COUNT
+};
+
+struct Section
+{
+	uint64_t offset;	// in bytes from the start of the block
+	uint64_t count;
+};
+
+struct Header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t nextId;
+	uint64_t byteSize;
+	Section sections[SECTION_COUNT];
+};
+
+size_t alignOffset(size_t offset)
+{
+	const size_t alignment = alignof(std::max_align_t);
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+Header computeHeader(const IntermediateStorage& storage)
+{
+	size_t stringLength = 0;
+	for (const StorageNode& node: storage.getStorageNodes())
+	{
+		stringLength += node.serializedName.size();
+	}
+	for (const StorageFile& file: storage.getStorageFiles())
+	{
+		stringLength += file.filePath.size() + file.languageIdentifier.size();
+	}
+	for (const StorageLocalSymbol& localSymbol: storage.getStorageLocalSymbols())
+	{
+		stringLength += localSymbol.name.size();
+	}
+	for (const StorageElementComponent& component: storage.getElementComponents())
+	{
+		stringLength += component.data.size();
+	}
+	for (const StorageError& error: storage.getErrors())
+	{
+		stringLength += error.message.size() + error.translationUnit.size();
+	}
+
+	Header header;
+	header.magic = s_magic;
+	header.version = s_version;
+	header.nextId = storage.getNextId();
+
+	const size_t counts[SECTION_COUNT] = {
+		stringLength,
+		storage.getStorageNodes().size(),
+		storage.getStorageFiles().size(),
+		storage.getStorageSymbols().size(),
+		storage.getStorageEdges().size(),
+		storage.getStorageLocalSymbols().size(),
+		storage.getStorageSourceLocations().size(),
+		storage.getStorageOccurrences().size(),
+		storage.getComponentAccesses().size(),
+		storage.getElementComponents().size(),
+		storage.getErrors().size()};
+
+	const size_t recordSizes[SECTION_COUNT] = {
+		sizeof(wchar_t),
+		sizeof(FlatNode),
+		sizeof(FlatFile),
+		sizeof(StorageSymbol),
+		sizeof(StorageEdge),
+		sizeof(FlatLocalSymbol),
+		sizeof(StorageSourceLocation),
+		sizeof(StorageOccurrence),
+		sizeof(StorageComponentAccess),
+		sizeof(FlatElementComponent),
+		sizeof(FlatError)};
+
+	size_t offset = alignOffset(sizeof(Header));
+	for (size_t i = 0; i < SECTION_COUNT; i++)
+	{
+		header.sections[i].offset = offset;
+		header.sections[i].count = counts[i];
+		offset = alignOffset(offset + counts[i] * recordSizes[i]);
+	}
+	header.byteSize = offset;
+
+	return header;
+}
+
+class Writer
+{
+public:
+	Writer(char* buffer, const Header& header)
+		: m_buffer(buffer)
+		, m_header(header)
+		, m_strings(reinterpret_cast<wchar_t*>(buffer + header.sections[SECTION_STRINGS].offset))
+		, m_stringOffset(0)
+	{
+	}
+
+	StringRef addString(const std::wstring& str)
+	{
+		StringRef ref;
+		ref.offset = m_stringOffset;
+		ref.length = str.size();
+
+		if (!str.empty())
+		{
+			std::memcpy(m_strings + m_stringOffset, str.data(), str.size() * sizeof(wchar_t));
+			m_stringOffset += str.size();
+		}
+		return ref;
+	}
+
+	template <typename T>
+	T* getRecords(SectionType type)
+	{
+		return reinterpret_cast<T*>(m_buffer + m_header.sections[type].offset);
+	}
+
+	template <typename T, typename ContainerType>
+	void copyRecords(SectionType type, const ContainerType& container)
+	{
+		T* records = getRecords<T>(type);
+		for (const T& element: container)
+		{
+			std::memcpy(records++, &element, sizeof(T));
+		}
+	}
+
+private:
+	char* m_buffer;
+	const Header& m_header;
+	wchar_t* m_strings;
+	size_t m_stringOffset;
+};
+
+class Reader
+{
+public:
+	Reader(const char* data)
+		: m_data(data)
+		, m_header(reinterpret_cast<const Header*>(data))
+		, m_strings(reinterpret_cast<const wchar_t*>(
+			  data + m_header->sections[SECTION_STRINGS].offset))
+	{
+	}
+
+	size_t getCount(SectionType type) const
+	{
+		return static_cast<size_t>(m_header->sections[type].count);
+	}
+
+	template <typename T>
+	const T* getRecords(SectionType type) const
+	{
+		return reinterpret_cast<const T*>(m_data + m_header->sections[type].offset);
+	}
+
+	std::wstring getString(const StringRef& ref) const
+	{
+		return std::wstring(m_strings + ref.offset, static_cast<size_t>(ref.length));
+	}
+
+private:
+	const char* m_data;
+	const Header* m_header;
+	const wchar_t* m_strings;
+};
+}	 // namespace
+
+size_t FlatIntermediateStorage::getByteSize(const IntermediateStorage& storage)
+{
+	return static_cast<size_t>(computeHeader(storage).byteSize);
+}
+
+bool FlatIntermediateStorage::write(const IntermediateStorage& storage, char* buffer, size_t bufferSize)
+{
+	const Header header = computeHeader(storage);
+	if (header.byteSize > bufferSize)
+	{
+		LOG_ERROR_STREAM(
+			<< "Buffer too small for flat intermediate storage: " << bufferSize << " < "
+			<< header.byteSize);
+		return false;
+	}
+
+	std::memcpy(buffer, &header, sizeof(Header));
+
+	Writer writer(buffer, header);
+
+	{
+		FlatNode* records = writer.getRecords<FlatNode>(SECTION_NODES);
+		for (const StorageNode& node: storage.getStorageNodes())
+		{
+			FlatNode& record = *(records++);
+			record.id = node.id;
+			record.type = node.type;
+			record.serializedName = writer.addString(node.serializedName);
+		}
+	}
+
+	{
+		FlatFile* records = writer.getRecords<FlatFile>(SECTION_FILES);
+		for (const StorageFile& file: storage.getStorageFiles())
+		{
+			FlatFile& record = *(records++);
+			record.id = file.id;
+			record.filePath = writer.addString(file.filePath);
+			record.languageIdentifier = writer.addString(file.languageIdentifier);
+			record.indexed = file.indexed;
+			record.complete = file.complete;
+		}
+	}
+
+	writer.copyRecords<StorageSymbol>(SECTION_SYMBOLS, storage.getStorageSymbols());
+	writer.copyRecords<StorageEdge>(SECTION_EDGES, storage.getStorageEdges());
+
+	{
+		FlatLocalSymbol* records = writer.getRecords<FlatLocalSymbol>(SECTION_LOCAL_SYMBOLS);
+		for (const StorageLocalSymbol& localSymbol: storage.getStorageLocalSymbols())
+		{
+			FlatLocalSymbol& record = *(records++);
+			record.id = localSymbol.id;
+			record.name = writer.addString(localSymbol.name);
+		}
+	}
+
+	// sets are written in their iteration order, so they can be restored without comparisons
+	writer.copyRecords<StorageSourceLocation>(
+		SECTION_SOURCE_LOCATIONS, storage.getStorageSourceLocations());
+	writer.copyRecords<StorageOccurrence>(SECTION_OCCURRENCES, storage.getStorageOccurrences());
+	writer.copyRecords<StorageComponentAccess>(
+		SECTION_COMPONENT_ACCESSES, storage.getComponentAccesses());
+
+	{
+		FlatElementComponent* records = writer.getRecords<FlatElementComponent>(
+			SECTION_ELEMENT_COMPONENTS);
+		for (const StorageElementComponent& component: storage.getElementComponents())
+		{
+			FlatElementComponent& record = *(records++);
+			record.elementId = component.elementId;
+			record.type = component.type;
+			record.data = writer.addString(component.data);
+		}
+	}
+
+	{
+		FlatError* records = writer.getRecords<FlatError>(SECTION_ERRORS);
+		for (const StorageError& error: storage.getErrors())
+		{
+			FlatError& record = *(records++);
+			record.id = error.id;
+			record.message = writer.addString(error.message);
+			record.translationUnit = writer.addString(error.translationUnit);
+			record.fatal = error.fatal;
+			record.indexed = error.indexed;
+		}
+	}
+
+	return true;
+}
+
+FlatIntermediateStorage::FlatIntermediateStorage(const char* data, size_t size)
+	: m_data(data), m_size(size)
+{
+}
+
+bool FlatIntermediateStorage::isValid() const
+{
+	if (!m_data || m_size < sizeof(Header))
+	{
+		return false;
+	}
+
+	const Header* header = reinterpret_cast<const Header*>(m_data);
+	return header->magic == s_magic && header->version == s_version && header->byteSize <= m_size;
+}
+
+std::shared_ptr<IntermediateStorage> FlatIntermediateStorage::createIntermediateStorage() const
+{
+	if (!isValid())
+	{
+		LOG_ERROR("Flat intermediate storage data is invalid.");
+		return nullptr;
+	}
+
+	const Reader reader(m_data);
+	std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
+
+	{
+		const FlatNode* records = reader.getRecords<FlatNode>(SECTION_NODES);
+		const size_t count = reader.getCount(SECTION_NODES);
+
+		std::vector<StorageNode> nodes;
+		nodes.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			nodes.emplace_back(records[i].id, records[i].type, reader.getString(records[i].serializedName));
+		}
+		storage->setStorageNodes(std::move(nodes));
+	}
+
+	{
+		const FlatFile* records = reader.getRecords<FlatFile>(SECTION_FILES);
+		const size_t count = reader.getCount(SECTION_FILES);
+
+		std::vector<StorageFile> files;
+		files.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			files.emplace_back(
+				records[i].id,
+				reader.getString(records[i].filePath),
+				reader.getString(records[i].languageIdentifier),
+				"",
+				records[i].indexed,
+				records[i].complete);
+		}
+		storage->setStorageFiles(std::move(files));
+	}
+
+	{
+		const StorageSymbol* records = reader.getRecords<StorageSymbol>(SECTION_SYMBOLS);
+		storage->setStorageSymbols(
+			std::vector<StorageSymbol>(records, records + reader.getCount(SECTION_SYMBOLS)));
+	}
+
+	{
+		const StorageEdge* records = reader.getRecords<StorageEdge>(SECTION_EDGES);
+		storage->setStorageEdges(
+			std::vector<StorageEdge>(records, records + reader.getCount(SECTION_EDGES)));
+	}
+
+	{
+		const FlatLocalSymbol* records = reader.getRecords<FlatLocalSymbol>(SECTION_LOCAL_SYMBOLS);
+		const size_t count = reader.getCount(SECTION_LOCAL_SYMBOLS);
+
+		std::set<StorageLocalSymbol> localSymbols;
+		for (size_t i = 0; i < count; i++)
+		{
+			localSymbols.emplace_hint(
+				localSymbols.end(), records[i].id, reader.getString(records[i].name));
+		}
+		storage->setStorageLocalSymbols(std::move(localSymbols));
+	}
+
+	{
+		const StorageSourceLocation* records = reader.getRecords<StorageSourceLocation>(
+			SECTION_SOURCE_LOCATIONS);
+		const size_t count = reader.getCount(SECTION_SOURCE_LOCATIONS);
+
+		std::set<StorageSourceLocation> sourceLocations;
+		for (size_t i = 0; i < count; i++)
+		{
+			sourceLocations.emplace_hint(sourceLocations.end(), records[i]);
+		}
+		storage->setStorageSourceLocations(std::move(sourceLocations));
+	}
+
+	{
+		const StorageOccurrence* records = reader.getRecords<StorageOccurrence>(SECTION_OCCURRENCES);
+		const size_t count = reader.getCount(SECTION_OCCURRENCES);
+
+		std::set<StorageOccurrence> occurrences;
+		for (size_t i = 0; i < count; i++)
+		{
+			occurrences.emplace_hint(occurrences.end(), records[i]);
+		}
+		storage->setStorageOccurrences(std::move(occurrences));
+	}
+
+	{
+		const StorageComponentAccess* records = reader.getRecords<StorageComponentAccess>(
+			SECTION_COMPONENT_ACCESSES);
+		const size_t count = reader.getCount(SECTION_COMPONENT_ACCESSES);
+
+		std::set<StorageComponentAccess> componentAccesses;
+		for (size_t i = 0; i < count; i++)
+		{
+			componentAccesses.emplace_hint(componentAccesses.end(), records[i]);
+		}
+		storage->setComponentAccesses(std::move(componentAccesses));
+	}
+
+	{
+		const FlatElementComponent* records = reader.getRecords<FlatElementComponent>(
+			SECTION_ELEMENT_COMPONENTS);
+		const size_t count = reader.getCount(SECTION_ELEMENT_COMPONENTS);
+
+		std::set<StorageElementComponent> components;
+		for (size_t i = 0; i < count; i++)
+		{
+			components.emplace_hint(
+				components.end(),
+				records[i].elementId,
+				records[i].type,
+				reader.getString(records[i].data));
+		}
+		storage->setElementComponents(std::move(components));
+	}
+
+	{
+		const FlatError* records = reader.getRecords<FlatError>(SECTION_ERRORS);
+		const size_t count = reader.getCount(SECTION_ERRORS);
+
+		std::vector<StorageError> errors;
+		errors.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			errors.emplace_back(
+				records[i].id,
+				reader.getString(records[i].message),
+				reader.getString(records[i].translationUnit),
+				records[i].fatal,
+				records[i].indexed);
+		}
+		storage->setErrors(std::move(errors));
+	}
+
+	storage->setNextId(static_cast<Id>(reinterpret_cast<const Header*>(m_data)->nextId));
+
+	return storage;
+}
@@ -0,0 +1,31 @@
+#ifndef FLAT_INTERMEDIATE_STORAGE_H
+#define FLAT_INTERMEDIATE_STORAGE_H
+
+#include <memory>
+
+class IntermediateStorage;
+
+// Relocatable single-block representation of an IntermediateStorage. All strings are kept
+// untranscoded in one wchar_t table and records are plain structs referencing it by offset, so the
+// whole block can be written once into shared memory and copied out again with a single memcpy.
+class FlatIntermediateStorage
+{
+public:
+	static size_t getByteSize(const IntermediateStorage& storage);
+
+	// buffer needs to hold at least getByteSize(storage) bytes
+	static bool write(const IntermediateStorage& storage, char* buffer, size_t bufferSize);
+
+	// the data is not copied and needs to outlive this view
+	FlatIntermediateStorage(const char* data, size_t size);
+
+	bool isValid() const;
+
+	std::shared_ptr<IntermediateStorage> createIntermediateStorage() const;
+
+private:
+	const char* m_data;
+	const size_t m_size;
+};
+
+#endif	  // FLAT_INTERMEDIATE_STORAGE_H
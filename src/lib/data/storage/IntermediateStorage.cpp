@@ -7,23 +7,27 @@ IntermediateStorage::IntermediateStorage(): m_nextId(1) {}
 
 void IntermediateStorage::clear()
 {
+#if !BUILD_HASHED_INTERMEDIATE_STORAGE
 	m_nodesIndex.clear();
+	m_filesIndex.clear();
+	m_edgesIndex.clear();
+#endif
+
 	m_nodeIdIndex.clear();
 	m_nodes.clear();
 
-	m_filesIndex.clear();
 	m_filesIdIndex.clear();
 	m_files.clear();
 
 	m_symbols.clear();
 
-	m_edgesIndex.clear();
 	m_edges.clear();
 
 	m_localSymbols.clear();
 	m_sourceLocations.clear();
 	m_occurrences.clear();
 	m_componentAccesses.clear();
+	m_elementComponents.clear();
 
 	m_errorsIndex.clear();
 	m_errors.clear();
@@ -35,37 +39,38 @@ size_t IntermediateStorage::getByteSize(size_t stringSize) const
 {
 	size_t byteSize = 0;
 
-	for (const StorageFile& storageFile: getStorageFiles())
+	// members are used directly, so no ordered views get created just for measuring
+	for (const StorageFile& storageFile: m_files)
 	{
 		byteSize += sizeof(StorageFile);
 		byteSize += stringSize + storageFile.filePath.size();
 		byteSize += stringSize + storageFile.modificationTime.size();
 	}
 
-	for (const StorageErrorData& storageError: getErrors())
+	for (const StorageErrorData& storageError: m_errors)
 	{
 		byteSize += sizeof(StorageErrorData);
 		byteSize += stringSize + storageError.message.size();
 		byteSize += stringSize + storageError.translationUnit.size();
 	}
 
-	for (const StorageNode& storageNode: getStorageNodes())
+	for (const StorageNode& storageNode: m_nodes)
 	{
 		byteSize += sizeof(StorageNode);
 		byteSize += stringSize + storageNode.serializedName.size();
 	}
 
-	for (const StorageLocalSymbol& storageLocalSymbol: getStorageLocalSymbols())
+	for (const StorageLocalSymbol& storageLocalSymbol: m_localSymbols)
 	{
 		byteSize += sizeof(StorageLocalSymbol);
 		byteSize += stringSize + storageLocalSymbol.name.size();
 	}
 
-	byteSize += sizeof(StorageEdge) * getStorageEdges().size();
-	byteSize += sizeof(StorageComponentAccess) * getComponentAccesses().size();
-	byteSize += sizeof(StorageOccurrence) * getStorageOccurrences().size();
-	byteSize += sizeof(StorageSymbol) * getStorageSymbols().size();
-	byteSize += sizeof(StorageSourceLocation) * getStorageSourceLocations().size();
+	byteSize += sizeof(StorageEdge) * m_edges.size();
+	byteSize += sizeof(StorageComponentAccess) * m_componentAccesses.size();
+	byteSize += sizeof(StorageOccurrence) * m_occurrences.size();
+	byteSize += sizeof(StorageSymbol) * m_symbols.size();
+	byteSize += sizeof(StorageSourceLocation) * m_sourceLocations.size();
 
 	return byteSize;
 }
@@ -90,9 +95,9 @@ bool IntermediateStorage::hasFatalErrors() const
 
 void IntermediateStorage::setAllFilesIncomplete()
 {
-	for (StorageFile& file: m_files)
+	for (size_t i = 0; i < m_files.size(); i++)
 	{
-		file.complete = false;
+		m_files[i].complete = false;
 	}
 }
 
@@ -107,18 +112,34 @@ void IntermediateStorage::setFilesWithErrorsIncomplete()
 		}
 	}
 
-	for (StorageFile& file: m_files)
+	for (size_t i = 0; i < m_files.size(); i++)
 	{
-		if (errorFileIds.find(file.id) != errorFileIds.end())
+		if (errorFileIds.find(m_files[i].id) != errorFileIds.end())
 		{
-			file.complete = false;
+			m_files[i].complete = false;
 		}
 	}
 }
 
 std::pair<Id, bool> IntermediateStorage::addNode(const StorageNodeData& nodeData)
 {
-	auto it = m_nodesIndex.find(nodeData);
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	const size_t index = m_nodes.find(nodeData);
+	if (index != m_nodes.npos)
+	{
+		StorageNode& storedNode = m_nodes[index];
+		if (storedNode.type < nodeData.type)
+		{
+			storedNode.type = nodeData.type;
+		}
+		return std::make_pair(storedNode.id, false);
+	}
+
+	Id nodeId = m_nextId++;
+	m_nodeIdIndex.emplace(nodeId, m_nodes.insert(nodeData, StorageNode(nodeId, nodeData)).first);
+	return std::make_pair(nodeId, true);
+#else
+	auto it = m_nodesIndex.find(nodeData.serializedName);
 	if (it != m_nodesIndex.end())
 	{
 		StorageNode& storedNode = m_nodes[it->second];
@@ -131,9 +152,10 @@ std::pair<Id, bool> IntermediateStorage::addNode(const StorageNodeData& nodeData
 
 	Id nodeId = m_nextId++;
 	m_nodes.emplace_back(nodeId, nodeData);
-	m_nodesIndex.emplace(nodeData, m_nodes.size() - 1);
+	m_nodesIndex.emplace(nodeData.serializedName, m_nodes.size() - 1);
 	m_nodeIdIndex.emplace(nodeId, m_nodes.size() - 1);
 	return std::make_pair(nodeId, true);
+#endif
 }
 
 std::vector<Id> IntermediateStorage::addNodes(const std::vector<StorageNode>& nodes)
@@ -168,10 +190,17 @@ void IntermediateStorage::addSymbols(const std::vector<StorageSymbol>& symbols)
 
 void IntermediateStorage::addFile(const StorageFile& file)
 {
-	auto it = m_filesIndex.find(file);
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	const size_t index = m_files.find(file);
+	if (index != m_files.npos)
+	{
+		StorageFile& storedFile = m_files[index];
+#else
+	auto it = m_filesIndex.find(file.filePath);
 	if (it != m_filesIndex.end())
 	{
 		StorageFile& storedFile = m_files[it->second];
+#endif
 
 		if (file.indexed)
 		{
@@ -190,9 +219,13 @@ void IntermediateStorage::addFile(const StorageFile& file)
 	}
 	else
 	{
-		m_filesIndex.emplace(file, m_files.size());
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+		m_filesIdIndex.emplace(file.id, m_files.insert(file).first);
+#else
+		m_filesIndex.emplace(file.filePath, m_files.size());
 		m_filesIdIndex.emplace(file.id, m_files.size());
 		m_files.emplace_back(file);
+#endif
 	}
 }
 
@@ -207,6 +240,17 @@ void IntermediateStorage::setFileLanguage(Id fileId, const std::wstring& languag
 
 Id IntermediateStorage::addEdge(const StorageEdgeData& edgeData)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	const size_t index = m_edges.find(edgeData);
+	if (index != m_edges.npos)
+	{
+		return m_edges[index].id;
+	}
+
+	Id edgeId = m_nextId++;
+	m_edges.insert(edgeData, StorageEdge(edgeId, edgeData));
+	return edgeId;
+#else
 	auto it = m_edgesIndex.find(edgeData);
 	if (it != m_edgesIndex.end())
 	{
@@ -217,6 +261,7 @@ Id IntermediateStorage::addEdge(const StorageEdgeData& edgeData)
 	m_edges.emplace_back(edgeId, edgeData);
 	m_edgesIndex.emplace(edgeData, m_edges.size() - 1);
 	return edgeId;
+#endif
 }
 
 std::vector<Id> IntermediateStorage::addEdges(const std::vector<StorageEdge>& edges)
@@ -232,6 +277,17 @@ std::vector<Id> IntermediateStorage::addEdges(const std::vector<StorageEdge>& ed
 
 Id IntermediateStorage::addLocalSymbol(const StorageLocalSymbolData& localSymbolData)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	const size_t index = m_localSymbols.find(localSymbolData);
+	if (index != m_localSymbols.npos)
+	{
+		return m_localSymbols[index].id;
+	}
+
+	Id localSymbolId = m_nextId++;
+	m_localSymbols.insert(localSymbolData, StorageLocalSymbol(localSymbolId, localSymbolData));
+	return localSymbolId;
+#else
 	auto it = m_localSymbols.find(StorageLocalSymbol(0, localSymbolData));
 	if (it != m_localSymbols.end())
 	{
@@ -241,6 +297,7 @@ Id IntermediateStorage::addLocalSymbol(const StorageLocalSymbolData& localSymbol
 	Id localSymbolId = m_nextId++;
 	m_localSymbols.emplace(localSymbolId, localSymbolData);
 	return localSymbolId;
+#endif
 }
 
 std::vector<Id> IntermediateStorage::addLocalSymbols(const std::set<StorageLocalSymbol>& symbols)
@@ -256,6 +313,18 @@ std::vector<Id> IntermediateStorage::addLocalSymbols(const std::set<StorageLocal
 
 Id IntermediateStorage::addSourceLocation(const StorageSourceLocationData& sourceLocationData)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	const size_t index = m_sourceLocations.find(sourceLocationData);
+	if (index != m_sourceLocations.npos)
+	{
+		return m_sourceLocations[index].id;
+	}
+
+	Id sourceLocationId = m_nextId++;
+	m_sourceLocations.insert(
+		sourceLocationData, StorageSourceLocation(sourceLocationId, sourceLocationData));
+	return sourceLocationId;
+#else
 	auto it = m_sourceLocations.find(StorageSourceLocation(0, sourceLocationData));
 	if (it != m_sourceLocations.end())
 	{
@@ -265,6 +334,7 @@ Id IntermediateStorage::addSourceLocation(const StorageSourceLocationData& sourc
 	Id sourceLocationId = m_nextId++;
 	m_sourceLocations.emplace(sourceLocationId, sourceLocationData);
 	return sourceLocationId;
+#endif
 }
 
 std::vector<Id> IntermediateStorage::addSourceLocations(const std::vector<StorageSourceLocation>& locations)
@@ -280,32 +350,53 @@ std::vector<Id> IntermediateStorage::addSourceLocations(const std::vector<Storag
 
 void IntermediateStorage::addOccurrence(const StorageOccurrence& occurrence)
 {
-	m_occurrences.emplace(occurrence);
+	m_occurrences.insert(occurrence);
 }
 
 void IntermediateStorage::addOccurrences(const std::vector<StorageOccurrence>& occurrences)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	for (const StorageOccurrence& occurrence: occurrences)
+	{
+		m_occurrences.insert(occurrence);
+	}
+#else
 	m_occurrences.insert(occurrences.begin(), occurrences.end());
+#endif
 }
 
 void IntermediateStorage::addComponentAccess(const StorageComponentAccess& componentAccess)
 {
-	m_componentAccesses.emplace(componentAccess);
+	m_componentAccesses.insert(componentAccess);
 }
 
 void IntermediateStorage::addComponentAccesses(const std::vector<StorageComponentAccess>& componentAccesses)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	for (const StorageComponentAccess& componentAccess: componentAccesses)
+	{
+		m_componentAccesses.insert(componentAccess);
+	}
+#else
 	m_componentAccesses.insert(componentAccesses.begin(), componentAccesses.end());
+#endif
 }
 
 void IntermediateStorage::addElementComponent(const StorageElementComponent& component)
 {
-	m_elementComponents.emplace(component);
+	m_elementComponents.insert(component);
 }
 
 void IntermediateStorage::addElementComponents(const std::vector<StorageElementComponent>& components)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	for (const StorageElementComponent& component: components)
+	{
+		m_elementComponents.insert(component);
+	}
+#else
 	m_elementComponents.insert(components.begin(), components.end());
+#endif
 }
 
 Id IntermediateStorage::addError(const StorageErrorData& errorData)
@@ -324,12 +415,20 @@ Id IntermediateStorage::addError(const StorageErrorData& errorData)
 
 const std::vector<StorageNode>& IntermediateStorage::getStorageNodes() const
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	return m_nodes.getValues();
+#else
 	return m_nodes;
+#endif
 }
 
 const std::vector<StorageFile>& IntermediateStorage::getStorageFiles() const
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	return m_files.getValues();
+#else
 	return m_files;
+#endif
 }
 
 const std::vector<StorageSymbol>& IntermediateStorage::getStorageSymbols() const
@@ -339,32 +438,56 @@ const std::vector<StorageSymbol>& IntermediateStorage::getStorageSymbols() const
 
 const std::vector<StorageEdge>& IntermediateStorage::getStorageEdges() const
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	return m_edges.getValues();
+#else
 	return m_edges;
+#endif
 }
 
 const std::set<StorageLocalSymbol>& IntermediateStorage::getStorageLocalSymbols() const
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	return m_localSymbols.getOrderedSet();
+#else
 	return m_localSymbols;
+#endif
 }
 
 const std::set<StorageSourceLocation>& IntermediateStorage::getStorageSourceLocations() const
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	return m_sourceLocations.getOrderedSet();
+#else
 	return m_sourceLocations;
+#endif
 }
 
 const std::set<StorageOccurrence>& IntermediateStorage::getStorageOccurrences() const
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	return m_occurrences.getOrderedSet();
+#else
 	return m_occurrences;
+#endif
 }
 
 const std::set<StorageComponentAccess>& IntermediateStorage::getComponentAccesses() const
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	return m_componentAccesses.getOrderedSet();
+#else
 	return m_componentAccesses;
+#endif
 }
 
 const std::set<StorageElementComponent>& IntermediateStorage::getElementComponents() const
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	return m_elementComponents.getOrderedSet();
+#else
 	return m_elementComponents;
+#endif
 }
 
 const std::vector<StorageError>& IntermediateStorage::getErrors() const
@@ -374,28 +497,51 @@ const std::vector<StorageError>& IntermediateStorage::getErrors() const
 
 void IntermediateStorage::setStorageNodes(std::vector<StorageNode> storageNodes)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	m_nodes.assign(storageNodes.begin(), storageNodes.end());
+
+	m_nodeIdIndex.clear();
+	m_nodeIdIndex.reserve(m_nodes.size());
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		m_nodeIdIndex.emplace(m_nodes[i].id, i);
+	}
+#else
 	m_nodes = std::move(storageNodes);
 
 	m_nodesIndex.clear();
 	m_nodeIdIndex.clear();
+	m_nodesIndex.reserve(m_nodes.size());
+	m_nodeIdIndex.reserve(m_nodes.size());
 	for (size_t i = 0; i < m_nodes.size(); i++)
 	{
-		m_nodesIndex.emplace(m_nodes[i], i);
+		m_nodesIndex.emplace(m_nodes[i].serializedName, i);
 		m_nodeIdIndex.emplace(m_nodes[i].id, i);
 	}
+#endif
 }
 
 void IntermediateStorage::setStorageFiles(std::vector<StorageFile> storageFiles)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	m_files.assign(storageFiles.begin(), storageFiles.end());
+
+	m_filesIdIndex.clear();
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		m_filesIdIndex.emplace(m_files[i].id, i);
+	}
+#else
 	m_files = std::move(storageFiles);
 
 	m_filesIndex.clear();
 	m_filesIdIndex.clear();
 	for (size_t i = 0; i < m_files.size(); i++)
 	{
-		m_filesIndex.emplace(m_files[i], i);
+		m_filesIndex.emplace(m_files[i].filePath, i);
 		m_filesIdIndex.emplace(m_files[i].id, i);
 	}
+#endif
 }
 
 void IntermediateStorage::setStorageSymbols(std::vector<StorageSymbol> storageSymbols)
@@ -405,38 +551,63 @@ void IntermediateStorage::setStorageSymbols(std::vector<StorageSymbol> storageSy
 
 void IntermediateStorage::setStorageEdges(std::vector<StorageEdge> storageEdges)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	m_edges.assign(storageEdges.begin(), storageEdges.end());
+#else
 	m_edges = std::move(storageEdges);
 
 	m_edgesIndex.clear();
+	m_edgesIndex.reserve(m_edges.size());
 	for (size_t i = 0; i < m_edges.size(); i++)
 	{
 		m_edgesIndex.emplace(m_edges[i], i);
 	}
+#endif
 }
 
 void IntermediateStorage::setStorageLocalSymbols(std::set<StorageLocalSymbol> storageLocalSymbols)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	m_localSymbols.assign(storageLocalSymbols.begin(), storageLocalSymbols.end());
+#else
 	m_localSymbols = std::move(storageLocalSymbols);
+#endif
 }
 
 void IntermediateStorage::setStorageSourceLocations(std::set<StorageSourceLocation> storageSourceLocations)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	m_sourceLocations.assign(storageSourceLocations.begin(), storageSourceLocations.end());
+#else
 	m_sourceLocations = std::move(storageSourceLocations);
+#endif
 }
 
 void IntermediateStorage::setStorageOccurrences(std::set<StorageOccurrence> storageOccurrences)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	m_occurrences.assign(storageOccurrences.begin(), storageOccurrences.end());
+#else
 	m_occurrences = std::move(storageOccurrences);
+#endif
 }
 
 void IntermediateStorage::setComponentAccesses(std::set<StorageComponentAccess> componentAccesses)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	m_componentAccesses.assign(componentAccesses.begin(), componentAccesses.end());
+#else
 	m_componentAccesses = std::move(componentAccesses);
+#endif
 }
 
 void IntermediateStorage::setElementComponents(std::set<StorageElementComponent> components)
 {
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	m_elementComponents.assign(components.begin(), components.end());
+#else
 	m_elementComponents = std::move(components);
+#endif
 }
 
 void IntermediateStorage::setErrors(std::vector<StorageError> errors)
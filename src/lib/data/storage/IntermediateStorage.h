@@ -4,8 +4,14 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 
 #include "Storage.h"
+#include "build_options.h"
+
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+#	include "OpenHashSet.h"
+#endif
 
 class IntermediateStorage: public Storage
 {
@@ -68,17 +74,40 @@ public:
 	void setNextId(const Id nextId);
 
 private:
-	std::map<StorageNodeData, size_t> m_nodesIndex;
-	std::map<Id, size_t> m_nodeIdIndex;
+#if BUILD_HASHED_INTERMEDIATE_STORAGE
+	// records are kept contiguously in insertion order and only referenced by position from the
+	// hash tables, ordered sets are created on demand when the data is read through Storage
+	OpenHashSet<StorageNode, StorageNodeDataHash> m_nodes;
+	std::unordered_map<Id, size_t> m_nodeIdIndex;
+
+	OpenHashSet<StorageFile, StorageFileHash> m_files;
+	std::unordered_map<Id, size_t> m_filesIdIndex;
+
+	std::vector<StorageSymbol> m_symbols;
+
+	OpenHashSet<StorageEdge, StorageEdgeDataHash> m_edges;
+
+	OpenHashSet<StorageLocalSymbol, StorageLocalSymbolDataHash> m_localSymbols;
+
+	OpenHashSet<StorageSourceLocation, StorageSourceLocationDataHash> m_sourceLocations;
+
+	OpenHashSet<StorageOccurrence, StorageOccurrenceHash> m_occurrences;
+
+	OpenHashSet<StorageComponentAccess, StorageComponentAccessHash> m_componentAccesses;
+	OpenHashSet<StorageElementComponent, StorageElementComponentHash> m_elementComponents;
+#else
+	// nodes and files are unique by their serialized name and path, so only these are hashed
+	std::unordered_map<std::wstring, size_t> m_nodesIndex;
+	std::unordered_map<Id, size_t> m_nodeIdIndex;
 	std::vector<StorageNode> m_nodes;
 
-	std::map<StorageFile, size_t> m_filesIndex;	   // this is used to prevent duplicates (unique)
-	std::map<Id, size_t> m_filesIdIndex;
+	std::unordered_map<std::wstring, size_t> m_filesIndex;	  // this is used to prevent duplicates (unique)
+	std::unordered_map<Id, size_t> m_filesIdIndex;
 	std::vector<StorageFile> m_files;
 
 	std::vector<StorageSymbol> m_symbols;
 
-	std::map<StorageEdgeData, size_t> m_edgesIndex;
+	std::unordered_map<StorageEdgeData, size_t, StorageEdgeDataHash> m_edgesIndex;
 	std::vector<StorageEdge> m_edges;
 
 	std::set<StorageLocalSymbol> m_localSymbols;
@@ -89,6 +118,7 @@ private:
 
 	std::set<StorageComponentAccess> m_componentAccesses;
 	std::set<StorageElementComponent> m_elementComponents;
+#endif
 
 	std::map<StorageErrorData, size_t> m_errorsIndex;	 // this is used to prevent duplicates (unique)
 	std::vector<StorageError> m_errors;
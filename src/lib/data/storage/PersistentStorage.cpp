@@ -1,7 +1,10 @@
 #include "PersistentStorage.h"
 
+#include <algorithm>
 #include <queue>
 #include <sstream>
+#include <tuple>
+#include <unordered_set>
 
 #include "AccessKind.h"
 #include "ApplicationSettings.h"
@@ -15,6 +18,7 @@
 #include "ParseLocation.h"
 #include "SourceLocationCollection.h"
 #include "SourceLocationFile.h"
+#include "SourceLocationIntervalIndex.h"
 #include "TextAccess.h"
 #include "TextCodec.h"
 #include "TimeStamp.h"
@@ -28,9 +32,12 @@
 #include "tracing.h"
 #include "utility.h"
 #include "utilityApp.h"
+#include "utilityHash.h"
 
 PersistentStorage::PersistentStorage(const FilePath& dbPath, const FilePath& bookmarkPath)
-	: m_sqliteIndexStorage(dbPath), m_sqliteBookmarkStorage(bookmarkPath)
+	: m_sqliteIndexStorage(dbPath)
+	, m_sqliteBookmarkStorage(bookmarkPath)
+	, m_threadPool(utility::getIdealThreadCount())
 {
 	m_commandIndex.addNode(0, SearchMatch::getCommandName(SearchMatch::COMMAND_ALL));
 	m_commandIndex.addNode(0, SearchMatch::getCommandName(SearchMatch::COMMAND_ERROR));
@@ -260,6 +267,33 @@ void PersistentStorage::rollbackInjection()
 	afterErrorRecording();
 }
 
+bool PersistentStorage::startRefreshTransaction()
+{
+	// readers don't get blocked by the writer, when the database has a write ahead log
+	if (!m_sqliteIndexStorage.setWriteAheadLogging(true))
+	{
+		return false;
+	}
+
+	m_sqliteIndexStorage.beginTransaction();
+	return true;
+}
+
+void PersistentStorage::commitRefreshTransaction()
+{
+	m_sqliteIndexStorage.commitTransaction();
+}
+
+void PersistentStorage::rollbackRefreshTransaction()
+{
+	m_sqliteIndexStorage.rollbackTransaction();
+}
+
+void PersistentStorage::disableWriteAheadLogging()
+{
+	m_sqliteIndexStorage.setWriteAheadLogging(false);
+}
+
 const std::vector<ErrorInfo> PersistentStorage::getErrorInfos() const
 {
 	return m_sqliteIndexStorage.getAllErrorInfos();
@@ -292,6 +326,7 @@ void PersistentStorage::afterErrorRecording()
 void PersistentStorage::setMode(const SqliteIndexStorage::StorageModeType mode)
 {
 	m_sqliteIndexStorage.setMode(mode);
+	m_isWriting = (mode != SqliteIndexStorage::STORAGE_MODE_READ);
 }
 
 FilePath PersistentStorage::getIndexDbFilePath() const
@@ -324,6 +359,31 @@ void PersistentStorage::setProjectSettingsText(std::string text)
 	m_sqliteIndexStorage.setProjectSettingsText(text);
 }
 
+std::map<FilePath, size_t> PersistentStorage::getIndexTimes() const
+{
+	return m_sqliteIndexStorage.getIndexTimes();
+}
+
+void PersistentStorage::setIndexTimes(const std::map<FilePath, size_t>& indexTimes)
+{
+	m_sqliteIndexStorage.setIndexTimes(indexTimes);
+}
+
+void PersistentStorage::setFilesIncomplete(const std::vector<FilePath>& filePaths)
+{
+	m_sqliteIndexStorage.setFilesIncomplete(filePaths);
+}
+
+void PersistentStorage::setNameInterningEnabled(bool enabled)
+{
+	m_sqliteIndexStorage.setNameInterningEnabled(enabled);
+}
+
+bool PersistentStorage::isNameInterningEnabled() const
+{
+	return m_sqliteIndexStorage.isNameInterningEnabled();
+}
+
 void PersistentStorage::setup()
 {
 	m_sqliteIndexStorage.setup();
@@ -332,6 +392,16 @@ void PersistentStorage::setup()
 	m_sqliteBookmarkStorage.migrateIfNecessary();
 }
 
+void PersistentStorage::setupCustomCommandStorage()
+{
+	m_sqliteIndexStorage.setupCustomCommandStorage();
+}
+
+void PersistentStorage::migrateCustomCommandStorage()
+{
+	m_sqliteIndexStorage.migrateCustomCommandStorage();
+}
+
 void PersistentStorage::updateVersion()
 {
 	m_sqliteIndexStorage.setVersion(m_sqliteIndexStorage.getStaticVersion());
@@ -350,7 +420,11 @@ void PersistentStorage::clear()
 
 void PersistentStorage::clearCaches()
 {
-	m_symbolIndex.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_symbolIndexMutex);
+		m_symbolIndex.clear();
+		m_symbolIndexLoaded = false;
+	}
 	m_fileIndex.clear();
 
 	m_fileNodeIds.clear();
@@ -362,8 +436,17 @@ void PersistentStorage::clearCaches()
 	m_symbolDefinitionKinds.clear();
 
 	m_hierarchyCache.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_adjacencyCacheMutex);
+		m_adjacencyCache.clear();
+		m_adjacencyCacheLoaded = false;
+	}
 	m_fullTextSearchIndex.clear();
 	m_fullTextSearchCodec = "";
+	{
+		std::lock_guard<std::mutex> lock(m_sourceLocationIntervalIndicesMutex);
+		m_sourceLocationIntervalIndices.clear();
+	}
 }
 
 std::set<FilePath> PersistentStorage::getReferenced(const std::set<FilePath>& filePaths) const
@@ -469,7 +552,7 @@ void PersistentStorage::buildCaches()
 	clearCaches();
 
 	buildFilePathMaps();
-	buildSearchIndex();
+	buildFileIndex();
 	buildMemberEdgeIdOrderMap();
 	buildHierarchyCache();
 }
@@ -484,6 +567,27 @@ void PersistentStorage::optimizeMemory()
 	m_sqliteBookmarkStorage.optimizeMemory();
 }
 
+void PersistentStorage::saveHierarchyCache() const
+{
+	TRACE();
+
+	const std::string key = getIndexFileKey();
+	if (key.empty())
+	{
+		return;
+	}
+
+	std::unordered_map<Id, DefinitionKind> definitionKinds;
+	m_sqliteIndexStorage.forEach<StorageSymbol>([&definitionKinds](StorageSymbol&& symbol) {
+		definitionKinds.emplace(symbol.id, intToDefinitionKind(symbol.definitionKind));
+	});
+
+	HierarchyCache cache;
+	addEdgesToHierarchyCache(&cache, definitionKinds);
+	cache.finishSetup();
+	cache.save(getHierarchyCacheFilePath(), key);
+}
+
 Id PersistentStorage::getNodeIdForFileNode(const FilePath& filePath) const
 {
 	return getFileNodeId(filePath);
@@ -587,7 +691,9 @@ StorageEdge PersistentStorage::getEdgeById(Id edgeId) const
 }
 
 std::shared_ptr<SourceLocationCollection> PersistentStorage::getFullTextSearchLocations(
-	const std::wstring& searchTerm, bool caseSensitive) const
+	const std::wstring& searchTerm,
+	bool caseSensitive,
+	const FullTextSearchBatchCallback& onBatch) const
 {
 	TRACE();
 
@@ -616,85 +722,75 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getFullTextSearchLo
 		true)
 		.dispatch();
 
-	{
-		std::vector<std::shared_ptr<std::thread>> threads;
-		std::mutex collectionMutex;
-		for (std::vector<FullTextSearchResult> fileResults: utility::splitToEquallySizedParts(
-				 m_fullTextSearchIndex.searchForTerm(searchTerm), utility::getIdealThreadCount()))
-		{
-			std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
-				[this,
-				 &searchTerm,
-				 &caseSensitive,
-				 &codec,
-				 /*no ref here!*/ fileResults,
-				 &collection,
-				 &collectionMutex]() {
-					const int termLength = static_cast<int>(searchTerm.length());
-					for (const FullTextSearchResult& fileResult: fileResults)
-					{
-						const FilePath filePath = getFileNodePath(fileResult.fileId);
-						std::shared_ptr<TextAccess> fileContent = getFileContent(filePath, false);
-
-						int charsTotal = 0;
-						int lineNumber = 1;
-						std::wstring line = codec.decode(fileContent->getLine(lineNumber));
-
-						for (int pos: fileResult.positions)
-						{
-							while (charsTotal + (int)line.length() <= pos)
-							{
-								charsTotal += static_cast<int>(line.length());
-								lineNumber++;
-								line = codec.decode(fileContent->getLine(lineNumber));
-							}
+	const std::vector<FullTextSearchResult> results = m_fullTextSearchIndex.searchForTerm(
+		searchTerm);
+	const size_t termLength = searchTerm.length();
+	size_t locationCount = 0;
 
-							ParseLocation location;
-							location.startLineNumber = lineNumber;
-							location.startColumnNumber = pos - charsTotal + 1;
+	// results are ranked, so they are resolved in growing batches to show the best files early
+	size_t batchStart = 0;
+	size_t batchSize = 8;
+	while (batchStart < results.size())
+	{
+		const size_t batchEnd = std::min(batchStart + batchSize, results.size());
 
-							if (caseSensitive &&
-								line.substr(location.startColumnNumber - 1, termLength) != searchTerm)
-							{
-								continue;
-							}
-							while ((charsTotal + (int)line.length()) < pos + termLength)
-							{
-								charsTotal += static_cast<int>(line.length());
-								lineNumber++;
-								line = codec.decode(fileContent->getLine(lineNumber));
-							}
-							location.endLineNumber = lineNumber;
-							location.endColumnNumber = pos + termLength - charsTotal;
+		// the index only knows the lowercase text, each file is checked into its own buffer
+		std::vector<std::vector<FullTextSearchMatch>> caseSensitiveMatches;
+		if (caseSensitive)
+		{
+			caseSensitiveMatches.resize(batchEnd - batchStart);
+			m_threadPool.parallelFor(caseSensitiveMatches.size(), [&](size_t i) {
+				const FullTextSearchResult& fileResult = results[batchStart + i];
+				const std::wstring text = codec.decode(
+					getFileContent(FilePath(fileResult.filePath), false)->getText());
 
-							{
-								std::lock_guard<std::mutex> lock(collectionMutex);
-								// Set first bit to 1 to avoid collisions
-								const Id locationId = ~(~Id(0) >> 1) +
-									collection->getSourceLocationCount() + 1;
-								collection->addSourceLocation(
-									LOCATION_FULLTEXT_SEARCH,
-									locationId,
-									std::vector<Id>(),
-									filePath,
-									location.startLineNumber,
-									location.startColumnNumber,
-									location.endLineNumber,
-									location.endColumnNumber);
-							}
-						}
+				for (const FullTextSearchMatch& match: fileResult.matches)
+				{
+					if (match.position + termLength <= text.size() &&
+						text.compare(match.position, termLength, searchTerm) == 0)
+					{
+						caseSensitiveMatches[i].push_back(match);
 					}
-				});
-			threads.push_back(thread);
+				}
+			});
 		}
 
-		for (std::shared_ptr<std::thread> thread: threads)
+		std::shared_ptr<SourceLocationCollection> batchCollection =
+			std::make_shared<SourceLocationCollection>();
+		for (size_t i = batchStart; i < batchEnd; i++)
 		{
-			thread->join();
+			const FilePath filePath(results[i].filePath);
+			for (const FullTextSearchMatch& match:
+				 caseSensitive ? caseSensitiveMatches[i - batchStart] : results[i].matches)
+			{
+				// Set first bit to 1 to avoid collisions
+				const Id locationId = ~(~Id(0) >> 1) + (++locationCount);
+				batchCollection->addSourceLocation(
+					LOCATION_FULLTEXT_SEARCH,
+					locationId,
+					std::vector<Id>(),
+					filePath,
+					match.startLineNumber,
+					match.startColumnNumber,
+					match.endLineNumber,
+					match.endColumnNumber);
+			}
 		}
-	}
 
-	addCompleteFlagsToSourceLocationCollection(collection.get());
+		addCompleteFlagsToSourceLocationCollection(batchCollection.get());
+		batchCollection->forEachSourceLocationFile(
+			[&collection](std::shared_ptr<SourceLocationFile> file) {
+				collection->addSourceLocationFile(file);
+			});
+
+		if (onBatch && batchCollection->getSourceLocationFileCount())
+		{
+			onBatch(batchCollection);
+		}
+
+		batchStart = batchEnd;
+		batchSize = std::min(batchSize * 2, size_t(1024));
+	}
 
 	MessageStatus(
 		std::to_wstring(collection->getSourceLocationCount()) + L" results in " +
@@ -810,8 +906,13 @@ std::vector<SearchMatch> PersistentStorage::getAutocompletionSymbolMatches(
 	size_t maxBestScoredResultsLength) const
 {
 	// search in indices
-	const std::vector<SearchResult> results = m_symbolIndex.search(
-		query, acceptedNodeTypes, maxResultsCount, maxBestScoredResultsLength);
+	std::vector<SearchResult> results;
+	{
+		std::lock_guard<std::mutex> lock(m_symbolIndexMutex);
+		loadSymbolIndex();
+		results = m_symbolIndex.search(
+			query, acceptedNodeTypes, maxResultsCount, maxBestScoredResultsLength);
+	}
 
 	// fetch StorageNodes for node ids
 	std::map<Id, StorageNode> storageNodeMap;
@@ -1289,10 +1390,17 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(
 	Edge::TypeMask edgeTypes,
 	bool nodeNonIndexed,
 	size_t depth,
-	bool directed) const
+	bool directed,
+	bool shortestPath) const
 {
 	TRACE();
 
+	if (shortestPath && originId && targetId)
+	{
+		return getGraphForShortestTrail(
+			originId, targetId, nodeTypes, edgeTypes, nodeNonIndexed, depth, directed);
+	}
+
 	std::set<Id> nodeIds;
 	std::set<Id> edgeIds;
 
@@ -1319,18 +1427,25 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(
 		trailNodes.emplace(originId, root);
 	}
 
+	// the adjacency cache answers all edge and node kind lookups of the traversal in memory, the
+	// database is only queried when it is disabled
+	const bool useAdjacencyCache =
+		ApplicationSettings::getInstance()->getGraphAdjacencyCacheEnabled();
+	std::unique_lock<std::mutex> adjacencyCacheLock(m_adjacencyCacheMutex, std::defer_lock);
+	if (useAdjacencyCache)
+	{
+		adjacencyCacheLock.lock();
+		loadAdjacencyCache();
+	}
+
 	while (nodeIdsToProcess.size() && (!depth || currentDepth < depth))
 	{
-		std::vector<StorageEdge> edges = forward
-			? m_sqliteIndexStorage.getEdgesBySourceIds(nodeIdsToProcess)
-			: m_sqliteIndexStorage.getEdgesByTargetIds(nodeIdsToProcess);
+		std::vector<StorageEdge> edges =
+			getTrailEdges(nodeIdsToProcess, forward, useAdjacencyCache);
 
 		if (!directed || edgeTypes & Edge::LAYOUT_VERTICAL)
 		{
-			utility::append(
-				edges,
-				forward ? m_sqliteIndexStorage.getEdgesByTargetIds(nodeIdsToProcess)
-						: m_sqliteIndexStorage.getEdgesBySourceIds(nodeIdsToProcess));
+			utility::append(edges, getTrailEdges(nodeIdsToProcess, !forward, useAdjacencyCache));
 		}
 
 		std::vector<Id> nodeIdsToCheck;
@@ -1379,38 +1494,19 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(
 
 		if (nodeTypes != 0)
 		{
-			for (const StorageNode& node:
-				 m_sqliteIndexStorage.getAllByIds<StorageNode>(nodeIdsToCheck))
+			for (const std::pair<Id, NodeKind>& node:
+				 getTrailNodeKinds(nodeIdsToCheck, useAdjacencyCache))
 			{
-				NodeKind kind = intToNodeKind(node.type);
-				if (kind & nodeTypes || (kind == NODE_SYMBOL && nodeNonIndexed))
+				const Id nodeId = node.first;
+				const NodeKind kind = node.second;
+				if (isTrailNode(nodeId, kind, nodeTypes, nodeNonIndexed))
 				{
-					if (!nodeNonIndexed)
-					{
-						if (kind == NODE_FILE)
-						{
-							auto it = m_fileNodeIndexed.find(node.id);
-							if (it == m_fileNodeIndexed.end() || !it->second)
-							{
-								continue;
-							}
-						}
-						else
-						{
-							auto it = m_symbolDefinitionKinds.find(node.id);
-							if (it == m_symbolDefinitionKinds.end() || it->second == DEFINITION_NONE)
-							{
-								continue;
-							}
-						}
-					}
-
 					// FIXME: don't add namespace nodes to the graph, because it destroys trail
 					// layouting Remove when namespaces are proper nodes with children
 					if ((kind & (NODE_MODULE | NODE_NAMESPACE | NODE_PACKAGE)) == 0)
 					{
-						nodeIds.insert(node.id);
-						for (const StorageEdge& edge: edgesToInsert[node.id])
+						nodeIds.insert(nodeId);
+						for (const StorageEdge& edge: edgesToInsert[nodeId])
 						{
 							if ((Edge::intToType(edge.type) & Edge::EDGE_MEMBER) == 0)
 							{
@@ -1418,20 +1514,20 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(
 							}
 						}
 					}
-					nodeIdsToProcess.push_back(node.id);
+					nodeIdsToProcess.push_back(nodeId);
 
 					if (isTerminatedTrail)
 					{
-						TrailNode& targetNode = trailNodes[node.id];
-						targetNode.id = node.id;
+						TrailNode& targetNode = trailNodes[nodeId];
+						targetNode.id = nodeId;
 
-						for (const StorageEdge& edge: edgesToInsert[node.id])
+						for (const StorageEdge& edge: edgesToInsert[nodeId])
 						{
 							targetNode.edgeIds.insert(edge.id);
 
 							Id sourceNodeId =
-								(edge.targetNodeId == node.id ? edge.sourceNodeId
-															  : edge.targetNodeId);
+								(edge.targetNodeId == nodeId ? edge.sourceNodeId
+															 : edge.targetNodeId);
 							TrailNode& oldNode = trailNodes[sourceNodeId];
 							targetNode.parents.insert(&oldNode);
 						}
@@ -1503,6 +1599,297 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(
 	return graph;
 }
 
+std::shared_ptr<Graph> PersistentStorage::getGraphForShortestTrail(
+	Id originId,
+	Id targetId,
+	NodeKindMask nodeTypes,
+	Edge::TypeMask edgeTypes,
+	bool nodeNonIndexed,
+	size_t depth,
+	bool directed) const
+{
+	TRACE();
+
+	const bool useAdjacencyCache =
+		ApplicationSettings::getInstance()->getGraphAdjacencyCacheEnabled();
+	std::unique_lock<std::mutex> adjacencyCacheLock(m_adjacencyCacheMutex, std::defer_lock);
+	if (useAdjacencyCache)
+	{
+		adjacencyCacheLock.lock();
+		loadAdjacencyCache();
+	}
+
+	// breadth first search from both ends, the origin side follows the trail direction and the
+	// target side goes against it. each node keeps all edges it was reached by on its level.
+	struct TrailSide
+	{
+		bool forward;
+		size_t depth = 0;
+		std::vector<Id> frontier;
+		std::unordered_map<Id, size_t> depths;
+		std::unordered_map<Id, std::vector<std::pair</*node*/ Id, /*edge*/ Id>>> parents;
+	};
+
+	TrailSide originSide;
+	originSide.forward = true;
+	originSide.frontier = {originId};
+	originSide.depths.emplace(originId, 0);
+
+	TrailSide targetSide;
+	targetSide.forward = false;
+	targetSide.frontier = {targetId};
+	targetSide.depths.emplace(targetId, 0);
+
+	// the trail does not show member edges if node types are filtered, like the other trails
+	std::set<Id> memberEdgeIds;
+
+	std::vector<Id> meetingNodeIds;
+	if (originId == targetId)
+	{
+		meetingNodeIds.push_back(originId);
+	}
+
+	// stops at the first level where both sides meet, so only shortest trails are found
+	while (meetingNodeIds.empty() && originSide.frontier.size() && targetSide.frontier.size() &&
+		   (!depth || originSide.depth + targetSide.depth < depth))
+	{
+		const bool expandOrigin = originSide.frontier.size() <= targetSide.frontier.size();
+		TrailSide& side = expandOrigin ? originSide : targetSide;
+		const TrailSide& otherSide = expandOrigin ? targetSide : originSide;
+
+		std::vector<StorageEdge> edges =
+			getTrailEdges(side.frontier, side.forward, useAdjacencyCache);
+		if (!directed || edgeTypes & Edge::LAYOUT_VERTICAL)
+		{
+			utility::append(edges, getTrailEdges(side.frontier, !side.forward, useAdjacencyCache));
+		}
+
+		std::vector<Id> nodeIdsToCheck;
+		std::map<Id, std::vector<std::pair<Id, Id>>> parentsToInsert;
+
+		auto addNeighbor = [&](Id nodeId, Id neighborId, Id edgeId) {
+			auto it = side.depths.find(nodeId);
+			if (it == side.depths.end() || it->second != side.depth)
+			{
+				return;
+			}
+
+			it = side.depths.find(neighborId);
+			if (it == side.depths.end())
+			{
+				std::vector<std::pair<Id, Id>>& parents = parentsToInsert[neighborId];
+				if (parents.empty())
+				{
+					nodeIdsToCheck.push_back(neighborId);
+				}
+				parents.emplace_back(nodeId, edgeId);
+			}
+		};
+
+		for (const StorageEdge& edge: edges)
+		{
+			const Edge::EdgeType type = Edge::intToType(edge.type);
+			if ((type & edgeTypes) == 0 || edge.sourceNodeId == edge.targetNodeId)
+			{
+				continue;
+			}
+			if (nodeTypes != 0 && (type & Edge::EDGE_MEMBER))
+			{
+				memberEdgeIds.insert(edge.id);
+			}
+
+			// vertical edges are followed from target to source
+			const bool isVertical = type & Edge::LAYOUT_VERTICAL;
+			const Id tailId = isVertical ? edge.targetNodeId : edge.sourceNodeId;
+			const Id headId = isVertical ? edge.sourceNodeId : edge.targetNodeId;
+
+			const Id fromId = side.forward ? tailId : headId;
+			const Id toId = side.forward ? headId : tailId;
+
+			addNeighbor(fromId, toId, edge.id);
+			if (!directed)
+			{
+				addNeighbor(toId, fromId, edge.id);
+			}
+		}
+
+		std::vector<Id> nodeIdsToInsert;
+		if (nodeTypes != 0)
+		{
+			// the ends of the trail are always allowed
+			for (const std::pair<Id, NodeKind>& node:
+				 getTrailNodeKinds(nodeIdsToCheck, useAdjacencyCache))
+			{
+				if (node.first == originId || node.first == targetId ||
+					isTrailNode(node.first, node.second, nodeTypes, nodeNonIndexed))
+				{
+					nodeIdsToInsert.push_back(node.first);
+				}
+			}
+		}
+		else
+		{
+			nodeIdsToInsert = nodeIdsToCheck;
+		}
+
+		side.depth++;
+		side.frontier.clear();
+
+		for (const Id nodeId: nodeIdsToInsert)
+		{
+			side.depths.emplace(nodeId, side.depth);
+			side.parents.emplace(nodeId, std::move(parentsToInsert[nodeId]));
+			side.frontier.push_back(nodeId);
+
+			if (otherSide.depths.find(nodeId) != otherSide.depths.end())
+			{
+				meetingNodeIds.push_back(nodeId);
+			}
+		}
+	}
+
+	std::set<Id> nodeIds;
+	std::set<Id> edgeIds;
+
+	if (meetingNodeIds.size())
+	{
+		std::map</*edge*/ Id, std::pair</*node*/ Id, /*parent*/ Id>> trailEdges;
+
+		// the trails through all meeting nodes have the same length, so they are all collected by
+		// following the parents back to both ends
+		for (const TrailSide* side: {&originSide, &targetSide})
+		{
+			std::set<Id> processedNodeIds;
+			std::vector<Id> nodeIdsToProcess = meetingNodeIds;
+
+			while (nodeIdsToProcess.size())
+			{
+				const Id nodeId = nodeIdsToProcess.back();
+				nodeIdsToProcess.pop_back();
+
+				if (!processedNodeIds.insert(nodeId).second)
+				{
+					continue;
+				}
+
+				nodeIds.insert(nodeId);
+
+				auto it = side->parents.find(nodeId);
+				if (it != side->parents.end())
+				{
+					for (const std::pair<Id, Id>& parent: it->second)
+					{
+						trailEdges.emplace(parent.second, std::make_pair(nodeId, parent.first));
+						nodeIdsToProcess.push_back(parent.first);
+					}
+				}
+			}
+		}
+
+		// FIXME: don't add namespace nodes to the graph, because it destroys trail layouting.
+		// Remove when namespaces are proper nodes with children
+		std::set<Id> namespaceNodeIds;
+		if (nodeTypes != 0)
+		{
+			for (const std::pair<Id, NodeKind>& node:
+				 getTrailNodeKinds(utility::toVector(nodeIds), useAdjacencyCache))
+			{
+				if (node.first != originId && node.first != targetId &&
+					(node.second & (NODE_MODULE | NODE_NAMESPACE | NODE_PACKAGE)) != 0)
+				{
+					namespaceNodeIds.insert(node.first);
+					nodeIds.erase(node.first);
+				}
+			}
+		}
+
+		// edges of namespace nodes are dropped with them, so they don't add them to the graph again
+		for (const auto& trailEdge: trailEdges)
+		{
+			if (memberEdgeIds.find(trailEdge.first) == memberEdgeIds.end() &&
+				namespaceNodeIds.find(trailEdge.second.first) == namespaceNodeIds.end() &&
+				namespaceNodeIds.find(trailEdge.second.second) == namespaceNodeIds.end())
+			{
+				edgeIds.insert(trailEdge.first);
+			}
+		}
+	}
+	else
+	{
+		nodeIds.insert(originId);
+	}
+
+	std::shared_ptr<Graph> graph = std::make_shared<Graph>();
+
+	addNodesWithParentsAndEdgesToGraph(
+		utility::toVector(nodeIds), utility::toVector(edgeIds), graph.get(), false);
+	addComponentAccessToGraph(graph.get());
+	addComponentIsAmbiguousToGraph(graph.get());
+
+	return graph;
+}
+
+std::vector<StorageEdge> PersistentStorage::getTrailEdges(
+	const std::vector<Id>& nodeIds, bool bySource, bool useAdjacencyCache) const
+{
+	if (useAdjacencyCache)
+	{
+		return bySource ? m_adjacencyCache.getEdgesBySourceIds(nodeIds)
+						: m_adjacencyCache.getEdgesByTargetIds(nodeIds);
+	}
+
+	return bySource ? m_sqliteIndexStorage.getEdgesBySourceIds(nodeIds)
+					: m_sqliteIndexStorage.getEdgesByTargetIds(nodeIds);
+}
+
+std::vector<std::pair<Id, NodeKind>> PersistentStorage::getTrailNodeKinds(
+	const std::vector<Id>& nodeIds, bool useAdjacencyCache) const
+{
+	std::vector<std::pair<Id, NodeKind>> nodeKinds;
+	if (useAdjacencyCache)
+	{
+		for (const Id nodeId: utility::unique(nodeIds))
+		{
+			const int type = m_adjacencyCache.getNodeType(nodeId);
+			if (type != AdjacencyCache::s_unknownNodeType)
+			{
+				nodeKinds.emplace_back(nodeId, intToNodeKind(type));
+			}
+		}
+	}
+	else
+	{
+		for (const StorageNode& node: m_sqliteIndexStorage.getAllByIds<StorageNode>(nodeIds))
+		{
+			nodeKinds.emplace_back(node.id, intToNodeKind(node.type));
+		}
+	}
+	return nodeKinds;
+}
+
+bool PersistentStorage::isTrailNode(
+	Id nodeId, NodeKind kind, NodeKindMask nodeTypes, bool nodeNonIndexed) const
+{
+	if ((kind & nodeTypes) == 0 && (kind != NODE_SYMBOL || !nodeNonIndexed))
+	{
+		return false;
+	}
+
+	if (nodeNonIndexed)
+	{
+		return true;
+	}
+
+	if (kind == NODE_FILE)
+	{
+		auto it = m_fileNodeIndexed.find(nodeId);
+		return it != m_fileNodeIndexed.end() && it->second;
+	}
+
+	auto it = m_symbolDefinitionKinds.find(nodeId);
+	return it != m_symbolDefinitionKinds.end() && it->second != DEFINITION_NONE;
+}
+
 NodeKindMask PersistentStorage::getAvailableNodeTypes() const
 {
 	TRACE();
@@ -1756,6 +2143,39 @@ std::shared_ptr<SourceLocationFile> PersistentStorage::getSourceLocationsForLine
 {
 	TRACE();
 
+	// the code view and the ide plugins query the same files again and again
+	const Id fileId = m_isWriting ? 0 : getFileNodeId(filePath);
+	if (fileId)
+	{
+		std::shared_ptr<SourceLocationFile> file = std::make_shared<SourceLocationFile>(
+			filePath,
+			getFileNodeLanguage(fileId),
+			false,
+			getFileNodeComplete(fileId),
+			getFileNodeIndexed(fileId));
+
+		for (const SourceLocationIntervalIndex::Location* location:
+			 getSourceLocationIntervalIndex(fileId)->getLocationsInLines(startLine, endLine))
+		{
+			file->addSourceLocation(
+				intToLocationType(location->location.type),
+				location->location.id,
+				location->elementIds,
+				location->location.startLine,
+				location->location.startCol,
+				location->location.endLine,
+				location->location.endCol);
+		}
+
+		return file->getFilteredByLines(startLine, endLine)
+			->getFilteredByTypes(
+				{LOCATION_TOKEN,
+				 LOCATION_SCOPE,
+				 LOCATION_QUALIFIER,
+				 LOCATION_LOCAL_SYMBOL,
+				 LOCATION_UNSOLVED});
+	}
+
 	return m_sqliteIndexStorage.getSourceLocationsForLinesInFile(filePath, startLine, endLine)
 		->getFilteredByLines(startLine, endLine)
 		->getFilteredByTypes(
@@ -1790,13 +2210,7 @@ std::shared_ptr<TextAccess> PersistentStorage::getFileContent(
 
 bool PersistentStorage::hasContentForFile(const FilePath& filePath) const
 {
-	std::shared_ptr<TextAccess> fileContent = m_sqliteIndexStorage.getFileContentByPath(
-		filePath.wstr());
-	if (fileContent->getLineCount() > 0)
-	{
-		return true;
-	}
-	return false;
+	return m_sqliteIndexStorage.hasFileContentByPath(filePath.wstr());
 }
 
 FileInfo PersistentStorage::getFileInfoForFileId(Id id) const
@@ -2279,11 +2693,19 @@ TooltipSnippet PersistentStorage::getTooltipSnippetForNode(const StorageNode& no
 			};
 
 			std::vector<Annotation> annotations;
-			std::vector<std::string> lines =
-				getFileContent(sigLoc->getFilePath(), false)
-					->getLines(
-						static_cast<unsigned int>(sigLoc->getLineNumber()),
-						static_cast<unsigned int>(sigLoc->getEndLocation()->getLineNumber()));
+
+			// only the lines of the signature are decompressed
+			const size_t firstLineNumber = sigLoc->getLineNumber();
+			const size_t lastLineNumber = sigLoc->getEndLocation()->getLineNumber();
+			std::vector<std::string> lines = m_sqliteIndexStorage.getFileContentLinesByPath(
+				sigLoc->getFilePath().wstr(), firstLineNumber, lastLineNumber);
+			if (lines.empty())
+			{
+				lines = getFileContent(sigLoc->getFilePath(), false)
+							->getLines(
+								static_cast<unsigned int>(firstLineNumber),
+								static_cast<unsigned int>(lastLineNumber));
+			}
 
 			// check if signature location refers to correct locations in the code
 			// wrongly recorded signature locations of implicit template methods in C++ caused crashes
@@ -3267,63 +3689,225 @@ void PersistentStorage::buildFilePathMaps()
 	});
 }
 
-void PersistentStorage::buildSearchIndex()
+void PersistentStorage::buildFileIndex()
 {
 	TRACE();
 
 	const FilePath dbPath = getIndexDbFilePath();
 
-	m_sqliteIndexStorage.forEach<StorageNode>([&](StorageNode&& node) {
-		const NodeType type(intToNodeKind(node.type));
-		if (type.isFile())
+	for (const std::pair<const Id, FilePath>& p: m_fileNodePaths)
+	{
+		if (!getFileNodeIndexed(p.first))
 		{
-			bool indexed = getFileNodeIndexed(node.id);
-			if (!indexed)
+			continue;
+		}
+
+		FilePath filePath(p.second);
+		if (filePath.exists())
+		{
+			filePath.makeRelativeTo(dbPath);
+		}
+
+		m_fileIndex.addNode(p.first, filePath.wstr(), NodeType(NODE_FILE));
+	}
+
+	m_fileIndex.finishSetup();
+}
+
+void PersistentStorage::loadSymbolIndex() const
+{
+	if (m_symbolIndexLoaded)
+	{
+		return;
+	}
+	m_symbolIndexLoaded = true;
+
+	TRACE();
+
+	const FilePath indexFilePath = getSymbolIndexFilePath();
+	const std::string key = getIndexFileKey();
+
+	std::string storedKey;
+	const bool loaded = m_symbolIndex.load(indexFilePath, &storedKey);
+	if (loaded && storedKey == key)
+	{
+		return;
+	}
+
+	MessageStatus(L"Building search index", false, true).dispatch();
+
+	// an index saved before the last refresh only needs the changed symbols
+	if (!loaded || !updateSymbolIndex())
+	{
+		m_symbolIndex.clear();
+		buildSymbolIndex();
+	}
+
+	// databases that never finished indexing don't get an index file
+	if (!key.empty())
+	{
+		m_symbolIndex.save(indexFilePath, key);
+	}
+
+	MessageStatus(L"Finished building search index").dispatch();
+}
+
+bool PersistentStorage::updateSymbolIndex() const
+{
+	TRACE();
+
+	// tags of stored elements hash the names they were indexed with, because the ids of removed
+	// elements are assigned to new elements again
+	std::vector<std::tuple<Id, NodeKind, uint64_t>> storedElements;
+	m_symbolIndex.forEachElement([&storedElements](Id id, NodeType type, uint64_t tag) {
+		storedElements.emplace_back(id, type.getKind(), tag);
+	});
+	std::sort(storedElements.begin(), storedElements.end());
+
+	std::vector<std::tuple<Id, NodeKind, uint64_t>> currentElements;
+	m_sqliteIndexStorage.forEachNodeNameHierarchy(
+		[&](Id id, int nodeType, NameHierarchy&& nameHierarchy) {
+			const NodeType type(intToNodeKind(nodeType));
+			auto defIt = m_symbolDefinitionKinds.find(id);
+			const DefinitionKind defKind =
+				(defIt != m_symbolDefinitionKinds.end() ? defIt->second : DEFINITION_NONE);
+			if (!type.isFile() && defKind != DEFINITION_IMPLICIT)
 			{
-				return;
+				currentElements.emplace_back(
+					id,
+					type.getKind(),
+					utility::hashFnv1a(getSymbolIndexName(nameHierarchy, defKind)));
 			}
+		});
+	std::sort(currentElements.begin(), currentElements.end());
 
-			auto it = m_fileNodePaths.find(node.id);
-			if (it != m_fileNodePaths.end())
-			{
-				FilePath filePath(it->second);
+	std::unordered_set<Id> removedIds;
+	std::vector<Id> addedIds;
 
-				if (filePath.exists())
-				{
-					filePath.makeRelativeTo(dbPath);
-				}
+	auto it = storedElements.begin();
+	for (const std::tuple<Id, NodeKind, uint64_t>& element: currentElements)
+	{
+		const Id id = std::get<0>(element);
+		while (it != storedElements.end() && std::get<0>(*it) < id)
+		{
+			removedIds.insert(std::get<0>(*it));
+			it++;
+		}
+
+		if (it != storedElements.end() && std::get<0>(*it) == id)
+		{
+			if (*it != element)
+			{
+				removedIds.insert(id);
+				addedIds.push_back(id);
+			}
 
-				m_fileIndex.addNode(node.id, filePath.wstr(), type);
+			while (it != storedElements.end() && std::get<0>(*it) == id)
+			{
+				it++;
 			}
 		}
 		else
 		{
-			auto it = m_symbolDefinitionKinds.find(node.id);
+			addedIds.push_back(id);
+		}
+	}
+
+	while (it != storedElements.end())
+	{
+		removedIds.insert(std::get<0>(*it));
+		it++;
+	}
+
+	// building from scratch is faster than changing most of the index
+	if (removedIds.size() + addedIds.size() > storedElements.size() / 2)
+	{
+		return false;
+	}
+
+	m_symbolIndex.removeNodes(removedIds);
+	m_sqliteIndexStorage.forEachNodeNameHierarchyByIds(
+		addedIds, [&](Id id, int type, NameHierarchy&& nameHierarchy) {
+			auto defIt = m_symbolDefinitionKinds.find(id);
+			addNodeToSymbolIndex(
+				id,
+				type,
+				nameHierarchy,
+				defIt != m_symbolDefinitionKinds.end() ? defIt->second : DEFINITION_NONE);
+		});
+	m_symbolIndex.finishSetup();
+
+	LOG_INFO(
+		"Updated search index with " + std::to_string(addedIds.size()) + " added and " +
+		std::to_string(removedIds.size()) + " removed symbols");
+
+	return true;
+}
+
+void PersistentStorage::buildSymbolIndex() const
+{
+	TRACE();
+
+	m_sqliteIndexStorage.forEachNodeNameHierarchy(
+		[&](Id id, int type, NameHierarchy&& nameHierarchy) {
+			if (NodeType(intToNodeKind(type)).isFile())
+			{
+				return;
+			}
+
+			auto it = m_symbolDefinitionKinds.find(id);
 			const DefinitionKind defKind =
 				(it != m_symbolDefinitionKinds.end() ? it->second : DEFINITION_NONE);
 			if (defKind != DEFINITION_IMPLICIT)
 			{
-				const NameHierarchy nameHierarchy = NameHierarchy::deserialize(node.serializedName);
+				addNodeToSymbolIndex(id, type, nameHierarchy, defKind);
+			}
+		});
 
-				// we don't use the signature here, so elements with the same signature share the
-				// same node.
-				std::wstring name = nameHierarchy.getQualifiedName();
+	m_symbolIndex.finishSetup();
+}
 
-				// replace template arguments with .. to avoid clutter in search results and have
-				// different template specializations share the same node.
-				if (defKind == DEFINITION_NONE &&
-					nameHierarchy.getDelimiter() == nameDelimiterTypeToString(NAME_DELIMITER_CXX))
-				{
-					name = utility::replaceBetween(name, L'<', L'>', L"..");
-				}
+void PersistentStorage::addNodeToSymbolIndex(
+	Id id, int type, const NameHierarchy& nameHierarchy, DefinitionKind definitionKind) const
+{
+	std::wstring name = getSymbolIndexName(nameHierarchy, definitionKind);
+	const uint64_t tag = utility::hashFnv1a(name);
+	m_symbolIndex.addNode(id, std::move(name), NodeType(intToNodeKind(type)), tag);
+}
 
-				m_symbolIndex.addNode(node.id, std::move(name), type);
-			}
-		}
-	});
+std::wstring PersistentStorage::getSymbolIndexName(
+	const NameHierarchy& nameHierarchy, DefinitionKind definitionKind)
+{
+	// we don't use the signature here, so elements with the same signature share the
+	// same node.
+	std::wstring name = nameHierarchy.getQualifiedName();
 
-	m_symbolIndex.finishSetup();
-	m_fileIndex.finishSetup();
+	// replace template arguments with .. to avoid clutter in search results and have
+	// different template specializations share the same node.
+	if (definitionKind == DEFINITION_NONE &&
+		nameHierarchy.getDelimiter() == nameDelimiterTypeToString(NAME_DELIMITER_CXX))
+	{
+		name = utility::replaceBetween(name, L'<', L'>', L"..");
+	}
+
+	return name;
+}
+
+FilePath PersistentStorage::getSymbolIndexFilePath() const
+{
+	return getIndexDbFilePath().replaceExtension(L".srctrlsym");
+}
+
+std::string PersistentStorage::getIndexFileKey() const
+{
+	const TimeStamp time = m_sqliteIndexStorage.getTime();
+	if (!time.isValid())
+	{
+		return "";
+	}
+
+	// the database is timestamped whenever indexing finishes
+	return std::to_string(m_sqliteIndexStorage.getStaticVersion()) + " " + time.toString();
 }
 
 void PersistentStorage::buildFullTextSearchIndex() const
@@ -3336,36 +3920,32 @@ void PersistentStorage::buildFullTextSearchIndex() const
 
 	m_fullTextSearchIndex.clear();
 
-	std::vector<std::shared_ptr<std::thread>> threads;
+	std::vector<StorageFile> indexedFiles;
+	for (const StorageFile& file: m_sqliteIndexStorage.getAll<StorageFile>())
 	{
-		std::vector<StorageFile> indexedFiles;
-		for (const StorageFile& file: m_sqliteIndexStorage.getAll<StorageFile>())
+		if (file.indexed)
 		{
-			if (file.indexed)
-			{
-				indexedFiles.push_back(file);
-			}
-		}
-		for (std::vector<StorageFile> part:
-			 utility::splitToEquallySizedParts(indexedFiles, utility::getIdealThreadCount()))
-		{
-			std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
-				[&](const std::vector<StorageFile>& files) {
-					for (const StorageFile& file: files)
-					{
-						m_fullTextSearchIndex.addFile(
-							file.id,
-							codec.decode(m_sqliteIndexStorage.getFileContentById(file.id)->getText()));
-					}
-				},
-				part);
-			threads.push_back(thread);
+			indexedFiles.push_back(file);
 		}
 	}
-	for (std::shared_ptr<std::thread> thread: threads)
-	{
-		thread->join();
-	}
+
+	// only files that were not stored with their current modification time need to be built
+	const FilePath indexFilePath = getFullTextSearchIndexFilePath();
+	const std::vector<StorageFile> filesToAdd = m_fullTextSearchIndex.load(
+		indexFilePath, m_fullTextSearchCodec, indexedFiles);
+
+	m_threadPool.parallelFor(filesToAdd.size(), [&](size_t i) {
+		m_fullTextSearchIndex.addFile(
+			filesToAdd[i],
+			codec.decode(m_sqliteIndexStorage.getFileContentById(filesToAdd[i].id)->getText()));
+	});
+
+	m_fullTextSearchIndex.save(indexFilePath, m_fullTextSearchCodec);
+}
+
+FilePath PersistentStorage::getFullTextSearchIndexFilePath() const
+{
+	return getIndexDbFilePath().replaceExtension(L".srctrlft");
 }
 
 void PersistentStorage::buildMemberEdgeIdOrderMap()
@@ -3444,24 +4024,37 @@ void PersistentStorage::buildHierarchyCache()
 {
 	TRACE();
 
-	std::vector<Id> sourceNodeIds;
+	const std::string key = getIndexFileKey();
+	std::string storedKey;
+	if (!m_isWriting && !key.empty() &&
+		m_hierarchyCache.load(getHierarchyCacheFilePath(), &storedKey) && storedKey == key)
+	{
+		return;
+	}
+
+	m_hierarchyCache.clear();
+	addEdgesToHierarchyCache(&m_hierarchyCache, m_symbolDefinitionKinds);
+	m_hierarchyCache.finishSetup();
+}
+
+void PersistentStorage::addEdgesToHierarchyCache(
+	HierarchyCache* cache, const std::unordered_map<Id, DefinitionKind>& definitionKinds) const
+{
 	std::vector<StorageEdge> memberEdges;
 
 	m_sqliteIndexStorage.forEachOfType<StorageEdge>(
-		Edge::typeToInt(Edge::EDGE_MEMBER), [&sourceNodeIds, &memberEdges](StorageEdge&& edge) {
-			sourceNodeIds.push_back(edge.sourceNodeId);
-			memberEdges.emplace_back(edge);
-		});
+		Edge::typeToInt(Edge::EDGE_MEMBER),
+		[&memberEdges](StorageEdge&& edge) { memberEdges.emplace_back(edge); });
 
+	// only the types are needed, so the names of the nodes are not loaded
 	std::set<Id> invisibleParentSourceNodeIds;
-
-	m_sqliteIndexStorage.forEachByIds<StorageNode>(
-		sourceNodeIds, [&invisibleParentSourceNodeIds](StorageNode&& node) {
-			if (!NodeType(intToNodeKind(node.type)).isVisibleAsParentInGraph())
-			{
-				invisibleParentSourceNodeIds.insert(node.id);
-			}
-		});
+	for (const std::pair<Id, int>& p: m_sqliteIndexStorage.getAllNodeTypes())
+	{
+		if (!NodeType(intToNodeKind(p.second)).isVisibleAsParentInGraph())
+		{
+			invisibleParentSourceNodeIds.insert(p.first);
+		}
+	}
 
 	for (const StorageEdge& edge: memberEdges)
 	{
@@ -3472,20 +4065,20 @@ void PersistentStorage::buildHierarchyCache()
 		}
 
 		bool sourceIsImplicit = false;
-		auto it = m_symbolDefinitionKinds.find(edge.sourceNodeId);
-		if (it != m_symbolDefinitionKinds.end())
+		auto it = definitionKinds.find(edge.sourceNodeId);
+		if (it != definitionKinds.end())
 		{
 			sourceIsImplicit = (it->second == DEFINITION_IMPLICIT);
 		}
 
 		bool targetIsImplicit = false;
-		it = m_symbolDefinitionKinds.find(edge.targetNodeId);
-		if (it != m_symbolDefinitionKinds.end())
+		it = definitionKinds.find(edge.targetNodeId);
+		if (it != definitionKinds.end())
 		{
 			targetIsImplicit = (it->second == DEFINITION_IMPLICIT);
 		}
 
-		m_hierarchyCache.createConnection(
+		cache->createConnection(
 			edge.id,
 			edge.sourceNodeId,
 			edge.targetNodeId,
@@ -3495,7 +4088,100 @@ void PersistentStorage::buildHierarchyCache()
 	}
 
 	m_sqliteIndexStorage.forEachOfType<StorageEdge>(
-		Edge::typeToInt(Edge::EDGE_INHERITANCE), [this](StorageEdge&& edge) {
-			m_hierarchyCache.createInheritance(edge.id, edge.sourceNodeId, edge.targetNodeId);
+		Edge::typeToInt(Edge::EDGE_INHERITANCE), [cache](StorageEdge&& edge) {
+			cache->createInheritance(edge.id, edge.sourceNodeId, edge.targetNodeId);
 		});
 }
+
+FilePath PersistentStorage::getHierarchyCacheFilePath() const
+{
+	return getIndexDbFilePath().replaceExtension(L".srctrlhc");
+}
+
+void PersistentStorage::loadAdjacencyCache() const
+{
+	if (m_adjacencyCacheLoaded)
+	{
+		return;
+	}
+	m_adjacencyCacheLoaded = true;
+
+	TRACE();
+
+	const FilePath cacheFilePath = getAdjacencyCacheFilePath();
+	const std::string key = getIndexFileKey();
+
+	std::string storedKey;
+	if (!m_isWriting && !key.empty() && m_adjacencyCache.load(cacheFilePath, &storedKey) &&
+		storedKey == key)
+	{
+		return;
+	}
+
+	m_adjacencyCache.clear();
+	// only the types are needed, so the node names are not read
+	for (const std::pair<Id, int>& p: m_sqliteIndexStorage.getAllNodeTypes())
+	{
+		m_adjacencyCache.addNode(p.first, p.second);
+	}
+	m_sqliteIndexStorage.forEach<StorageEdge>([this](StorageEdge&& edge) {
+		m_adjacencyCache.addEdge(edge.id, edge.type, edge.sourceNodeId, edge.targetNodeId);
+	});
+	m_adjacencyCache.finishSetup();
+
+	// databases that are changed or never finished indexing don't get a cache file
+	if (!m_isWriting && !key.empty())
+	{
+		m_adjacencyCache.save(cacheFilePath, key);
+	}
+}
+
+FilePath PersistentStorage::getAdjacencyCacheFilePath() const
+{
+	return getIndexDbFilePath().replaceExtension(L".srctrladj");
+}
+
+std::shared_ptr<SourceLocationIntervalIndex> PersistentStorage::getSourceLocationIntervalIndex(
+	Id fileId) const
+{
+	// about the number of files shown in the code view at once
+	const size_t maxCachedFileCount = 8;
+
+	const auto findCachedIndex = [this, fileId]() -> std::shared_ptr<SourceLocationIntervalIndex> {
+		auto it = std::find_if(
+			m_sourceLocationIntervalIndices.begin(),
+			m_sourceLocationIntervalIndices.end(),
+			[fileId](const auto& p) { return p.first == fileId; });
+		if (it == m_sourceLocationIntervalIndices.end())
+		{
+			return nullptr;
+		}
+		std::rotate(m_sourceLocationIntervalIndices.begin(), it, it + 1);
+		return m_sourceLocationIntervalIndices.front().second;
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(m_sourceLocationIntervalIndicesMutex);
+		if (std::shared_ptr<SourceLocationIntervalIndex> index = findCachedIndex())
+		{
+			return index;
+		}
+	}
+
+	// loaded without holding the lock, so queries of other files don't wait
+	std::shared_ptr<SourceLocationIntervalIndex> index =
+		m_sqliteIndexStorage.getSourceLocationIntervalIndexForFile(fileId);
+
+	std::lock_guard<std::mutex> lock(m_sourceLocationIntervalIndicesMutex);
+	if (std::shared_ptr<SourceLocationIntervalIndex> cachedIndex = findCachedIndex())
+	{
+		return cachedIndex;
+	}
+	m_sourceLocationIntervalIndices.insert(
+		m_sourceLocationIntervalIndices.begin(), std::make_pair(fileId, index));
+	if (m_sourceLocationIntervalIndices.size() > maxCachedFileCount)
+	{
+		m_sourceLocationIntervalIndices.pop_back();
+	}
+	return index;
+}
@@ -1,9 +1,11 @@
 #ifndef PERSISTENT_STORAGE_H
 #define PERSISTENT_STORAGE_H
 
+#include <map>
 #include <memory>
 #include <vector>
 
+#include "AdjacencyCache.h"
 #include "FullTextSearchIndex.h"
 #include "HierarchyCache.h"
 #include "SearchIndex.h"
@@ -11,6 +13,9 @@
 #include "SqliteIndexStorage.h"
 #include "Storage.h"
 #include "StorageAccess.h"
+#include "ThreadPool.h"
+
+class SourceLocationIntervalIndex;
 
 class PersistentStorage
 	: public Storage
@@ -59,6 +64,14 @@ public:
 	void finishInjection() override;
 	void rollbackInjection();
 
+	// writes a refresh into the index database in a single transaction, other connections keep
+	// reading the state before the refresh until it is committed. returns false if the database
+	// does not support it.
+	bool startRefreshTransaction();
+	void commitRefreshTransaction();
+	void rollbackRefreshTransaction();
+	void disableWriteAheadLogging();
+
 	const std::vector<ErrorInfo> getErrorInfos() const;
 
 	void beforeErrorRecording();
@@ -74,7 +87,17 @@ public:
 	std::string getProjectSettingsText() const;
 	void setProjectSettingsText(std::string text);
 
+	std::map<FilePath, size_t> getIndexTimes() const;
+	void setIndexTimes(const std::map<FilePath, size_t>& indexTimes);
+	// the files are indexed again by the next refresh of incomplete files
+	void setFilesIncomplete(const std::vector<FilePath>& filePaths);
+
+	void setNameInterningEnabled(bool enabled);
+	bool isNameInterningEnabled() const;
+
 	void setup();
+	void setupCustomCommandStorage();
+	void migrateCustomCommandStorage();
 	void updateVersion();
 	void clear();
 	void clearCaches();
@@ -93,6 +116,8 @@ public:
 	void buildCaches();
 
 	void optimizeMemory();
+	// stores the hierarchy beside the database, so loading the project doesn't need to build it
+	void saveHierarchyCache() const;
 
 	// StorageAccess implementation
 	Id getNodeIdForFileNode(const FilePath& filePath) const override;
@@ -110,7 +135,9 @@ public:
 	StorageEdge getEdgeById(Id edgeId) const override;
 
 	std::shared_ptr<SourceLocationCollection> getFullTextSearchLocations(
-		const std::wstring& searchTerm, bool caseSensitive) const override;
+		const std::wstring& searchTerm,
+		bool caseSensitive,
+		const FullTextSearchBatchCallback& onBatch) const override;
 
 	std::vector<SearchMatch> getAutocompletionMatches(
 		const std::wstring& query, NodeTypeSet acceptedNodeTypes, bool acceptCommands) const override;
@@ -139,7 +166,8 @@ public:
 		Edge::TypeMask trailType,
 		bool nodeNonIndexed,
 		size_t depth,
-		bool directed) const override;
+		bool directed,
+		bool shortestPath) const override;
 
 	NodeKindMask getAvailableNodeTypes() const override;
 	Edge::TypeMask getAvailableEdgeTypes() const override;
@@ -236,6 +264,20 @@ private:
 	std::set<FilePath> getReferencingByIncludes(const std::set<FilePath>& filePaths) const;
 	std::set<FilePath> getReferencingByImports(const std::set<FilePath>& filePaths) const;
 
+	std::shared_ptr<Graph> getGraphForShortestTrail(
+		Id originId,
+		Id targetId,
+		NodeKindMask nodeTypes,
+		Edge::TypeMask edgeTypes,
+		bool nodeNonIndexed,
+		size_t depth,
+		bool directed) const;
+	std::vector<StorageEdge> getTrailEdges(
+		const std::vector<Id>& nodeIds, bool bySource, bool useAdjacencyCache) const;
+	std::vector<std::pair<Id, NodeKind>> getTrailNodeKinds(
+		const std::vector<Id>& nodeIds, bool useAdjacencyCache) const;
+	bool isTrailNode(Id nodeId, NodeKind kind, NodeKindMask nodeTypes, bool nodeNonIndexed) const;
+
 	void addNodesToGraph(const std::vector<Id>& nodeIds, Graph* graph, bool addChildCount) const;
 	void addEdgesToGraph(const std::vector<Id>& edgeIds, Graph* graph) const;
 	void addNodesWithParentsAndEdgesToGraph(
@@ -256,19 +298,39 @@ private:
 	void addInheritanceChainsToGraph(const std::vector<Id>& nodeIds, Graph* graph) const;
 
 	void buildFilePathMaps();
-	void buildSearchIndex();
+	void buildFileIndex();
+	void loadSymbolIndex() const;
+	bool updateSymbolIndex() const;
+	void buildSymbolIndex() const;
+	void addNodeToSymbolIndex(
+		Id id, int type, const NameHierarchy& nameHierarchy, DefinitionKind definitionKind) const;
+	static std::wstring getSymbolIndexName(
+		const NameHierarchy& nameHierarchy, DefinitionKind definitionKind);
+	FilePath getSymbolIndexFilePath() const;
+	std::string getIndexFileKey() const;
 	void buildFullTextSearchIndex() const;
+	FilePath getFullTextSearchIndexFilePath() const;
 	void buildMemberEdgeIdOrderMap();
 	void buildHierarchyCache();
+	void addEdgesToHierarchyCache(
+		HierarchyCache* cache, const std::unordered_map<Id, DefinitionKind>& definitionKinds) const;
+	FilePath getHierarchyCacheFilePath() const;
+	void loadAdjacencyCache() const;
+	FilePath getAdjacencyCacheFilePath() const;
+	std::shared_ptr<SourceLocationIntervalIndex> getSourceLocationIntervalIndex(Id fileId) const;
 
 	bool m_preIndexingErrorCountSet = false;
 	size_t m_preIndexingErrorCount = 0;
 	size_t m_preInjectionErrorCount = 0;
 
 	SearchIndex m_commandIndex;
-	SearchIndex m_symbolIndex;
 	SearchIndex m_fileIndex;
 
+	// loaded from its index file on first search
+	mutable SearchIndex m_symbolIndex;
+	mutable bool m_symbolIndexLoaded = false;
+	mutable std::mutex m_symbolIndexMutex;
+
 	mutable FullTextSearchIndex m_fullTextSearchIndex;
 	mutable std::string m_fullTextSearchCodec;
 	mutable std::mutex m_fullTextSearchMutex;
@@ -276,6 +338,9 @@ private:
 	SqliteIndexStorage m_sqliteIndexStorage;
 	SqliteBookmarkStorage m_sqliteBookmarkStorage;
 
+	// shared by queries that resolve their results in parallel
+	mutable ThreadPool m_threadPool;
+
 	std::map<FilePath, Id> m_fileNodeIds;
 	std::map<FilePath, Id> m_lowerCasefileNodeIds;
 	std::map<Id, FilePath> m_fileNodePaths;
@@ -288,6 +353,19 @@ private:
 
 	HierarchyCache m_hierarchyCache;
 
+	// loaded from its cache file on first trail, guarded during traversals
+	mutable AdjacencyCache m_adjacencyCache;
+	mutable bool m_adjacencyCacheLoaded = false;
+	mutable std::mutex m_adjacencyCacheMutex;
+
+	// interval indices of the most recently queried files, the most recent one first
+	mutable std::vector<std::pair<Id, std::shared_ptr<SourceLocationIntervalIndex>>>
+		m_sourceLocationIntervalIndices;
+	mutable std::mutex m_sourceLocationIntervalIndicesMutex;
+
+	// files keyed by the database timestamp are outdated while the database is changed
+	bool m_isWriting = false;
+
 	bool m_hasJavaFiles = false;
 };
 
@@ -1,6 +1,7 @@
 #ifndef STORAGE_ACCESS_H
 #define STORAGE_ACCESS_H
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -30,6 +31,9 @@ class TextAccess;
 
 struct FileInfo;
 
+// receives the fulltext search results of a batch of files, best ranked files come first
+typedef std::function<void(std::shared_ptr<SourceLocationCollection>)> FullTextSearchBatchCallback;
+
 class StorageAccess
 {
 public:
@@ -51,7 +55,9 @@ public:
 	virtual StorageEdge getEdgeById(Id edgeId) const = 0;
 
 	virtual std::shared_ptr<SourceLocationCollection> getFullTextSearchLocations(
-		const std::wstring& searchTerm, bool caseSensitive) const = 0;
+		const std::wstring& searchTerm,
+		bool caseSensitive,
+		const FullTextSearchBatchCallback& onBatch) const = 0;
 	virtual std::vector<SearchMatch> getAutocompletionMatches(
 		const std::wstring& query, NodeTypeSet acceptedNodeTypes, bool acceptCommands) const = 0;
 	virtual std::vector<SearchMatch> getSearchMatchesForTokenIds(
@@ -71,7 +77,8 @@ public:
 		Edge::TypeMask edgeTypes,
 		bool nodeNonIndexed,
 		size_t depth,
-		bool directed) const = 0;
+		bool directed,
+		bool shortestPath) const = 0;
 
 	virtual NodeKindMask getAvailableNodeTypes() const = 0;
 	virtual Edge::TypeMask getAvailableEdgeTypes() const = 0;
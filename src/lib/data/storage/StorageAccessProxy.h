@@ -28,7 +28,9 @@ public:
 	StorageEdge getEdgeById(Id edgeId) const override;
 
 	std::shared_ptr<SourceLocationCollection> getFullTextSearchLocations(
-		const std::wstring& searchTerm, bool caseSensitive) const override;
+		const std::wstring& searchTerm,
+		bool caseSensitive,
+		const FullTextSearchBatchCallback& onBatch) const override;
 	std::vector<SearchMatch> getAutocompletionMatches(
 		const std::wstring& query, NodeTypeSet acceptedNodeTypes, bool acceptCommands) const override;
 	std::vector<SearchMatch> getSearchMatchesForTokenIds(const std::vector<Id>& tokenIds) const override;
@@ -47,7 +49,8 @@ public:
 		Edge::TypeMask edgeTypes,
 		bool nodeNonIndexed,
 		size_t depth,
-		bool directed) const override;
+		bool directed,
+		bool shortestPath) const override;
 
 	NodeKindMask getAvailableNodeTypes() const override;
 	Edge::TypeMask getAvailableEdgeTypes() const override;
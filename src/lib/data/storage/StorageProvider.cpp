@@ -1,47 +1,115 @@
 #include "StorageProvider.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "logging.h"
 
+StorageProvider::StorageProvider(size_t byteBudget)
+	: m_byteBudget(byteBudget)
+	, m_queuedByteSize(0)
+	, m_mergingByteSize(0)
+	, m_peakStorageCount(0)
+	, m_peakByteSizeInFlight(0)
+	, m_runningMergeCount(0)
+	, m_mergeCount(0)
+	, m_mergedSourceLocationCount(0)
+	, m_mergeTimeSeconds(0.0f)
+{
+}
+
 int StorageProvider::getStorageCount() const
 {
 	std::lock_guard<std::mutex> lock(m_storagesMutex);
 	return static_cast<int>(m_storages.size());
 }
 
-void StorageProvider::clear()
+size_t StorageProvider::getByteBudget() const
 {
-	std::lock_guard<std::mutex> lock(m_storagesMutex);
-	return m_storages.clear();
+	return m_byteBudget;
 }
 
-void StorageProvider::insert(std::shared_ptr<IntermediateStorage> storage)
+size_t StorageProvider::getByteSizeInFlight() const
 {
-	const std::size_t storageSize = storage->getSourceLocationCount();
-	std::list<std::shared_ptr<IntermediateStorage>>::iterator it;
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	return m_queuedByteSize + m_mergingByteSize;
+}
 
+bool StorageProvider::isOverBudget() const
+{
 	std::lock_guard<std::mutex> lock(m_storagesMutex);
-	for (it = m_storages.begin(); it != m_storages.end(); it++)
+	return m_byteBudget && m_queuedByteSize + m_mergingByteSize >= m_byteBudget;
+}
+
+bool StorageProvider::waitForByteSizeBelowBudget(size_t timeoutMilliseconds)
+{
+	std::unique_lock<std::mutex> lock(m_storagesMutex);
+	return m_storagesConsumedCondition.wait_for(
+		lock, std::chrono::milliseconds(timeoutMilliseconds), [this]() {
+			return !m_byteBudget || m_queuedByteSize + m_mergingByteSize < m_byteBudget;
+		});
+}
+
+void StorageProvider::clear()
+{
 	{
-		if ((*it)->getSourceLocationCount() < storageSize)
-		{
-			break;
-		}
+		std::lock_guard<std::mutex> lock(m_storagesMutex);
+		m_storages.clear();
+		m_queuedByteSize = 0;
 	}
-	m_storages.insert(it, storage);
+	m_storagesConsumedCondition.notify_all();
 }
 
-std::shared_ptr<IntermediateStorage> StorageProvider::consumeSecondLargestStorage()
+void StorageProvider::insert(std::shared_ptr<IntermediateStorage> storage)
 {
-	std::shared_ptr<IntermediateStorage> ret;
+	const size_t sourceLocationCount = storage->getSourceLocationCount();
+	const size_t byteSize = getByteSize(*storage);
+
+	bool merged = false;
 	{
 		std::lock_guard<std::mutex> lock(m_storagesMutex);
-		if (m_storages.size() > 1)
+		auto it = m_mergingByteSizes.find(storage.get());
+		if (it != m_mergingByteSizes.end())
 		{
-			std::list<std::shared_ptr<IntermediateStorage>>::iterator it = m_storages.begin();
-			it++;
-			ret = *it;
-			m_storages.erase(it);
+			m_mergingByteSize -= it->second;
+			m_mergingByteSizes.erase(it);
+			merged = true;
 		}
+
+		m_storages.emplace(sourceLocationCount, QueuedStorage {storage, byteSize});
+		m_queuedByteSize += byteSize;
+		updatePeaks();
+	}
+
+	if (merged)
+	{
+		// the merged storage usually takes less memory than its sources
+		m_storagesConsumedCondition.notify_all();
+	}
+}
+
+std::pair<std::shared_ptr<IntermediateStorage>, std::shared_ptr<IntermediateStorage>> StorageProvider::
+	consumeSmallestStoragePair()
+{
+	std::pair<std::shared_ptr<IntermediateStorage>, std::shared_ptr<IntermediateStorage>> ret;
+
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	if (m_storages.size() > 2)
+	{
+		StorageQueue::iterator it = m_storages.begin();
+		ret.second = it->second.storage;
+		size_t byteSize = it->second.byteSize;
+		it = m_storages.erase(it);
+
+		ret.first = it->second.storage;
+		byteSize += it->second.byteSize;
+		m_storages.erase(it);
+
+		// the storages stay in flight until the merged storage gets inserted again
+		m_queuedByteSize -= byteSize;
+		m_mergingByteSize += byteSize;
+		m_mergingByteSizes[ret.first.get()] += byteSize;
+		m_runningMergeCount++;
 	}
 	return ret;
 }
@@ -53,23 +121,81 @@ std::shared_ptr<IntermediateStorage> StorageProvider::consumeLargestStorage()
 		std::lock_guard<std::mutex> lock(m_storagesMutex);
 		if (!m_storages.empty())
 		{
-			ret = m_storages.front();
-			m_storages.pop_front();
+			StorageQueue::iterator it = std::prev(m_storages.end());
+			ret = it->second.storage;
+			m_queuedByteSize -= it->second.byteSize;
+			m_storages.erase(it);
 		}
 	}
 
+	if (ret)
+	{
+		m_storagesConsumedCondition.notify_all();
+	}
 	return ret;
 }
 
+void StorageProvider::addMergeStats(size_t mergedSourceLocationCount, float mergeTimeSeconds)
+{
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	if (m_runningMergeCount > 0)
+	{
+		m_runningMergeCount--;
+	}
+	m_mergeCount++;
+	m_mergedSourceLocationCount += mergedSourceLocationCount;
+	m_mergeTimeSeconds += mergeTimeSeconds;
+}
+
+size_t StorageProvider::getMergeBacklogCount() const
+{
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	return m_storages.size() > 1 ? m_storages.size() - 1 : 0;
+}
+
 void StorageProvider::logCurrentState() const
 {
 	std::string logString = "Storages waiting for injection:";
+	std::string queueString;
+	std::string mergeString;
 	{
 		std::lock_guard<std::mutex> lock(m_storagesMutex);
-		for (const std::shared_ptr<IntermediateStorage>& storage: m_storages)
+		for (StorageQueue::const_reverse_iterator it = m_storages.rbegin(); it != m_storages.rend();
+			 it++)
 		{
-			logString += " " + std::to_string(storage->getSourceLocationCount()) + ";";
+			logString += " " + std::to_string(it->first) + ";";
+		}
+
+		queueString = "Storage queue - depth: " + std::to_string(m_storages.size()) +
+			" peak depth: " + std::to_string(m_peakStorageCount) +
+			" queued: " + std::to_string(m_queuedByteSize / 1024) + "kB" +
+			" merging: " + std::to_string(m_mergingByteSize / 1024) + "kB" +
+			" peak in flight: " + std::to_string(m_peakByteSizeInFlight / 1024) + "kB" +
+			" budget: " + std::to_string(m_byteBudget / 1024) + "kB";
+
+		mergeString = "Storage merges - running: " + std::to_string(m_runningMergeCount) +
+			" done: " + std::to_string(m_mergeCount) +
+			" locations: " + std::to_string(m_mergedSourceLocationCount) +
+			" time: " + std::to_string(m_mergeTimeSeconds) + "s";
+		if (m_mergeTimeSeconds > 0.0f)
+		{
+			mergeString += " throughput: " +
+				std::to_string(static_cast<size_t>(m_mergedSourceLocationCount / m_mergeTimeSeconds)) +
+				" locations/s";
 		}
 	}
 	LOG_INFO(logString);
+	LOG_INFO(queueString);
+	LOG_INFO(mergeString);
+}
+
+size_t StorageProvider::getByteSize(const IntermediateStorage& storage)
+{
+	return storage.getByteSize(sizeof(std::wstring));
+}
+
+void StorageProvider::updatePeaks()
+{
+	m_peakStorageCount = std::max(m_peakStorageCount, m_storages.size());
+	m_peakByteSizeInFlight = std::max(m_peakByteSizeInFlight, m_queuedByteSize + m_mergingByteSize);
 }
@@ -2,30 +2,82 @@
 #define STORAGE_PROVIDER_H
 
 #include "IntermediateStorage.h"
-#include <list>
+#include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
+// keeps the intermediate storages that wait for merging and injection. the storages held by the
+// provider, including the ones that are being merged, are measured against a byte budget, so the
+// producers can wait for the consumers instead of piling up storages in memory.
 class StorageProvider
 {
 public:
+	// a budget of 0 bytes means that the provider never runs over budget
+	StorageProvider(size_t byteBudget = 0);
+
 	int getStorageCount() const;
 
+	size_t getByteBudget() const;
+	size_t getByteSizeInFlight() const;
+	bool isOverBudget() const;
+
+	// returns whether the storages in flight fit into the budget before the timeout passed
+	bool waitForByteSizeBelowBudget(size_t timeoutMilliseconds);
+
 	void clear();
 
 	void insert(std::shared_ptr<IntermediateStorage> storage);
 
-	// returns empty shared_ptr if no storages available
-	std::shared_ptr<IntermediateStorage> consumeSecondLargestStorage();
+	// returns empty shared_ptrs if less than three storages are available, because the largest
+	// storage is left for injection. Merging the smallest storages first keeps the merge tree
+	// balanced when several threads are merging at the same time.
+	std::pair<std::shared_ptr<IntermediateStorage>, std::shared_ptr<IntermediateStorage>>
+		consumeSmallestStoragePair();
 
 	// returns empty shared_ptr if no storages available
 	std::shared_ptr<IntermediateStorage> consumeLargestStorage();
 
+	void addMergeStats(size_t mergedSourceLocationCount, float mergeTimeSeconds);
+	size_t getMergeBacklogCount() const;
+
 	void logCurrentState() const;
 
 private:
-	std::list<std::shared_ptr<IntermediateStorage>> m_storages;	   // larger storages are in front
+	struct QueuedStorage
+	{
+		std::shared_ptr<IntermediateStorage> storage;
+		size_t byteSize;
+	};
+
+	// ordered by source location count, so both the smallest and the largest storages can be taken
+	// in logarithmic time
+	using StorageQueue = std::multimap<size_t, QueuedStorage>;
+
+	static size_t getByteSize(const IntermediateStorage& storage);
+
+	void updatePeaks();
+
+	const size_t m_byteBudget;
+
+	StorageQueue m_storages;
 	mutable std::mutex m_storagesMutex;
+	std::condition_variable m_storagesConsumedCondition;
+
+	size_t m_queuedByteSize;
+	size_t m_mergingByteSize;
+
+	// merge targets are inserted again after merging, so their sources are accounted until then
+	std::unordered_map<const IntermediateStorage*, size_t> m_mergingByteSizes;
+
+	size_t m_peakStorageCount;
+	size_t m_peakByteSizeInFlight;
+
+	size_t m_runningMergeCount;
+	size_t m_mergeCount;
+	size_t m_mergedSourceLocationCount;
+	float m_mergeTimeSeconds;
 };
 
 #endif	  // STORAGE_PROVIDER_H
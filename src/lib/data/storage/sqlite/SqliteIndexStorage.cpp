@@ -1,5 +1,7 @@
 #include "SqliteIndexStorage.h"
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 #include <unordered_map>
 
@@ -7,11 +9,21 @@
 #include "LocationType.h"
 #include "SourceLocationCollection.h"
 #include "SourceLocationFile.h"
+#include "SourceLocationIntervalIndex.h"
+#include "SqliteStorageMigrationLambda.h"
+#include "SqliteStorageMigrator.h"
 #include "TextAccess.h"
 #include "logging.h"
+#include "tracing.h"
+#include "utilityCompression.h"
+#include "utilityHash.h"
 #include "utilityString.h"
 
-const size_t SqliteIndexStorage::s_storageVersion = 25;
+const size_t SqliteIndexStorage::s_storageVersion = 26;
+const size_t SqliteIndexStorage::s_customCommandStorageVersion = 25;
+const size_t SqliteIndexStorage::s_clearChunkLocationCount = 100000;
+const size_t SqliteIndexStorage::s_clearChunkFileCount = 256;
+const size_t SqliteIndexStorage::s_fileContentBlockSize = 32 * 1024;
 
 namespace
 {
@@ -32,6 +44,11 @@ size_t SqliteIndexStorage::getStorageVersion()
 	return s_storageVersion;
 }
 
+size_t SqliteIndexStorage::getCustomCommandStorageVersion()
+{
+	return s_customCommandStorageVersion;
+}
+
 SqliteIndexStorage::SqliteIndexStorage(const FilePath& dbFilePath)
 	: SqliteStorage(dbFilePath.getCanonical())
 {
@@ -42,19 +59,61 @@ size_t SqliteIndexStorage::getStaticVersion() const
 	return s_storageVersion;
 }
 
+void SqliteIndexStorage::setupCustomCommandStorage()
+{
+	executeStatement("PRAGMA foreign_keys=ON;");
+	setupMetaTable();
+	setupCustomCommandTables();
+	setVersion(s_customCommandStorageVersion);
+}
+
+void SqliteIndexStorage::migrateCustomCommandStorage()
+{
+	if (getVersion() != s_customCommandStorageVersion)
+	{
+		return;
+	}
+
+	// the tables added since only extend the layout, the full names and the uncompressed file
+	// contents written by custom commands are still read
+	SqliteStorageMigrator migrator;
+	migrator.addMigration(
+		s_storageVersion,
+		std::make_shared<SqliteStorageMigrationLambda>(
+			[this](const SqliteStorageMigration* migration, SqliteStorage* storage) {
+				setupTables();
+			}));
+	migrator.migrate(this, s_storageVersion);
+}
+
 void SqliteIndexStorage::setMode(const StorageModeType mode)
 {
-	m_tempNodeNameIndex.clear();
-	m_tempWNodeNameIndex.clear();
-	m_tempNodeTypes.clear();
+	if (m_bulkLoad)
+	{
+		finishBulkLoad();
+	}
+
+	clearTempNodeIndex();
+	clearNameTree();
 	m_tempEdgeIndex.clear();
 	m_tempLocalSymbolIndex.clear();
 	m_tempSourceLocationIndices.clear();
+	m_tempFilePaths.clear();
+	m_tempErrorIndex.clear();
+
+	// databases that already contain elements keep the indices of the write mode
+	StorageModeType indexMode = mode;
+	if (mode == STORAGE_MODE_BULK_LOAD &&
+		executeStatementScalar("SELECT EXISTS(SELECT 1 FROM element);", 0) != 0)
+	{
+		LOG_INFO("Database already contains elements, writing without bulk load.");
+		indexMode = STORAGE_MODE_WRITE;
+	}
 
 	std::vector<std::pair<int, SqliteDatabaseIndex>> indices = getIndices();
 	for (size_t i = 0; i < indices.size(); i++)
 	{
-		if (indices[i].first & mode)
+		if (indices[i].first & indexMode)
 		{
 			indices[i].second.createOnDatabase(m_database);
 		}
@@ -63,6 +122,11 @@ void SqliteIndexStorage::setMode(const StorageModeType mode)
 			indices[i].second.removeFromDatabase(m_database);
 		}
 	}
+
+	if (indexMode == STORAGE_MODE_BULK_LOAD)
+	{
+		startBulkLoad();
+	}
 }
 
 std::string SqliteIndexStorage::getProjectSettingsText() const
@@ -75,6 +139,80 @@ void SqliteIndexStorage::setProjectSettingsText(std::string text)
 	insertOrUpdateMetaValue("project_settings", text);
 }
 
+std::map<FilePath, size_t> SqliteIndexStorage::getIndexTimes() const
+{
+	std::map<FilePath, size_t> indexTimes;
+
+	// databases of older versions may lack the table
+	if (!hasTable("index_time"))
+	{
+		return indexTimes;
+	}
+
+	CppSQLite3Query q = executeQuery("SELECT path, milliseconds FROM index_time;");
+	while (!q.eof())
+	{
+		const std::string path = q.getStringField(0, "");
+		const int milliseconds = q.getIntField(1, -1);
+		if (!path.empty() && milliseconds >= 0)
+		{
+			indexTimes.emplace(FilePath(utility::decodeFromUtf8(path)), milliseconds);
+		}
+
+		q.nextRow();
+	}
+
+	return indexTimes;
+}
+
+void SqliteIndexStorage::setIndexTimes(const std::map<FilePath, size_t>& indexTimes)
+{
+	CppSQLite3Statement stmt = m_database.compileStatement(
+		"INSERT OR REPLACE INTO index_time(path, milliseconds) VALUES(?, ?);");
+
+	beginTransaction();
+	for (const auto& p: indexTimes)
+	{
+		stmt.bind(1, utility::encodeToUtf8(p.first.wstr()).c_str());
+		stmt.bind(2, int(std::min<size_t>(p.second, std::numeric_limits<int>::max())));
+		executeStatement(stmt);
+	}
+	commitTransaction();
+}
+
+void SqliteIndexStorage::setFilesIncomplete(const std::vector<FilePath>& filePaths)
+{
+	CppSQLite3Statement stmt = m_database.compileStatement(
+		"UPDATE file SET complete = 0 WHERE path = ?;");
+
+	beginTransaction();
+	for (const FilePath& filePath: filePaths)
+	{
+		stmt.bind(1, utility::encodeToUtf8(filePath.wstr()).c_str());
+		executeStatement(stmt);
+	}
+	commitTransaction();
+}
+
+void SqliteIndexStorage::setNameInterningEnabled(bool enabled)
+{
+	if (enabled == m_nameInterningEnabled)
+	{
+		return;
+	}
+
+	m_nameInterningEnabled = enabled;
+	if (!enabled)
+	{
+		storeInternedNamesInFull();
+	}
+}
+
+bool SqliteIndexStorage::isNameInterningEnabled() const
+{
+	return m_nameInterningEnabled;
+}
+
 Id SqliteIndexStorage::addNode(const StorageNodeData& data)
 {
 	std::vector<Id> ids = addNodes({StorageNode(0, data)});
@@ -83,38 +221,42 @@ Id SqliteIndexStorage::addNode(const StorageNodeData& data)
 
 std::vector<Id> SqliteIndexStorage::addNodes(const std::vector<StorageNode>& nodes)
 {
-	if (m_tempNodeNameIndex.empty() && m_tempWNodeNameIndex.empty())
+	if (!m_tempNodeIndexLoaded)
 	{
-		forEach<StorageNode>([this](StorageNode&& node) {
-			std::string name = utility::encodeToUtf8(node.serializedName);
-			if (name.size() != node.serializedName.size())
-			{
-				m_tempWNodeNameIndex.add(node.serializedName, static_cast<uint32_t>(node.id));
-			}
-			else
-			{
-				m_tempNodeNameIndex.add(name, static_cast<uint32_t>(node.id));
-			}
-
-			m_tempNodeTypes.emplace(static_cast<uint32_t>(node.id), node.type);
-		});
+		loadTempNodeIndex();
 	}
 
+	const std::shared_ptr<SerializedNameTree> nameTree = getNameTree();
+
 	std::vector<Id> nodeIds(nodes.size(), 0);
 	std::vector<StorageNode> nodesToInsert;
+	std::vector<std::pair<Id, uint32_t>> nodeNamesToInsert;
 	for (size_t i = 0; i < nodes.size(); i++)
 	{
 		const StorageNodeData& data = nodes[i];
 		std::string name = utility::encodeToUtf8(data.serializedName);
 		{
-			Id nodeId;
-			if (name.size() != data.serializedName.size())
+			Id nodeId = 0;
+			uint32_t nameId = nameTree->findSerializedName(data.serializedName);
+			if (nameId)
 			{
-				nodeId = m_tempWNodeNameIndex.find(data.serializedName);
+				auto it = m_tempNameNodeIds.find(nameId);
+				if (it != m_tempNameNodeIds.end())
+				{
+					nodeId = it->second;
+				}
 			}
-			else
+
+			if (!nodeId)
 			{
-				nodeId = m_tempNodeNameIndex.find(name);
+				if (name.size() != data.serializedName.size())
+				{
+					nodeId = m_tempWNodeNameIndex.find(data.serializedName);
+				}
+				else
+				{
+					nodeId = m_tempNodeNameIndex.find(name);
+				}
 			}
 
 			if (nodeId)
@@ -130,19 +272,33 @@ std::vector<Id> SqliteIndexStorage::addNodes(const std::vector<StorageNode>& nod
 			}
 			else
 			{
-				executeStatement(m_insertElementStmt);
-				const Id id = static_cast<Id>(m_database.lastRowId());
-
-				nodesToInsert.emplace_back(id, data);
+				const Id id = addElement();
 				nodeIds[i] = id;
 
-				if (name.size() != data.serializedName.size())
+				if (m_nameInterningEnabled && !nameId)
 				{
-					m_tempWNodeNameIndex.add(data.serializedName, static_cast<uint32_t>(id));
+					nameId = nameTree->addSerializedName(data.serializedName);
+				}
+
+				if (m_nameInterningEnabled && nameId)
+				{
+					// the serialized_name column stays empty
+					nodesToInsert.emplace_back(id, data.type, L"");
+					nodeNamesToInsert.emplace_back(id, nameId);
+					m_tempNameNodeIds.emplace(nameId, static_cast<uint32_t>(id));
 				}
 				else
 				{
-					m_tempNodeNameIndex.add(name, static_cast<uint32_t>(id));
+					nodesToInsert.emplace_back(id, data);
+
+					if (name.size() != data.serializedName.size())
+					{
+						m_tempWNodeNameIndex.add(data.serializedName, static_cast<uint32_t>(id));
+					}
+					else
+					{
+						m_tempNodeNameIndex.add(name, static_cast<uint32_t>(id));
+					}
 				}
 				m_tempNodeTypes.emplace(static_cast<uint32_t>(id), data.type);
 			}
@@ -151,7 +307,10 @@ std::vector<Id> SqliteIndexStorage::addNodes(const std::vector<StorageNode>& nod
 
 	if (nodesToInsert.size())
 	{
+		flushBulkLoadElements();
+		storeAddedNames(*nameTree);
 		m_insertNodeBatchStatement.execute(nodesToInsert, this);
+		m_insertNodeNameBatchStatement.execute(nodeNamesToInsert, this);
 	}
 
 	return nodeIds;
@@ -169,7 +328,14 @@ bool SqliteIndexStorage::addSymbols(const std::vector<StorageSymbol>& symbols)
 
 bool SqliteIndexStorage::addFile(const StorageFile& data)
 {
-	if (getFileByPath(data.filePath).id != 0)
+	if (m_bulkLoad)
+	{
+		if (!m_tempFilePaths.insert(data.filePath).second)
+		{
+			return false;
+		}
+	}
+	else if (getFileByPath(data.filePath).id != 0)
 	{
 		return false;
 	}
@@ -204,9 +370,7 @@ bool SqliteIndexStorage::addFile(const StorageFile& data)
 
 	if (success && content)
 	{
-		m_insertFileContentStmt.bind(1, int(data.id));
-		m_insertFileContentStmt.bind(2, content->getText().c_str());
-		success = executeStatement(m_insertFileContentStmt);
+		success = addFileContent(data.id, *content);
 	}
 
 	return success;
@@ -241,8 +405,7 @@ std::vector<Id> SqliteIndexStorage::addEdges(const std::vector<StorageEdge>& edg
 		}
 		else
 		{
-			executeStatement(m_insertElementStmt);
-			const Id id = static_cast<Id>(m_database.lastRowId());
+			const Id id = addElement();
 
 			edgeIds[i] = id;
 			edgesToInsert.emplace_back(id, data);
@@ -253,6 +416,7 @@ std::vector<Id> SqliteIndexStorage::addEdges(const std::vector<StorageEdge>& edg
 
 	if (edgesToInsert.size())
 	{
+		flushBulkLoadElements();
 		m_insertEdgeBatchStatement.execute(edgesToInsert, this);
 	}
 
@@ -301,8 +465,7 @@ std::vector<Id> SqliteIndexStorage::addLocalSymbols(const std::set<StorageLocalS
 
 		if (!symbolIds[i])
 		{
-			executeStatement(m_insertElementStmt);
-			const Id id = static_cast<Id>(m_database.lastRowId());
+			const Id id = addElement();
 
 			symbolIds[i] = id;
 			symbolsToInsert.emplace_back(id, data);
@@ -317,6 +480,7 @@ std::vector<Id> SqliteIndexStorage::addLocalSymbols(const std::set<StorageLocalS
 
 	if (symbolsToInsert.size())
 	{
+		flushBulkLoadElements();
 		m_insertLocalSymbolBatchStatement.execute(symbolsToInsert, this);
 	}
 
@@ -349,7 +513,9 @@ std::vector<Id> SqliteIndexStorage::addSourceLocations(const std::vector<Storage
 
 	std::vector<Id> locationIds(locations.size(), 0);
 	std::vector<StorageSourceLocationData> locationsToInsert;
-	size_t lastRowId = executeStatementScalar("SELECT MAX(rowid) from source_location", 0);
+	const size_t lastRowId = m_bulkLoad
+		? m_nextBulkLoadSourceLocationId - 1
+		: executeStatementScalar("SELECT MAX(rowid) from source_location", 0);
 
 	for (size_t i = 0; i < locations.size(); i++)
 	{
@@ -370,7 +536,8 @@ std::vector<Id> SqliteIndexStorage::addSourceLocations(const std::vector<Storage
 		}
 		else
 		{
-			executeStatement(m_insertElementStmt);
+			// each location takes an element id as well, so bulk loads assign the same ids
+			addElement();
 			Id id = lastRowId + 1 + locationsToInsert.size();
 
 			locationIds[i] = id;
@@ -383,6 +550,11 @@ std::vector<Id> SqliteIndexStorage::addSourceLocations(const std::vector<Storage
 	if (locationsToInsert.size())
 	{
 		m_insertSourceLocationBatchStatement.execute(locationsToInsert, this);
+
+		if (m_bulkLoad)
+		{
+			m_nextBulkLoadSourceLocationId += locationsToInsert.size();
+		}
 	}
 
 	return locationIds;
@@ -430,6 +602,15 @@ StorageError SqliteIndexStorage::addError(const StorageErrorData& data)
 	const std::wstring sanitizedMessage = utility::replace(data.message, L"'", L"''");
 
 	Id id = 0;
+	if (m_bulkLoad)
+	{
+		auto it = m_tempErrorIndex.find(std::make_pair(sanitizedMessage, data.fatal));
+		if (it != m_tempErrorIndex.end())
+		{
+			id = it->second;
+		}
+	}
+	else
 	{
 		m_checkErrorExistsStmt.bind(1, utility::encodeToUtf8(sanitizedMessage).c_str());
 		m_checkErrorExistsStmt.bind(2, int(data.fatal));
@@ -444,8 +625,8 @@ StorageError SqliteIndexStorage::addError(const StorageErrorData& data)
 
 	if (id == 0)
 	{
-		executeStatement(m_insertElementStmt);
-		id = static_cast<Id>(m_database.lastRowId());
+		id = addElement();
+		flushBulkLoadElements();
 
 		m_insertErrorStmt.bind(1, int(id));
 		m_insertErrorStmt.bind(2, utility::encodeToUtf8(sanitizedMessage).c_str());
@@ -457,6 +638,11 @@ StorageError SqliteIndexStorage::addError(const StorageErrorData& data)
 		if (success)
 		{
 			id = static_cast<Id>(m_database.lastRowId());
+
+			if (m_bulkLoad)
+			{
+				m_tempErrorIndex.emplace(std::make_pair(sanitizedMessage, data.fatal), id);
+			}
 		}
 	}
 
@@ -472,8 +658,13 @@ void SqliteIndexStorage::removeElement(Id id)
 
 void SqliteIndexStorage::removeElements(const std::vector<Id>& ids)
 {
-	executeStatement(
-		"DELETE FROM element WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ");");
+	TRACE();
+
+	const TempIdTable idTable(this, ids);
+	executeStatement("DELETE FROM element WHERE id IN " + idTable.getQuery() + ";");
+
+	// clearing files removes the file nodes last, so their names are released here
+	removeUnusedNames();
 }
 
 void SqliteIndexStorage::removeOccurrence(const StorageOccurrence& occurrence)
@@ -493,150 +684,135 @@ void SqliteIndexStorage::removeOccurrences(const std::vector<StorageOccurrence>&
 
 void SqliteIndexStorage::removeElementsWithoutOccurrences(const std::vector<Id>& elementIds)
 {
+	TRACE();
+
+	const TempIdTable elementIdTable(this, elementIds);
 	executeStatement(
-		"DELETE FROM element WHERE id IN (" + utility::join(utility::toStrings(elementIds), ',') +
-		") AND id NOT IN (SELECT element_id FROM occurrence);");
+		"DELETE FROM element WHERE id IN " + elementIdTable.getQuery() +
+		" AND id NOT IN (SELECT element_id FROM occurrence);");
 }
 
 void SqliteIndexStorage::removeElementsWithLocationInFiles(
 	const std::vector<Id>& fileIds, std::function<void(int)> updateStatusCallback)
 {
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(1);
-	}
+	TRACE();
 
-	// preparing
-	executeStatement("DROP TABLE IF EXISTS main.element_id_to_clear;");
+	const auto updateStatus = [&updateStatusCallback](int progress) {
+		if (updateStatusCallback != nullptr)
+		{
+			updateStatusCallback(progress);
+		}
+	};
 
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(2);
-	}
+	updateStatus(1);
 
+	// elements located in the cleared files are collected as candidates, the ones that are still
+	// referenced from other files are kept after all files have been cleared. all lookups go
+	// through the indices from the files to their locations, occurrences and edges.
 	executeStatement(
-		"CREATE TABLE IF NOT EXISTS element_id_to_clear("
-		"id INTEGER NOT NULL, "
-		"PRIMARY KEY(id));");
-
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(3);
-	}
-
-	// store ids of all elements located in fileIds into element_id_to_clear
+		"CREATE TEMP TABLE IF NOT EXISTS element_id_to_clear(id INTEGER PRIMARY KEY);");
 	executeStatement(
-		"INSERT INTO element_id_to_clear "
-		"	SELECT occurrence.element_id "
-		"	FROM occurrence "
-		"	INNER JOIN source_location ON ("
-		"		occurrence.source_location_id = source_location.id"
-		"	) "
-		"	WHERE source_location.file_node_id IN (" +
-		utility::join(utility::toStrings(fileIds), ',') +
-		")"
-		"	GROUP BY (occurrence.element_id)");
+		"CREATE TEMP TABLE IF NOT EXISTS chunk_element_id_to_clear(id INTEGER PRIMARY KEY);");
+	executeStatement("DELETE FROM temp.element_id_to_clear;");
 
-	if (updateStatusCallback != nullptr)
+	std::map<Id, size_t> locationCounts;
 	{
-		updateStatusCallback(4);
+		const TempIdTable fileIdTable(this, fileIds);
+		CppSQLite3Query q = executeQuery(
+			"SELECT file_node_id, COUNT(*) FROM source_location WHERE file_node_id IN " +
+			fileIdTable.getQuery() + " GROUP BY file_node_id;");
+		while (!q.eof())
+		{
+			locationCounts[q.getIntField(0, 0)] = q.getIntField(1, 0);
+			q.nextRow();
+		}
 	}
 
-	// delete all edges in element_id_to_clear
-	executeStatement(
-		"DELETE FROM element WHERE element.id IN "
-		"	(SELECT element_id_to_clear.id FROM element_id_to_clear INNER JOIN edge ON "
-		"(element_id_to_clear.id = edge.id))");
-
-	if (updateStatusCallback != nullptr)
+	// every file counts as one location, so files without locations still move the progress
+	size_t totalWork = 0;
+	for (Id fileId: fileIds)
 	{
-		updateStatusCallback(30);
+		totalWork += locationCounts[fileId] + 1;
 	}
 
-	// delete all edges originating from element_id_to_clear
-	executeStatement(
-		"DELETE FROM element WHERE element.id IN (SELECT id FROM edge WHERE source_node_id IN "
-		"(SELECT id FROM element_id_to_clear))");
+	size_t doneWork = 0;
+	size_t chunkCount = 0;
+	size_t removedEdgeCount = 0;
+	size_t removedLocationCount = 0;
 
-	if (updateStatusCallback != nullptr)
+	std::vector<Id> chunkFileIds;
+	size_t chunkWork = 0;
+	for (size_t i = 0; i < fileIds.size(); i++)
 	{
-		updateStatusCallback(31);
-	}
+		chunkFileIds.push_back(fileIds[i]);
+		chunkWork += locationCounts[fileIds[i]] + 1;
 
-	// remove all non existing ids from element_id_to_clear (they have been cleared by now and we
-	// can disregard them)
-	executeStatement(
-		"DELETE FROM element_id_to_clear WHERE id NOT IN ("
-		"	SELECT id FROM element"
-		")");
+		if (chunkWork < s_clearChunkLocationCount && chunkFileIds.size() < s_clearChunkFileCount &&
+			i + 1 < fileIds.size())
+		{
+			continue;
+		}
 
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(33);
-	}
+		const TempIdTable fileIdTable(this, chunkFileIds);
 
-	// remove all files from element_id_to_clear (they will be cleared later)
-	executeStatement(
-		"DELETE FROM element_id_to_clear WHERE id IN ("
-		"	SELECT id FROM file"
-		")");
+		executeStatement("DELETE FROM temp.chunk_element_id_to_clear;");
+		executeStatement(
+			"INSERT OR IGNORE INTO temp.chunk_element_id_to_clear "
+			"	SELECT occurrence.element_id FROM source_location "
+			"	INNER JOIN occurrence ON occurrence.source_location_id = source_location.id "
+			"	WHERE source_location.file_node_id IN " +
+			fileIdTable.getQuery() + ";");
+
+		// delete edges located in the files and edges originating from elements located there
+		removedEdgeCount += executeStatementChangeCount(
+			"DELETE FROM element WHERE id IN ("
+			"	SELECT edge.id FROM temp.chunk_element_id_to_clear AS chunk "
+			"	INNER JOIN edge ON edge.id = chunk.id"
+			");");
+		removedEdgeCount += executeStatementChangeCount(
+			"DELETE FROM element WHERE id IN ("
+			"	SELECT edge.id FROM temp.chunk_element_id_to_clear AS chunk "
+			"	INNER JOIN edge ON edge.source_node_id = chunk.id"
+			");");
 
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(34);
-	}
+		// this also deletes the occurrences of the source locations
+		removedLocationCount += executeStatementChangeCount(
+			"DELETE FROM source_location WHERE file_node_id IN " + fileIdTable.getQuery() + ";");
 
-	// delete source locations from fileIds (this also deletes the respective occurrences)
-	executeStatement(
-		"DELETE FROM source_location WHERE file_node_id IN (" +
-		utility::join(utility::toStrings(fileIds), ',') + ");");
+		executeStatement(
+			"INSERT OR IGNORE INTO temp.element_id_to_clear "
+			"	SELECT id FROM temp.chunk_element_id_to_clear;");
 
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(45);
-	}
+		doneWork += chunkWork;
+		chunkCount++;
+		updateStatus(1 + static_cast<int>(89 * doneWork / std::max<size_t>(totalWork, 1)));
 
-	// remove all ids from element_id_to_clear that still have occurrences
-	executeStatement(
-		"DELETE FROM element_id_to_clear WHERE id IN ("
-		"	SELECT element_id_to_clear.id FROM element_id_to_clear INNER JOIN occurrence ON "
-		"		element_id_to_clear.id = occurrence.element_id"
-		")");
-
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(59);
+		chunkFileIds.clear();
+		chunkWork = 0;
 	}
 
-	// remove all ids from element_id_to_clear that still have an edge pointing to them
+	// keep files (they are cleared later) and elements that are still referenced
 	executeStatement(
-		"DELETE FROM element_id_to_clear WHERE id IN ("
-		"	SELECT target_node_id FROM edge"
-		")");
-
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(74);
-	}
+		"DELETE FROM temp.element_id_to_clear WHERE "
+		"	EXISTS (SELECT 1 FROM file WHERE file.id = element_id_to_clear.id) OR "
+		"	EXISTS (SELECT 1 FROM occurrence WHERE occurrence.element_id = element_id_to_clear.id) "
+		"	OR EXISTS (SELECT 1 FROM edge WHERE edge.target_node_id = element_id_to_clear.id);");
 
-	// delete all elements that are still listed in element_id_to_clear
-	executeStatement(
-		"DELETE FROM element WHERE EXISTS ("
-		"	SELECT * FROM element_id_to_clear WHERE element.id = element_id_to_clear.id"
-		")");
+	updateStatus(92);
 
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(87);
-	}
+	const size_t removedElementCount = executeStatementChangeCount(
+		"DELETE FROM element WHERE id IN (SELECT id FROM temp.element_id_to_clear);");
 
 	// cleaning up
-	executeStatement("DROP TABLE IF EXISTS main.element_id_to_clear;");
+	executeStatement("DELETE FROM temp.element_id_to_clear;");
+	executeStatement("DELETE FROM temp.chunk_element_id_to_clear;");
 
-	if (updateStatusCallback != nullptr)
-	{
-		updateStatusCallback(89);
-	}
+	updateStatus(95);
+
+	LOG_INFO_STREAM(
+		<< "Cleared " << fileIds.size() << " files in " << chunkCount
+		<< " chunks - removed source locations: " << removedLocationCount
+		<< " edges: " << removedEdgeCount << " elements: " << removedElementCount);
 }
 
 void SqliteIndexStorage::removeAllErrors()
@@ -699,8 +875,10 @@ std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceId(Id sourceId) con
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceIds(const std::vector<Id>& sourceIds) const
 {
-	return doGetAll<StorageEdge>(
-		"WHERE source_node_id IN (" + utility::join(utility::toStrings(sourceIds), ',') + ")");
+	TRACE();
+
+	const TempIdTable sourceIdTable(this, sourceIds);
+	return doGetAll<StorageEdge>("WHERE source_node_id IN " + sourceIdTable.getQuery());
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetId(Id targetId) const
@@ -710,8 +888,10 @@ std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetId(Id targetId) con
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetIds(const std::vector<Id>& targetIds) const
 {
-	return doGetAll<StorageEdge>(
-		"WHERE target_node_id IN (" + utility::join(utility::toStrings(targetIds), ',') + ")");
+	TRACE();
+
+	const TempIdTable targetIdTable(this, targetIds);
+	return doGetAll<StorageEdge>("WHERE target_node_id IN " + targetIdTable.getQuery());
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceOrTargetId(Id id) const
@@ -736,11 +916,12 @@ std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceType(Id sourceId, i
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourcesType(
 	const std::vector<Id>& sourceIds, int type) const
 {
+	TRACE();
+
+	const TempIdTable sourceIdTable(this, sourceIds);
 	return doGetAll<StorageEdge>(
-		"WHERE source_node_id IN (" + utility::join(utility::toStrings(sourceIds), ',') +
-		")"
-		" AND type == " +
-		std::to_string(type));
+		"WHERE source_node_id IN " + sourceIdTable.getQuery() +
+		" AND type == " + std::to_string(type));
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetType(Id targetId, int type) const
@@ -753,11 +934,12 @@ std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetType(Id targetId, i
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetsType(
 	const std::vector<Id>& targetIds, int type) const
 {
+	TRACE();
+
+	const TempIdTable targetIdTable(this, targetIds);
 	return doGetAll<StorageEdge>(
-		"WHERE target_node_id IN (" + utility::join(utility::toStrings(targetIds), ',') +
-		")"
-		" AND type == " +
-		std::to_string(type));
+		"WHERE target_node_id IN " + targetIdTable.getQuery() +
+		" AND type == " + std::to_string(type));
 }
 
 StorageNode SqliteIndexStorage::getNodeById(Id id) const
@@ -774,6 +956,18 @@ StorageNode SqliteIndexStorage::getNodeById(Id id) const
 
 StorageNode SqliteIndexStorage::getNodeBySerializedName(const std::wstring& serializedName) const
 {
+	const uint32_t nameId = getNameTree()->findSerializedName(serializedName);
+	if (nameId)
+	{
+		const StorageNode node = doGetFirst<StorageNode>(
+			"WHERE node.id = (SELECT node_id FROM node_name WHERE name_id = " +
+			std::to_string(nameId) + ")");
+		if (node.id != 0)
+		{
+			return node;
+		}
+	}
+
 	CppSQLite3Statement stmt = m_database.compileStatement(
 		"SELECT id, type, serialized_name FROM node WHERE serialized_name == ? LIMIT 1;");
 
@@ -817,6 +1011,27 @@ std::vector<int> SqliteIndexStorage::getAvailableNodeTypes() const
 	return types;
 }
 
+std::vector<std::pair<Id, int>> SqliteIndexStorage::getAllNodeTypes() const
+{
+	CppSQLite3Query q = executeQuery("SELECT id, type FROM node ORDER BY id;");
+
+	std::vector<std::pair<Id, int>> nodeTypes;
+
+	while (!q.eof())
+	{
+		const Id id = q.getIntField(0, 0);
+		const int type = q.getIntField(1, -1);
+		if (id != 0 && type != -1)
+		{
+			nodeTypes.emplace_back(id, type);
+		}
+
+		q.nextRow();
+	}
+
+	return nodeTypes;
+}
+
 std::vector<int> SqliteIndexStorage::getAvailableEdgeTypes() const
 {
 	CppSQLite3Query q = executeQuery("SELECT DISTINCT type FROM edge;");
@@ -850,6 +1065,13 @@ std::vector<StorageFile> SqliteIndexStorage::getFilesByPaths(const std::vector<F
 
 std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentById(Id fileId) const
 {
+	if (const Id contentId = getFileContentId("file_id = " + std::to_string(fileId)))
+	{
+		return TextAccess::createFromLines(
+			getFileContentLines(contentId, 1, std::numeric_limits<size_t>::max()));
+	}
+
+	// contents written by other tools are not compressed
 	CppSQLite3Query q = executeQuery(
 		"SELECT content FROM filecontent WHERE id = '" + std::to_string(fileId) + "';");
 	if (!q.eof())
@@ -862,6 +1084,14 @@ std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentById(Id fileId) co
 
 std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentByPath(const std::wstring& filePath) const
 {
+	const std::string fileCondition = "file_id = (SELECT id FROM file WHERE path = '" +
+		utility::encodeToUtf8(filePath) + "')";
+	if (const Id contentId = getFileContentId(fileCondition))
+	{
+		return TextAccess::createFromLines(
+			getFileContentLines(contentId, 1, std::numeric_limits<size_t>::max()));
+	}
+
 	try
 	{
 		CppSQLite3Query q = executeQuery(
@@ -884,6 +1114,44 @@ std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentByPath(const std::
 	return TextAccess::createFromString("");
 }
 
+std::vector<std::string> SqliteIndexStorage::getFileContentLinesByPath(
+	const std::wstring& filePath, size_t firstLineNumber, size_t lastLineNumber) const
+{
+	const std::string fileCondition = "file_id = (SELECT id FROM file WHERE path = '" +
+		utility::encodeToUtf8(filePath) + "')";
+	if (const Id contentId = getFileContentId(fileCondition))
+	{
+		return getFileContentLines(contentId, firstLineNumber, lastLineNumber);
+	}
+
+	std::shared_ptr<TextAccess> content = getFileContentByPath(filePath);
+	if (firstLineNumber < 1 || firstLineNumber > lastLineNumber ||
+		lastLineNumber > content->getLineCount())
+	{
+		return {};
+	}
+	return content->getLines(
+		static_cast<unsigned int>(firstLineNumber), static_cast<unsigned int>(lastLineNumber));
+}
+
+bool SqliteIndexStorage::hasFileContentByPath(const std::wstring& filePath) const
+{
+	const std::string fileCondition = "file.path = '" + utility::encodeToUtf8(filePath) + "'";
+	return executeStatementScalar(
+			   "SELECT EXISTS ("
+			   "SELECT 1 FROM file_compressed_content "
+			   "INNER JOIN compressed_content "
+			   "ON compressed_content.id = file_compressed_content.content_id "
+			   "INNER JOIN file ON file.id = file_compressed_content.file_id "
+			   "WHERE compressed_content.line_count > 0 AND " +
+				   fileCondition +
+				   ") OR EXISTS ("
+				   "SELECT 1 FROM filecontent INNER JOIN file ON filecontent.id = file.id "
+				   "WHERE filecontent.content != '' AND " +
+				   fileCondition + ");",
+			   0) > 0;
+}
+
 void SqliteIndexStorage::setFileIndexed(Id fileId, bool indexed)
 {
 	executeStatement(
@@ -977,9 +1245,32 @@ std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsOfType
 		filePath, "AND type == " + std::to_string(locationTypeToInt(type)));
 }
 
+std::shared_ptr<SourceLocationIntervalIndex> SqliteIndexStorage::
+	getSourceLocationIntervalIndexForFile(Id fileId) const
+{
+	TRACE();
+
+	std::shared_ptr<SourceLocationIntervalIndex> index =
+		std::make_shared<SourceLocationIntervalIndex>();
+
+	const std::string fileCondition = "file_node_id == " + std::to_string(fileId);
+	forEach<StorageSourceLocation>(
+		"WHERE " + fileCondition, [&index](StorageSourceLocation&& location) {
+			index->addSourceLocation(location);
+		});
+	forEach<StorageOccurrence>(
+		"WHERE source_location_id IN (SELECT id FROM source_location WHERE " + fileCondition + ")",
+		[&index](StorageOccurrence&& occurrence) { index->addOccurrence(occurrence); });
+
+	index->finishSetup();
+	return index;
+}
+
 std::shared_ptr<SourceLocationCollection> SqliteIndexStorage::getSourceLocationsForElementIds(
 	const std::vector<Id>& elementIds) const
 {
+	TRACE();
+
 	std::vector<Id> sourceLocationIds;
 	std::map<Id, std::vector<Id>> sourceLocationIdToElementIds;
 	for (const StorageOccurrence& occurrence: getOccurrencesForElementIds(elementIds))
@@ -988,13 +1279,14 @@ std::shared_ptr<SourceLocationCollection> SqliteIndexStorage::getSourceLocations
 		sourceLocationIdToElementIds[occurrence.sourceLocationId].push_back(occurrence.elementId);
 	}
 
+	const TempIdTable sourceLocationIdTable(this, sourceLocationIds);
 	CppSQLite3Query q = executeQuery(
 		"SELECT source_location.id, file.path, source_location.start_line, "
 		"source_location.start_column, "
 		"source_location.end_line, source_location.end_column, source_location.type "
 		"FROM source_location INNER JOIN file ON (file.id = source_location.file_node_id) "
-		"WHERE source_location.id IN (" +
-		utility::join(utility::toStrings(sourceLocationIds), ',') + ");");
+		"WHERE source_location.id IN " +
+		sourceLocationIdTable.getQuery() + ";");
 
 	std::shared_ptr<SourceLocationCollection> ret = std::make_shared<SourceLocationCollection>();
 
@@ -1037,15 +1329,19 @@ std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForLocationId(I
 std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForLocationIds(
 	const std::vector<Id>& locationIds) const
 {
-	return doGetAll<StorageOccurrence>(
-		"WHERE source_location_id IN (" + utility::join(utility::toStrings(locationIds), ',') + ")");
+	TRACE();
+
+	const TempIdTable locationIdTable(this, locationIds);
+	return doGetAll<StorageOccurrence>("WHERE source_location_id IN " + locationIdTable.getQuery());
 }
 
 std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForElementIds(
 	const std::vector<Id>& elementIds) const
 {
-	return doGetAll<StorageOccurrence>(
-		"WHERE element_id IN (" + utility::join(utility::toStrings(elementIds), ',') + ")");
+	TRACE();
+
+	const TempIdTable elementIdTable(this, elementIds);
+	return doGetAll<StorageOccurrence>("WHERE element_id IN " + elementIdTable.getQuery());
 }
 
 StorageComponentAccess SqliteIndexStorage::getComponentAccessByNodeId(Id nodeId) const
@@ -1056,15 +1352,19 @@ StorageComponentAccess SqliteIndexStorage::getComponentAccessByNodeId(Id nodeId)
 std::vector<StorageComponentAccess> SqliteIndexStorage::getComponentAccessesByNodeIds(
 	const std::vector<Id>& nodeIds) const
 {
-	return doGetAll<StorageComponentAccess>(
-		"WHERE node_id IN (" + utility::join(utility::toStrings(nodeIds), ',') + ")");
+	TRACE();
+
+	const TempIdTable nodeIdTable(this, nodeIds);
+	return doGetAll<StorageComponentAccess>("WHERE node_id IN " + nodeIdTable.getQuery());
 }
 
 std::vector<StorageElementComponent> SqliteIndexStorage::getElementComponentsByElementIds(
 	const std::vector<Id>& elementIds) const
 {
-	return doGetAll<StorageElementComponent>(
-		"WHERE element_id IN (" + utility::join(utility::toStrings(elementIds), ',') + ")");
+	TRACE();
+
+	const TempIdTable elementIdTable(this, elementIds);
+	return doGetAll<StorageElementComponent>("WHERE element_id IN " + elementIdTable.getQuery());
 }
 
 std::vector<ErrorInfo> SqliteIndexStorage::getAllErrorInfos() const
@@ -1160,6 +1460,73 @@ int SqliteIndexStorage::getErrorCount() const
 		"SELECT COUNT(*) FROM error INNER JOIN occurrence ON (error.id = occurrence.element_id);", 0);
 }
 
+int SqliteIndexStorage::getFileContentCount() const
+{
+	return executeStatementScalar("SELECT COUNT(*) FROM compressed_content;", 0);
+}
+
+int SqliteIndexStorage::getNameCount() const
+{
+	return executeStatementScalar("SELECT COUNT(*) FROM name;", 0);
+}
+
+const size_t SqliteIndexStorage::TempIdTable::s_minTableIdCount = 16;
+
+SqliteIndexStorage::TempIdTable::TempIdTable(
+	const SqliteIndexStorage* storage, const std::vector<Id>& ids)
+	: m_storage(storage)
+{
+	if (ids.size() < s_minTableIdCount)
+	{
+		m_inlineIds = '(' + utility::join(utility::toStrings(ids), ',') + ')';
+		return;
+	}
+
+	m_lock = std::unique_lock<std::recursive_mutex>(storage->m_tempIdTableMutex);
+	m_level = storage->m_tempIdTableCount;
+
+	std::vector<std::unique_ptr<InsertBatchStatement<Id>>>& statements =
+		storage->m_insertTempIdStatements;
+	if (m_level == statements.size())
+	{
+		const std::string tableName = "query_id_" + std::to_string(m_level);
+		storage->executeStatement(
+			"CREATE TEMP TABLE IF NOT EXISTS " + tableName + "(id INTEGER PRIMARY KEY);");
+
+		std::unique_ptr<InsertBatchStatement<Id>> statement =
+			std::make_unique<InsertBatchStatement<Id>>();
+		statement->compile(
+			"INSERT OR IGNORE INTO temp." + tableName + "(id) VALUES",
+			1,
+			[](CppSQLite3Statement& stmt, const Id& id, size_t index) {
+				stmt.bind(int(index) + 1, int(id));
+			},
+			storage->m_database);
+		statements.push_back(std::move(statement));
+	}
+
+	statements[m_level]->execute(ids, storage);
+	storage->m_tempIdTableCount++;
+}
+
+SqliteIndexStorage::TempIdTable::~TempIdTable()
+{
+	if (m_lock.owns_lock())
+	{
+		m_storage->executeStatement("DELETE FROM temp.query_id_" + std::to_string(m_level) + ";");
+		m_storage->m_tempIdTableCount--;
+	}
+}
+
+std::string SqliteIndexStorage::TempIdTable::getQuery() const
+{
+	if (!m_lock.owns_lock())
+	{
+		return m_inlineIds;
+	}
+	return "(SELECT id FROM temp.query_id_" + std::to_string(m_level) + ")";
+}
+
 std::vector<std::pair<int, SqliteDatabaseIndex>> SqliteIndexStorage::getIndices() const
 {
 	std::vector<std::pair<int, SqliteDatabaseIndex>> indices;
@@ -1172,6 +1539,9 @@ std::vector<std::pair<int, SqliteDatabaseIndex>> SqliteIndexStorage::getIndices(
 	indices.push_back(std::make_pair(
 		STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
 		SqliteDatabaseIndex("node_serialized_name_index", "node(serialized_name)")));
+	indices.push_back(std::make_pair(
+		STORAGE_MODE_READ | STORAGE_MODE_WRITE,
+		SqliteDatabaseIndex("node_name_name_id_index", "node_name(name_id)")));
 	indices.push_back(std::make_pair(
 		STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
 		SqliteDatabaseIndex("source_location_file_node_id_index", "source_location(file_node_id)")));
@@ -1179,6 +1549,13 @@ std::vector<std::pair<int, SqliteDatabaseIndex>> SqliteIndexStorage::getIndices(
 		STORAGE_MODE_WRITE, SqliteDatabaseIndex("error_all_data_index", "error(message, fatal)")));
 	indices.push_back(
 		std::make_pair(STORAGE_MODE_WRITE, SqliteDatabaseIndex("file_path_index", "file(path)")));
+	indices.push_back(std::make_pair(
+		STORAGE_MODE_WRITE,
+		SqliteDatabaseIndex("compressed_content_hash_index", "compressed_content(hash)")));
+	indices.push_back(std::make_pair(
+		STORAGE_MODE_CLEAR,
+		SqliteDatabaseIndex(
+			"file_compressed_content_content_id_index", "file_compressed_content(content_id)")));
 	indices.push_back(std::make_pair(
 		STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
 		SqliteDatabaseIndex("occurrence_element_id_index", "occurrence(element_id)")));
@@ -1210,18 +1587,364 @@ std::vector<std::pair<int, SqliteDatabaseIndex>> SqliteIndexStorage::getIndices(
 	return indices;
 }
 
+void SqliteIndexStorage::startBulkLoad()
+{
+	LOG_INFO("Starting bulk load into empty database");
+
+	{
+		CppSQLite3Query q = executeQuery("PRAGMA journal_mode;");
+		m_preBulkLoadJournalMode = q.eof() ? "delete" : q.getStringField(0, "delete");
+	}
+	m_preBulkLoadSynchronous = executeStatementScalar("PRAGMA synchronous;", 2);
+
+	// all ids are assigned in memory, so the foreign keys cannot be violated while loading
+	executeStatement("PRAGMA foreign_keys=OFF;");
+	executeQuery("PRAGMA journal_mode=MEMORY;");
+	executeStatement("PRAGMA synchronous=OFF;");
+
+	m_nextBulkLoadElementId = 1;
+	m_nextBulkLoadSourceLocationId = 1;
+	m_bulkLoad = true;
+}
+
+void SqliteIndexStorage::finishBulkLoad()
+{
+	flushBulkLoadElements();
+	m_bulkLoad = false;
+
+	executeStatement("PRAGMA synchronous=" + std::to_string(m_preBulkLoadSynchronous) + ";");
+	executeQuery("PRAGMA journal_mode=" + m_preBulkLoadJournalMode + ";");
+	executeStatement("PRAGMA foreign_keys=ON;");
+
+	LOG_INFO_STREAM(
+		<< "Finished bulk load of " << (m_nextBulkLoadElementId - 1) << " elements and "
+		<< (m_nextBulkLoadSourceLocationId - 1) << " source locations");
+}
+
+Id SqliteIndexStorage::addElement()
+{
+	if (m_bulkLoad)
+	{
+		m_bulkLoadElementIds.push_back(m_nextBulkLoadElementId);
+		return m_nextBulkLoadElementId++;
+	}
+
+	executeStatement(m_insertElementStmt);
+	return static_cast<Id>(m_database.lastRowId());
+}
+
+void SqliteIndexStorage::flushBulkLoadElements()
+{
+	if (m_bulkLoadElementIds.size())
+	{
+		m_insertElementBatchStatement.execute(m_bulkLoadElementIds, this);
+		m_bulkLoadElementIds.clear();
+	}
+}
+
+std::shared_ptr<SerializedNameTree> SqliteIndexStorage::getNameTree() const
+{
+	std::lock_guard<std::mutex> lock(m_nameTreeMutex);
+
+	if (!m_nameTree)
+	{
+		std::shared_ptr<SerializedNameTree> nameTree = std::make_shared<SerializedNameTree>();
+
+		CppSQLite3Query partQuery = executeQuery("SELECT id, text FROM name_part;");
+		while (!partQuery.eof())
+		{
+			nameTree->loadPart(
+				partQuery.getIntField(0, 0),
+				utility::decodeFromUtf8(partQuery.getStringField(1, "")));
+			partQuery.nextRow();
+		}
+
+		CppSQLite3Query nameQuery = executeQuery(
+			"SELECT id, parent_id, element_id, signature_id FROM name;");
+		while (!nameQuery.eof())
+		{
+			const SerializedNameTree::Name name = {
+				static_cast<uint32_t>(nameQuery.getIntField(1, 0)),
+				static_cast<uint32_t>(nameQuery.getIntField(2, 0)),
+				static_cast<uint32_t>(nameQuery.getIntField(3, 0))};
+			nameTree->loadName(nameQuery.getIntField(0, 0), name);
+			nameQuery.nextRow();
+		}
+
+		m_nameTree = nameTree;
+	}
+
+	return m_nameTree;
+}
+
+void SqliteIndexStorage::clearNameTree() const
+{
+	std::lock_guard<std::mutex> lock(m_nameTreeMutex);
+
+	// readers keep their snapshot until they are done with it
+	m_nameTree.reset();
+}
+
+void SqliteIndexStorage::storeAddedNames(SerializedNameTree& nameTree)
+{
+	// parents are added before their children, so every stored name can be rebuilt
+	std::vector<std::pair<uint32_t, std::wstring>> parts;
+	for (const uint32_t partId: nameTree.takeAddedPartIds())
+	{
+		parts.emplace_back(partId, nameTree.getPart(partId));
+	}
+	m_insertNamePartBatchStatement.execute(parts, this);
+
+	std::vector<std::pair<uint32_t, SerializedNameTree::Name>> names;
+	for (const uint32_t nameId: nameTree.takeAddedNameIds())
+	{
+		names.emplace_back(nameId, nameTree.getName(nameId));
+	}
+	m_insertNameBatchStatement.execute(names, this);
+}
+
+void SqliteIndexStorage::storeInternedNamesInFull()
+{
+	TRACE();
+
+	const std::shared_ptr<SerializedNameTree> nameTree = getNameTree();
+
+	CppSQLite3Statement stmt = m_database.compileStatement(
+		"UPDATE node SET serialized_name = ? WHERE id = ?;");
+
+	beginTransaction();
+
+	size_t nodeCount = 0;
+	CppSQLite3Query q = executeQuery("SELECT node_id, name_id FROM node_name;");
+	while (!q.eof())
+	{
+		const std::wstring serializedName = nameTree->getSerializedName(q.getIntField(1, 0));
+		stmt.bind(1, utility::encodeToUtf8(serializedName).c_str());
+		stmt.bind(2, q.getIntField(0, 0));
+		executeStatement(stmt);
+		nodeCount++;
+
+		q.nextRow();
+	}
+	q.finalize();
+
+	executeStatement("DELETE FROM node_name;");
+	removeUnusedNames();
+
+	commitTransaction();
+
+	LOG_INFO_STREAM(<< "Stored the full names of " << nodeCount << " nodes");
+}
+
+void SqliteIndexStorage::removeUnusedNames()
+{
+	executeStatement(
+		"DELETE FROM name WHERE id NOT IN ("
+		"	WITH RECURSIVE used_name(id) AS ("
+		"		SELECT name_id FROM node_name "
+		"		UNION SELECT name.parent_id FROM name "
+		"		INNER JOIN used_name ON name.id = used_name.id"
+		"	) "
+		"	SELECT id FROM used_name"
+		");");
+	executeStatement(
+		"DELETE FROM name_part WHERE id NOT IN ("
+		"	SELECT element_id FROM name UNION SELECT signature_id FROM name"
+		");");
+
+	// ids of removed names are assigned again
+	clearTempNodeIndex();
+	clearNameTree();
+}
+
+void SqliteIndexStorage::loadTempNodeIndex()
+{
+	CppSQLite3Query q = executeQuery(
+		"SELECT node.id, node.type, node.serialized_name, node_name.name_id FROM node "
+		"LEFT JOIN node_name ON node_name.node_id = node.id;");
+
+	while (!q.eof())
+	{
+		const uint32_t id = q.getIntField(0, 0);
+		const int type = q.getIntField(1, -1);
+		const uint32_t nameId = q.getIntField(3, 0);
+
+		if (id != 0 && type != -1)
+		{
+			if (nameId)
+			{
+				m_tempNameNodeIds.emplace(nameId, id);
+			}
+			else
+			{
+				const std::string name = q.getStringField(2, "");
+				const std::wstring serializedName = utility::decodeFromUtf8(name);
+				if (name.size() != serializedName.size())
+				{
+					m_tempWNodeNameIndex.add(serializedName, id);
+				}
+				else
+				{
+					m_tempNodeNameIndex.add(name, id);
+				}
+			}
+
+			m_tempNodeTypes.emplace(id, type);
+		}
+
+		q.nextRow();
+	}
+
+	m_tempNodeIndexLoaded = true;
+}
+
+void SqliteIndexStorage::clearTempNodeIndex()
+{
+	m_tempNodeIndexLoaded = false;
+	m_tempNameNodeIds.clear();
+	m_tempNodeNameIndex.clear();
+	m_tempWNodeNameIndex.clear();
+	m_tempNodeTypes.clear();
+}
+
+bool SqliteIndexStorage::addFileContent(Id fileId, const TextAccess& content)
+{
+	const std::vector<std::string>& lines = content.getAllLines();
+	const std::string text = content.getText();
+	const std::string hash = std::to_string(static_cast<long long>(utility::hashFnv1a(text)));
+
+	Id contentId = 0;
+	{
+		std::vector<Id> candidateIds;
+		CppSQLite3Query q = executeQuery(
+			"SELECT id FROM compressed_content WHERE hash = " + hash +
+			" AND size = " + std::to_string(text.size()) + ";");
+		while (!q.eof())
+		{
+			candidateIds.push_back(q.getIntField(0, 0));
+			q.nextRow();
+		}
+
+		// the hash only narrows down the candidates
+		for (const Id candidateId: candidateIds)
+		{
+			if (getFileContentLines(candidateId, 1, std::numeric_limits<size_t>::max()) == lines)
+			{
+				contentId = candidateId;
+				break;
+			}
+		}
+	}
+
+	if (!contentId)
+	{
+		if (!executeStatement(
+				"INSERT INTO compressed_content(hash, size, line_count) VALUES(" + hash + ", " +
+				std::to_string(text.size()) + ", " + std::to_string(lines.size()) + ");"))
+		{
+			return false;
+		}
+		contentId = static_cast<Id>(m_database.lastRowId());
+
+		size_t firstLineNumber = 1;
+		std::string block;
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			block += lines[i];
+			if (block.size() >= s_fileContentBlockSize || i + 1 == lines.size())
+			{
+				const std::string data = utility::compress(block);
+				m_insertFileContentBlockStmt.bind(1, int(contentId));
+				m_insertFileContentBlockStmt.bind(2, int(firstLineNumber));
+				m_insertFileContentBlockStmt.bind(3, int(i + 2 - firstLineNumber));
+				m_insertFileContentBlockStmt.bind(
+					4, reinterpret_cast<const unsigned char*>(data.data()), int(data.size()));
+				if (!executeStatement(m_insertFileContentBlockStmt))
+				{
+					return false;
+				}
+
+				firstLineNumber = i + 2;
+				block.clear();
+			}
+		}
+	}
+
+	m_insertFileContentReferenceStmt.bind(1, int(fileId));
+	m_insertFileContentReferenceStmt.bind(2, int(contentId));
+	return executeStatement(m_insertFileContentReferenceStmt);
+}
+
+Id SqliteIndexStorage::getFileContentId(const std::string& fileCondition) const
+{
+	return executeStatementScalar(
+		"SELECT content_id FROM file_compressed_content WHERE " + fileCondition + ";", 0);
+}
+
+std::vector<std::string> SqliteIndexStorage::getFileContentLines(
+	Id contentId, size_t firstLineNumber, size_t lastLineNumber) const
+{
+	std::vector<std::string> lines;
+	if (firstLineNumber < 1 || firstLineNumber > lastLineNumber)
+	{
+		return lines;
+	}
+
+	const std::string lastLine = std::to_string(
+		std::min<size_t>(lastLineNumber, std::numeric_limits<int>::max()));
+	CppSQLite3Query q = executeQuery(
+		"SELECT first_line, data FROM compressed_content_block WHERE content_id = " +
+		std::to_string(contentId) + " AND first_line <= " + lastLine +
+		" AND first_line + line_count > " + std::to_string(firstLineNumber) +
+		" ORDER BY first_line ASC;");
+
+	while (!q.eof())
+	{
+		size_t lineNumber = q.getIntField(0, 0);
+
+		int dataSize = 0;
+		const unsigned char* data = q.getBlobField(1, dataSize);
+		const std::string block = utility::decompress(
+			std::string(reinterpret_cast<const char*>(data), dataSize));
+
+		size_t start = 0;
+		while (start < block.size() && lineNumber <= lastLineNumber)
+		{
+			size_t end = block.find('\n', start);
+			end = (end == std::string::npos ? block.size() : end + 1);
+			if (lineNumber >= firstLineNumber)
+			{
+				lines.push_back(block.substr(start, end - start));
+			}
+			start = end;
+			lineNumber++;
+		}
+
+		q.nextRow();
+	}
+
+	return lines;
+}
+
 void SqliteIndexStorage::clearTables()
 {
 	try
 	{
+		m_database.execDML("DROP TABLE IF EXISTS main.index_time;");
 		m_database.execDML("DROP TABLE IF EXISTS main.error;");
 		m_database.execDML("DROP TABLE IF EXISTS main.component_access;");
 		m_database.execDML("DROP TABLE IF EXISTS main.occurrence;");
 		m_database.execDML("DROP TABLE IF EXISTS main.source_location;");
 		m_database.execDML("DROP TABLE IF EXISTS main.local_symbol;");
 		m_database.execDML("DROP TABLE IF EXISTS main.filecontent;");
+		m_database.execDML("DROP TABLE IF EXISTS main.file_compressed_content;");
+		m_database.execDML("DROP TABLE IF EXISTS main.compressed_content_block;");
+		m_database.execDML("DROP TABLE IF EXISTS main.compressed_content;");
 		m_database.execDML("DROP TABLE IF EXISTS main.file;");
 		m_database.execDML("DROP TABLE IF EXISTS main.symbol;");
+		m_database.execDML("DROP TABLE IF EXISTS main.node_name;");
+		m_database.execDML("DROP TABLE IF EXISTS main.name;");
+		m_database.execDML("DROP TABLE IF EXISTS main.name_part;");
 		m_database.execDML("DROP TABLE IF EXISTS main.node;");
 		m_database.execDML("DROP TABLE IF EXISTS main.edge;");
 		m_database.execDML("DROP TABLE IF EXISTS main.element_component;");
@@ -1232,9 +1955,12 @@ void SqliteIndexStorage::clearTables()
 	{
 		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
 	}
+
+	clearTempNodeIndex();
+	clearNameTree();
 }
 
-void SqliteIndexStorage::setupTables()
+void SqliteIndexStorage::setupCustomCommandTables()
 {
 	try
 	{
@@ -1352,17 +2078,141 @@ void SqliteIndexStorage::setupTables()
 	}
 }
 
+void SqliteIndexStorage::setupTables()
+{
+	setupCustomCommandTables();
+
+	try
+	{
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS name_part("
+			"id INTEGER NOT NULL, "
+			"text TEXT NOT NULL, "
+			"PRIMARY KEY(id));");
+
+		// roots have no parent and the delimiter as element, the other names refer to the parts of
+		// their last element
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS name("
+			"id INTEGER NOT NULL, "
+			"parent_id INTEGER NOT NULL, "
+			"element_id INTEGER NOT NULL, "
+			"signature_id INTEGER NOT NULL, "
+			"PRIMARY KEY(id));");
+
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS node_name("
+			"node_id INTEGER NOT NULL, "
+			"name_id INTEGER NOT NULL, "
+			"PRIMARY KEY(node_id), "
+			"FOREIGN KEY(node_id) REFERENCES node(id) ON DELETE CASCADE);");
+
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS compressed_content("
+			"id INTEGER NOT NULL, "
+			"hash INTEGER NOT NULL, "
+			"size INTEGER NOT NULL, "
+			"line_count INTEGER NOT NULL, "
+			"PRIMARY KEY(id));");
+
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS compressed_content_block("
+			"content_id INTEGER NOT NULL, "
+			"first_line INTEGER NOT NULL, "
+			"line_count INTEGER NOT NULL, "
+			"data BLOB, "
+			"PRIMARY KEY(content_id, first_line), "
+			"FOREIGN KEY(content_id) REFERENCES compressed_content(id) ON DELETE CASCADE);");
+
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS file_compressed_content("
+			"file_id INTEGER NOT NULL, "
+			"content_id INTEGER NOT NULL, "
+			"PRIMARY KEY(file_id), "
+			"FOREIGN KEY(file_id) REFERENCES file(id) ON DELETE CASCADE, "
+			"FOREIGN KEY(content_id) REFERENCES compressed_content(id));");
+
+		// contents are shared by files, so they are released with the last file
+		m_database.execDML(
+			"CREATE TRIGGER IF NOT EXISTS release_compressed_content "
+			"AFTER DELETE ON file_compressed_content "
+			"WHEN NOT EXISTS ("
+			"	SELECT 1 FROM file_compressed_content WHERE content_id = OLD.content_id) "
+			"BEGIN "
+			"	DELETE FROM compressed_content WHERE id = OLD.content_id; "
+			"END;");
+
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS index_time("
+			"path TEXT NOT NULL, "
+			"milliseconds INTEGER NOT NULL, "
+			"PRIMARY KEY(path));");
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+
+		throw(std::exception());
+	}
+}
+
 void SqliteIndexStorage::setupPrecompiledStatements()
 {
 	try
 	{
+		m_insertElementBatchStatement.compile(
+			"INSERT INTO element(id) VALUES",
+			1,
+			[](CppSQLite3Statement& stmt, const Id& id, size_t index) {
+				stmt.bind(int(index) + 1, int(id));
+			},
+			m_database);
 		m_insertNodeBatchStatement.compile(
 			"INSERT INTO node(id, type, serialized_name) VALUES",
 			3,
 			[](CppSQLite3Statement& stmt, const StorageNode& node, size_t index) {
 				stmt.bind(int(index) * 3 + 1, int(node.id));
 				stmt.bind(int(index) * 3 + 2, int(node.type));
-				stmt.bind(int(index) * 3 + 3, utility::encodeToUtf8(node.serializedName).c_str());
+				if (node.serializedName.empty())
+				{
+					stmt.bindNull(int(index) * 3 + 3);
+				}
+				else
+				{
+					const std::string name = utility::encodeToUtf8(node.serializedName);
+					stmt.bind(int(index) * 3 + 3, name.c_str());
+				}
+			},
+			m_database);
+		m_insertNamePartBatchStatement.compile(
+			"INSERT INTO name_part(id, text) VALUES",
+			2,
+			[](CppSQLite3Statement& stmt,
+			   const std::pair<uint32_t, std::wstring>& part,
+			   size_t index) {
+				stmt.bind(int(index) * 2 + 1, int(part.first));
+				stmt.bind(int(index) * 2 + 2, utility::encodeToUtf8(part.second).c_str());
+			},
+			m_database);
+		m_insertNameBatchStatement.compile(
+			"INSERT INTO name(id, parent_id, element_id, signature_id) VALUES",
+			4,
+			[](CppSQLite3Statement& stmt,
+			   const std::pair<uint32_t, SerializedNameTree::Name>& idAndName,
+			   size_t index) {
+				const SerializedNameTree::Name& name = idAndName.second;
+				stmt.bind(int(index) * 4 + 1, int(idAndName.first));
+				stmt.bind(int(index) * 4 + 2, int(name.parentId));
+				stmt.bind(int(index) * 4 + 3, int(name.elementId));
+				stmt.bind(int(index) * 4 + 4, int(name.signatureId));
+			},
+			m_database);
+		m_insertNodeNameBatchStatement.compile(
+			"INSERT INTO node_name(node_id, name_id) VALUES",
+			2,
+			[](CppSQLite3Statement& stmt, const std::pair<Id, uint32_t>& nodeName, size_t index) {
+				stmt.bind(int(index) * 2 + 1, int(nodeName.first));
+				stmt.bind(int(index) * 2 + 2, int(nodeName.second));
 			},
 			m_database);
 		m_insertEdgeBatchStatement.compile(
@@ -1427,8 +2277,11 @@ void SqliteIndexStorage::setupPrecompiledStatements()
 		m_insertFileStmt = m_database.compileStatement(
 			"INSERT INTO file(id, path, language, modification_time, indexed, complete, "
 			"line_count) VALUES(?, ?, ?, ?, ?, ?, ?);");
-		m_insertFileContentStmt = m_database.compileStatement(
-			"INSERT INTO filecontent(id, content) VALUES(?, ?);");
+		m_insertFileContentBlockStmt = m_database.compileStatement(
+			"INSERT INTO compressed_content_block(content_id, first_line, line_count, data) "
+			"VALUES(?, ?, ?, ?);");
+		m_insertFileContentReferenceStmt = m_database.compileStatement(
+			"INSERT INTO file_compressed_content(file_id, content_id) VALUES(?, ?);");
 		m_checkErrorExistsStmt = m_database.compileStatement(
 			"SELECT id FROM error WHERE "
 			"message = ? AND "
@@ -1475,17 +2328,75 @@ template <>
 void SqliteIndexStorage::forEach<StorageNode>(
 	const std::string& query, std::function<void(StorageNode&&)> func) const
 {
-	CppSQLite3Query q = executeQuery("SELECT id, type, serialized_name FROM node " + query + ";");
+	const std::shared_ptr<SerializedNameTree> nameTree = getNameTree();
+
+	CppSQLite3Query q = executeQuery(
+		"SELECT node.id, node.type, node.serialized_name, node_name.name_id FROM node "
+		"LEFT JOIN node_name ON node_name.node_id = node.id " +
+		query + ";");
 
 	while (!q.eof())
 	{
 		const Id id = q.getIntField(0, 0);
 		const int type = q.getIntField(1, -1);
 		const std::string serializedName = q.getStringField(2, "");
+		const uint32_t nameId = q.getIntField(3, 0);
+
+		if (id != 0 && type != -1)
+		{
+			func(StorageNode(
+				id,
+				type,
+				nameId ? nameTree->getSerializedName(nameId)
+					   : utility::decodeFromUtf8(serializedName)));
+		}
+
+		q.nextRow();
+	}
+}
+
+void SqliteIndexStorage::forEachNodeNameHierarchy(
+	std::function<void(Id, int, NameHierarchy&&)> func) const
+{
+	forEachNodeNameHierarchy("", func);
+}
+
+void SqliteIndexStorage::forEachNodeNameHierarchyByIds(
+	const std::vector<Id>& ids, std::function<void(Id, int, NameHierarchy&&)> func) const
+{
+	TRACE();
+
+	if (ids.size())
+	{
+		const TempIdTable idTable(this, ids);
+		forEachNodeNameHierarchy("WHERE id IN " + idTable.getQuery(), func);
+	}
+}
+
+void SqliteIndexStorage::forEachNodeNameHierarchy(
+	const std::string& query, std::function<void(Id, int, NameHierarchy&&)> func) const
+{
+	const std::shared_ptr<SerializedNameTree> nameTree = getNameTree();
+
+	CppSQLite3Query q = executeQuery(
+		"SELECT node.id, node.type, node.serialized_name, node_name.name_id FROM node "
+		"LEFT JOIN node_name ON node_name.node_id = node.id " +
+		query + ";");
+
+	while (!q.eof())
+	{
+		const Id id = q.getIntField(0, 0);
+		const int type = q.getIntField(1, -1);
+		const uint32_t nameId = q.getIntField(3, 0);
 
 		if (id != 0 && type != -1)
 		{
-			func(StorageNode(id, type, utility::decodeFromUtf8(serializedName)));
+			func(
+				id,
+				type,
+				nameId ? nameTree->getNameHierarchy(nameId)
+					   : NameHierarchy::deserialize(
+							 utility::decodeFromUtf8(q.getStringField(2, ""))));
 		}
 
 		q.nextRow();
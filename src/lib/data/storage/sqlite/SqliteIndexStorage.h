@@ -1,13 +1,18 @@
 #ifndef SQLITE_INDEX_STORAGE_H
 #define SQLITE_INDEX_STORAGE_H
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "ErrorInfo.h"
 #include "LocationType.h"
 #include "LowMemoryStringMap.h"
+#include "SerializedNameTree.h"
 #include "SqliteDatabaseIndex.h"
 #include "SqliteStorage.h"
 #include "StorageComponentAccess.h"
@@ -20,6 +25,7 @@
 #include "StorageOccurrence.h"
 #include "StorageSourceLocation.h"
 #include "StorageSymbol.h"
+#include "tracing.h"
 #include "types.h"
 #include "utility.h"
 #include "utilityString.h"
@@ -28,28 +34,50 @@ class TextAccess;
 class Version;
 class SourceLocationCollection;
 class SourceLocationFile;
+class SourceLocationIntervalIndex;
 
 class SqliteIndexStorage: public SqliteStorage
 {
 public:
 	static size_t getStorageVersion();
+	// custom commands write databases in the layout of this older version
+	static size_t getCustomCommandStorageVersion();
 
 	enum StorageModeType
 	{
 		STORAGE_MODE_READ = 1,
 		STORAGE_MODE_WRITE = 2,
-		STORAGE_MODE_CLEAR = 4
+		STORAGE_MODE_CLEAR = 4,
+		// write mode for databases without elements: ids are assigned in memory, indices and
+		// journaling are skipped until another mode is set. falls back to write mode otherwise.
+		STORAGE_MODE_BULK_LOAD = 8
 	};
 
 	SqliteIndexStorage(const FilePath& dbFilePath);
 
 	virtual size_t getStaticVersion() const;
 
+	// creates the tables custom commands know about, stamped with their version
+	void setupCustomCommandStorage();
+	// adds the tables of the current version to a database written by a custom command
+	void migrateCustomCommandStorage();
+
 	void setMode(const StorageModeType mode);
 
 	std::string getProjectSettingsText() const;
 	void setProjectSettingsText(std::string text);
 
+	// milliseconds it took to index each source file in the last run that indexed it
+	std::map<FilePath, size_t> getIndexTimes() const;
+	void setIndexTimes(const std::map<FilePath, size_t>& indexTimes);
+	void setFilesIncomplete(const std::vector<FilePath>& filePaths);
+
+	// node names are stored as interned elements of a name tree instead of full serialized names.
+	// disabling it writes the full names of all nodes, for writers that look nodes up by the
+	// serialized_name column.
+	void setNameInterningEnabled(bool enabled);
+	bool isNameInterningEnabled() const;
+
 	Id addNode(const StorageNodeData& data);
 	std::vector<Id> addNodes(const std::vector<StorageNode>& nodes);
 	bool addSymbol(const StorageSymbol& data);
@@ -102,6 +130,8 @@ public:
 	StorageNode getNodeBySerializedName(const std::wstring& serializedName) const;
 
 	std::vector<int> getAvailableNodeTypes() const;
+	// ordered by id, doesn't read the names of the nodes
+	std::vector<std::pair<Id, int>> getAllNodeTypes() const;
 	std::vector<int> getAvailableEdgeTypes() const;
 
 	StorageFile getFileByPath(const std::wstring& filePath) const;
@@ -109,6 +139,10 @@ public:
 	std::vector<StorageFile> getFilesByPaths(const std::vector<FilePath>& filePaths) const;
 	std::shared_ptr<TextAccess> getFileContentByPath(const std::wstring& filePath) const;
 	std::shared_ptr<TextAccess> getFileContentById(Id fileId) const;
+	// only decompresses the blocks containing the lines, line numbers start with 1
+	std::vector<std::string> getFileContentLinesByPath(
+		const std::wstring& filePath, size_t firstLineNumber, size_t lastLineNumber) const;
+	bool hasFileContentByPath(const std::wstring& filePath) const;
 
 	void setFileIndexed(Id fileId, bool indexed);
 	void setFileCompleteIfNoError(Id fileId, const std::wstring& filePath, bool complete);
@@ -120,6 +154,9 @@ public:
 		const FilePath& filePath, size_t startLine, size_t endLine) const;
 	std::shared_ptr<SourceLocationFile> getSourceLocationsOfTypeInFile(
 		const FilePath& filePath, LocationType type) const;
+	// loads all locations of the file with their occurrences, for repeated queries of line ranges
+	std::shared_ptr<SourceLocationIntervalIndex> getSourceLocationIntervalIndexForFile(
+		Id fileId) const;
 
 	std::shared_ptr<SourceLocationCollection> getSourceLocationsForElementIds(
 		const std::vector<Id>& elementIds) const;
@@ -156,10 +193,12 @@ public:
 	template <typename ResultType>
 	std::vector<ResultType> getAllByIds(const std::vector<Id>& ids) const
 	{
+		TRACE();
+
 		if (ids.size())
 		{
-			return doGetAll<ResultType>(
-				"WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ")");
+			const TempIdTable idTable(this, ids);
+			return doGetAll<ResultType>("WHERE id IN " + idTable.getQuery());
 		}
 		return std::vector<ResultType>();
 	}
@@ -179,12 +218,20 @@ public:
 	template <typename StorageType>
 	void forEachByIds(const std::vector<Id> ids, std::function<void(StorageType&&)> func) const
 	{
+		TRACE();
+
 		if (ids.size())
 		{
-			forEach("WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ")", func);
+			const TempIdTable idTable(this, ids);
+			forEach("WHERE id IN " + idTable.getQuery(), func);
 		}
 	}
 
+	// like forEach<StorageNode>, but interned names are not serialized to be deserialized again
+	void forEachNodeNameHierarchy(std::function<void(Id, int, NameHierarchy&&)> func) const;
+	void forEachNodeNameHierarchyByIds(
+		const std::vector<Id>& ids, std::function<void(Id, int, NameHierarchy&&)> func) const;
+
 	int getNodeCount() const;
 	int getEdgeCount() const;
 	int getFileCount() const;
@@ -192,9 +239,19 @@ public:
 	int getFileLineSum() const;
 	int getSourceLocationCount() const;
 	int getErrorCount() const;
+	int getFileContentCount() const;
+	int getNameCount() const;
 
 private:
 	static const size_t s_storageVersion;
+	static const size_t s_customCommandStorageVersion;
+
+	// files are cleared in chunks of at most this many source locations or files
+	static const size_t s_clearChunkLocationCount;
+	static const size_t s_clearChunkFileCount;
+
+	// file contents are compressed in blocks of whole lines that reach this size
+	static const size_t s_fileContentBlockSize;
 
 	struct TempSourceLocation
 	{
@@ -235,9 +292,55 @@ private:
 		uint8_t type;
 	};
 
+	// ids of batch queries are inserted into a temporary table instead of the query text, so
+	// statements stay short no matter how many ids are queried. nested queries use separate tables
+	// and a few ids are still written into the query, because filling the table costs more
+	class TempIdTable
+	{
+	public:
+		TempIdTable(const SqliteIndexStorage* storage, const std::vector<Id>& ids);
+		~TempIdTable();
+
+		// selects all ids, to be used with IN
+		std::string getQuery() const;
+
+	private:
+		static const size_t s_minTableIdCount;
+
+		const SqliteIndexStorage* m_storage;
+		std::unique_lock<std::recursive_mutex> m_lock;
+		size_t m_level = 0;
+		std::string m_inlineIds;
+	};
+
 	std::vector<std::pair<int, SqliteDatabaseIndex>> getIndices() const;
 
+	void startBulkLoad();
+	void finishBulkLoad();
+
+	Id addElement();
+	void flushBulkLoadElements();
+
+	// loaded on first use, the interned names of a database are read as a whole
+	// the returned tree stays valid after the names of the database are cleared
+	std::shared_ptr<SerializedNameTree> getNameTree() const;
+	void clearNameTree() const;
+	void storeAddedNames(SerializedNameTree& nameTree);
+	void storeInternedNamesInFull();
+	// names that are not referenced by nodes or other names
+	void removeUnusedNames();
+
+	void loadTempNodeIndex();
+	void clearTempNodeIndex();
+
+	// identical contents of different files are stored once
+	bool addFileContent(Id fileId, const TextAccess& content);
+	Id getFileContentId(const std::string& fileCondition) const;
+	std::vector<std::string> getFileContentLines(
+		Id contentId, size_t firstLineNumber, size_t lastLineNumber) const;
+
 	virtual void clearTables();
+	void setupCustomCommandTables();
 	virtual void setupTables();
 	virtual void setupPrecompiledStatements();
 
@@ -263,7 +366,17 @@ private:
 
 	template <typename StorageType>
 	void forEach(const std::string& query, std::function<void(StorageType&&)> func) const;
+	void forEachNodeNameHierarchy(
+		const std::string& query, std::function<void(Id, int, NameHierarchy&&)> func) const;
+
+	// null until loaded
+	mutable std::shared_ptr<SerializedNameTree> m_nameTree;
+	mutable std::mutex m_nameTreeMutex;
+	bool m_nameInterningEnabled = true;
 
+	// nodes with interned names are found by name id, the others by their full names
+	bool m_tempNodeIndexLoaded = false;
+	std::unordered_map<uint32_t, uint32_t> m_tempNameNodeIds;
 	LowMemoryStringMap<std::string, uint32_t, 0> m_tempNodeNameIndex;
 	LowMemoryStringMap<std::wstring, uint32_t, 0> m_tempWNodeNameIndex;
 	std::map<uint32_t, int> m_tempNodeTypes;
@@ -271,6 +384,18 @@ private:
 	std::map<std::wstring, std::map<std::wstring, uint32_t>> m_tempLocalSymbolIndex;
 	std::map<uint32_t, std::map<TempSourceLocation, uint32_t>> m_tempSourceLocationIndices;
 
+	// the write mode indices are not available while bulk loading, so files and errors are
+	// deduplicated in memory instead
+	std::unordered_set<std::wstring> m_tempFilePaths;
+	std::map<std::pair<std::wstring, bool>, Id> m_tempErrorIndex;
+
+	bool m_bulkLoad = false;
+	Id m_nextBulkLoadElementId = 1;
+	Id m_nextBulkLoadSourceLocationId = 1;
+	std::vector<Id> m_bulkLoadElementIds;
+	std::string m_preBulkLoadJournalMode;
+	int m_preBulkLoadSynchronous = 2;
+
 	template <typename StorageType>
 	class InsertBatchStatement
 	{
@@ -318,7 +443,7 @@ private:
 			}
 		}
 
-		bool execute(const std::vector<StorageType>& types, SqliteIndexStorage* storage)
+		bool execute(const std::vector<StorageType>& types, const SqliteIndexStorage* storage)
 		{
 			size_t i = 0;
 			for (std::pair<size_t, CppSQLite3Statement>& p: m_stmts)
@@ -352,7 +477,11 @@ private:
 		std::function<void(CppSQLite3Statement& stmt, const StorageType&, size_t)> m_bindValuesFunc;
 	};
 
+	InsertBatchStatement<Id> m_insertElementBatchStatement;
 	InsertBatchStatement<StorageNode> m_insertNodeBatchStatement;
+	InsertBatchStatement<std::pair<uint32_t, std::wstring>> m_insertNamePartBatchStatement;
+	InsertBatchStatement<std::pair<uint32_t, SerializedNameTree::Name>> m_insertNameBatchStatement;
+	InsertBatchStatement<std::pair<Id, uint32_t>> m_insertNodeNameBatchStatement;
 	InsertBatchStatement<StorageEdge> m_insertEdgeBatchStatement;
 	InsertBatchStatement<StorageSymbol> m_insertSymbolBatchStatement;
 	InsertBatchStatement<StorageLocalSymbol> m_insertLocalSymbolBatchStatement;
@@ -360,10 +489,16 @@ private:
 	InsertBatchStatement<StorageOccurrence> m_insertOccurrenceBatchStatement;
 	InsertBatchStatement<StorageComponentAccess> m_insertComponentAccessBatchStatement;
 
+	// compiled on first use, one for each level of nested temp id tables
+	mutable std::vector<std::unique_ptr<InsertBatchStatement<Id>>> m_insertTempIdStatements;
+	mutable size_t m_tempIdTableCount = 0;
+	mutable std::recursive_mutex m_tempIdTableMutex;
+
 	CppSQLite3Statement m_insertElementStmt;
 	CppSQLite3Statement m_insertElementComponentStmt;
 	CppSQLite3Statement m_insertFileStmt;
-	CppSQLite3Statement m_insertFileContentStmt;
+	CppSQLite3Statement m_insertFileContentBlockStmt;
+	CppSQLite3Statement m_insertFileContentReferenceStmt;
 	CppSQLite3Statement m_checkErrorExistsStmt;
 	CppSQLite3Statement m_insertErrorStmt;
 };
@@ -84,21 +84,89 @@ void SqliteStorage::setVersion(size_t version)
 
 void SqliteStorage::beginTransaction()
 {
-	executeStatement("BEGIN TRANSACTION;");
+	if (m_transactionDepth == 0)
+	{
+		executeStatement("BEGIN TRANSACTION;");
+	}
+	else
+	{
+		executeStatement("SAVEPOINT transaction_" + std::to_string(m_transactionDepth) + ";");
+	}
+	m_transactionDepth++;
 }
 
 void SqliteStorage::commitTransaction()
 {
-	executeStatement("COMMIT TRANSACTION;");
+	if (m_transactionDepth > 0)
+	{
+		m_transactionDepth--;
+	}
+
+	if (m_transactionDepth == 0)
+	{
+		executeStatement("COMMIT TRANSACTION;");
+	}
+	else
+	{
+		executeStatement("RELEASE transaction_" + std::to_string(m_transactionDepth) + ";");
+	}
 }
 
 void SqliteStorage::rollbackTransaction()
 {
-	executeStatement("ROLLBACK TRANSACTION;");
+	if (m_transactionDepth > 0)
+	{
+		m_transactionDepth--;
+	}
+
+	if (m_transactionDepth == 0)
+	{
+		executeStatement("ROLLBACK TRANSACTION;");
+	}
+	else
+	{
+		const std::string savepoint = "transaction_" + std::to_string(m_transactionDepth);
+		executeStatement("ROLLBACK TO " + savepoint + ";");
+		executeStatement("RELEASE " + savepoint + ";");
+	}
+}
+
+bool SqliteStorage::isInTransaction() const
+{
+	return m_transactionDepth > 0;
+}
+
+bool SqliteStorage::setWriteAheadLogging(bool enabled)
+{
+	const std::string journalMode = enabled ? "wal" : "delete";
+
+	std::string currentJournalMode;
+	try
+	{
+		const std::string statement = "PRAGMA journal_mode=" + journalMode + ";";
+		CppSQLite3Query q = m_database.execQuery(statement.c_str());
+		if (!q.eof())
+		{
+			currentJournalMode = utility::toLowerCase(std::string(q.getStringField(0, "")));
+		}
+	}
+	catch (CppSQLite3Exception e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+	}
+
+	return currentJournalMode == journalMode;
 }
 
 void SqliteStorage::optimizeMemory() const
 {
+	// vacuum cannot run inside of a transaction and rewrites the whole file
+	if (m_transactionDepth > 0)
+	{
+		LOG_INFO("Skipping database vacuum, the database is written in a transaction.");
+		return;
+	}
+
 	executeStatement("VACUUM;");
 }
 
@@ -195,6 +263,19 @@ bool SqliteStorage::executeStatement(CppSQLite3Statement& statement) const
 	return true;
 }
 
+int SqliteStorage::executeStatementChangeCount(const std::string& statement) const
+{
+	try
+	{
+		return m_database.execDML(statement.c_str());
+	}
+	catch (CppSQLite3Exception e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+	}
+	return 0;
+}
+
 int SqliteStorage::executeStatementScalar(const std::string& statement, const int nullValue) const
 {
 	int ret = 0;
@@ -21,9 +21,15 @@ public:
 	size_t getVersion() const;
 	void setVersion(size_t version);
 
+	// transactions begun inside of another transaction become savepoints of the outer one
 	void beginTransaction();
 	void commitTransaction();
 	void rollbackTransaction();
+	bool isInTransaction() const;
+
+	// with a write ahead log other connections keep reading the last committed state while a
+	// transaction is open. returns whether the journal mode was changed.
+	bool setWriteAheadLogging(bool enabled);
 
 	void optimizeMemory() const;
 
@@ -42,6 +48,8 @@ protected:
 	bool executeStatement(const std::string& statement) const;
 	bool executeStatement(CppSQLite3Statement& statement) const;
 	int executeStatementScalar(const std::string& statement, const int nullValue) const;
+	// returns the number of changed rows
+	int executeStatementChangeCount(const std::string& statement) const;
 	int executeStatementScalar(CppSQLite3Statement& statement, const int nullValue) const;
 	CppSQLite3Query executeQuery(const std::string& statement) const;
 	CppSQLite3Query executeQuery(CppSQLite3Statement& statement) const;
@@ -64,6 +72,8 @@ private:
 
 	bool m_precompiledStatementsInitialized = false;
 
+	size_t m_transactionDepth = 0;
+
 	friend SqliteStorageMigration;
 };
 
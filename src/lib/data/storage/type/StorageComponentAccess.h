@@ -1,6 +1,8 @@
 #ifndef STORAGE_COMPONENT_ACCESS_H
 #define STORAGE_COMPONENT_ACCESS_H
 
+#include <functional>
+
 #include "types.h"
 
 struct StorageComponentAccess
@@ -18,4 +20,12 @@ struct StorageComponentAccess
 	int type;
 };
 
+struct StorageComponentAccessHash
+{
+	size_t operator()(const StorageComponentAccess& componentAccess) const
+	{
+		return std::hash<Id>()(componentAccess.nodeId);
+	}
+};
+
 #endif	  // STORAGE_COMPONENT_ACCESS_H
@@ -1,6 +1,8 @@
 #ifndef STORAGE_EDGE_H
 #define STORAGE_EDGE_H
 
+#include <functional>
+
 #include "types.h"
 
 struct StorageEdgeData
@@ -28,11 +30,28 @@ struct StorageEdgeData
 		}
 	}
 
+	bool operator==(const StorageEdgeData& other) const
+	{
+		return type == other.type && sourceNodeId == other.sourceNodeId &&
+			targetNodeId == other.targetNodeId;
+	}
+
 	int type;
 	Id sourceNodeId;
 	Id targetNodeId;
 };
 
+struct StorageEdgeDataHash
+{
+	size_t operator()(const StorageEdgeData& data) const
+	{
+		size_t hash = std::hash<Id>()(data.sourceNodeId);
+		hash ^= std::hash<Id>()(data.targetNodeId) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<int>()(data.type) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+};
+
 struct StorageEdge: public StorageEdgeData
 {
 	StorageEdge(): StorageEdgeData(), id(0) {}
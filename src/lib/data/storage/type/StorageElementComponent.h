@@ -1,6 +1,7 @@
 #ifndef STORAGE_ELEMENT_COMPONENT_H
 #define STORAGE_ELEMENT_COMPONENT_H
 
+#include <functional>
 #include <string>
 
 #include "types.h"
@@ -35,4 +36,15 @@ struct StorageElementComponent
 	std::wstring data;
 };
 
+struct StorageElementComponentHash
+{
+	size_t operator()(const StorageElementComponent& component) const
+	{
+		size_t hash = std::hash<Id>()(component.elementId);
+		hash ^= std::hash<int>()(component.type) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<std::wstring>()(component.data) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+};
+
 #endif	  // STORAGE_ELEMENT_COMPONENT_H
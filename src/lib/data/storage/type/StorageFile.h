@@ -1,6 +1,7 @@
 #ifndef STORAGE_FILE_H
 #define STORAGE_FILE_H
 
+#include <functional>
 #include <string>
 
 #include "types.h"
@@ -46,4 +47,12 @@ struct StorageFile
 	bool complete;
 };
 
+struct StorageFileHash
+{
+	size_t operator()(const StorageFile& file) const
+	{
+		return std::hash<std::wstring>()(file.filePath);
+	}
+};
+
 #endif	  // STORAGE_FILE_H
@@ -1,6 +1,7 @@
 #ifndef STORAGE_LOCAL_SYMBOL_H
 #define STORAGE_LOCAL_SYMBOL_H
 
+#include <functional>
 #include <string>
 
 #include "types.h"
@@ -19,6 +20,14 @@ struct StorageLocalSymbolData
 	std::wstring name;
 };
 
+struct StorageLocalSymbolDataHash
+{
+	size_t operator()(const StorageLocalSymbolData& data) const
+	{
+		return std::hash<std::wstring>()(data.name);
+	}
+};
+
 struct StorageLocalSymbol: public StorageLocalSymbolData
 {
 	StorageLocalSymbol(): StorageLocalSymbolData(), id(0) {}
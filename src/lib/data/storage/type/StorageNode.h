@@ -1,6 +1,7 @@
 #ifndef STORAGE_NODE_H
 #define STORAGE_NODE_H
 
+#include <functional>
 #include <string>
 
 #include "types.h"
@@ -23,6 +24,14 @@ struct StorageNodeData
 	std::wstring serializedName;
 };
 
+struct StorageNodeDataHash
+{
+	size_t operator()(const StorageNodeData& data) const
+	{
+		return std::hash<std::wstring>()(data.serializedName);
+	}
+};
+
 struct StorageNode: public StorageNodeData
 {
 	StorageNode(): StorageNodeData(), id(0) {}
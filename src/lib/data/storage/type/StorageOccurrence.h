@@ -1,6 +1,8 @@
 #ifndef STORAGE_OCCURRENCE_H
 #define STORAGE_OCCURRENCE_H
 
+#include <functional>
+
 #include "types.h"
 
 struct StorageOccurrence
@@ -28,4 +30,14 @@ struct StorageOccurrence
 	Id sourceLocationId;
 };
 
+struct StorageOccurrenceHash
+{
+	size_t operator()(const StorageOccurrence& occurrence) const
+	{
+		size_t hash = std::hash<Id>()(occurrence.elementId);
+		hash ^= std::hash<Id>()(occurrence.sourceLocationId) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+};
+
 #endif	  // STORAGE_OCCURRENCE_H
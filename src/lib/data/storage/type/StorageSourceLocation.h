@@ -1,6 +1,8 @@
 #ifndef STORAGE_SOURCE_LOCATION_H
 #define STORAGE_SOURCE_LOCATION_H
 
+#include <functional>
+
 #include "types.h"
 
 struct StorageSourceLocationData
@@ -57,6 +59,20 @@ struct StorageSourceLocationData
 	int type;
 };
 
+struct StorageSourceLocationDataHash
+{
+	size_t operator()(const StorageSourceLocationData& data) const
+	{
+		size_t hash = std::hash<Id>()(data.fileNodeId);
+		hash ^= std::hash<size_t>()(data.startLine) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<size_t>()(data.startCol) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<size_t>()(data.endLine) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<size_t>()(data.endCol) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<int>()(data.type) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+};
+
 struct StorageSourceLocation: public StorageSourceLocationData
 {
 	StorageSourceLocation(): StorageSourceLocationData(), id(0) {}
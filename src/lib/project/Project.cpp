@@ -168,6 +168,9 @@ void Project::load(std::shared_ptr<DialogView> dialogView)
 
 	m_storage = std::make_shared<PersistentStorage>(dbPath, bookmarkDbPath);
 
+	// a refresh that was written in place leaves the write ahead log enabled
+	m_storage->disableWriteAheadLogging();
+
 	bool canLoad = false;
 
 	if (m_settings->needMigration())
@@ -543,16 +546,51 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 	const FilePath indexDbFilePath = m_settings->getDBFilePath();
 	const FilePath tempIndexDbFilePath = m_settings->getTempDBFilePath();
 
+	if (m_refreshStorage)
+	{
+		LOG_WARNING("Rolling back refresh that was neither kept nor discarded");
+		m_refreshStorage->rollbackRefreshTransaction();
+		m_refreshStorage.reset();
+	}
+
+	std::shared_ptr<PersistentStorage> tempStorage;
 	if (info.mode != REFRESH_ALL_FILES)
 	{
-		// store the indexed data into the temp db but keep the current state to allow browsing
-		// while indexing
-		FileSystem::copyFile(indexDbFilePath, tempIndexDbFilePath);
+		// custom commands write into the database from other processes, which would wait for the
+		// refresh transaction
+		if (ApplicationSettings::getInstance()->getRefreshInPlaceEnabled() &&
+			!hasCustomCommandSourceGroup())
+		{
+			// the refresh is written into the index db in one transaction, so the current state
+			// can be browsed while indexing and nothing needs to be copied
+			tempStorage = std::make_shared<PersistentStorage>(
+				indexDbFilePath, m_storage->getBookmarkDbFilePath());
+			tempStorage->setup();
+			if (tempStorage->startRefreshTransaction())
+			{
+				m_refreshStorage = tempStorage;
+			}
+			else
+			{
+				LOG_WARNING("Unable to refresh the index database in place, copying it instead");
+				tempStorage.reset();
+			}
+		}
+
+		if (!tempStorage)
+		{
+			// store the indexed data into the temp db but keep the current state to allow browsing
+			// while indexing
+			FileSystem::copyFile(indexDbFilePath, tempIndexDbFilePath);
+		}
 	}
 
-	std::shared_ptr<PersistentStorage> tempStorage = std::make_shared<PersistentStorage>(
-		tempIndexDbFilePath, m_storage->getBookmarkDbFilePath());
-	tempStorage->setup();
+	if (!tempStorage)
+	{
+		tempStorage = std::make_shared<PersistentStorage>(
+			tempIndexDbFilePath, m_storage->getBookmarkDbFilePath());
+		tempStorage->setup();
+	}
 
 	std::shared_ptr<TaskGroupSequence> taskSequential = std::make_shared<TaskGroupSequence>();
 
@@ -621,7 +659,12 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 		const int adjustedIndexerThreadCount = std::min<int>(
 			indexerThreadCount, static_cast<int>(indexerCommandProvider->size()));
 
-		std::shared_ptr<StorageProvider> storageProvider = std::make_shared<StorageProvider>();
+		const int storageMemoryBudgetMegabytes = std::max(
+			0, ApplicationSettings::getInstance()->getStorageMemoryBudgetMegabytes());
+		const size_t storageMemoryBudget = static_cast<size_t>(storageMemoryBudgetMegabytes) * 1024 *
+			1024;
+		std::shared_ptr<StorageProvider> storageProvider = std::make_shared<StorageProvider>(
+			storageMemoryBudget);
 		// add tasks for setting some variables on the blackboard that are used during indexing
 		taskSequential->addTask(
 			std::make_shared<TaskSetValue<bool>>("indexer_threads_started", false));
@@ -651,37 +694,54 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 		taskParserWrapper->setTask(taskParallelIndexing);
 
 		// add task for refilling the indexer command queue
+		// the queue keeps a few commands in the lane of each indexer
 		taskParallelIndexing->addTask(std::make_shared<TaskFillIndexerCommandsQueue>(
-			m_appUUID, std::move(indexerCommandProvider), 20));
+			m_appUUID,
+			std::move(indexerCommandProvider),
+			std::max(20, 4 * adjustedIndexerThreadCount),
+			adjustedIndexerThreadCount,
+			m_storage->getIndexTimes()));
 
 		// add task for indexing
 		bool multiProcess = ApplicationSettings::getInstance()->getMultiProcessIndexingEnabled() &&
 			hasCxxSourceGroup();
+		std::shared_ptr<TaskBuildIndex> taskBuildIndex = std::make_shared<TaskBuildIndex>(
+			adjustedIndexerThreadCount, storageProvider, dialogView, m_appUUID, multiProcess);
 		taskParallelIndexing->addChildTasks(std::make_shared<TaskGroupSequence>()->addChildTasks(
 			// block until there are indexer commands to process
 			std::make_shared<TaskDecoratorRepeat>(
 				TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
 				->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
 					"indexer_command_queue_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
-			std::make_shared<TaskBuildIndex>(
-				adjustedIndexerThreadCount, storageProvider, dialogView, m_appUUID, multiProcess)));
+			taskBuildIndex));
 
-		// add task for merging the intermediate storages
-		taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
-			// block until there are indexers running
-			std::make_shared<TaskDecoratorRepeat>(
-				TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
-				->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
-					"indexer_threads_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
-			// merge until all indexers stopped and nothing left to merge
-			std::make_shared<TaskDecoratorRepeat>(
-				TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 250)
-				->addChildTask(std::make_shared<TaskGroupSelector>()->addChildTasks(
-					std::make_shared<TaskMergeStorages>(storageProvider),
-					std::make_shared<TaskReturnSuccessIf<bool>>(
-						"indexer_threads_stopped",
+		// add tasks for merging the intermediate storages, each merge task runs in its own thread
+		int mergeThreadCount = ApplicationSettings::getInstance()->getStorageMergeThreadCount();
+		if (mergeThreadCount <= 0)
+		{
+			mergeThreadCount = std::max(1, adjustedIndexerThreadCount / 4);
+		}
+
+		for (int i = 0; i < mergeThreadCount; i++)
+		{
+			taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
+				// block until there are indexers running
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+					->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
+						"indexer_threads_started",
 						TaskReturnSuccessIf<bool>::CONDITION_EQUALS,
-						false)))));
+						false)),
+				// merge until all indexers stopped and nothing left to merge
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+					->addChildTask(std::make_shared<TaskGroupSelector>()->addChildTasks(
+						std::make_shared<TaskMergeStorages>(storageProvider),
+						std::make_shared<TaskReturnSuccessIf<bool>>(
+							"indexer_threads_stopped",
+							TaskReturnSuccessIf<bool>::CONDITION_EQUALS,
+							false)))));
+		}
 
 		// add task for injecting the intermediate storages into the persistent storage
 		taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
@@ -703,7 +763,8 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 		// add task that notifies the user of what's going on
 		taskSequential->addTask(	// we don't need to hide this dialog again, because it's
 									// overridden by other dialogs later on.
-			std::make_shared<TaskLambda>([dialogView]() {
+			std::make_shared<TaskLambda>([dialogView, storageProvider]() {
+				storageProvider->logCurrentState();
 				dialogView->showUnknownProgressDialog(L"Finish Indexing", L"Saving\nRemaining Data");
 			}));
 
@@ -712,6 +773,12 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 			std::make_shared<TaskDecoratorRepeat>(
 				TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
 				->addChildTask(std::make_shared<TaskInjectStorage>(storageProvider, tempStorage)));
+
+		// keep the index times for ordering the indexer commands of the next refresh
+		taskSequential->addTask(std::make_shared<TaskLambda>([taskBuildIndex, tempStorage]() {
+			tempStorage->setIndexTimes(taskBuildIndex->getIndexTimes());
+			tempStorage->setFilesIncomplete(taskBuildIndex->getIncompleteSourceFilePaths());
+		}));
 	}
 	else
 	{
@@ -786,7 +853,13 @@ void Project::swapToTempStorage(std::shared_ptr<DialogView> dialogView)
 
 	m_storage.reset();
 
-	if (!swapToTempStorageFile(indexDbFilePath, tempIndexDbFilePath, dialogView))
+	if (m_refreshStorage)
+	{
+		// readers of the index db see the refresh as soon as it is committed
+		m_refreshStorage->commitRefreshTransaction();
+		m_refreshStorage.reset();
+	}
+	else if (!swapToTempStorageFile(indexDbFilePath, tempIndexDbFilePath, dialogView))
 	{
 		m_state = PROJECT_STATE_NOT_LOADED;
 		return;
@@ -810,12 +883,8 @@ bool Project::swapToTempStorageFile(
 	const FilePath& tempIndexDbFilePath,
 	std::shared_ptr<DialogView> dialogView)
 {
-	try
-	{
-		FileSystem::remove(indexDbFilePath);
-		FileSystem::rename(tempIndexDbFilePath, indexDbFilePath);
-	}
-	catch (std::exception& /*e*/)
+	// replacing the file atomically keeps the old index intact if the swap fails
+	if (!FileSystem::replace(tempIndexDbFilePath, indexDbFilePath))
 	{
 		if (m_hasGUI)
 		{
@@ -833,6 +902,14 @@ bool Project::swapToTempStorageFile(
 
 void Project::discardTempStorage()
 {
+	if (m_refreshStorage)
+	{
+		LOG_INFO("Discarding indexing data written in place");
+		m_refreshStorage->rollbackRefreshTransaction();
+		m_refreshStorage.reset();
+		return;
+	}
+
 	const FilePath tempIndexDbPath = m_settings->getTempDBFilePath();
 	if (tempIndexDbPath.exists())
 	{
@@ -857,3 +934,24 @@ bool Project::hasCxxSourceGroup() const
 #endif	  // BUILD_CXX_LANGUAGE_PACKAGE
 	return false;
 }
+
+bool Project::hasCustomCommandSourceGroup() const
+{
+	for (const std::shared_ptr<SourceGroup>& sourceGroup: m_sourceGroups)
+	{
+		if (sourceGroup->getStatus() == SOURCE_GROUP_STATUS_ENABLED)
+		{
+			if (sourceGroup->getType() == SOURCE_GROUP_CUSTOM_COMMAND)
+			{
+				return true;
+			}
+#if BUILD_PYTHON_LANGUAGE_PACKAGE
+			if (sourceGroup->getType() == SOURCE_GROUP_PYTHON_EMPTY)
+			{
+				return true;
+			}
+#endif	  // BUILD_PYTHON_LANGUAGE_PACKAGE
+		}
+	}
+	return false;
+}
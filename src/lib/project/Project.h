@@ -73,6 +73,7 @@ private:
 	void discardTempStorage();
 
 	bool hasCxxSourceGroup() const;
+	bool hasCustomCommandSourceGroup() const;
 
 	std::shared_ptr<ProjectSettings> m_settings;
 	StorageCache* const m_storageCache;
@@ -81,6 +82,10 @@ private:
 	RefreshStageType m_refreshStage;
 
 	std::shared_ptr<PersistentStorage> m_storage;
+
+	// writes the running refresh into the index database, set if the database is not copied
+	std::shared_ptr<PersistentStorage> m_refreshStorage;
+
 	std::vector<std::shared_ptr<SourceGroup>> m_sourceGroups;
 
 	std::string m_appUUID;
@@ -54,7 +54,7 @@ std::vector<std::shared_ptr<IndexerCommand>> SourceGroupCustomCommand::getIndexe
 				std::vector<std::wstring> {},
 				m_settings->getProjectSettings()->getProjectFilePath(),
 				m_settings->getProjectSettings()->getTempDBFilePath(),
-				std::to_wstring(SqliteIndexStorage::getStorageVersion()),
+				std::to_wstring(SqliteIndexStorage::getCustomCommandStorageVersion()),
 				sourcePath,
 				runInParallel));
 		}
@@ -298,6 +298,16 @@ void ApplicationSettings::setGraphGrouping(GroupType type)
 	setValue<std::wstring>("application/graph_grouping", groupTypeToString(type));
 }
 
+bool ApplicationSettings::getGraphAdjacencyCacheEnabled() const
+{
+	return getValue<bool>("application/graph_adjacency_cache", true);
+}
+
+void ApplicationSettings::setGraphAdjacencyCacheEnabled(bool enabled)
+{
+	setValue<bool>("application/graph_adjacency_cache", enabled);
+}
+
 int ApplicationSettings::getScreenAutoScaling() const
 {
 	return getValue<int>("screen/auto_scaling", 1);
@@ -390,6 +400,56 @@ void ApplicationSettings::setMultiProcessIndexingEnabled(bool enabled)
 	setValue<bool>("indexing/multi_process_indexing", enabled);
 }
 
+bool ApplicationSettings::getHeaderClaimsEnabled() const
+{
+	return getValue<bool>("indexing/header_claims", true);
+}
+
+void ApplicationSettings::setHeaderClaimsEnabled(bool enabled)
+{
+	setValue<bool>("indexing/header_claims", enabled);
+}
+
+bool ApplicationSettings::getAutomaticPchEnabled() const
+{
+	return getValue<bool>("indexing/automatic_pch", true);
+}
+
+void ApplicationSettings::setAutomaticPchEnabled(bool enabled)
+{
+	setValue<bool>("indexing/automatic_pch", enabled);
+}
+
+bool ApplicationSettings::getRefreshInPlaceEnabled() const
+{
+	return getValue<bool>("indexing/refresh_in_place", true);
+}
+
+void ApplicationSettings::setRefreshInPlaceEnabled(bool enabled)
+{
+	setValue<bool>("indexing/refresh_in_place", enabled);
+}
+
+int ApplicationSettings::getStorageMergeThreadCount() const
+{
+	return getValue<int>("indexing/storage_merge_thread_count", 0);
+}
+
+void ApplicationSettings::setStorageMergeThreadCount(const int count)
+{
+	setValue<int>("indexing/storage_merge_thread_count", count);
+}
+
+int ApplicationSettings::getStorageMemoryBudgetMegabytes() const
+{
+	return getValue<int>("indexing/storage_memory_budget_mb", 2048);
+}
+
+void ApplicationSettings::setStorageMemoryBudgetMegabytes(const int megabytes)
+{
+	setValue<int>("indexing/storage_memory_budget_mb", megabytes);
+}
+
 FilePath ApplicationSettings::getJavaPath() const
 {
 	return FilePath(getValue<std::wstring>("indexing/java/java_path", L""));
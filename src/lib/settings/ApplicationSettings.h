@@ -68,6 +68,9 @@ public:
 	GroupType getGraphGrouping() const;
 	void setGraphGrouping(GroupType type);
 
+	bool getGraphAdjacencyCacheEnabled() const;
+	void setGraphAdjacencyCacheEnabled(bool enabled);
+
 	// screen
 	int getScreenAutoScaling() const;
 	void setScreenAutoScaling(int autoScaling);
@@ -98,6 +101,21 @@ public:
 	bool getMultiProcessIndexingEnabled() const;
 	void setMultiProcessIndexingEnabled(bool enabled);
 
+	bool getHeaderClaimsEnabled() const;
+	void setHeaderClaimsEnabled(bool enabled);
+
+	bool getAutomaticPchEnabled() const;
+	void setAutomaticPchEnabled(bool enabled);
+
+	bool getRefreshInPlaceEnabled() const;
+	void setRefreshInPlaceEnabled(bool enabled);
+
+	int getStorageMergeThreadCount() const;
+	void setStorageMergeThreadCount(const int count);
+
+	int getStorageMemoryBudgetMegabytes() const;
+	void setStorageMemoryBudgetMegabytes(const int megabytes);
+
 	FilePath getJavaPath() const;
 	void setJavaPath(const FilePath& path);
 
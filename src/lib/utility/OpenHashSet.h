@@ -0,0 +1,290 @@
+#ifndef OPEN_HASH_SET_H
+#define OPEN_HASH_SET_H
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <vector>
+
+// Set of values stored contiguously in insertion order. Uniqueness is checked through an open
+// addressing table that only keeps the precomputed hash and the position of each value, so keys are
+// never copied and growing the table does not need to hash the values again. Two values are treated
+// as equal if neither is less than the other, which matches the std::set semantics of the types.
+template <typename ValueType, typename Hasher>
+class OpenHashSet
+{
+public:
+	static const size_t npos = static_cast<size_t>(-1);
+
+	OpenHashSet();
+
+	size_t size() const;
+	bool empty() const;
+	void clear();
+	void reserve(size_t count);
+
+	// the key type needs to be comparable with ValueType and hashable by Hasher
+	template <typename KeyType>
+	size_t find(const KeyType& key) const;
+
+	// returns the position of the equal value if one was stored before
+	template <typename KeyType>
+	std::pair<size_t, bool> insert(const KeyType& key);
+	template <typename KeyType>
+	std::pair<size_t, bool> insert(const KeyType& key, const ValueType& value);
+
+	// modifying the value must not change its hash or ordering
+	ValueType& operator[](size_t index);
+	const ValueType& operator[](size_t index) const;
+
+	typename std::vector<ValueType>::const_iterator begin() const;
+	typename std::vector<ValueType>::const_iterator end() const;
+
+	const std::vector<ValueType>& getValues() const;
+	template <typename IteratorType>
+	void assign(IteratorType first, IteratorType last);
+
+	// ordered copy for interfaces that expect a std::set, built lazily and kept until modified
+	const std::set<ValueType>& getOrderedSet() const;
+
+private:
+	struct Slot
+	{
+		size_t hash;
+		size_t index;
+	};
+
+	// spreads the bits of weak hashes like std::hash<Id> before they get masked
+	static size_t mix(size_t hash);
+
+	template <typename KeyType>
+	size_t findSlot(const KeyType& key, size_t hash) const;
+
+	void rehash(size_t slotCount);
+
+	std::vector<ValueType> m_values;
+	std::vector<Slot> m_slots;
+	Hasher m_hasher;
+
+	mutable std::set<ValueType> m_orderedSet;
+	mutable bool m_orderedSetValid;
+};
+
+template <typename ValueType, typename Hasher>
+OpenHashSet<ValueType, Hasher>::OpenHashSet(): m_orderedSetValid(true)
+{
+}
+
+template <typename ValueType, typename Hasher>
+size_t OpenHashSet<ValueType, Hasher>::size() const
+{
+	return m_values.size();
+}
+
+template <typename ValueType, typename Hasher>
+bool OpenHashSet<ValueType, Hasher>::empty() const
+{
+	return m_values.empty();
+}
+
+template <typename ValueType, typename Hasher>
+void OpenHashSet<ValueType, Hasher>::clear()
+{
+	m_values.clear();
+	m_slots.clear();
+	m_orderedSet.clear();
+	m_orderedSetValid = true;
+}
+
+template <typename ValueType, typename Hasher>
+void OpenHashSet<ValueType, Hasher>::reserve(size_t count)
+{
+	m_values.reserve(count);
+
+	size_t slotCount = 16;
+	while (slotCount < count * 2)
+	{
+		slotCount *= 2;
+	}
+
+	if (slotCount > m_slots.size())
+	{
+		rehash(slotCount);
+	}
+}
+
+template <typename ValueType, typename Hasher>
+template <typename KeyType>
+size_t OpenHashSet<ValueType, Hasher>::find(const KeyType& key) const
+{
+	if (m_slots.empty())
+	{
+		return npos;
+	}
+
+	return m_slots[findSlot(key, mix(m_hasher(key)))].index;
+}
+
+template <typename ValueType, typename Hasher>
+template <typename KeyType>
+std::pair<size_t, bool> OpenHashSet<ValueType, Hasher>::insert(const KeyType& key)
+{
+	return insert(key, key);
+}
+
+template <typename ValueType, typename Hasher>
+template <typename KeyType>
+std::pair<size_t, bool> OpenHashSet<ValueType, Hasher>::insert(
+	const KeyType& key, const ValueType& value)
+{
+	// keep the load factor below one half
+	if ((m_values.size() + 1) * 2 > m_slots.size())
+	{
+		rehash(std::max<size_t>(16, m_slots.size() * 2));
+	}
+
+	const size_t hash = mix(m_hasher(key));
+	Slot& slot = m_slots[findSlot(key, hash)];
+	if (slot.index != npos)
+	{
+		return std::make_pair(slot.index, false);
+	}
+
+	slot.hash = hash;
+	slot.index = m_values.size();
+	m_values.push_back(value);
+	m_orderedSetValid = false;
+
+	return std::make_pair(slot.index, true);
+}
+
+template <typename ValueType, typename Hasher>
+ValueType& OpenHashSet<ValueType, Hasher>::operator[](size_t index)
+{
+	m_orderedSetValid = false;
+	return m_values[index];
+}
+
+template <typename ValueType, typename Hasher>
+const ValueType& OpenHashSet<ValueType, Hasher>::operator[](size_t index) const
+{
+	return m_values[index];
+}
+
+template <typename ValueType, typename Hasher>
+typename std::vector<ValueType>::const_iterator OpenHashSet<ValueType, Hasher>::begin() const
+{
+	return m_values.begin();
+}
+
+template <typename ValueType, typename Hasher>
+typename std::vector<ValueType>::const_iterator OpenHashSet<ValueType, Hasher>::end() const
+{
+	return m_values.end();
+}
+
+template <typename ValueType, typename Hasher>
+const std::vector<ValueType>& OpenHashSet<ValueType, Hasher>::getValues() const
+{
+	return m_values;
+}
+
+template <typename ValueType, typename Hasher>
+template <typename IteratorType>
+void OpenHashSet<ValueType, Hasher>::assign(IteratorType first, IteratorType last)
+{
+	clear();
+	reserve(std::distance(first, last));
+
+	for (IteratorType it = first; it != last; it++)
+	{
+		insert(*it);
+	}
+}
+
+template <typename ValueType, typename Hasher>
+const std::set<ValueType>& OpenHashSet<ValueType, Hasher>::getOrderedSet() const
+{
+	if (!m_orderedSetValid)
+	{
+		std::vector<const ValueType*> sortedValues;
+		sortedValues.reserve(m_values.size());
+		for (const ValueType& value: m_values)
+		{
+			sortedValues.push_back(&value);
+		}
+
+		std::sort(
+			sortedValues.begin(),
+			sortedValues.end(),
+			[](const ValueType* a, const ValueType* b) { return *a < *b; });
+
+		m_orderedSet.clear();
+		for (const ValueType* value: sortedValues)
+		{
+			m_orderedSet.emplace_hint(m_orderedSet.end(), *value);
+		}
+		m_orderedSetValid = true;
+	}
+
+	return m_orderedSet;
+}
+
+template <typename ValueType, typename Hasher>
+size_t OpenHashSet<ValueType, Hasher>::mix(size_t hash)
+{
+	unsigned long long h = hash;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed62ccd5ULL;
+	h ^= h >> 33;
+	return static_cast<size_t>(h);
+}
+
+template <typename ValueType, typename Hasher>
+template <typename KeyType>
+size_t OpenHashSet<ValueType, Hasher>::findSlot(const KeyType& key, size_t hash) const
+{
+	const size_t mask = m_slots.size() - 1;
+	size_t pos = hash & mask;
+
+	while (true)
+	{
+		const Slot& slot = m_slots[pos];
+		if (slot.index == npos)
+		{
+			return pos;
+		}
+
+		// comparing the stored hash first avoids most of the expensive value comparisons
+		if (slot.hash == hash && !(m_values[slot.index] < key) && !(key < m_values[slot.index]))
+		{
+			return pos;
+		}
+
+		pos = (pos + 1) & mask;
+	}
+}
+
+template <typename ValueType, typename Hasher>
+void OpenHashSet<ValueType, Hasher>::rehash(size_t slotCount)
+{
+	std::vector<Slot> slots(slotCount, Slot {0, npos});
+	const size_t mask = slotCount - 1;
+
+	for (const Slot& slot: m_slots)
+	{
+		if (slot.index != npos)
+		{
+			size_t pos = slot.hash & mask;
+			while (slots[pos].index != npos)
+			{
+				pos = (pos + 1) & mask;
+			}
+			slots[pos] = slot;
+		}
+	}
+
+	m_slots.swap(slots);
+}
+
+#endif	  // OPEN_HASH_SET_H
@@ -57,3 +57,18 @@ bool FileRegister::hasFilePath(const FilePath& filePath) const
 {
 	return m_hasFilePathCache.getValue(filePath.wstr());
 }
+
+void FileRegister::setClaimFilePathFunction(std::function<bool(const FilePath&)> claimFilePath)
+{
+	m_claimFilePath = claimFilePath;
+}
+
+bool FileRegister::claimFilePath(const FilePath& filePath) const
+{
+	if (!m_claimFilePath || filePath == m_currentPath)
+	{
+		return true;
+	}
+
+	return m_claimFilePath(filePath);
+}
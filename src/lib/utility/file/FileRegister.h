@@ -1,6 +1,7 @@
 #ifndef FILE_REGISTER_H
 #define FILE_REGISTER_H
 
+#include <functional>
 #include <set>
 
 #include "FilePath.h"
@@ -19,11 +20,17 @@ public:
 
 	virtual bool hasFilePath(const FilePath& filePath) const;
 
+	// files claimed by another indexer of the same run are indexed there, the current file is
+	// always claimed
+	void setClaimFilePathFunction(std::function<bool(const FilePath&)> claimFilePath);
+	bool claimFilePath(const FilePath& filePath) const;
+
 private:
 	const FilePath& m_currentPath;
 	const std::set<FilePath> m_indexedPaths;
 	const std::set<FilePathFilter> m_excludeFilters;
 	mutable UnorderedCache<std::wstring, bool> m_hasFilePathCache;
+	std::function<bool(const FilePath&)> m_claimFilePath;
 };
 
 #endif	  // FILE_REGISTER_H
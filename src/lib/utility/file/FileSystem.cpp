@@ -230,6 +230,20 @@ bool FileSystem::rename(const FilePath& from, const FilePath& to)
 	return true;
 }
 
+bool FileSystem::replace(const FilePath& from, const FilePath& to)
+{
+	if (!from.recheckExists())
+	{
+		return false;
+	}
+
+	boost::system::error_code ec;
+	boost::filesystem::rename(from.getPath(), to.getPath(), ec);
+	from.recheckExists();
+	to.recheckExists();
+	return !ec;
+}
+
 bool FileSystem::copyFile(const FilePath& from, const FilePath& to)
 {
 	if (!from.recheckExists() || to.recheckExists())
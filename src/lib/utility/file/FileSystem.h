@@ -30,6 +30,8 @@ public:
 
 	static bool remove(const FilePath& path);
 	static bool rename(const FilePath& from, const FilePath& to);
+	// moves the file and replaces an existing target in one step
+	static bool replace(const FilePath& from, const FilePath& to);
 
 	static bool copyFile(const FilePath& from, const FilePath& to);
 	static bool copy_directory(const FilePath& from, const FilePath& to);
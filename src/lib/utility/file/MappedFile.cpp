@@ -0,0 +1,141 @@
+#include "MappedFile.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstring>
+
+#include "FilePath.h"
+#include "FileSystem.h"
+#include "logging.h"
+#include "utilityString.h"
+
+namespace
+{
+struct FileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t keyLength;
+};
+}	 // namespace
+
+size_t MappedFile::getPaddedSize(size_t size)
+{
+	return (size + 7) & ~size_t(7);
+}
+
+void MappedFile::writePadded(std::ofstream& out, const void* data, size_t size)
+{
+	const char padding[8] = {};
+	out.write(static_cast<const char*>(data), size);
+	out.write(padding, getPaddedSize(size) - size);
+}
+
+bool MappedFile::save(
+	const FilePath& filePath,
+	const char (&magic)[8],
+	uint32_t version,
+	const std::string& key,
+	const std::function<void(std::ofstream&)>& writeData)
+{
+	const FilePath tempFilePath(filePath.wstr() + L"_tmp");
+
+	bool written = false;
+	{
+		std::ofstream out(tempFilePath.str(), std::ios::binary | std::ios::trunc);
+		if (out)
+		{
+			FileHeader header;
+			std::memcpy(header.magic, magic, sizeof(header.magic));
+			header.version = version;
+			header.keyLength = static_cast<uint32_t>(key.size());
+
+			writePadded(out, &header, sizeof(header));
+			writePadded(out, key.data(), key.size());
+			writeData(out);
+
+			out.close();
+			written = !out.fail();
+		}
+	}
+
+	if (!written)
+	{
+		LOG_ERROR(L"Unable to write file \"" + tempFilePath.wstr() + L"\"");
+		FileSystem::remove(tempFilePath);
+		return false;
+	}
+
+	if (!FileSystem::replace(tempFilePath, filePath))
+	{
+		LOG_ERROR(L"Unable to replace file \"" + filePath.wstr() + L"\"");
+		FileSystem::remove(tempFilePath);
+		return false;
+	}
+
+	return true;
+}
+
+MappedFile::MappedFile(const FilePath& filePath)
+{
+	if (!filePath.recheckExists())
+	{
+		return;
+	}
+
+	try
+	{
+		boost::interprocess::file_mapping mapping(
+			filePath.str().c_str(), boost::interprocess::read_only);
+		std::shared_ptr<boost::interprocess::mapped_region> region =
+			std::make_shared<boost::interprocess::mapped_region>(
+				mapping, boost::interprocess::read_only);
+
+		m_data = static_cast<const char*>(region->get_address());
+		m_size = region->get_size();
+		m_region = region;
+	}
+	catch (boost::interprocess::interprocess_exception& e)
+	{
+		LOG_WARNING(
+			L"Unable to map file \"" + filePath.wstr() + L"\": " +
+			utility::decodeFromUtf8(e.what()));
+	}
+}
+
+bool MappedFile::isMapped() const
+{
+	return m_region != nullptr;
+}
+
+bool MappedFile::readHeader(const char (&magic)[8], uint32_t version, std::string* key)
+{
+	const FileHeader* header = read<FileHeader>(1);
+	const char* storedKey = header ? read<char>(header->keyLength) : nullptr;
+
+	if (!storedKey || std::memcmp(header->magic, magic, sizeof(header->magic)) != 0 ||
+		header->version != version)
+	{
+		fail();
+		return false;
+	}
+
+	*key = std::string(storedKey, header->keyLength);
+	return true;
+}
+
+std::shared_ptr<const void> MappedFile::getDataOwner() const
+{
+	return m_region;
+}
+
+void MappedFile::fail()
+{
+	m_failed = true;
+}
+
+bool MappedFile::failed() const
+{
+	return m_failed || !m_region;
+}
@@ -0,0 +1,68 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+
+class FilePath;
+
+// read only mapping of a file that consists of blocks padded to 8 bytes, so all data stays aligned
+// and can be used in place
+class MappedFile
+{
+public:
+	static size_t getPaddedSize(size_t size);
+	static void writePadded(std::ofstream& out, const void* data, size_t size);
+
+	// writes a file that starts with the magic, the version and the key of the data, followed by
+	// the blocks of writeData. the file is written beside the old one and replaces it when
+	// complete, so no partially written file gets mapped. on failure the old file is kept.
+	static bool save(
+		const FilePath& filePath,
+		const char (&magic)[8],
+		uint32_t version,
+		const std::string& key,
+		const std::function<void(std::ofstream&)>& writeData);
+
+	// maps nothing if the file does not exist or cannot be mapped
+	MappedFile(const FilePath& filePath);
+
+	bool isMapped() const;
+
+	// reads the start of a file written by save and fails if the magic or the version differ
+	bool readHeader(const char (&magic)[8], uint32_t version, std::string* key);
+
+	// keeps the mapping alive, so data that was read can be used instead of copies of it
+	std::shared_ptr<const void> getDataOwner() const;
+
+	// returns the next block or nullptr if the file ends before
+	template <typename T>
+	const T* read(size_t count)
+	{
+		const size_t size = getPaddedSize(sizeof(T) * count);
+		if (m_failed || m_size - m_pos < size)
+		{
+			m_failed = true;
+			return nullptr;
+		}
+
+		const T* data = reinterpret_cast<const T*>(m_data + m_pos);
+		m_pos += size;
+		return data;
+	}
+
+	void fail();
+	bool failed() const;
+
+private:
+	std::shared_ptr<const void> m_region;
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+	size_t m_pos = 0;
+	bool m_failed = false;
+};
+
+#endif	  // MAPPED_FILE_H
@@ -51,6 +51,66 @@ std::vector<FilePath> utility::partitionFilePathsBySize(std::vector<FilePath> fi
 	return sortedFilePaths;
 }
 
+std::vector<FilePath> utility::orderFilePathsByIndexCost(
+	const std::vector<FilePath>& filePaths, const std::map<FilePath, size_t>& indexTimes)
+{
+	std::vector<unsigned long long int> fileSizes;
+	std::vector<double> costs;
+	unsigned long long int timedSize = 0;
+	unsigned long long int timedMilliseconds = 0;
+	for (const FilePath& path: filePaths)
+	{
+		const unsigned long long int fileSize = path.exists() ? FileSystem::getFileByteSize(path)
+															  : 1;
+		fileSizes.push_back(fileSize);
+
+		auto it = indexTimes.find(path);
+		if (it != indexTimes.end())
+		{
+			costs.push_back(static_cast<double>(it->second));
+			timedSize += fileSize;
+			timedMilliseconds += it->second;
+		}
+		else
+		{
+			costs.push_back(-1.0);
+		}
+	}
+
+	double millisecondsPerByte = 1.0;
+	if (timedSize > 0 && timedMilliseconds > 0)
+	{
+		millisecondsPerByte = static_cast<double>(timedMilliseconds) / timedSize;
+	}
+	else
+	{
+		// without measured times the costs are the file sizes
+		std::fill(costs.begin(), costs.end(), -1.0);
+	}
+
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < filePaths.size(); i++)
+	{
+		if (costs[i] < 0.0)
+		{
+			costs[i] = fileSizes[i] * millisecondsPerByte;
+		}
+		indices.push_back(i);
+	}
+
+	std::stable_sort(indices.begin(), indices.end(), [&costs](size_t a, size_t b) {
+		return costs[a] > costs[b];
+	});
+
+	std::vector<FilePath> sortedFilePaths;
+	sortedFilePaths.reserve(filePaths.size());
+	for (size_t index: indices)
+	{
+		sortedFilePaths.push_back(filePaths[index]);
+	}
+	return sortedFilePaths;
+}
+
 std::vector<FilePath> utility::getTopLevelPaths(const std::vector<FilePath>& paths)
 {
 	return utility::getTopLevelPaths(utility::toSet(paths));
@@ -1,6 +1,8 @@
 #ifndef UTILITY_FILE_H
 #define UTILITY_FILE_H
 
+#include <cstddef>
+#include <map>
 #include <set>
 #include <vector>
 
@@ -10,6 +12,11 @@ namespace utility
 {
 std::vector<FilePath> partitionFilePathsBySize(std::vector<FilePath> filePaths, int partitionCount = 0);
 
+// orders by descending cost, which is the previous index time or, for files without one, the file
+// size scaled by the index time per byte of the other files
+std::vector<FilePath> orderFilePathsByIndexCost(
+	const std::vector<FilePath>& filePaths, const std::map<FilePath, size_t>& indexTimes);
+
 std::vector<FilePath> getTopLevelPaths(const std::vector<FilePath>& paths);
 std::vector<FilePath> getTopLevelPaths(const std::set<FilePath>& paths);
 
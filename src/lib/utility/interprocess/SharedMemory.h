@@ -9,6 +9,7 @@
 #include <boost/interprocess/containers/string.hpp>
 #include <boost/interprocess/containers/vector.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/named_condition.hpp>
 #include <boost/interprocess/sync/named_mutex.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 
@@ -64,6 +65,11 @@ public:
 		void growMemory(size_t size);
 		void shrinkToFitMemory();
 
+		// releases the lock until another access notifies a change or the timeout passed. values
+		// need to be accessed again afterwards, because the memory may have grown meanwhile.
+		void waitForChange(size_t timeoutMilliseconds);
+		void notifyChange();
+
 		template <typename T>
 		T* accessValue(const std::string& key)
 		{
@@ -98,6 +104,7 @@ public:
 
 	private:
 		boost::interprocess::managed_shared_memory m_memory;
+		boost::interprocess::named_condition& m_condition;
 		std::string m_memoryName;
 		size_t m_minimumMemorySize;
 	};
@@ -107,15 +114,19 @@ public:
 private:
 	static const char* s_memoryNamePrefix;
 	static const char* s_mutexNamePrefix;
+	static const char* s_conditionNamePrefix;
 
 	std::string getMemoryName() const;
 	std::string getMutexName() const;
+	std::string getConditionName() const;
 
 	boost::interprocess::named_mutex& getMutex();
+	boost::interprocess::named_condition& getCondition();
 
 	size_t getInitialMemorySize() const;
 
 	std::shared_ptr<boost::interprocess::named_mutex> m_mutex;
+	std::shared_ptr<boost::interprocess::named_condition> m_condition;
 	std::string m_name;
 	AccessMode m_mode;
 
@@ -21,6 +21,7 @@ public:
 		, nodeNonIndexed(false)
 		, depth(depth)
 		, horizontalLayout(horizontalLayout)
+		, shortestPath(false)
 		, custom(false)
 	{
 		setSchedulerId(TabId::currentTab());
@@ -33,7 +34,8 @@ public:
 		Edge::TypeMask edgeTypes,
 		bool nodeNonIndexed,
 		size_t depth,
-		bool horizontalLayout)
+		bool horizontalLayout,
+		bool shortestPath)
 		: originId(originId)
 		, targetId(targetId)
 		, nodeTypes(nodeTypes)
@@ -41,6 +43,7 @@ public:
 		, nodeNonIndexed(nodeNonIndexed)
 		, depth(depth)
 		, horizontalLayout(horizontalLayout)
+		, shortestPath(shortestPath)
 		, custom(true)
 	{
 		setSchedulerId(TabId::currentTab());
@@ -65,6 +68,9 @@ public:
 	const bool nodeNonIndexed;
 	const size_t depth;
 	const bool horizontalLayout;
+
+	// only keep the shortest trails between origin and target, found by searching from both ends
+	const bool shortestPath;
 	const bool custom;
 };
 
@@ -1,8 +1,8 @@
 #include "Blackboard.h"
 
-Blackboard::Blackboard() {}
+Blackboard::Blackboard(): m_changeCount(0) {}
 
-Blackboard::Blackboard(std::shared_ptr<Blackboard> parent): m_parent(parent) {}
+Blackboard::Blackboard(std::shared_ptr<Blackboard> parent): m_parent(parent), m_changeCount(0) {}
 
 bool Blackboard::exists(const std::string& key)
 {
@@ -20,7 +20,33 @@ bool Blackboard::clear(const std::string& key)
 	if (it != m_items.end())
 	{
 		m_items.erase(it);
+
+		m_changeCount++;
+		m_changeCondition.notify_all();
 		return true;
 	}
 	return false;
 }
+
+size_t Blackboard::getChangeCount()
+{
+	std::lock_guard<std::mutex> lock(m_itemMutex);
+	return m_changeCount;
+}
+
+bool Blackboard::waitForChange(size_t changeCount, size_t timeoutMilliseconds)
+{
+	std::unique_lock<std::mutex> lock(m_itemMutex);
+	return m_changeCondition.wait_for(
+		lock, std::chrono::milliseconds(timeoutMilliseconds), [this, changeCount]() {
+			return m_changeCount != changeCount;
+		});
+}
+
+void Blackboard::notifyChange()
+{
+	std::lock_guard<std::mutex> lock(m_itemMutex);
+
+	m_changeCount++;
+	m_changeCondition.notify_all();
+}
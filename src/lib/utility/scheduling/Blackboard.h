@@ -1,6 +1,7 @@
 #ifndef BLACKBOARD_H
 #define BLACKBOARD_H
 
+#include <condition_variable>
 #include <functional>
 #include <map>
 #include <memory>
@@ -45,6 +46,16 @@ public:
 	bool exists(const std::string& key);
 	bool clear(const std::string& key);
 
+	// counts the changes of all values, taking the count before reading values ensures that a
+	// change in between does not get missed when waiting
+	size_t getChangeCount();
+
+	// returns whether the change count differs from the given one before the timeout passed
+	bool waitForChange(size_t changeCount, size_t timeoutMilliseconds);
+
+	// wakes waiting tasks after changes that are not stored on the blackboard
+	void notifyChange();
+
 private:
 	typedef std::map<std::string, std::shared_ptr<BlackboardItemBase>> ItemMap;
 
@@ -52,6 +63,9 @@ private:
 
 	ItemMap m_items;
 	std::mutex m_itemMutex;
+
+	size_t m_changeCount;
+	std::condition_variable m_changeCondition;
 };
 
 
@@ -61,6 +75,9 @@ void Blackboard::set(const std::string& key, const T& value)
 	std::lock_guard<std::mutex> lock(m_itemMutex);
 
 	m_items[key] = std::make_shared<BlackboardItem<T>>(value);
+
+	m_changeCount++;
+	m_changeCondition.notify_all();
 }
 
 template <typename T>
@@ -99,6 +116,9 @@ bool Blackboard::update(const std::string& key, std::function<T(const T&)> updat
 				it->second))
 		{
 			item->value = updater(item->value);
+
+			m_changeCount++;
+			m_changeCondition.notify_all();
 			return true;
 		}
 	}
@@ -1,7 +1,6 @@
 #include "TaskDecoratorRepeat.h"
 
-#include <chrono>
-#include <thread>
+#include "Blackboard.h"
 
 TaskDecoratorRepeat::TaskDecoratorRepeat(ConditionType condition, TaskState exitState, size_t delayMS)
 	: m_condition(condition), m_exitState(exitState), m_delayMS(delayMS)
@@ -12,6 +11,7 @@ void TaskDecoratorRepeat::doEnter(std::shared_ptr<Blackboard> blackboard) {}
 
 Task::TaskState TaskDecoratorRepeat::doUpdate(std::shared_ptr<Blackboard> blackboard)
 {
+	const size_t changeCount = blackboard->getChangeCount();
 	TaskState state = m_taskRunner->update(blackboard);
 
 	switch (m_condition)
@@ -29,7 +29,8 @@ Task::TaskState TaskDecoratorRepeat::doUpdate(std::shared_ptr<Blackboard> blackb
 		break;
 	}
 
-	std::this_thread::sleep_for(std::chrono::milliseconds(m_delayMS));
+	// repeating right away when something changed since the last update, otherwise after the delay
+	blackboard->waitForChange(changeCount, m_delayMS);
 
 	return state;
 }
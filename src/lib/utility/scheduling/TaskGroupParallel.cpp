@@ -1,8 +1,6 @@
 #include "TaskGroupParallel.h"
 
-#include <chrono>
-#include <thread>
-
+#include "Blackboard.h"
 #include "ScopedFunctor.h"
 
 TaskGroupParallel::TaskGroupParallel()
@@ -38,10 +36,11 @@ void TaskGroupParallel::doEnter(std::shared_ptr<Blackboard> blackboard)
 
 Task::TaskState TaskGroupParallel::doUpdate(std::shared_ptr<Blackboard> blackboard)
 {
-	std::this_thread::sleep_for(std::chrono::milliseconds(25));
-
+	const size_t changeCount = blackboard->getChangeCount();
 	if (m_tasks.size() != 0 && getActiveTaskCount() > 0)
 	{
+		// finishing tasks notify the blackboard
+		blackboard->waitForChange(changeCount, 25);
 		return STATE_RUNNING;
 	}
 
@@ -103,8 +102,11 @@ void TaskGroupParallel::processTaskThreaded(
 	std::shared_ptr<std::mutex> activeTaskCountMutex)
 {
 	ScopedFunctor functor([&]() {
-		std::lock_guard<std::mutex> lock(*activeTaskCountMutex.get());
-		m_activeTaskCount--;
+		{
+			std::lock_guard<std::mutex> lock(*activeTaskCountMutex.get());
+			m_activeTaskCount--;
+		}
+		blackboard->notifyChange();
 	});
 
 	while (true)
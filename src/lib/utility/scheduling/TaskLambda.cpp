@@ -1,12 +1,17 @@
 #include "TaskLambda.h"
 
-TaskLambda::TaskLambda(std::function<void()> func): m_func(func) {}
+TaskLambda::TaskLambda(std::function<void()> func)
+	: m_func([func](std::shared_ptr<Blackboard> blackboard) { func(); })
+{
+}
+
+TaskLambda::TaskLambda(std::function<void(std::shared_ptr<Blackboard>)> func): m_func(func) {}
 
 void TaskLambda::doEnter(std::shared_ptr<Blackboard> blackboard) {}
 
 Task::TaskState TaskLambda::doUpdate(std::shared_ptr<Blackboard> blackboard)
 {
-	m_func();
+	m_func(blackboard);
 	return STATE_SUCCESS;
 }
 
@@ -9,6 +9,7 @@ class TaskLambda: public Task
 {
 public:
 	TaskLambda(std::function<void()> func);
+	TaskLambda(std::function<void(std::shared_ptr<Blackboard>)> func);
 
 private:
 	void doEnter(std::shared_ptr<Blackboard> blackboard) override;
@@ -16,7 +17,7 @@ private:
 	void doExit(std::shared_ptr<Blackboard> blackboard) override;
 	void doReset(std::shared_ptr<Blackboard> blackboard) override;
 
-	std::function<void()> m_func;
+	std::function<void(std::shared_ptr<Blackboard>)> m_func;
 };
 
 #endif	  // LAMBDA_TASK_H
@@ -21,22 +21,28 @@ TaskScheduler::~TaskScheduler()
 
 void TaskScheduler::pushTask(std::shared_ptr<Task> task)
 {
-	std::lock_guard<std::mutex> lock(m_tasksMutex);
-	m_taskRunners.push_back(std::make_shared<TaskRunner>(task));
+	{
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+		m_taskRunners.push_back(std::make_shared<TaskRunner>(task));
+	}
+	m_tasksCondition.notify_all();
 }
 
 void TaskScheduler::pushNextTask(std::shared_ptr<Task> task)
 {
-	std::lock_guard<std::mutex> lock(m_tasksMutex);
-
-	if (m_taskRunners.size() == 0)
-	{
-		m_taskRunners.push_front(std::make_shared<TaskRunner>(task));
-	}
-	else
 	{
-		m_taskRunners.insert(m_taskRunners.begin() + 1, std::make_shared<TaskRunner>(task));
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+
+		if (m_taskRunners.size() == 0)
+		{
+			m_taskRunners.push_front(std::make_shared<TaskRunner>(task));
+		}
+		else
+		{
+			m_taskRunners.insert(m_taskRunners.begin() + 1, std::make_shared<TaskRunner>(task));
+		}
 	}
+	m_tasksCondition.notify_all();
 }
 
 void TaskScheduler::startSchedulerLoopThreaded()
@@ -74,7 +80,10 @@ void TaskScheduler::startSchedulerLoop()
 			}
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(25));
+		std::unique_lock<std::mutex> lock(m_tasksMutex);
+		m_tasksCondition.wait_for(lock, std::chrono::milliseconds(25), [this]() {
+			return !m_taskRunners.empty() || !loopIsRunning();
+		});
 	}
 
 	{
@@ -99,6 +108,12 @@ void TaskScheduler::stopSchedulerLoop()
 		m_loopIsRunning = false;
 	}
 
+	{
+		// the loop checks the running state while holding the tasks mutex
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+	}
+	m_tasksCondition.notify_all();
+
 	while (true)
 	{
 		{
@@ -1,6 +1,7 @@
 #ifndef TASK_SCHEDULER_H
 #define TASK_SCHEDULER_H
 
+#include <condition_variable>
 #include <deque>
 #include <memory>
 #include <mutex>
@@ -39,6 +40,7 @@ private:
 	std::deque<std::shared_ptr<TaskRunner>> m_taskRunners;
 
 	mutable std::mutex m_tasksMutex;
+	std::condition_variable m_tasksCondition;
 	mutable std::mutex m_loopMutex;
 	mutable std::mutex m_threadMutex;
 };
@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount): m_threadCount(std::max<size_t>(threadCount, 1)) {}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_jobsMutex);
+		m_stopped = true;
+	}
+	m_jobsCondition.notify_all();
+
+	for (std::thread& thread: m_threads)
+	{
+		thread.join();
+	}
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+	return m_threadCount;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (count == 1 || m_threadCount == 1)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			func(i);
+		}
+		return;
+	}
+
+	std::shared_ptr<Job> job = std::make_shared<Job>(count, func);
+	{
+		std::lock_guard<std::mutex> lock(m_jobsMutex);
+		startThreads();
+		m_jobs.push_back(job);
+	}
+	m_jobsCondition.notify_all();
+
+	runJob(*job);
+	removeJob(job);
+
+	std::unique_lock<std::mutex> lock(job->doneMutex);
+	job->doneCondition.wait(lock, [&job]() { return job->doneCount == job->count; });
+}
+
+void ThreadPool::runJob(Job& job)
+{
+	for (size_t i = job.nextIndex++; i < job.count; i = job.nextIndex++)
+	{
+		job.func(i);
+
+		std::lock_guard<std::mutex> lock(job.doneMutex);
+		if (++job.doneCount == job.count)
+		{
+			job.doneCondition.notify_all();
+		}
+	}
+}
+
+void ThreadPool::startThreads()
+{
+	if (!m_threads.empty())
+	{
+		return;
+	}
+
+	for (size_t i = 1; i < m_threadCount; i++)
+	{
+		m_threads.emplace_back(&ThreadPool::runWorker, this);
+	}
+}
+
+void ThreadPool::runWorker()
+{
+	while (true)
+	{
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(m_jobsMutex);
+			m_jobsCondition.wait(lock, [this]() { return m_stopped || !m_jobs.empty(); });
+			if (m_stopped)
+			{
+				return;
+			}
+			job = m_jobs.front();
+		}
+
+		runJob(*job);
+		removeJob(job);
+	}
+}
+
+void ThreadPool::removeJob(const std::shared_ptr<Job>& job)
+{
+	std::lock_guard<std::mutex> lock(m_jobsMutex);
+	auto it = std::find(m_jobs.begin(), m_jobs.end(), job);
+	if (it != m_jobs.end())
+	{
+		m_jobs.erase(it);
+	}
+}
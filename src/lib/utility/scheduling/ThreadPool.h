@@ -0,0 +1,56 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// keeps worker threads alive between parallel loops, workers are started on first use
+class ThreadPool
+{
+public:
+	// threadCount includes the calling thread, that takes part in every loop
+	ThreadPool(size_t threadCount);
+	~ThreadPool();
+
+	size_t getThreadCount() const;
+
+	// calls func for every index in [0, count) and returns once all calls are done, may also be
+	// called from within func
+	void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+private:
+	struct Job
+	{
+		Job(size_t count, const std::function<void(size_t)>& func): count(count), func(func) {}
+
+		const size_t count;
+		const std::function<void(size_t)>& func;
+		std::atomic<size_t> nextIndex {0};
+
+		std::mutex doneMutex;
+		std::condition_variable doneCondition;
+		size_t doneCount = 0;
+	};
+
+	static void runJob(Job& job);
+
+	void startThreads();
+	void runWorker();
+	void removeJob(const std::shared_ptr<Job>& job);
+
+	const size_t m_threadCount;
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_jobsMutex;
+	std::condition_variable m_jobsCondition;
+	std::deque<std::shared_ptr<Job>> m_jobs;
+	bool m_stopped = false;
+};
+
+#endif	  // THREAD_POOL_H
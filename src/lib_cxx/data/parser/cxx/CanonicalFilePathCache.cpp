@@ -157,3 +157,22 @@ bool CanonicalFilePathCache::isProjectFile(
 	m_isProjectFileMap.emplace(fileId, ret);
 	return ret;
 }
+
+bool CanonicalFilePathCache::isClaimedProjectFile(
+	const clang::FileID& fileId, const clang::SourceManager& sourceManager)
+{
+	if (!isProjectFile(fileId, sourceManager))
+	{
+		return false;
+	}
+
+	auto it = m_isClaimedProjectFileMap.find(fileId);
+	if (it != m_isClaimedProjectFileMap.end())
+	{
+		return it->second;
+	}
+
+	bool ret = m_fileRegister->claimFilePath(getCanonicalFilePath(fileId, sourceManager));
+	m_isClaimedProjectFileMap.emplace(fileId, ret);
+	return ret;
+}
@@ -34,6 +34,9 @@ public:
 
 	bool isProjectFile(const clang::FileID& fileId, const clang::SourceManager& sourceManager);
 
+	// project files that are not claimed by the indexer of another translation unit
+	bool isClaimedProjectFile(const clang::FileID& fileId, const clang::SourceManager& sourceManager);
+
 private:
 	std::shared_ptr<FileRegister> m_fileRegister;
 
@@ -45,6 +48,7 @@ private:
 	std::unordered_map<std::wstring, Id> m_fileStringSymbolIdMap;
 
 	std::map<clang::FileID, bool> m_isProjectFileMap;
+	std::map<clang::FileID, bool> m_isClaimedProjectFileMap;
 };
 
 #endif	  // CANONICAL_FILE_PATH_CACHE_H
@@ -710,6 +710,8 @@ bool CxxAstVisitor::isLocatedInProjectFile(clang::SourceLocation loc) const
 		return false;
 	}
 
+	// files claimed by other translation units are skipped, their symbols are recorded there
 	const clang::SourceManager& sourceManager = m_astContext->getSourceManager();
-	return m_canonicalFilePathCache->isProjectFile(sourceManager.getFileID(loc), sourceManager);
+	return m_canonicalFilePathCache->isClaimedProjectFile(
+		sourceManager.getFileID(loc), sourceManager);
 }
@@ -13,6 +13,7 @@
 #include "ApplicationSettings.h"
 #include "CanonicalFilePathCache.h"
 #include "ClangInvocationInfo.h"
+#include "CxxAutomaticPchPlanner.h"
 #include "CxxCompilationDatabaseSingle.h"
 #include "CxxDiagnosticConsumer.h"
 #include "FilePath.h"
@@ -138,6 +139,7 @@ void CxxParser::buildIndex(std::shared_ptr<IndexerCommandCxx> indexerCommand)
 	{
 		args.erase(args.begin());
 	}
+	CxxAutomaticPchPlanner::removeMissingPchFlags(args);
 	compileCommand.CommandLine = getCommandlineArgumentsEssential(args);
 	compileCommand.CommandLine = prependSyntaxOnlyToolArgs(compileCommand.CommandLine);
 
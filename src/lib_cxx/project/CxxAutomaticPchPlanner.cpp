@@ -0,0 +1,345 @@
+#include "CxxAutomaticPchPlanner.h"
+
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <sstream>
+
+#include "FileSystem.h"
+#include "IncludeDirective.h"
+#include "IncludeProcessing.h"
+#include "TextAccess.h"
+#include "logging.h"
+#include "utility.h"
+#include "utilityString.h"
+
+namespace
+{
+// returns false if the flags already bring their own precompiled or forced includes
+bool getPchCompilerFlags(
+	const std::vector<std::wstring>& compilerFlags,
+	const FilePath& sourceFilePath,
+	std::vector<std::wstring>* pchCompilerFlags,
+	std::wstring* language)
+{
+	const std::set<std::wstring> flagsWithValue = {L"-o", L"-MF", L"-MT", L"-MQ"};
+	const std::set<std::wstring> ignoredFlags = {L"-c", L"-M", L"-MM", L"-MD", L"-MMD", L"-MP"};
+	const std::vector<std::wstring> unsupportedFlagPrefixes = {
+		L"-include", L"-imacros", L"--driver-mode=cl", L"/FI", L"/Yc", L"/Yu"};
+
+	std::wstring languageFlag;
+	for (size_t i = 0; i < compilerFlags.size(); i++)
+	{
+		const std::wstring& flag = compilerFlags[i];
+
+		for (const std::wstring& prefix: unsupportedFlagPrefixes)
+		{
+			if (utility::isPrefix(prefix, flag))
+			{
+				return false;
+			}
+		}
+
+		if (flagsWithValue.find(flag) != flagsWithValue.end())
+		{
+			i++;
+			continue;
+		}
+
+		// the compiler and the source file
+		if (ignoredFlags.find(flag) != ignoredFlags.end() ||
+			(!utility::isPrefix<std::wstring>(L"-", flag) &&
+			 (i == 0 || FilePath(flag).fileName() == sourceFilePath.fileName())))
+		{
+			continue;
+		}
+
+		if (flag == L"-x" && i + 1 < compilerFlags.size())
+		{
+			languageFlag = compilerFlags[i + 1];
+		}
+
+		pchCompilerFlags->push_back(flag);
+	}
+
+	const std::wstring extension = sourceFilePath.extension();
+	if (languageFlag.empty())
+	{
+		if (utility::toLowerCase(extension) == L".c" && extension != L".C")
+		{
+			languageFlag = L"c";
+		}
+		else if (sourceFilePath.hasExtension({L".cpp", L".cxx", L".cc", L".c++", L".cp", L".C"}))
+		{
+			languageFlag = L"c++";
+		}
+	}
+
+	if (languageFlag != L"c" && languageFlag != L"c++")
+	{
+		return false;
+	}
+
+	*language = languageFlag + L"-header";
+	return true;
+}
+
+std::wstring getHashString(const std::wstring& text)
+{
+	// FNV-1a, so file names stay the same across runs
+	uint64_t hash = 14695981039346656037ull;
+	for (wchar_t c: text)
+	{
+		hash ^= static_cast<uint64_t>(c);
+		hash *= 1099511628211ull;
+	}
+
+	std::wstringstream ss;
+	ss << std::hex << std::setw(16) << std::setfill(L'0') << hash;
+	return ss.str();
+}
+}	 // namespace
+
+const size_t CxxAutomaticPchPlanner::s_minimumCommandCount = 3;
+const size_t CxxAutomaticPchPlanner::s_noIndex = std::numeric_limits<size_t>::max();
+const wchar_t* CxxAutomaticPchPlanner::s_pchFileExtension = L".autopch";
+
+void CxxAutomaticPchPlanner::removeMissingPchFlags(std::vector<std::wstring>& compilerFlags)
+{
+	for (size_t i = 0; i + 1 < compilerFlags.size(); i++)
+	{
+		if (compilerFlags[i] == L"-include-pch")
+		{
+			const FilePath pchFilePath(compilerFlags[i + 1]);
+			if (pchFilePath.extension() == s_pchFileExtension && !pchFilePath.exists())
+			{
+				LOG_INFO(L"Automatic precompiled header is missing: " + pchFilePath.wstr());
+				compilerFlags.erase(compilerFlags.begin() + i, compilerFlags.begin() + i + 2);
+				i--;
+			}
+		}
+	}
+}
+
+CxxAutomaticPchPlanner::CxxAutomaticPchPlanner(const FilePath& pchDirectoryPath)
+	: m_pchDirectoryPath(pchDirectoryPath)
+{
+}
+
+size_t CxxAutomaticPchPlanner::addCommand(
+	const FilePath& sourceFilePath,
+	const FilePath& workingDirectory,
+	const std::vector<std::wstring>& compilerFlags)
+{
+	Command command;
+	command.groupIndex = s_noIndex;
+	command.pchIndex = s_noIndex;
+
+	std::vector<std::wstring> pchCompilerFlags;
+	std::wstring language;
+	if (sourceFilePath.exists() &&
+		getPchCompilerFlags(compilerFlags, sourceFilePath, &pchCompilerFlags, &language))
+	{
+		// only system includes, because quoted includes depend on the directory of the source file
+		const std::vector<IncludeDirective> includeDirectives =
+			IncludeProcessing::getLeadingIncludeDirectives(TextAccess::createFromFile(sourceFilePath));
+		for (const IncludeDirective& includeDirective: includeDirectives)
+		{
+			const std::wstring directive = includeDirective.getDirective();
+			if (!utility::isPrefix<std::wstring>(L"#include <", directive))
+			{
+				break;
+			}
+			command.includeDirectives.push_back(directive);
+		}
+	}
+
+	if (!command.includeDirectives.empty())
+	{
+		const std::wstring groupKey = workingDirectory.wstr() + L'\n' + language + L'\n' +
+			utility::join(pchCompilerFlags, L"\n");
+
+		auto it = m_groupIndices.find(groupKey);
+		if (it == m_groupIndices.end())
+		{
+			Group group;
+			group.workingDirectory = workingDirectory;
+			group.compilerFlags = pchCompilerFlags;
+			group.language = language;
+
+			it = m_groupIndices.emplace(groupKey, m_groups.size()).first;
+			m_groups.push_back(group);
+		}
+
+		command.groupIndex = it->second;
+		m_groups[command.groupIndex].commandIndices.push_back(m_commands.size());
+	}
+
+	m_commands.push_back(command);
+	return m_commands.size() - 1;
+}
+
+void CxxAutomaticPchPlanner::finishSetup()
+{
+	m_pchs.clear();
+	for (Command& command: m_commands)
+	{
+		command.pchIndex = s_noIndex;
+	}
+
+	for (const Group& group: m_groups)
+	{
+		if (group.commandIndices.size() < s_minimumCommandCount)
+		{
+			continue;
+		}
+
+		// commands starting with the most common include share a precompiled header
+		std::map<std::wstring, size_t> firstIncludeCounts;
+		for (size_t commandIndex: group.commandIndices)
+		{
+			firstIncludeCounts[m_commands[commandIndex].includeDirectives.front()]++;
+		}
+
+		auto firstInclude = firstIncludeCounts.begin();
+		for (auto it = firstIncludeCounts.begin(); it != firstIncludeCounts.end(); it++)
+		{
+			if (it->second > firstInclude->second)
+			{
+				firstInclude = it;
+			}
+		}
+
+		if (firstInclude->second < s_minimumCommandCount)
+		{
+			continue;
+		}
+
+		std::vector<size_t> commandIndices;
+		std::vector<std::wstring> includeDirectives;
+		for (size_t commandIndex: group.commandIndices)
+		{
+			const std::vector<std::wstring>& commandIncludeDirectives =
+				m_commands[commandIndex].includeDirectives;
+			if (commandIncludeDirectives.front() != firstInclude->first)
+			{
+				continue;
+			}
+
+			if (commandIndices.empty())
+			{
+				includeDirectives = commandIncludeDirectives;
+			}
+			else
+			{
+				size_t sharedCount = 0;
+				while (sharedCount < includeDirectives.size() &&
+					   sharedCount < commandIncludeDirectives.size() &&
+					   includeDirectives[sharedCount] == commandIncludeDirectives[sharedCount])
+				{
+					sharedCount++;
+				}
+				includeDirectives.resize(sharedCount);
+			}
+
+			commandIndices.push_back(commandIndex);
+		}
+
+		Pch pch;
+		pch.name = getHashString(
+			group.workingDirectory.wstr() + L'\n' + group.language + L'\n' +
+			utility::join(group.compilerFlags, L"\n") + L'\n' +
+			utility::join(includeDirectives, L"\n"));
+		pch.workingDirectory = group.workingDirectory;
+		pch.compilerFlags = group.compilerFlags;
+		pch.language = group.language;
+		pch.includeDirectives = includeDirectives;
+		pch.commandCount = commandIndices.size();
+
+		for (size_t commandIndex: commandIndices)
+		{
+			m_commands[commandIndex].pchIndex = m_pchs.size();
+		}
+		m_pchs.push_back(pch);
+	}
+
+	LOG_INFO(
+		"Planned " + std::to_string(m_pchs.size()) + " automatic precompiled headers for " +
+		std::to_string(m_commands.size()) + " indexer commands");
+}
+
+void CxxAutomaticPchPlanner::removeUnusedFiles() const
+{
+	if (!m_pchDirectoryPath.exists())
+	{
+		return;
+	}
+
+	std::set<std::wstring> usedNames;
+	for (const Pch& pch: m_pchs)
+	{
+		usedNames.insert(pch.name);
+	}
+
+	size_t removedCount = 0;
+	for (const FilePath& filePath: FileSystem::getFilePathsFromDirectory(
+			 m_pchDirectoryPath, {L".h", s_pchFileExtension, L".deps"}))
+	{
+		if (usedNames.find(filePath.withoutExtension().fileName()) == usedNames.end() &&
+			FileSystem::remove(filePath))
+		{
+			removedCount++;
+		}
+	}
+
+	if (removedCount > 0)
+	{
+		LOG_INFO(
+			"Removed " + std::to_string(removedCount) +
+			" files of unused automatic precompiled headers");
+	}
+}
+
+std::vector<std::wstring> CxxAutomaticPchPlanner::getIncludePchFlags(size_t commandIndex) const
+{
+	if (commandIndex >= m_commands.size() || m_commands[commandIndex].pchIndex == s_noIndex)
+	{
+		return {};
+	}
+
+	return {
+		L"-fallow-pch-with-compiler-errors",
+		L"-include-pch",
+		getPchFilePath(m_pchs[m_commands[commandIndex].pchIndex]).wstr()};
+}
+
+const std::vector<CxxAutomaticPchPlanner::Pch>& CxxAutomaticPchPlanner::getPchs() const
+{
+	return m_pchs;
+}
+
+size_t CxxAutomaticPchPlanner::getCommandCount() const
+{
+	return m_commands.size();
+}
+
+FilePath CxxAutomaticPchPlanner::getPchDirectoryPath() const
+{
+	return m_pchDirectoryPath;
+}
+
+FilePath CxxAutomaticPchPlanner::getHeaderFilePath(const Pch& pch) const
+{
+	return m_pchDirectoryPath.getConcatenated(pch.name + L".h");
+}
+
+FilePath CxxAutomaticPchPlanner::getPchFilePath(const Pch& pch) const
+{
+	return m_pchDirectoryPath.getConcatenated(pch.name + s_pchFileExtension);
+}
+
+FilePath CxxAutomaticPchPlanner::getDependencyFilePath(const Pch& pch) const
+{
+	return m_pchDirectoryPath.getConcatenated(pch.name + L".deps");
+}
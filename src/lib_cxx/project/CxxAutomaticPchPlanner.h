@@ -0,0 +1,85 @@
+#ifndef CXX_AUTOMATIC_PCH_PLANNER_H
+#define CXX_AUTOMATIC_PCH_PLANNER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FilePath.h"
+
+// plans precompiled headers for indexer commands that share their compiler flags and start with
+// the same system includes, so these includes are parsed once instead of once per translation
+// unit. the precompiled headers only contain includes that the source files repeat, so indexing
+// can go on without them if they could not be built.
+class CxxAutomaticPchPlanner
+{
+public:
+	struct Pch
+	{
+		std::wstring name;
+		FilePath workingDirectory;
+		std::vector<std::wstring> compilerFlags;
+		std::wstring language;
+		std::vector<std::wstring> includeDirectives;
+		size_t commandCount;
+	};
+
+	static const size_t s_minimumCommandCount;
+
+	// drops automatic precompiled headers from the flags that have not been built
+	static void removeMissingPchFlags(std::vector<std::wstring>& compilerFlags);
+
+	CxxAutomaticPchPlanner(const FilePath& pchDirectoryPath);
+
+	// returns the index of the command
+	size_t addCommand(
+		const FilePath& sourceFilePath,
+		const FilePath& workingDirectory,
+		const std::vector<std::wstring>& compilerFlags);
+
+	// assigns the added commands to precompiled headers
+	void finishSetup();
+
+	// deletes the files of precompiled headers that are no longer planned, e.g. because their
+	// group of commands changed or went away
+	void removeUnusedFiles() const;
+
+	// returns the flags to add to the command, empty if the command uses no precompiled header
+	std::vector<std::wstring> getIncludePchFlags(size_t commandIndex) const;
+
+	const std::vector<Pch>& getPchs() const;
+	size_t getCommandCount() const;
+
+	FilePath getPchDirectoryPath() const;
+	FilePath getHeaderFilePath(const Pch& pch) const;
+	FilePath getPchFilePath(const Pch& pch) const;
+	FilePath getDependencyFilePath(const Pch& pch) const;
+
+private:
+	static const size_t s_noIndex;
+	static const wchar_t* s_pchFileExtension;
+
+	struct Command
+	{
+		size_t groupIndex;
+		std::vector<std::wstring> includeDirectives;
+		size_t pchIndex;
+	};
+
+	struct Group
+	{
+		FilePath workingDirectory;
+		std::vector<std::wstring> compilerFlags;
+		std::wstring language;
+		std::vector<size_t> commandIndices;
+	};
+
+	const FilePath m_pchDirectoryPath;
+
+	std::vector<Command> m_commands;
+	std::vector<Group> m_groups;
+	std::map<std::wstring, size_t> m_groupIndices;
+	std::vector<Pch> m_pchs;
+};
+
+#endif	  // CXX_AUTOMATIC_PCH_PLANNER_H
@@ -6,6 +6,7 @@
 #include "Application.h"
 #include "ApplicationSettings.h"
 #include "ClangInvocationInfo.h"
+#include "CxxAutomaticPchPlanner.h"
 #include "CxxCompilationDatabaseSingle.h"
 #include "CxxIndexerCommandProvider.h"
 #include "IndexerCommandCxx.h"
@@ -99,6 +100,15 @@ std::shared_ptr<IndexerCommandProvider> SourceGroupCxxCdb::getIndexerCommandProv
 		m_settings->getExcludeFiltersExpandedAndAbsolute());
 	const std::set<FilePath>& sourceFilePaths = getAllSourceFilePaths(cdb);
 
+	m_automaticPchPlanner.reset();
+	if (m_settings->getPchInputFilePath().empty() &&
+		ApplicationSettings::getInstance()->getAutomaticPchEnabled())
+	{
+		m_automaticPchPlanner = std::make_shared<CxxAutomaticPchPlanner>(
+			m_settings->getSourceGroupDependenciesDirectoryPath().concatenate(L"automatic_pch"));
+	}
+
+	std::vector<std::pair<FilePath, clang::tooling::CompileCommand>> commands;
 	for (const clang::tooling::CompileCommand& command: cdb->getAllCompileCommands())
 	{
 		FilePath sourcePath = FilePath(utility::decodeFromUtf8(command.Filename)).makeCanonical();
@@ -115,26 +125,57 @@ std::shared_ptr<IndexerCommandProvider> SourceGroupCxxCdb::getIndexerCommandProv
 		if (info.filesToIndex.find(sourcePath) != info.filesToIndex.end() &&
 			sourceFilePaths.find(sourcePath) != sourceFilePaths.end())
 		{
-			std::vector<std::wstring> cdbFlags = utility::convert<std::string, std::wstring>(
-				command.CommandLine, [](const std::string& s) { return utility::decodeFromUtf8(s); });
+			commands.emplace_back(sourcePath, command);
+		}
+	}
 
-			utility::removeIncludePchFlag(cdbFlags);
+	std::vector<std::vector<std::wstring>> commandFlags;
+	for (const std::pair<FilePath, clang::tooling::CompileCommand>& command: commands)
+	{
+		std::vector<std::wstring> cdbFlags = utility::convert<std::string, std::wstring>(
+			command.second.CommandLine,
+			[](const std::string& s) { return utility::decodeFromUtf8(s); });
 
-			if (command.CommandLine.size() != cdbFlags.size())
-			{
-				utility::append(cdbFlags, includePchFlags);
-			}
+		utility::removeIncludePchFlag(cdbFlags);
+
+		if (command.second.CommandLine.size() != cdbFlags.size())
+		{
+			utility::append(cdbFlags, includePchFlags);
+		}
 
-			provider->addCommand(std::make_shared<IndexerCommandCxx>(
-				sourcePath,
-				utility::concat(indexedHeaderPaths, {sourcePath}),
-				excludeFilters,
-				std::set<FilePathFilter>(),
-				FilePath(utility::decodeFromUtf8(command.Directory)),
-				utility::concat(cdbFlags, compilerFlags)));
+		commandFlags.push_back(utility::concat(cdbFlags, compilerFlags));
+
+		if (m_automaticPchPlanner)
+		{
+			m_automaticPchPlanner->addCommand(
+				command.first,
+				FilePath(utility::decodeFromUtf8(command.second.Directory)),
+				commandFlags.back());
 		}
 	}
 
+	if (m_automaticPchPlanner)
+	{
+		m_automaticPchPlanner->finishSetup();
+		m_automaticPchPlanner->removeUnusedFiles();
+	}
+
+	for (size_t i = 0; i < commands.size(); i++)
+	{
+		if (m_automaticPchPlanner)
+		{
+			utility::append(commandFlags[i], m_automaticPchPlanner->getIncludePchFlags(i));
+		}
+
+		provider->addCommand(std::make_shared<IndexerCommandCxx>(
+			commands[i].first,
+			utility::concat(indexedHeaderPaths, {commands[i].first}),
+			excludeFilters,
+			std::set<FilePathFilter>(),
+			FilePath(utility::decodeFromUtf8(commands[i].second.Directory)),
+			commandFlags[i]));
+	}
+
 	provider->logStats();
 
 	return provider;
@@ -151,7 +192,11 @@ std::shared_ptr<Task> SourceGroupCxxCdb::getPreIndexTask(
 {
 	if (m_settings->getPchInputFilePath().empty())
 	{
-		return std::make_shared<TaskLambda>([]() {});
+		return utility::createBuildAutomaticPchTask(
+			m_automaticPchPlanner,
+			utility::toSet(m_settings->getIndexedHeaderPathsExpandedAndAbsolute()),
+			utility::toSet(m_settings->getExcludeFiltersExpandedAndAbsolute()),
+			dialogView);
 	}
 
 	std::vector<std::wstring> compilerFlags;
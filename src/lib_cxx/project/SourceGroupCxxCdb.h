@@ -16,6 +16,7 @@ class JSONCompilationDatabase;
 }
 }	 // namespace clang
 
+class CxxAutomaticPchPlanner;
 class SourceGroupSettingsCxxCdb;
 
 class SourceGroupCxxCdb: public SourceGroup
@@ -41,6 +42,9 @@ private:
 	std::vector<std::wstring> getBaseCompilerFlags() const;
 
 	std::shared_ptr<SourceGroupSettingsCxxCdb> m_settings;
+
+	// planned while creating the indexer commands and built by the pre index task
+	mutable std::shared_ptr<CxxAutomaticPchPlanner> m_automaticPchPlanner;
 };
 
 #endif	  // SOURCE_GROUP_CXX_CDB_H
@@ -1,8 +1,12 @@
 #include "utilitySourceGroupCxx.h"
 
+#include <fstream>
+
 #include <clang/Tooling/JSONCompilationDatabase.h>
 
+#include "Blackboard.h"
 #include "CanonicalFilePathCache.h"
+#include "CxxAutomaticPchPlanner.h"
 #include "CxxCompilationDatabaseSingle.h"
 #include "CxxDiagnosticConsumer.h"
 #include "CxxParser.h"
@@ -11,14 +15,173 @@
 #include "FileRegister.h"
 #include "FileSystem.h"
 #include "GeneratePCHAction.h"
+#include "IntermediateStorage.h"
 #include "ParserClientImpl.h"
 #include "SingleFrontendActionFactory.h"
 #include "SourceGroupSettingsWithCxxPchOptions.h"
 #include "StorageProvider.h"
 #include "TaskLambda.h"
+#include "TextAccess.h"
+#include "TimeStamp.h"
 #include "logging.h"
 #include "utility.h"
 
+namespace
+{
+enum AutomaticPchState
+{
+	AUTOMATIC_PCH_REUSED,
+	AUTOMATIC_PCH_BUILT,
+	AUTOMATIC_PCH_SKIPPED,
+	AUTOMATIC_PCH_FAILED
+};
+
+void generatePch(
+	const FilePath& pchInputFilePath,
+	const FilePath& workingDirectoryPath,
+	const std::vector<std::wstring>& compilerFlags,
+	std::shared_ptr<ParserClientImpl> client,
+	std::shared_ptr<FileRegister> fileRegister)
+{
+	std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache =
+		std::make_shared<CanonicalFilePathCache>(fileRegister);
+
+	clang::tooling::CompileCommand pchCommand;
+	pchCommand.Filename = utility::encodeToUtf8(pchInputFilePath.fileName());
+	pchCommand.Directory = workingDirectoryPath.str();
+	// DON'T use "-fsyntax-only" here because it will cause the output file to be erased
+	pchCommand.CommandLine = utility::concat(
+		{"clang-tool"}, CxxParser::getCommandlineArgumentsEssential(compilerFlags));
+
+	CxxCompilationDatabaseSingle compilationDatabase(pchCommand);
+	clang::tooling::ClangTool tool(
+		compilationDatabase, {utility::encodeToUtf8(pchInputFilePath.wstr())});
+	GeneratePCHAction* action = new GeneratePCHAction(client, canonicalFilePathCache);
+
+	llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> options = new clang::DiagnosticOptions();
+	CxxDiagnosticConsumer diagnostics(
+		llvm::errs(), &*options, client, canonicalFilePathCache, pchInputFilePath, true);
+
+	tool.setDiagnosticConsumer(&diagnostics);
+	tool.clearArgumentsAdjusters();
+	tool.run(new SingleFrontendActionFactory(action));
+}
+
+// the dependency file lists all files of the precompiled header, it is written after the build
+bool isAutomaticPchUpToDate(const FilePath& dependencyFilePath, bool* accepted)
+{
+	if (!dependencyFilePath.exists())
+	{
+		return false;
+	}
+
+	const TimeStamp buildTime = FileSystem::getLastWriteTime(dependencyFilePath);
+	const std::vector<std::string> lines =
+		TextAccess::createFromFile(dependencyFilePath)->getAllLines();
+	if (lines.empty())
+	{
+		return false;
+	}
+
+	*accepted = utility::trim(lines.front()) == "accepted";
+	for (size_t i = 1; i < lines.size(); i++)
+	{
+		const FilePath filePath(utility::decodeFromUtf8(utility::trim(lines[i])));
+		if (!filePath.exists() || FileSystem::getLastWriteTime(filePath) > buildTime)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+AutomaticPchState buildAutomaticPch(
+	const CxxAutomaticPchPlanner& planner,
+	const CxxAutomaticPchPlanner::Pch& pch,
+	const std::set<FilePath>& indexedPaths,
+	const std::set<FilePathFilter>& excludeFilters)
+{
+	const FilePath headerFilePath = planner.getHeaderFilePath(pch);
+	const FilePath pchFilePath = planner.getPchFilePath(pch);
+	const FilePath dependencyFilePath = planner.getDependencyFilePath(pch);
+
+	bool accepted = false;
+	if (isAutomaticPchUpToDate(dependencyFilePath, &accepted) &&
+		(!accepted || pchFilePath.exists()))
+	{
+		return accepted ? AUTOMATIC_PCH_REUSED : AUTOMATIC_PCH_SKIPPED;
+	}
+
+	FileSystem::remove(pchFilePath);
+	FileSystem::remove(dependencyFilePath);
+
+	{
+		std::ofstream headerFile(headerFilePath.str());
+		for (const std::wstring& includeDirective: pch.includeDirectives)
+		{
+			headerFile << utility::encodeToUtf8(includeDirective) << "\n";
+		}
+	}
+
+	std::vector<std::wstring> compilerFlags = pch.compilerFlags;
+	compilerFlags.push_back(L"-x");
+	compilerFlags.push_back(pch.language);
+	compilerFlags.push_back(headerFilePath.wstr());
+	compilerFlags.push_back(L"-emit-pch");
+	compilerFlags.push_back(L"-o");
+	compilerFlags.push_back(pchFilePath.wstr());
+
+	std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
+	std::shared_ptr<ParserClientImpl> client = std::make_shared<ParserClientImpl>(storage.get());
+
+	// the generated header is no project file
+	const FilePath currentFilePath;
+	std::shared_ptr<FileRegister> fileRegister = std::make_shared<FileRegister>(
+		currentFilePath, indexedPaths, excludeFilters);
+
+	generatePch(headerFilePath, pch.workingDirectory, compilerFlags, client, fileRegister);
+
+	if (!pchFilePath.exists())
+	{
+		return AUTOMATIC_PCH_FAILED;
+	}
+
+	// preprocessor data of project headers is only recorded while indexing the source files, so
+	// these headers must not be precompiled
+	bool containsProjectFiles = false;
+	for (const StorageFile& file: storage->getStorageFiles())
+	{
+		containsProjectFiles = containsProjectFiles || file.indexed;
+	}
+
+	if (containsProjectFiles)
+	{
+		FileSystem::remove(pchFilePath);
+	}
+
+	std::ofstream dependencyFile(dependencyFilePath.str());
+	dependencyFile << (containsProjectFiles ? "skipped" : "accepted") << "\n";
+	for (const StorageFile& file: storage->getStorageFiles())
+	{
+		dependencyFile << utility::encodeToUtf8(file.filePath) << "\n";
+	}
+
+	return containsProjectFiles ? AUTOMATIC_PCH_SKIPPED : AUTOMATIC_PCH_BUILT;
+}
+
+void addToBlackboardValue(std::shared_ptr<Blackboard> blackboard, const std::string& key, int value)
+{
+	if (blackboard->exists(key))
+	{
+		blackboard->update<int>(key, [value](const int& count) { return count + value; });
+	}
+	else
+	{
+		blackboard->set(key, value);
+	}
+}
+}	 // namespace
+
 namespace utility
 {
 std::shared_ptr<Task> createBuildPchTask(
@@ -74,32 +237,82 @@ std::shared_ptr<Task> createBuildPchTask(
 			std::shared_ptr<FileRegister> fileRegister = std::make_shared<FileRegister>(
 				pchInputFilePath, std::set<FilePath> {pchInputFilePath}, std::set<FilePathFilter> {});
 
-			std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache =
-				std::make_shared<CanonicalFilePathCache>(fileRegister);
+			generatePch(
+				pchInputFilePath,
+				pchOutputFilePath.getParentDirectory(),
+				compilerFlags,
+				client,
+				fileRegister);
 
-			clang::tooling::CompileCommand pchCommand;
-			pchCommand.Filename = utility::encodeToUtf8(pchInputFilePath.fileName());
-			pchCommand.Directory = pchOutputFilePath.getParentDirectory().str();
-			// DON'T use "-fsyntax-only" here because it will cause the output file to be erased
-			pchCommand.CommandLine = utility::concat(
-				{"clang-tool"}, CxxParser::getCommandlineArgumentsEssential(compilerFlags));
+			storageProvider->insert(storage);
+		});
+}
 
-			CxxCompilationDatabaseSingle compilationDatabase(pchCommand);
-			clang::tooling::ClangTool tool(
-				compilationDatabase, {utility::encodeToUtf8(pchInputFilePath.wstr())});
-			GeneratePCHAction* action = new GeneratePCHAction(client, canonicalFilePathCache);
+std::shared_ptr<Task> createBuildAutomaticPchTask(
+	std::shared_ptr<const CxxAutomaticPchPlanner> planner,
+	const std::set<FilePath>& indexedPaths,
+	const std::set<FilePathFilter>& excludeFilters,
+	std::shared_ptr<DialogView> dialogView)
+{
+	if (!planner || planner->getPchs().empty())
+	{
+		return std::make_shared<TaskLambda>([]() {});
+	}
 
-			llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> options =
-				new clang::DiagnosticOptions();
-			CxxDiagnosticConsumer diagnostics(
-				llvm::errs(), &*options, client, canonicalFilePathCache, pchInputFilePath, true);
+	return std::make_shared<TaskLambda>([planner, indexedPaths, excludeFilters, dialogView](
+											std::shared_ptr<Blackboard> blackboard) {
+		dialogView->showUnknownProgressDialog(
+			L"Preparing Indexing", L"Processing Precompiled Headers");
 
-			tool.setDiagnosticConsumer(&diagnostics);
-			tool.clearArgumentsAdjusters();
-			tool.run(new SingleFrontendActionFactory(action));
+		CxxParser::initializeLLVM();
 
-			storageProvider->insert(storage);
-		});
+		if (!planner->getPchDirectoryPath().exists())
+		{
+			FileSystem::createDirectory(planner->getPchDirectoryPath());
+		}
+
+		int reusedCount = 0;
+		int builtCount = 0;
+		int skippedCount = 0;
+		int failedCount = 0;
+		int commandCount = 0;
+		for (const CxxAutomaticPchPlanner::Pch& pch: planner->getPchs())
+		{
+			switch (buildAutomaticPch(*planner, pch, indexedPaths, excludeFilters))
+			{
+			case AUTOMATIC_PCH_REUSED:
+				reusedCount++;
+				commandCount += static_cast<int>(pch.commandCount);
+				break;
+			case AUTOMATIC_PCH_BUILT:
+				builtCount++;
+				commandCount += static_cast<int>(pch.commandCount);
+				break;
+			case AUTOMATIC_PCH_SKIPPED:
+				skippedCount++;
+				break;
+			case AUTOMATIC_PCH_FAILED:
+				failedCount++;
+				break;
+			}
+		}
+
+		LOG_INFO(
+			"Automatic precompiled headers: " + std::to_string(reusedCount) + " reused, " +
+			std::to_string(builtCount) + " built, " + std::to_string(skippedCount) +
+			" skipped, " + std::to_string(failedCount) + " failed");
+
+		// the counts of all source groups are reported with the indexing summary
+		addToBlackboardValue(blackboard, "automatic_pch_reused_count", reusedCount);
+		addToBlackboardValue(blackboard, "automatic_pch_built_count", builtCount);
+		addToBlackboardValue(blackboard, "automatic_pch_skipped_count", skippedCount);
+		addToBlackboardValue(blackboard, "automatic_pch_failed_count", failedCount);
+		addToBlackboardValue(blackboard, "automatic_pch_command_count", commandCount);
+		addToBlackboardValue(
+			blackboard,
+			"automatic_pch_total_command_count",
+			static_cast<int>(planner->getCommandCount()));
+	});
 }
 
 std::shared_ptr<clang::tooling::JSONCompilationDatabase> loadCDB(
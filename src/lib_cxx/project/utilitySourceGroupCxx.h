@@ -2,6 +2,7 @@
 #define UTILITY_SOURCE_GROUP_CXX_H
 
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -13,8 +14,10 @@ class JSONCompilationDatabase;
 }
 }	 // namespace clang
 
+class CxxAutomaticPchPlanner;
 class DialogView;
 class FilePath;
+class FilePathFilter;
 class SourceGroupSettingsWithCxxPchOptions;
 class StorageProvider;
 class Task;
@@ -27,6 +30,12 @@ std::shared_ptr<Task> createBuildPchTask(
 	std::shared_ptr<StorageProvider> storageProvider,
 	std::shared_ptr<DialogView> dialogView);
 
+std::shared_ptr<Task> createBuildAutomaticPchTask(
+	std::shared_ptr<const CxxAutomaticPchPlanner> planner,
+	const std::set<FilePath>& indexedPaths,
+	const std::set<FilePathFilter>& excludeFilters,
+	std::shared_ptr<DialogView> dialogView);
+
 std::shared_ptr<clang::tooling::JSONCompilationDatabase> loadCDB(
 	const FilePath& cdbPath, std::string* error = nullptr);
 bool containsIncludePchFlags(std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb);
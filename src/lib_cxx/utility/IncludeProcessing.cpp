@@ -22,6 +22,45 @@ struct IncludeDirectiveComparator
 		return a.getIncludedFile() < b.getIncludedFile();
 	}
 };
+
+std::wstring removeComments(const std::wstring& line, bool* inBlockComment)
+{
+	std::wstring ret;
+	size_t pos = 0;
+	while (pos < line.size())
+	{
+		if (*inBlockComment)
+		{
+			const size_t blockCommentEnd = line.find(L"*/", pos);
+			if (blockCommentEnd == std::wstring::npos)
+			{
+				break;
+			}
+			*inBlockComment = false;
+			pos = blockCommentEnd + 2;
+		}
+		else
+		{
+			const size_t lineCommentStart = line.find(L"//", pos);
+			const size_t blockCommentStart = line.find(L"/*", pos);
+			if (blockCommentStart < lineCommentStart)
+			{
+				ret += line.substr(pos, blockCommentStart - pos) + L" ";
+				*inBlockComment = true;
+				pos = blockCommentStart + 2;
+			}
+			else
+			{
+				ret += line.substr(
+					pos,
+					lineCommentStart == std::wstring::npos ? lineCommentStart
+														   : lineCommentStart - pos);
+				break;
+			}
+		}
+	}
+	return ret;
+}
 }	 // namespace
 
 std::vector<IncludeDirective> IncludeProcessing::getUnresolvedIncludeDirectives(
@@ -194,6 +233,61 @@ std::vector<IncludeDirective> IncludeProcessing::getIncludeDirectives(
 	return includeDirectives;
 }
 
+std::vector<IncludeDirective> IncludeProcessing::getLeadingIncludeDirectives(
+	std::shared_ptr<TextAccess> textAccess)
+{
+	std::vector<IncludeDirective> includeDirectives;
+
+	TextCodec codec(ApplicationSettings::getInstance()->getTextEncoding());
+	const std::vector<std::string> lines = textAccess->getAllLines();
+	bool inBlockComment = false;
+	for (unsigned i = 0; i < lines.size(); i++)
+	{
+		const std::wstring line = utility::trim(
+			removeComments(codec.decode(lines[i]), &inBlockComment));
+		if (line.empty())
+		{
+			continue;
+		}
+
+		if (!utility::isPrefix<std::wstring>(L"#", line))
+		{
+			break;
+		}
+
+		const std::wstring directive = utility::trim(line.substr(1));
+		if (utility::isPrefix<std::wstring>(L"pragma", directive) &&
+			utility::trim(directive.substr(6)) == L"once")
+		{
+			continue;
+		}
+
+		if (!utility::isPrefix<std::wstring>(L"include", directive))
+		{
+			break;
+		}
+
+		std::wstring includeString = utility::substrBetween<std::wstring>(directive, L"<", L">");
+		bool usesBrackets = true;
+		if (includeString.empty())
+		{
+			includeString = utility::substrBetween<std::wstring>(directive, L"\"", L"\"");
+			usesBrackets = false;
+		}
+
+		if (includeString.empty())
+		{
+			break;
+		}
+
+		// lines are 1 based
+		includeDirectives.push_back(IncludeDirective(
+			FilePath(includeString), textAccess->getFilePath(), i + 1, usesBrackets));
+	}
+
+	return includeDirectives;
+}
+
 std::vector<IncludeDirective> IncludeProcessing::doGetUnresolvedIncludeDirectives(
 	std::set<FilePath> filePathsToProcess,
 	std::unordered_set<std::wstring>& processedFilePaths,
@@ -33,6 +33,10 @@ public:
 
 	static std::vector<IncludeDirective> getIncludeDirectives(std::shared_ptr<TextAccess> textAccess);
 
+	// include directives at the top of the file, only preceded by comments and other includes
+	static std::vector<IncludeDirective> getLeadingIncludeDirectives(
+		std::shared_ptr<TextAccess> textAccess);
+
 private:
 	static std::vector<IncludeDirective> doGetUnresolvedIncludeDirectives(
 		std::set<FilePath> filePathsToProcess,
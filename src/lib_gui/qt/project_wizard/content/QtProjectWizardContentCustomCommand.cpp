@@ -31,7 +31,7 @@ void QtProjectWizardContentCustomCommand::populate(QGridLayout* layout, int& row
 			"\"</li>"
 			"<li><b>%{DATABASE_VERSION}</b> - Database version used by this Sourcetrail version: "
 			"\"" +
-			QString::number(SqliteIndexStorage::getStorageVersion()) +
+			QString::number(SqliteIndexStorage::getCustomCommandStorageVersion()) +
 			"\"</li>"
 			"<li><b>%{PROJECT_FILE_PATH}</b> - Path to project file: \"" +
 			QString::fromStdWString(m_settings->getProjectSettings()->getProjectFilePath().wstr()) +
@@ -115,6 +115,17 @@ void QtProjectWizardContentPreferences::populate(QGridLayout* layout, int& row)
 		layout,
 		row);
 
+	// adjacency cache
+	m_graphAdjacencyCache = addCheckBox(
+		QStringLiteral("Trail Cache"),
+		QStringLiteral("Keep graph edges in memory for trails"),
+		QStringLiteral(
+			"<p>Load all nodes and edges into memory when the first trail is opened, so trails "
+			"are computed without querying the database at every depth. The cache is stored "
+			"beside the database. Disable to save memory on very large projects.</p>"),
+		layout,
+		row);
+
 	// directory in code
 	m_showDirectoryInCode = addCheckBox(
 		QStringLiteral("Directory in File Title"),
@@ -327,6 +338,19 @@ void QtProjectWizardContentPreferences::populate(QGridLayout* layout, int& row)
 		this,
 		&QtProjectWizardContentPreferences::indexerThreadsChanges);
 
+	// storage merge threads
+	m_mergeThreads = addComboBox(
+		QStringLiteral("Storage Merge Threads"),
+		0,
+		12,
+		QStringLiteral(
+			"<p>Set the number of threads used to merge the results of the indexer threads before "
+			"they are written to the index database.</p>"
+			"<p>By default one thread is used for every four indexer threads.</p>"),
+		layout,
+		row);
+	m_mergeThreads->setItemText(0, QStringLiteral("default"));
+
 	// multi process indexing
 	m_multiProcessIndexing = addCheckBox(
 		QStringLiteral("Multi Process<br />C/C++ Indexing"),
@@ -338,6 +362,42 @@ void QtProjectWizardContentPreferences::populate(QGridLayout* layout, int& row)
 		layout,
 		row);
 
+	// header claims
+	m_headerClaims = addCheckBox(
+		QStringLiteral("Index Headers Once"),
+		QStringLiteral("Index each C/C++ header in one translation unit only"),
+		QStringLiteral(
+			"<p>The first translation unit that reaches a project header records its symbols, "
+			"other translation units only record their references into it. This speeds up "
+			"indexing of header heavy code.</p>"
+			"<p>Disable if headers are compiled differently depending on the including file, "
+			"e.g. because of macros defined before the include.</p>"),
+		layout,
+		row);
+
+	// automatic precompiled headers
+	m_automaticPch = addCheckBox(
+		QStringLiteral("Automatic Precompiled Headers"),
+		QStringLiteral("Precompile system includes shared by translation units"),
+		QStringLiteral(
+			"<p>System headers that many translation units of a compilation database include "
+			"first with the same flags are parsed once into a precompiled header, that is kept "
+			"for later refreshes.</p>"
+			"<p>Source groups with a configured precompiled header are not affected.</p>"),
+		layout,
+		row);
+
+	// refresh in place
+	m_refreshInPlace = addCheckBox(
+		QStringLiteral("Refresh In Place"),
+		QStringLiteral("Write refreshes into the index database in one transaction"),
+		QStringLiteral(
+			"<p>Refreshing a project writes the changes into its index database without copying "
+			"it first. The old state can be browsed until the refresh is finished.</p>"
+			"<p>Projects with custom command source groups are always refreshed on a copy.</p>"),
+		layout,
+		row);
+
 	addGap(layout, row);
 
 
@@ -504,6 +564,7 @@ void QtProjectWizardContentPreferences::load()
 
 	m_useAnimations->setChecked(appSettings->getUseAnimations());
 	m_showBuiltinTypes->setChecked(appSettings->getShowBuiltinTypesInGraph());
+	m_graphAdjacencyCache->setChecked(appSettings->getGraphAdjacencyCacheEnabled());
 	m_showDirectoryInCode->setChecked(appSettings->getShowDirectoryInCodeFileTitle());
 
 	if (m_screenAutoScaling)
@@ -539,7 +600,12 @@ void QtProjectWizardContentPreferences::load()
 	m_threads->setCurrentIndex(
 		appSettings->getIndexerThreadCount());	  // index and value are the same
 	indexerThreadsChanges(m_threads->currentIndex());
+	m_mergeThreads->setCurrentIndex(
+		appSettings->getStorageMergeThreadCount());	  // index and value are the same
 	m_multiProcessIndexing->setChecked(appSettings->getMultiProcessIndexingEnabled());
+	m_headerClaims->setChecked(appSettings->getHeaderClaimsEnabled());
+	m_automaticPch->setChecked(appSettings->getAutomaticPchEnabled());
+	m_refreshInPlace->setChecked(appSettings->getRefreshInPlaceEnabled());
 
 	if (m_javaPath)
 	{
@@ -573,6 +639,7 @@ void QtProjectWizardContentPreferences::save()
 
 	appSettings->setUseAnimations(m_useAnimations->isChecked());
 	appSettings->setShowBuiltinTypesInGraph(m_showBuiltinTypes->isChecked());
+	appSettings->setGraphAdjacencyCacheEnabled(m_graphAdjacencyCache->isChecked());
 	appSettings->setShowDirectoryInCodeFileTitle(m_showDirectoryInCode->isChecked());
 
 	if (m_screenAutoScaling)
@@ -616,7 +683,12 @@ void QtProjectWizardContentPreferences::save()
 		appSettings->setPluginPort(pluginPort);
 
 	appSettings->setIndexerThreadCount(m_threads->currentIndex());	  // index and value are the same
+	appSettings->setStorageMergeThreadCount(
+		m_mergeThreads->currentIndex());	  // index and value are the same
 	appSettings->setMultiProcessIndexingEnabled(m_multiProcessIndexing->isChecked());
+	appSettings->setHeaderClaimsEnabled(m_headerClaims->isChecked());
+	appSettings->setAutomaticPchEnabled(m_automaticPch->isChecked());
+	appSettings->setRefreshInPlaceEnabled(m_refreshInPlace->isChecked());
 
 	if (m_javaPath)
 	{
@@ -110,6 +110,7 @@ private:
 
 	QCheckBox* m_useAnimations;
 	QCheckBox* m_showBuiltinTypes;
+	QCheckBox* m_graphAdjacencyCache;
 	QCheckBox* m_showDirectoryInCode;
 
 	QComboBox* m_screenAutoScaling;
@@ -132,8 +133,12 @@ private:
 
 	QComboBox* m_threads;
 	QLabel* m_threadsInfoLabel;
+	QComboBox* m_mergeThreads;
 
 	QCheckBox* m_multiProcessIndexing;
+	QCheckBox* m_headerClaims;
+	QCheckBox* m_automaticPch;
+	QCheckBox* m_refreshInPlace;
 
 	std::shared_ptr<CombinedPathDetector> m_javaPathDetector;
 	std::shared_ptr<CombinedPathDetector> m_jreSystemLibraryPathsDetector;
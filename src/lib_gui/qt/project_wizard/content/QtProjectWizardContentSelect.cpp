@@ -134,7 +134,7 @@ void QtProjectWizardContentSelect::populate(QGridLayout* layout, int& row)
 		"href=\"https://github.com/CoatiSoftware/SourcetrailDB\">SourcetrailDB</a> binaries that "
 		"add "
 		"custom language support to Sourcetrail.<br /><br />Current Database Version: " +
-		std::to_string(SqliteIndexStorage::getStorageVersion());
+		std::to_string(SqliteIndexStorage::getCustomCommandStorageVersion());
 
 	QVBoxLayout* vlayout = new QVBoxLayout();
 	vlayout->setContentsMargins(0, 10, 0, 0);
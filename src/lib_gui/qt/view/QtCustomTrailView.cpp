@@ -105,6 +105,7 @@ QtCustomTrailView::QtCustomTrailView(ViewLayout* viewLayout)
 			QOverload<QAbstractButton*>::of(&QButtonGroup::buttonClicked),
 			[this, searchBoxToContainer](QAbstractButton* button) {
 				searchBoxToContainer->setEnabled(button == m_optionTo);
+				m_shortestPath->setEnabled(button == m_optionTo);
 			});
 
 		connect(
@@ -157,6 +158,13 @@ QtCustomTrailView::QtCustomTrailView(ViewLayout* viewLayout)
 			}
 		});
 
+		hLayout->addSpacing(15);
+
+		m_shortestPath = new QCheckBox(QStringLiteral("Shortest only"));
+		m_shortestPath->setToolTip(
+			QStringLiteral("only show the shortest trails between start and target symbol"));
+		hLayout->addWidget(m_shortestPath);
+
 		hLayout->addStretch();
 	}
 
@@ -337,7 +345,8 @@ QtCustomTrailView::QtCustomTrailView(ViewLayout* viewLayout)
 				edgeTypes,
 				m_nodeNonIndexed->isChecked(),
 				m_slider->value() == m_slider->maximum() ? 0 : m_slider->value(),
-				m_horizontalButton->isChecked());
+				m_horizontalButton->isChecked(),
+				m_optionTo->isChecked() && m_shortestPath->isChecked());
 
 			m_controllerProxy.executeAsTaskWithArgs(&CustomTrailController::activateTrail, message);
 
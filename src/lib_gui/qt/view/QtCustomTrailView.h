@@ -70,6 +70,7 @@ private:
 	QRadioButton* m_optionTo;
 
 	QSlider* m_slider;
+	QCheckBox* m_shortestPath;
 
 	QRadioButton* m_horizontalButton;
 	QRadioButton* m_verticalButton;
@@ -84,7 +84,7 @@ std::vector<std::shared_ptr<IndexerCommand>> SourceGroupPythonEmpty::getIndexerC
 				args,
 				m_settings->getProjectSettings()->getProjectFilePath(),
 				m_settings->getProjectSettings()->getTempDBFilePath(),
-				std::to_wstring(SqliteIndexStorage::getStorageVersion()),
+				std::to_wstring(SqliteIndexStorage::getCustomCommandStorageVersion()),
 				sourceFilePath,
 				true));
 		}
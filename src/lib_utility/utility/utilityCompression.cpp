@@ -0,0 +1,20 @@
+#include "utilityCompression.h"
+
+#include <QByteArray>
+
+namespace utility
+{
+std::string compress(const std::string& data)
+{
+	const QByteArray compressed = qCompress(
+		reinterpret_cast<const uchar*>(data.data()), static_cast<int>(data.size()));
+	return std::string(compressed.constData(), static_cast<size_t>(compressed.size()));
+}
+
+std::string decompress(const std::string& data)
+{
+	const QByteArray decompressed = qUncompress(
+		reinterpret_cast<const uchar*>(data.data()), static_cast<int>(data.size()));
+	return std::string(decompressed.constData(), static_cast<size_t>(decompressed.size()));
+}
+}	 // namespace utility
@@ -0,0 +1,14 @@
+#ifndef UTILITY_COMPRESSION_H
+#define UTILITY_COMPRESSION_H
+
+#include <string>
+
+namespace utility
+{
+// compressed data starts with the size of the uncompressed data
+std::string compress(const std::string& data);
+// returns an empty string if the data is corrupt
+std::string decompress(const std::string& data);
+}	 // namespace utility
+
+#endif	  // UTILITY_COMPRESSION_H
@@ -0,0 +1,22 @@
+#include "utilityHash.h"
+
+#include "utilityString.h"
+
+namespace utility
+{
+uint64_t hashFnv1a(const std::string& data)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (const char c: data)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+uint64_t hashFnv1a(const std::wstring& data)
+{
+	return hashFnv1a(encodeToUtf8(data));
+}
+}	 // namespace utility
@@ -0,0 +1,15 @@
+#ifndef UTILITY_HASH_H
+#define UTILITY_HASH_H
+
+#include <cstdint>
+#include <string>
+
+namespace utility
+{
+// 64 bit fnv-1a, stable between runs and platforms, so the hashes can be stored
+uint64_t hashFnv1a(const std::string& data);
+// hashes the utf-8 encoding, because the size of wchar_t differs between platforms
+uint64_t hashFnv1a(const std::wstring& data);
+}	 // namespace utility
+
+#endif	  // UTILITY_HASH_H
@@ -0,0 +1,100 @@
+#include "catch.hpp"
+
+#include <algorithm>
+
+#include "AdjacencyCache.h"
+#include "FilePath.h"
+#include "FileSystem.h"
+
+namespace
+{
+std::vector<Id> getEdgeIds(const std::vector<StorageEdge>& edges)
+{
+	std::vector<Id> edgeIds;
+	for (const StorageEdge& edge: edges)
+	{
+		edgeIds.push_back(edge.id);
+	}
+	std::sort(edgeIds.begin(), edgeIds.end());
+	return edgeIds;
+}
+}	 // namespace
+
+TEST_CASE("AdjacencyCache is empty without nodes")
+{
+	AdjacencyCache cache;
+	cache.finishSetup();
+
+	REQUIRE(cache.isEmpty());
+	REQUIRE(cache.getEdgesBySourceIds({1}).size() == 0);
+	REQUIRE(cache.getEdgesByTargetIds({1}).size() == 0);
+	REQUIRE(cache.getNodeType(1) == AdjacencyCache::s_unknownNodeType);
+}
+
+TEST_CASE("AdjacencyCache returns outgoing and incoming edges")
+{
+	AdjacencyCache cache;
+	cache.addNode(1, 8);
+	cache.addNode(2, 8);
+	cache.addNode(3, 16);
+	cache.addEdge(10, 1, 1, 2);
+	cache.addEdge(11, 2, 1, 3);
+	cache.addEdge(12, 1, 2, 3);
+	cache.finishSetup();
+
+	REQUIRE(cache.getNodeCount() == 3);
+	REQUIRE(cache.getEdgeCount() == 3);
+
+	REQUIRE(getEdgeIds(cache.getEdgesBySourceIds({1})) == std::vector<Id>({10, 11}));
+	REQUIRE(getEdgeIds(cache.getEdgesBySourceIds({2, 3})) == std::vector<Id>({12}));
+	REQUIRE(getEdgeIds(cache.getEdgesByTargetIds({3})) == std::vector<Id>({11, 12}));
+	REQUIRE(getEdgeIds(cache.getEdgesByTargetIds({1})).empty());
+
+	const std::vector<StorageEdge> edges = cache.getEdgesByTargetIds({2});
+	REQUIRE(edges.size() == 1);
+	REQUIRE(edges[0].id == 10);
+	REQUIRE(edges[0].type == 1);
+	REQUIRE(edges[0].sourceNodeId == 1);
+	REQUIRE(edges[0].targetNodeId == 2);
+}
+
+TEST_CASE("AdjacencyCache keeps node types and edges with unknown nodes")
+{
+	AdjacencyCache cache;
+	cache.addEdge(10, 1, 1, 5);
+	cache.addNode(1, 8);
+	cache.addNode(1, 8);
+	cache.finishSetup();
+
+	REQUIRE(cache.getNodeCount() == 2);
+	REQUIRE(cache.getNodeType(1) == 8);
+	REQUIRE(cache.getNodeType(5) == AdjacencyCache::s_unknownNodeType);
+	REQUIRE(getEdgeIds(cache.getEdgesByTargetIds({5})) == std::vector<Id>({10}));
+}
+
+TEST_CASE("AdjacencyCache keeps edges after saving and loading")
+{
+	const FilePath cacheFilePath(L"data/AdjacencyCacheTestSuite/test.srctrladj");
+	FileSystem::createDirectory(cacheFilePath.getParentDirectory());
+
+	{
+		AdjacencyCache cache;
+		cache.addNode(1, 8);
+		cache.addNode(2, 16);
+		cache.addEdge(10, 1, 1, 2);
+		cache.addEdge(11, 4, 2, 1);
+		cache.finishSetup();
+		REQUIRE(cache.save(cacheFilePath, "key"));
+	}
+
+	AdjacencyCache cache;
+	std::string key;
+	REQUIRE(cache.load(cacheFilePath, &key));
+	REQUIRE(key == "key");
+
+	REQUIRE(cache.getNodeType(2) == 16);
+	REQUIRE(getEdgeIds(cache.getEdgesBySourceIds({1})) == std::vector<Id>({10}));
+	REQUIRE(getEdgeIds(cache.getEdgesByTargetIds({1})) == std::vector<Id>({11}));
+
+	FileSystem::remove(cacheFilePath);
+}
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+
+#include <fstream>
+
+#include "CxxAutomaticPchPlanner.h"
+#include "FilePath.h"
+#include "FileSystem.h"
+#include "utility.h"
+
+namespace
+{
+const FilePath s_dataDirectoryPath(L"data/CxxAutomaticPchPlannerTestSuite");
+
+FilePath writeSourceFile(const std::wstring& fileName, const std::string& content)
+{
+	FileSystem::createDirectory(s_dataDirectoryPath);
+	const FilePath filePath = s_dataDirectoryPath.getConcatenated(fileName).makeAbsolute();
+	std::ofstream file(filePath.str());
+	file << content;
+	return filePath;
+}
+
+std::vector<std::wstring> getCompilerFlags(const FilePath& sourceFilePath)
+{
+	return {L"clang++", L"-std=c++17", L"-c", sourceFilePath.wstr(), L"-o", L"out.o"};
+}
+}	 // namespace
+
+TEST_CASE("automatic pch planner shares leading system includes of similar commands")
+{
+	const FilePath a = writeSourceFile(L"a.cpp", "#include <vector>\n#include <map>\nint a;\n");
+	const FilePath b = writeSourceFile(L"b.cpp", "// b\n#include <vector>\n#include <map>\n");
+	const FilePath c = writeSourceFile(L"c.cpp", "#include <vector>\n#include <set>\n");
+
+	CxxAutomaticPchPlanner planner(s_dataDirectoryPath);
+	planner.addCommand(a, s_dataDirectoryPath, getCompilerFlags(a));
+	planner.addCommand(b, s_dataDirectoryPath, getCompilerFlags(b));
+	planner.addCommand(c, s_dataDirectoryPath, getCompilerFlags(c));
+	planner.finishSetup();
+
+	REQUIRE(planner.getPchs().size() == 1);
+	const CxxAutomaticPchPlanner::Pch& pch = planner.getPchs().front();
+	REQUIRE(pch.commandCount == 3);
+	REQUIRE(pch.language == L"c++-header");
+	REQUIRE(pch.includeDirectives == std::vector<std::wstring>({L"#include <vector>"}));
+	REQUIRE(pch.compilerFlags == std::vector<std::wstring>({L"-std=c++17"}));
+
+	const std::vector<std::wstring> includePchFlags = planner.getIncludePchFlags(1);
+	REQUIRE(includePchFlags.size() == 3);
+	REQUIRE(includePchFlags[1] == L"-include-pch");
+	REQUIRE(includePchFlags[2] == planner.getPchFilePath(pch).wstr());
+}
+
+TEST_CASE("automatic pch planner skips commands with different flags or forced includes")
+{
+	const FilePath a = writeSourceFile(L"a.cpp", "#include <vector>\n");
+	const FilePath b = writeSourceFile(L"b.cpp", "#include <vector>\n");
+	const FilePath c = writeSourceFile(L"c.cpp", "#include <vector>\n");
+	const FilePath d = writeSourceFile(L"d.cpp", "#include \"d.h\"\n#include <vector>\n");
+
+	std::vector<std::wstring> forcedIncludeFlags = getCompilerFlags(b);
+	forcedIncludeFlags.push_back(L"-include");
+	forcedIncludeFlags.push_back(L"config.h");
+
+	std::vector<std::wstring> definedFlags = getCompilerFlags(c);
+	definedFlags.push_back(L"-DTEST");
+
+	CxxAutomaticPchPlanner planner(s_dataDirectoryPath);
+	planner.addCommand(a, s_dataDirectoryPath, getCompilerFlags(a));
+	planner.addCommand(b, s_dataDirectoryPath, forcedIncludeFlags);
+	planner.addCommand(c, s_dataDirectoryPath, definedFlags);
+	planner.addCommand(d, s_dataDirectoryPath, getCompilerFlags(d));
+	planner.finishSetup();
+
+	REQUIRE(planner.getPchs().empty());
+	REQUIRE(planner.getCommandCount() == 4);
+	REQUIRE(planner.getIncludePchFlags(0).empty());
+}
+
+TEST_CASE("automatic pch planner removes flags of missing precompiled headers")
+{
+	std::vector<std::wstring> compilerFlags = {
+		L"-std=c++17",
+		L"-include-pch",
+		L"data/CxxAutomaticPchPlannerTestSuite/missing.autopch",
+		L"-include-pch",
+		L"manual.pch"};
+	CxxAutomaticPchPlanner::removeMissingPchFlags(compilerFlags);
+
+	REQUIRE(
+		compilerFlags ==
+		std::vector<std::wstring>({L"-std=c++17", L"-include-pch", L"manual.pch"}));
+}
+
+TEST_CASE("automatic pch planner removes files of precompiled headers that are no longer planned")
+{
+	const FilePath a = writeSourceFile(L"a.cpp", "#include <vector>\nint a;\n");
+	const FilePath b = writeSourceFile(L"b.cpp", "#include <vector>\nint b;\n");
+	const FilePath c = writeSourceFile(L"c.cpp", "#include <vector>\nint c;\n");
+
+	const FilePath pchDirectoryPath = s_dataDirectoryPath.getConcatenated(L"pch");
+	FileSystem::createDirectory(pchDirectoryPath);
+
+	CxxAutomaticPchPlanner planner(pchDirectoryPath);
+	planner.addCommand(a, s_dataDirectoryPath, getCompilerFlags(a));
+	planner.addCommand(b, s_dataDirectoryPath, getCompilerFlags(b));
+	planner.addCommand(c, s_dataDirectoryPath, getCompilerFlags(c));
+	planner.finishSetup();
+	REQUIRE(planner.getPchs().size() == 1);
+
+	const CxxAutomaticPchPlanner::Pch& pch = planner.getPchs().front();
+	CxxAutomaticPchPlanner::Pch stalePch = pch;
+	stalePch.name = L"stale";
+
+	const std::vector<FilePath> usedFilePaths = {
+		planner.getHeaderFilePath(pch),
+		planner.getPchFilePath(pch),
+		planner.getDependencyFilePath(pch)};
+	const std::vector<FilePath> staleFilePaths = {
+		planner.getHeaderFilePath(stalePch),
+		planner.getPchFilePath(stalePch),
+		planner.getDependencyFilePath(stalePch)};
+	for (const FilePath& filePath: utility::concat(usedFilePaths, staleFilePaths))
+	{
+		std::ofstream(filePath.str()) << "content\n";
+	}
+
+	planner.removeUnusedFiles();
+
+	for (const FilePath& filePath: usedFilePaths)
+	{
+		REQUIRE(filePath.exists());
+		FileSystem::remove(filePath);
+	}
+	for (const FilePath& filePath: staleFilePaths)
+	{
+		REQUIRE(!filePath.exists());
+	}
+}
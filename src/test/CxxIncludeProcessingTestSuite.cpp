@@ -67,6 +67,34 @@ TEST_CASE("include detection does not find include in file without include prepr
 			.empty());
 }
 
+TEST_CASE("leading include detection stops at first line that is no include")
+{
+	std::vector<IncludeDirective> includeDirectives =
+		IncludeProcessing::getLeadingIncludeDirectives(TextAccess::createFromString(
+			"// license\n"
+			"/* multi\n"
+			"   line */\n"
+			"#pragma once\n"
+			"#include <vector> // containers\n"
+			"\n"
+			"#  include \"foo.h\"\n"
+			"#define BAR\n"
+			"#include <map>\n",
+			FilePath(L"foo.cpp")));
+
+	REQUIRE(includeDirectives.size() == 2);
+	REQUIRE(L"#include <vector>" == includeDirectives[0].getDirective());
+	REQUIRE(includeDirectives[0].getLineNumber() == 5);
+	REQUIRE(L"#include \"foo.h\"" == includeDirectives[1].getDirective());
+}
+
+TEST_CASE("leading include detection does not find include after code")
+{
+	REQUIRE(IncludeProcessing::getLeadingIncludeDirectives(
+				TextAccess::createFromString("int a; /* x */\n#include <vector>"))
+				.empty());
+}
+
 TEST_CASE("header search path detection does not find path relative to including file")
 {
 	std::vector<FilePath> headerSearchDirectories = utility::toVector(
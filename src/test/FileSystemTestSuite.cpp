@@ -7,6 +7,7 @@
 
 #include "FileSystem.h"
 #include "utility.h"
+#include "utilityFile.h"
 
 namespace
 {
@@ -144,3 +145,24 @@ TEST_CASE("find symlinked directories")
 	REQUIRE(dirs.size() == 2);
 #endif
 }
+
+TEST_CASE("order file paths by index cost")
+{
+	const FilePath mainPath(L"./data/FileSystemTestSuite/main.cpp");
+	const FilePath headerPath(L"./data/FileSystemTestSuite/tictactoe.h");
+	const FilePath updatePath(L"./data/FileSystemTestSuite/update.c");
+	const FilePath testSourcePath(L"./data/FileSystemTestSuite/src/test.cpp");
+	const FilePath testHeaderPath(L"./data/FileSystemTestSuite/src/test.h");
+	const std::vector<FilePath> filePaths = {
+		updatePath, testHeaderPath, mainPath, testSourcePath, headerPath};
+
+	// without index times larger files go first, files of equal size keep their order
+	REQUIRE(
+		utility::orderFilePathsByIndexCost(filePaths, {}) ==
+		std::vector<FilePath>({headerPath, mainPath, testHeaderPath, testSourcePath, updatePath}));
+
+	// the index times of the timed files scale the sizes of the others
+	REQUIRE(
+		utility::orderFilePathsByIndexCost(filePaths, {{mainPath, 500}, {updatePath, 1000}}) ==
+		std::vector<FilePath>({headerPath, updatePath, mainPath, testHeaderPath, testSourcePath}));
+}
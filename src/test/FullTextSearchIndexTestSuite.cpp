@@ -0,0 +1,148 @@
+#include "catch.hpp"
+
+#include "FilePath.h"
+#include "FileSystem.h"
+#include "FullTextSearchIndex.h"
+
+namespace
+{
+std::vector<int> getPositions(const FullTextSearchIndex& index, const std::wstring& term, Id fileId)
+{
+	for (const FullTextSearchResult& result: index.searchForTerm(term))
+	{
+		if (result.fileId == fileId)
+		{
+			std::vector<int> positions;
+			for (const FullTextSearchMatch& match: result.matches)
+			{
+				positions.push_back(match.position);
+			}
+			return positions;
+		}
+	}
+	return {};
+}
+}	 // namespace
+
+TEST_CASE("fulltext search index finds all occurrences case insensitive")
+{
+	FullTextSearchIndex index;
+	index.addFile(StorageFile(1, L"a.cpp", L"", "1", true, true), L"int foo; Foo bar; foobar");
+	index.addFile(StorageFile(2, L"b.cpp", L"", "1", true, true), L"nothing here");
+	index.finishAdding();
+
+	REQUIRE(index.fileCount() == 2);
+	REQUIRE(index.searchForTerm(L"foo").size() == 1);
+	REQUIRE(getPositions(index, L"foo", 1) == std::vector<int>({4, 9, 18}));
+	REQUIRE(index.searchForTerm(L"missing").empty());
+}
+
+TEST_CASE("fulltext search index does not match across file boundaries")
+{
+	FullTextSearchIndex index;
+	index.addFile(StorageFile(1, L"a.cpp", L"", "1", true, true), L"int fo");
+	index.addFile(StorageFile(2, L"b.cpp", L"", "1", true, true), L"obar; foo");
+	index.addFile(StorageFile(3, L"c.cpp", L"", "1", true, true), L"foo foo");
+	index.finishAdding();
+
+	REQUIRE(index.segmentCount() == 1);
+	REQUIRE(index.searchForTerm(L"fo").size() == 3);
+	REQUIRE(getPositions(index, L"foo", 1).empty());
+	REQUIRE(getPositions(index, L"foo", 2) == std::vector<int>({6}));
+	REQUIRE(getPositions(index, L"foo", 3) == std::vector<int>({0, 4}));
+
+	// files with more matches are ranked first
+	REQUIRE(index.searchForTerm(L"foo")[0].fileId == 3);
+}
+
+TEST_CASE("fulltext search index resolves lines and columns of matches")
+{
+	FullTextSearchIndex index;
+	index.addFile(StorageFile(1, L"a.cpp", L"", "1", true, true), L"int a;\n\nfoo();\n");
+	index.addFile(StorageFile(2, L"b.cpp", L"", "1", true, true), L"// fo\no\n  foo");
+	index.finishAdding();
+
+	const std::vector<FullTextSearchResult> results = index.searchForTerm(L"fo");
+	REQUIRE(results.size() == 2);
+	REQUIRE(results[0].fileId == 2);
+	REQUIRE(results[0].filePath == L"b.cpp");
+	REQUIRE(results[0].matches.size() == 2);
+	REQUIRE(results[0].matches[1].startLineNumber == 3);
+	REQUIRE(results[0].matches[1].startColumnNumber == 3);
+
+	const FullTextSearchMatch match = index.searchForTerm(L"foo();")[0].matches[0];
+	REQUIRE(match.startLineNumber == 3);
+	REQUIRE(match.startColumnNumber == 1);
+	REQUIRE(match.endLineNumber == 3);
+	REQUIRE(match.endColumnNumber == 6);
+
+	// matches spanning lines end on the line of their last character
+	const FullTextSearchMatch multiLineMatch = index.searchForTerm(L"fo\no")[0].matches[0];
+	REQUIRE(multiLineMatch.startLineNumber == 1);
+	REQUIRE(multiLineMatch.startColumnNumber == 4);
+	REQUIRE(multiLineMatch.endLineNumber == 2);
+	REQUIRE(multiLineMatch.endColumnNumber == 1);
+}
+
+TEST_CASE("fulltext search index merges segments")
+{
+	FullTextSearchIndex index;
+	for (Id id = 1; id <= 6; id++)
+	{
+		index.addFile(
+			StorageFile(id, std::to_wstring(id) + L".cpp", L"", "1", true, true),
+			L"füü " + std::to_wstring(id));
+		index.finishAdding();
+	}
+
+	REQUIRE(index.fileCount() == 6);
+	REQUIRE(index.segmentCount() <= 4);
+	REQUIRE(index.searchForTerm(L"Füü").size() == 6);
+	for (Id id = 1; id <= 6; id++)
+	{
+		REQUIRE(getPositions(index, std::to_wstring(id), id) == std::vector<int>({4}));
+	}
+}
+
+TEST_CASE("fulltext search index reuses stored files with unchanged modification time")
+{
+	const FilePath indexFilePath(L"data/FullTextSearchIndexTestSuite/test.srctrlft");
+	FileSystem::createDirectory(indexFilePath.getParentDirectory());
+
+	const StorageFile fileA(1, L"a.cpp", L"", "1", true, true);
+	const StorageFile fileB(2, L"b.cpp", L"", "1", true, true);
+	{
+		FullTextSearchIndex index;
+		index.addFile(fileA, L"int foo; Foo bar;");
+		index.addFile(fileB, L"void bar();");
+		REQUIRE(index.save(indexFilePath, "UTF-8"));
+		REQUIRE(getPositions(index, L"bar", 2) == std::vector<int>({5}));
+	}
+
+	{
+		// ids change after refreshing, so files are matched by their paths
+		FullTextSearchIndex index;
+		const std::vector<StorageFile> missingFiles = index.load(
+			indexFilePath,
+			"UTF-8",
+			{StorageFile(3, fileA.filePath, L"", "1", true, true),
+			 StorageFile(4, fileB.filePath, L"", "2", true, true)});
+
+		REQUIRE(missingFiles.size() == 1);
+		REQUIRE(missingFiles[0].id == 4);
+		REQUIRE(index.fileCount() == 1);
+		REQUIRE(getPositions(index, L"foo", 3) == std::vector<int>({4, 9}));
+
+		index.addFile(missingFiles[0], L"void bar(); bar();");
+		REQUIRE(index.save(indexFilePath, "UTF-8"));
+		REQUIRE(getPositions(index, L"bar", 4) == std::vector<int>({5, 12}));
+	}
+
+	{
+		FullTextSearchIndex index;
+		REQUIRE(index.load(indexFilePath, "UTF-8", {fileA}).empty());
+		REQUIRE(index.load(indexFilePath, "UTF-16", {fileA}).size() == 1);
+	}
+
+	FileSystem::remove(indexFilePath);
+}
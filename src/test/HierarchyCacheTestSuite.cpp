@@ -1,5 +1,7 @@
 #include "catch.hpp"
 
+#include "FilePath.h"
+#include "FileSystem.h"
 #include "HierarchyCache.h"
 #include "utility.h"
 
@@ -39,6 +41,8 @@ public:
 std::vector<std::string> getSerializedInheritanceEdges(
 	HierarchyCache& cache, Id nodeId, std::set<Id> nodeIds)
 {
+	cache.finishSetup();
+
 	std::vector<std::string> inheritanceEdges;
 	for (const std::tuple<Id, Id, std::vector<size_t>>& edge:
 		 cache.getInheritanceEdgesForNodeId(nodeId, nodeIds))
@@ -110,3 +114,86 @@ TEST_CASE("HierarchyCache returns inheritance edges for diamond inheritance")
 	REQUIRE(utility::containsElement(inheritanceEdges, TestEdge(1, 3, {2}).toString()));
 	REQUIRE(utility::containsElement(inheritanceEdges, TestEdge(1, 4, {1, 2, 3, 4}).toString()));
 }
+
+TEST_CASE("HierarchyCache finds last visible parent of member")
+{
+	HierarchyCache cache;
+	cache.createConnection(10, 1, 2, false, false, false);
+	cache.createConnection(11, 2, 3, true, false, false);
+	cache.createConnection(12, 3, 4, true, false, false);
+	cache.finishSetup();
+
+	REQUIRE(cache.getLastVisibleParentNodeId(4) == 2);
+	REQUIRE(cache.getLastVisibleParentNodeId(3) == 2);
+	REQUIRE(cache.getLastVisibleParentNodeId(5) == 5);
+	REQUIRE(cache.isChildOfVisibleNodeOrInvisible(3));
+	REQUIRE(!cache.isChildOfVisibleNodeOrInvisible(2));
+	REQUIRE(cache.isChildOfVisibleNodeOrInvisible(1));
+
+	std::set<Id> nodeIds;
+	std::set<Id> edgeIds;
+	cache.addAllVisibleParentIdsForNodeId(4, &nodeIds, &edgeIds);
+	REQUIRE(nodeIds == std::set<Id>({2, 3, 4}));
+	REQUIRE(edgeIds == std::set<Id>({11, 12}));
+}
+
+TEST_CASE("HierarchyCache skips implicit children of explicit members")
+{
+	HierarchyCache cache;
+	cache.createConnection(10, 1, 2, true, false, false);
+	cache.createConnection(11, 1, 3, true, false, true);
+	cache.createConnection(12, 1, 4, true, false, false);
+	cache.createConnection(13, 3, 5, true, true, false);
+	cache.finishSetup();
+
+	std::vector<Id> nodeIds;
+	std::vector<Id> edgeIds;
+	cache.addFirstChildIdsForNodeId(1, &nodeIds, &edgeIds);
+	REQUIRE(nodeIds == std::vector<Id>({2, 4}));
+	REQUIRE(edgeIds == std::vector<Id>({10, 12}));
+	REQUIRE(cache.getFirstChildIdsCountForNodeId(1) == 2);
+	REQUIRE(cache.getFirstChildIdsCountForNodeId(3) == 1);
+	REQUIRE(cache.nodeIsImplicit(3));
+	REQUIRE(!cache.nodeHasChildren(2));
+
+	std::set<Id> allNodeIds;
+	std::set<Id> allEdgeIds;
+	cache.addAllChildIdsForNodeId(1, &allNodeIds, &allEdgeIds);
+	REQUIRE(allNodeIds == std::set<Id>({2, 3, 4, 5}));
+	REQUIRE(allEdgeIds == std::set<Id>({10, 11, 12, 13}));
+}
+
+TEST_CASE("HierarchyCache keeps members and inheritance after saving and loading")
+{
+	const FilePath cacheFilePath(L"data/HierarchyCacheTestSuite/test.srctrlhc");
+	FileSystem::createDirectory(cacheFilePath.getParentDirectory());
+
+	{
+		HierarchyCache cache;
+		cache.createConnection(10, 1, 2, true, false, false);
+		cache.createConnection(11, 1, 3, true, false, true);
+		cache.createInheritance(20, 1, 4);
+		cache.createInheritance(21, 4, 5);
+		cache.finishSetup();
+		REQUIRE(cache.save(cacheFilePath, "key"));
+	}
+
+	HierarchyCache cache;
+	std::string key;
+	REQUIRE(cache.load(cacheFilePath, &key));
+	REQUIRE(key == "key");
+
+	std::vector<Id> nodeIds;
+	std::vector<Id> edgeIds;
+	cache.addFirstChildIdsForNodeId(1, &nodeIds, &edgeIds);
+	REQUIRE(nodeIds == std::vector<Id>({2}));
+	REQUIRE(edgeIds == std::vector<Id>({10}));
+	REQUIRE(cache.getLastVisibleParentNodeId(3) == 1);
+
+	std::vector<std::tuple<Id, Id, std::vector<Id>>> inheritanceEdges =
+		cache.getInheritanceEdgesForNodeId(1, {5});
+	REQUIRE(inheritanceEdges.size() == 1);
+	REQUIRE(TestEdge(inheritanceEdges[0]).toString() == TestEdge(1, 5, {20, 21}).toString());
+
+	FileSystem::remove(cacheFilePath);
+}
@@ -0,0 +1,216 @@
+#include "catch.hpp"
+
+#include <iostream>
+#include <map>
+#include <set>
+
+#include "IntermediateStorage.h"
+#include "TimeStamp.h"
+
+namespace
+{
+// records data into the ordered containers IntermediateStorage used before hashed containers were
+// available, so both can be compared on the same input
+class OrderedRecorder
+{
+public:
+	Id addNode(const StorageNodeData& nodeData)
+	{
+		auto it = m_nodes.find(nodeData.serializedName);
+		if (it != m_nodes.end())
+		{
+			return it->second;
+		}
+		m_nodes.emplace(nodeData.serializedName, m_nextId);
+		return m_nextId++;
+	}
+
+	Id addEdge(const StorageEdgeData& edgeData)
+	{
+		auto it = m_edges.find(edgeData);
+		if (it != m_edges.end())
+		{
+			return it->second;
+		}
+		m_edges.emplace(edgeData, m_nextId);
+		return m_nextId++;
+	}
+
+	Id addSourceLocation(const StorageSourceLocationData& sourceLocationData)
+	{
+		auto it = m_sourceLocations.find(StorageSourceLocation(0, sourceLocationData));
+		if (it != m_sourceLocations.end())
+		{
+			return it->id;
+		}
+		m_sourceLocations.emplace(m_nextId, sourceLocationData);
+		return m_nextId++;
+	}
+
+	void addOccurrence(const StorageOccurrence& occurrence)
+	{
+		m_occurrences.emplace(occurrence);
+	}
+
+private:
+	std::map<std::wstring, Id> m_nodes;
+	std::map<StorageEdgeData, Id> m_edges;
+	std::set<StorageSourceLocation> m_sourceLocations;
+	std::set<StorageOccurrence> m_occurrences;
+	Id m_nextId = 1;
+};
+
+// simulates the records of a translation unit where every symbol is referenced several times and
+// each header is seen twice, like it happens when the same header gets included again
+template <typename RecorderType>
+void recordTranslationUnit(RecorderType& recorder, size_t symbolCount, size_t referenceCount)
+{
+	const Id fileId = recorder.addNode(StorageNodeData(0, L"file"));
+
+	for (size_t pass = 0; pass < 2; pass++)
+	{
+		Id previousId = fileId;
+		for (size_t i = 0; i < symbolCount; i++)
+		{
+			const Id symbolId = recorder.addNode(
+				StorageNodeData(1, L"namespace::Class" + std::to_wstring(i / 16) + L"::member" + std::to_wstring(i)));
+			const Id edgeId = recorder.addEdge(StorageEdgeData(1, previousId, symbolId));
+
+			for (size_t j = 0; j < referenceCount; j++)
+			{
+				const size_t line = i * referenceCount + j + 1;
+				const Id locationId = recorder.addSourceLocation(
+					StorageSourceLocationData(fileId, line, 5, line, 20, 0));
+				recorder.addOccurrence(StorageOccurrence(symbolId, locationId));
+				recorder.addOccurrence(StorageOccurrence(edgeId, locationId));
+			}
+			previousId = symbolId;
+		}
+	}
+}
+
+class IntermediateStorageRecorder
+{
+public:
+	Id addNode(const StorageNodeData& nodeData)
+	{
+		return m_storage.addNode(nodeData).first;
+	}
+
+	Id addEdge(const StorageEdgeData& edgeData)
+	{
+		return m_storage.addEdge(edgeData);
+	}
+
+	Id addSourceLocation(const StorageSourceLocationData& sourceLocationData)
+	{
+		return m_storage.addSourceLocation(sourceLocationData);
+	}
+
+	void addOccurrence(const StorageOccurrence& occurrence)
+	{
+		m_storage.addOccurrence(occurrence);
+	}
+
+	IntermediateStorage m_storage;
+};
+}	 // namespace
+
+TEST_CASE("intermediate storage does not add equal nodes twice")
+{
+	IntermediateStorage storage;
+
+	const std::pair<Id, bool> first = storage.addNode(StorageNodeData(1, L"foo"));
+	const std::pair<Id, bool> second = storage.addNode(StorageNodeData(4, L"foo"));
+
+	REQUIRE(first.second);
+	REQUIRE(!second.second);
+	REQUIRE(first.first == second.first);
+	REQUIRE(storage.getStorageNodes().size() == 1);
+	REQUIRE(storage.getStorageNodes()[0].type == 4);
+}
+
+TEST_CASE("intermediate storage does not add equal edges and locations twice")
+{
+	IntermediateStorage storage;
+
+	const Id edgeId = storage.addEdge(StorageEdgeData(1, 2, 3));
+	REQUIRE(storage.addEdge(StorageEdgeData(1, 2, 3)) == edgeId);
+	REQUIRE(storage.addEdge(StorageEdgeData(1, 3, 2)) != edgeId);
+
+	const Id locationId = storage.addSourceLocation(StorageSourceLocationData(1, 2, 3, 4, 5, 0));
+	REQUIRE(storage.addSourceLocation(StorageSourceLocationData(1, 2, 3, 4, 5, 0)) == locationId);
+	REQUIRE(storage.addSourceLocation(StorageSourceLocationData(1, 2, 3, 4, 5, 1)) != locationId);
+
+	storage.addOccurrence(StorageOccurrence(edgeId, locationId));
+	storage.addOccurrence(StorageOccurrence(edgeId, locationId));
+
+	REQUIRE(storage.getStorageEdges().size() == 2);
+	REQUIRE(storage.getStorageSourceLocations().size() == 2);
+	REQUIRE(storage.getStorageOccurrences().size() == 1);
+}
+
+TEST_CASE("intermediate storage returns ordered source locations")
+{
+	IntermediateStorage storage;
+	storage.addSourceLocation(StorageSourceLocationData(2, 1, 1, 1, 1, 0));
+	storage.addSourceLocation(StorageSourceLocationData(1, 5, 1, 5, 1, 0));
+	storage.addSourceLocation(StorageSourceLocationData(1, 2, 1, 2, 1, 0));
+
+	const std::set<StorageSourceLocation>& locations = storage.getStorageSourceLocations();
+	REQUIRE(locations.size() == 3);
+	REQUIRE(locations.begin()->fileNodeId == 1);
+	REQUIRE(locations.begin()->startLine == 2);
+	REQUIRE(locations.rbegin()->fileNodeId == 2);
+
+	storage.addSourceLocation(StorageSourceLocationData(1, 1, 1, 1, 1, 0));
+	REQUIRE(storage.getStorageSourceLocations().size() == 4);
+	REQUIRE(storage.getStorageSourceLocations().begin()->startLine == 1);
+}
+
+TEST_CASE("intermediate storage keeps file flags when adding file again")
+{
+	IntermediateStorage storage;
+	storage.addFile(StorageFile(1, L"file.h", L"", "", false, false));
+	storage.addFile(StorageFile(1, L"file.h", L"cpp", "", true, false));
+	storage.setFileLanguage(1, L"c");
+
+	REQUIRE(storage.getStorageFiles().size() == 1);
+	REQUIRE(storage.getStorageFiles()[0].indexed);
+	REQUIRE(!storage.getStorageFiles()[0].complete);
+	REQUIRE(storage.getStorageFiles()[0].languageIdentifier == L"c");
+
+	storage.setAllFilesIncomplete();
+	storage.clear();
+	REQUIRE(storage.getStorageFiles().empty());
+}
+
+// run explicitly with "[benchmark]" to compare recording costs of both container layouts
+TEST_CASE("intermediate storage recording benchmark", "[.][benchmark]")
+{
+	const size_t symbolCount = 100000;
+	const size_t referenceCount = 8;
+
+	TimeStamp orderedStart = TimeStamp::now();
+	{
+		OrderedRecorder recorder;
+		recordTranslationUnit(recorder, symbolCount, referenceCount);
+	}
+	const size_t orderedMS = TimeStamp::now().deltaMS(orderedStart);
+
+	TimeStamp storageStart = TimeStamp::now();
+	size_t sourceLocationCount = 0;
+	{
+		IntermediateStorageRecorder recorder;
+		recordTranslationUnit(recorder, symbolCount, referenceCount);
+		sourceLocationCount = recorder.m_storage.getSourceLocationCount();
+	}
+	const size_t storageMS = TimeStamp::now().deltaMS(storageStart);
+
+	std::cout << "recorded " << sourceLocationCount << " source locations: ordered containers "
+			  << orderedMS << " ms, intermediate storage ("
+			  << (BUILD_HASHED_INTERMEDIATE_STORAGE ? "hashed" : "default") << ") " << storageMS
+			  << " ms" << std::endl;
+
+	REQUIRE(sourceLocationCount == symbolCount * referenceCount);
+}
@@ -0,0 +1,85 @@
+#include "catch.hpp"
+
+#include "InterprocessFileClaimManager.h"
+
+TEST_CASE("InterprocessFileClaimManager gives each file to the first claiming process")
+{
+	InterprocessFileClaimManager owner("claim_test", 0, true);
+	InterprocessFileClaimManager first("claim_test", 1, false);
+	InterprocessFileClaimManager second("claim_test", 2, false);
+
+	REQUIRE(first.claimFile(FilePath(L"/a.h")));
+	// claimed again by another include within the same translation unit
+	REQUIRE(first.claimFile(FilePath(L"/a.h")));
+	REQUIRE(!second.claimFile(FilePath(L"/a.h")));
+	REQUIRE(second.claimFile(FilePath(L"/b.h")));
+	REQUIRE(!first.claimFile(FilePath(L"/b.h")));
+
+	REQUIRE(owner.getClaimedFileCount() == 2);
+}
+
+TEST_CASE("InterprocessFileClaimManager keeps finished claims and drops released ones")
+{
+	InterprocessFileClaimManager owner("claim_test", 0, true);
+	InterprocessFileClaimManager first("claim_test", 1, false);
+	InterprocessFileClaimManager second("claim_test", 2, false);
+
+	REQUIRE(first.claimFile(FilePath(L"/a.h")));
+	first.finishClaims();
+	REQUIRE(!first.claimFile(FilePath(L"/a.h")));
+
+	REQUIRE(first.claimFile(FilePath(L"/b.h")));
+	first.releaseClaims();
+
+	REQUIRE(owner.getClaimedFileCount() == 1);
+	REQUIRE(!second.claimFile(FilePath(L"/a.h")));
+	REQUIRE(second.claimFile(FilePath(L"/b.h")));
+}
+
+TEST_CASE("InterprocessFileClaimManager reports translation units that skipped released files")
+{
+	InterprocessFileClaimManager owner("claim_test", 0, true);
+	InterprocessFileClaimManager first("claim_test", 1, false);
+	InterprocessFileClaimManager second("claim_test", 2, false);
+	InterprocessFileClaimManager third("claim_test", 3, false);
+
+	first.startClaims(FilePath(L"/1.cpp"));
+	REQUIRE(first.claimFile(FilePath(L"/a.h")));
+	REQUIRE(first.claimFile(FilePath(L"/b.h")));
+
+	second.startClaims(FilePath(L"/2.cpp"));
+	REQUIRE(!second.claimFile(FilePath(L"/a.h")));
+	REQUIRE(!second.claimFile(FilePath(L"/b.h")));
+	second.finishClaims();
+
+	// the first translation unit crashed, the next one includes only one of its headers
+	first.releaseClaims();
+	third.startClaims(FilePath(L"/3.cpp"));
+	REQUIRE(third.claimFile(FilePath(L"/a.h")));
+	third.finishClaims();
+
+	REQUIRE(
+		std::vector<FilePath>({FilePath(L"/2.cpp")}) ==
+		owner.getSourceFilePathsMissingSkippedFiles());
+
+	third.startClaims(FilePath(L"/4.cpp"));
+	REQUIRE(third.claimFile(FilePath(L"/b.h")));
+	third.finishClaims();
+
+	REQUIRE(owner.getSourceFilePathsMissingSkippedFiles().empty());
+}
+
+TEST_CASE("InterprocessFileClaimManager grows memory for many claims")
+{
+	InterprocessFileClaimManager owner("claim_test", 0, true);
+	InterprocessFileClaimManager first("claim_test", 1, false);
+
+	for (int i = 0; i < 20000; i++)
+	{
+		const std::wstring path = L"/some/project/include/header_" + std::to_wstring(i) + L".h";
+		REQUIRE(first.claimFile(FilePath(path)));
+	}
+	first.finishClaims();
+
+	REQUIRE(owner.getClaimedFileCount() == 20000);
+}
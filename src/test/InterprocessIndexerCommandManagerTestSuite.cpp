@@ -0,0 +1,163 @@
+#include "catch.hpp"
+
+#include "language_packages.h"
+
+#if BUILD_CXX_LANGUAGE_PACKAGE
+
+#	include "IndexerCommandCxx.h"
+#	include "InterprocessIndexerCommandManager.h"
+
+namespace
+{
+// shaped like the commands of a compilation database, which name the source file in the indexed
+// paths, in the output file and as the last flag
+std::shared_ptr<IndexerCommand> createCommand(
+	const std::wstring& sourceFilePath, const std::wstring& compilerFlag)
+{
+	const FilePath filePath(sourceFilePath);
+	return std::make_shared<IndexerCommandCxx>(
+		filePath,
+		std::set<FilePath>({FilePath(L"/src/include"), filePath}),
+		std::set<FilePathFilter>(),
+		std::set<FilePathFilter>(),
+		FilePath(L"/build"),
+		std::vector<std::wstring>(
+			{L"-std=c++17",
+			 compilerFlag,
+			 L"-o",
+			 L"CMakeFiles/app.dir/" + filePath.fileName() + L".o",
+			 L"-c",
+			 sourceFilePath}));
+}
+
+std::vector<std::wstring> getSourceFilePaths(
+	const std::vector<std::shared_ptr<IndexerCommand>>& commands)
+{
+	std::vector<std::wstring> paths;
+	for (const std::shared_ptr<IndexerCommand>& command: commands)
+	{
+		paths.push_back(command->getSourceFilePath().wstr());
+	}
+	return paths;
+}
+}	 // namespace
+
+TEST_CASE("InterprocessIndexerCommandManager spreads commands over the lanes")
+{
+	InterprocessIndexerCommandManager owner("command_test", 0, true, 2);
+	owner.pushIndexerCommands(
+		{createCommand(L"/src/a.cpp", L"-DA"),
+		 createCommand(L"/src/b.cpp", L"-DB"),
+		 createCommand(L"/src/c.cpp", L"-DA"),
+		 createCommand(L"/src/d.cpp", L"-DB")});
+	REQUIRE(owner.indexerCommandCount() == 4);
+
+	InterprocessIndexerCommandManager first("command_test", 1, false);
+	InterprocessIndexerCommandManager second("command_test", 2, false);
+
+	const std::vector<std::shared_ptr<IndexerCommand>> firstCommands = first.popIndexerCommands(4);
+	REQUIRE(getSourceFilePaths(firstCommands) == std::vector<std::wstring>({L"/src/a.cpp"}));
+	REQUIRE(owner.indexerCommandCount() == 3);
+
+	const std::shared_ptr<IndexerCommandCxx> command = std::dynamic_pointer_cast<IndexerCommandCxx>(
+		firstCommands[0]);
+	REQUIRE(command);
+	REQUIRE(command->getWorkingDirectory().wstr() == L"/build");
+	REQUIRE(
+		command->getIndexedPaths() ==
+		std::set<FilePath>({FilePath(L"/src/include"), FilePath(L"/src/a.cpp")}));
+	REQUIRE(
+		command->getCompilerFlags() ==
+		std::vector<std::wstring>(
+			{L"-std=c++17", L"-DA", L"-o", L"CMakeFiles/app.dir/a.cpp.o", L"-c", L"/src/a.cpp"}));
+
+	REQUIRE(
+		getSourceFilePaths(second.popIndexerCommands(4)) ==
+		std::vector<std::wstring>({L"/src/b.cpp"}));
+	REQUIRE(
+		getSourceFilePaths(second.popIndexerCommands(4)) ==
+		std::vector<std::wstring>({L"/src/d.cpp"}));
+
+	// the second indexer steals from the first lane after its own lane ran empty
+	second.finishIndexerCommand();
+	second.finishIndexerCommand();
+	const std::vector<std::shared_ptr<IndexerCommand>> stolenCommands = second.popIndexerCommands(4);
+	REQUIRE(getSourceFilePaths(stolenCommands) == std::vector<std::wstring>({L"/src/c.cpp"}));
+	REQUIRE(
+		std::dynamic_pointer_cast<IndexerCommandCxx>(stolenCommands[0])->getCompilerFlags() ==
+		std::vector<std::wstring>(
+			{L"-std=c++17", L"-DA", L"-o", L"CMakeFiles/app.dir/c.cpp.o", L"-c", L"/src/c.cpp"}));
+
+	REQUIRE(owner.indexerCommandCount() == 0);
+	REQUIRE(first.popIndexerCommands(4).empty());
+}
+
+TEST_CASE("shared indexer commands share the settings of commands that differ in their source file")
+{
+	const std::shared_ptr<IndexerCommand> a = SharedIndexerCommand::createSettings(
+		createCommand(L"/src/a.cpp", L"-DA").get());
+	const std::shared_ptr<IndexerCommand> b = SharedIndexerCommand::createSettings(
+		createCommand(L"/src/lib/b.cpp", L"-DA").get());
+	const std::shared_ptr<IndexerCommand> c = SharedIndexerCommand::createSettings(
+		createCommand(L"/src/c.cpp", L"-DC").get());
+
+	REQUIRE(
+		SharedIndexerCommand::getSettingsKey(a.get()) ==
+		SharedIndexerCommand::getSettingsKey(b.get()));
+	REQUIRE(
+		SharedIndexerCommand::getSettingsKey(a.get()) !=
+		SharedIndexerCommand::getSettingsKey(c.get()));
+
+	// flags that contain the file name for other reasons are restored as well
+	const std::shared_ptr<IndexerCommand> d = std::make_shared<IndexerCommandCxx>(
+		FilePath(L"/src/d"),
+		std::set<FilePath>({FilePath(L"/src/d")}),
+		std::set<FilePathFilter>(),
+		std::set<FilePathFilter>(),
+		FilePath(L"/build"),
+		std::vector<std::wstring>({L"-DNAME=d", L"-I/src/d_include", L"/src/d"}));
+	const std::shared_ptr<IndexerCommand> settings = SharedIndexerCommand::createSettings(d.get());
+	const std::shared_ptr<IndexerCommandCxx> restored =
+		std::dynamic_pointer_cast<IndexerCommandCxx>(SharedIndexerCommand::createForSourceFilePath(
+			settings.get(), FilePath(L"/src/d")));
+	REQUIRE(restored);
+	REQUIRE(restored->getIndexedPaths() == std::set<FilePath>({FilePath(L"/src/d")}));
+	REQUIRE(
+		restored->getCompilerFlags() ==
+		std::vector<std::wstring>({L"-DNAME=d", L"-I/src/d_include", L"/src/d"}));
+}
+
+TEST_CASE("InterprocessIndexerCommandManager gives back commands of crashed indexers")
+{
+	InterprocessIndexerCommandManager owner("command_test", 0, true, 1);
+
+	std::vector<std::shared_ptr<IndexerCommand>> commands;
+	for (int i = 0; i < 6; i++)
+	{
+		commands.push_back(createCommand(L"/src/" + std::to_wstring(i) + L".cpp", L"-DA"));
+	}
+	owner.pushIndexerCommands(commands);
+
+	{
+		InterprocessIndexerCommandManager indexer("command_test", 1, false);
+		REQUIRE(
+			getSourceFilePaths(indexer.popIndexerCommands(4)) ==
+			std::vector<std::wstring>({L"/src/0.cpp", L"/src/1.cpp", L"/src/2.cpp"}));
+		indexer.finishIndexerCommand();
+		REQUIRE(owner.indexerCommandCount() == 3);
+	}
+
+	InterprocessIndexerCommandManager indexer("command_test", 1, false);
+	indexer.releaseTakenIndexerCommands(FilePath(L"/src/1.cpp"));
+	REQUIRE(owner.indexerCommandCount() == 4);
+
+	REQUIRE(
+		getSourceFilePaths(indexer.popIndexerCommands(4)) ==
+		std::vector<std::wstring>({L"/src/2.cpp", L"/src/3.cpp"}));
+
+	owner.clearIndexerCommands();
+	REQUIRE(owner.indexerCommandCount() == 0);
+	REQUIRE(indexer.popIndexerCommands(4).empty());
+}
+
+#endif	  // BUILD_CXX_LANGUAGE_PACKAGE
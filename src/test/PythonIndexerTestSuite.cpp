@@ -74,7 +74,7 @@ std::shared_ptr<TestStorage> parseCode(std::string code)
 			args,
 			rootPath,
 			tempDbPath,
-			std::to_wstring(SqliteIndexStorage::getStorageVersion()),
+			std::to_wstring(SqliteIndexStorage::getCustomCommandStorageVersion()),
 			sourceFilePath,
 			true);
 
@@ -94,6 +94,7 @@ std::shared_ptr<TestStorage> parseCode(std::string code)
 	{
 		std::shared_ptr<PersistentStorage> persistentStorage = std::make_shared<PersistentStorage>(
 			tempDbPath, FilePath());
+		persistentStorage->migrateCustomCommandStorage();
 		persistentStorage->setup();
 		persistentStorage->buildCaches();
 		TaskExecuteCustomCommands::runPythonPostProcessing(*(persistentStorage.get()));
@@ -1,8 +1,15 @@
 #include "catch.hpp"
 
+#include <cmath>
+#include <iostream>
+
+#include "FilePath.h"
+#include "FileSystem.h"
 #include "NameHierarchy.h"
 #include "SearchIndex.h"
+#include "TimeStamp.h"
 #include "utility.h"
+#include "utilityString.h"
 
 TEST_CASE("search index finds id of element added")
 {
@@ -91,3 +98,157 @@ TEST_CASE("search index rates higher on consecutive letters")
 	REQUIRE(L"ocbcabc" == results[0].text);
 	REQUIRE(L"oaabbcc" == results[1].text);
 }
+
+TEST_CASE("search index finds names that share prefixes")
+{
+	SearchIndex index;
+	index.addNode(1, L"foobar");
+	index.addNode(2, L"foo");
+	index.addNode(3, L"foobaz");
+	index.addNode(4, L"fo");
+	index.finishSetup();
+	std::vector<SearchResult> results = index.search(L"fob", NodeTypeSet::all(), 0);
+
+	REQUIRE(2 == results.size());
+	REQUIRE(L"foobar" == results[0].text);
+	REQUIRE(L"foobaz" == results[1].text);
+	REQUIRE(utility::containsElement<Id>(results[0].elementIds, 1));
+	REQUIRE(utility::containsElement<Id>(results[1].elementIds, 3));
+	REQUIRE(3 == results[0].indices.size());
+	REQUIRE(0 == results[0].indices[0]);
+	REQUIRE(1 == results[0].indices[1]);
+	REQUIRE(3 == results[0].indices[2]);
+}
+
+TEST_CASE("search index only finds elements of accepted types")
+{
+	SearchIndex index;
+	index.addNode(1, L"foo", NodeType(NODE_CLASS));
+	index.addNode(2, L"foo", NodeType(NODE_FUNCTION));
+	index.addNode(3, L"foobar", NodeType(NODE_CLASS));
+	index.finishSetup();
+	std::vector<SearchResult> results = index.search(
+		L"foo", NodeTypeSet(NodeType(NODE_FUNCTION)), 0);
+
+	REQUIRE(1 == results.size());
+	REQUIRE(1 == results[0].elementIds.size());
+	REQUIRE(utility::containsElement<Id>(results[0].elementIds, 2));
+}
+
+TEST_CASE("search index finds nodes added after setup was finished")
+{
+	SearchIndex index;
+	index.addNode(1, L"foobar");
+	index.finishSetup();
+	index.addNode(2, L"foobaz");
+	index.addNode(3, L"fox");
+	index.finishSetup();
+	std::vector<SearchResult> results = index.search(L"fo", NodeTypeSet::all(), 0);
+
+	REQUIRE(3 == results.size());
+}
+
+TEST_CASE("search index does not find removed nodes")
+{
+	SearchIndex index;
+	index.addNode(1, L"foobar");
+	index.addNode(2, L"foobaz");
+	index.addNode(3, L"foo");
+	index.finishSetup();
+	index.removeNodes({2, 3});
+	index.finishSetup();
+	std::vector<SearchResult> results = index.search(L"fo", NodeTypeSet::all(), 0);
+
+	REQUIRE(1 == results.size());
+	REQUIRE(L"foobar" == results[0].text);
+	REQUIRE(utility::containsElement<Id>(results[0].elementIds, 1));
+}
+
+TEST_CASE("search index finds nodes after saving and loading")
+{
+	const FilePath indexFilePath(L"data/SearchIndexTestSuite/test.srctrlsym");
+	FileSystem::createDirectory(indexFilePath.getParentDirectory());
+
+	{
+		SearchIndex index;
+		index.addNode(1, L"foobar", NodeType(NODE_CLASS), 7);
+		index.addNode(2, L"foobaz", NodeType(NODE_FUNCTION), uint64_t(8) << 32);
+		REQUIRE(index.save(indexFilePath, "key"));
+	}
+
+	{
+		SearchIndex index;
+		std::string key;
+		REQUIRE(index.load(indexFilePath, &key));
+		REQUIRE("key" == key);
+
+		std::vector<SearchResult> results = index.search(
+			L"fob", NodeTypeSet(NodeType(NODE_FUNCTION)), 0);
+		REQUIRE(1 == results.size());
+		REQUIRE(L"foobaz" == results[0].text);
+
+		std::vector<uint64_t> tags;
+		index.forEachElement([&tags](Id, NodeType, uint64_t tag) { tags.push_back(tag); });
+		REQUIRE(std::vector<uint64_t>({7, uint64_t(8) << 32}) == tags);
+
+		// changes to a loaded index are saved into the mapped file
+		index.removeNodes({1});
+		index.addNode(3, L"fox");
+		REQUIRE(index.save(indexFilePath, "other"));
+		REQUIRE(2 == index.search(L"fo", NodeTypeSet::all(), 0).size());
+	}
+
+	{
+		SearchIndex index;
+		std::string key;
+		REQUIRE(index.load(indexFilePath, &key));
+		REQUIRE("other" == key);
+		REQUIRE(2 == index.search(L"fo", NodeTypeSet::all(), 0).size());
+	}
+
+	FileSystem::remove(indexFilePath);
+}
+
+// run explicitly with "[benchmark]" to measure the latency of each keystroke while typing
+TEST_CASE("search index keystroke benchmark", "[.][benchmark]")
+{
+	const size_t symbolCount = 5000000;
+	const std::vector<std::wstring> words = {
+		L"Storage", L"Node", L"Edge", L"Graph", L"View", L"Controller", L"Search", L"Index",
+		L"Token", L"Parser", L"File", L"Path", L"Message", L"Handler", L"Type", L"Name"};
+
+	TimeStamp buildStart = TimeStamp::now();
+	SearchIndex index;
+	for (size_t i = 0; i < symbolCount; i++)
+	{
+		// namespace::Class::method names with many shared prefixes, similar to indexed code
+		const size_t a = i % 97;
+		const size_t b = (i / 97) % 1009;
+		std::wstring name = L"ns" + std::to_wstring(a) + L"::" + words[b % words.size()] +
+			words[(b / words.size()) % words.size()] + std::to_wstring(b) + L"::" +
+			L"get" + words[i % words.size()] + words[(i / 7) % words.size()] +
+			std::to_wstring(i);
+		index.addNode(i + 1, std::move(name));
+	}
+	index.finishSetup();
+	const size_t buildMS = TimeStamp::now().deltaMS(buildStart);
+
+	std::cout << "built search index of " << symbolCount << " symbols in " << buildMS << " ms, "
+			  << index.getNodeCount() << " nodes, " << index.getMemoryUsage() / (1024 * 1024)
+			  << " MB" << std::endl;
+
+	const std::wstring query = L"storagegetpathfile";
+	for (size_t i = 1; i <= query.size(); i++)
+	{
+		// same limits as used for autocompletion by the storage
+		const size_t maxResultCount = static_cast<size_t>(std::pow(3, i + 3));
+
+		TimeStamp searchStart = TimeStamp::now();
+		const std::vector<SearchResult> results = index.search(
+			query.substr(0, i), NodeTypeSet::all(), maxResultCount, 100);
+		std::cout << "\"" << utility::encodeToUtf8(query.substr(0, i)) << "\": " << results.size()
+				  << " results in " << TimeStamp::now().deltaMS(searchStart) << " ms" << std::endl;
+
+		REQUIRE(!results.empty());
+	}
+}
@@ -0,0 +1,125 @@
+#include "catch.hpp"
+
+#include "NameHierarchy.h"
+#include "SerializedNameTree.h"
+
+namespace
+{
+std::wstring serialize(const std::vector<std::wstring>& names, const std::wstring& postfix = L"")
+{
+	NameHierarchy nameHierarchy(names, L"::");
+	if (!postfix.empty())
+	{
+		const std::wstring name = nameHierarchy.back().getName();
+		nameHierarchy.pop();
+		nameHierarchy.push(NameElement(name, L"void", postfix));
+	}
+	return NameHierarchy::serialize(nameHierarchy);
+}
+}	 // namespace
+
+TEST_CASE("SerializedNameTree rebuilds added names")
+{
+	SerializedNameTree tree;
+
+	const std::vector<std::wstring> serializedNames = {
+		serialize({L"a"}),
+		serialize({L"a", L"b"}),
+		serialize({L"a", L"b", L"f"}, L"(int)"),
+		serialize({L"a", L"b", L"f"}, L"(float) const"),
+		serialize({}),
+		NameHierarchy::serialize(NameHierarchy(L"/usr/include/vector", L"/"))};
+
+	std::vector<uint32_t> nameIds;
+	for (const std::wstring& serializedName: serializedNames)
+	{
+		nameIds.push_back(tree.addSerializedName(serializedName));
+	}
+
+	for (size_t i = 0; i < serializedNames.size(); i++)
+	{
+		REQUIRE(nameIds[i] != 0);
+		REQUIRE(tree.getSerializedName(nameIds[i]) == serializedNames[i]);
+		REQUIRE(tree.findSerializedName(serializedNames[i]) == nameIds[i]);
+		REQUIRE(tree.addSerializedName(serializedNames[i]) == nameIds[i]);
+	}
+
+	// two roots, a, b, both overloads of f and the file
+	REQUIRE(tree.getNameCount() == 7);
+}
+
+TEST_CASE("SerializedNameTree shares parts of names")
+{
+	SerializedNameTree tree;
+
+	const uint32_t fId = tree.addSerializedName(serialize({L"a", L"f"}));
+	tree.takeAddedPartIds();
+	tree.takeAddedNameIds();
+
+	const uint32_t gId = tree.addSerializedName(serialize({L"b", L"a", L"f"}));
+
+	REQUIRE(tree.getName(gId).elementId == tree.getName(fId).elementId);
+	REQUIRE(tree.getName(gId).signatureId == tree.getName(fId).signatureId);
+	REQUIRE(tree.takeAddedPartIds().size() == 1);
+	REQUIRE(tree.takeAddedNameIds().size() == 3);
+}
+
+TEST_CASE("SerializedNameTree ignores strings that are not serialized names")
+{
+	SerializedNameTree tree;
+
+	REQUIRE(tree.addSerializedName(L"") == 0);
+	REQUIRE(tree.addSerializedName(L"a") == 0);
+	REQUIRE(tree.addSerializedName(L"::\tma") == 0);
+	REQUIRE(tree.addSerializedName(serialize({L"a"}) + L"\tn") == 0);
+	REQUIRE(tree.getNameCount() == 0);
+
+	REQUIRE(tree.findSerializedName(serialize({L"a"})) == 0);
+	REQUIRE(tree.getSerializedName(1).empty());
+}
+
+TEST_CASE("SerializedNameTree rebuilds loaded names")
+{
+	const std::wstring serializedName = serialize({L"a", L"b"}, L"()");
+
+	SerializedNameTree tree;
+	const uint32_t nameId = tree.addSerializedName(serializedName);
+
+	SerializedNameTree loadedTree;
+	for (uint32_t partId: tree.takeAddedPartIds())
+	{
+		loadedTree.loadPart(partId, tree.getPart(partId));
+	}
+	for (uint32_t id: tree.takeAddedNameIds())
+	{
+		loadedTree.loadName(id, tree.getName(id));
+	}
+
+	REQUIRE(loadedTree.getSerializedName(nameId) == serializedName);
+	REQUIRE(loadedTree.findSerializedName(serializedName) == nameId);
+	REQUIRE(loadedTree.addSerializedName(serialize({L"a", L"c"})) == nameId + 1);
+}
+
+TEST_CASE("SerializedNameTree builds the same name hierarchies as deserializing")
+{
+	SerializedNameTree tree;
+
+	const std::vector<std::wstring> serializedNames = {
+		serialize({L"a", L"b", L"f"}, L"(int)"),
+		serialize({L".:main:.1"}, L"()"),
+		serialize({}),
+		NameHierarchy::serialize(NameHierarchy(L"/usr/include/vector", L"/"))};
+
+	for (const std::wstring& serializedName: serializedNames)
+	{
+		const NameHierarchy nameHierarchy = tree.getNameHierarchy(
+			tree.addSerializedName(serializedName));
+		REQUIRE(
+			NameHierarchy::serialize(nameHierarchy) ==
+			NameHierarchy::serialize(NameHierarchy::deserialize(serializedName)));
+	}
+
+	REQUIRE(
+		tree.getNameHierarchy(0).getDelimiter() ==
+		nameDelimiterTypeToString(NAME_DELIMITER_UNKNOWN));
+}
@@ -1,5 +1,7 @@
 #include "catch.hpp"
 
+#include "ApplicationSettings.h"
+#include "FileSystem.h"
 #include "ProjectSettings.h"
 #include "Settings.h"
 #include "SourceGroupSettings.h"
@@ -201,3 +203,21 @@ TEST_CASE("load source path from file")
 	REQUIRE(paths[0].wstr() == L"src");
 	REQUIRE(paths[1].wstr() == L"test");
 }
+
+TEST_CASE("application settings store the storage merge thread count")
+{
+	const FilePath filePath(L"data/SettingsTestSuite/temp_application_settings.xml");
+
+	ApplicationSettings settings;
+	REQUIRE(settings.getStorageMergeThreadCount() == 0);
+
+	settings.setStorageMergeThreadCount(3);
+	REQUIRE(settings.getStorageMergeThreadCount() == 3);
+	REQUIRE(settings.save(filePath));
+
+	ApplicationSettings loadedSettings;
+	REQUIRE(loadedSettings.load(filePath));
+	FileSystem::remove(filePath);
+
+	REQUIRE(loadedSettings.getStorageMergeThreadCount() == 3);
+}
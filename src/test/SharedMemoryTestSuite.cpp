@@ -96,3 +96,29 @@ TEST_CASE("shared memory")
 		}
 	}
 }
+
+TEST_CASE("shared memory access waits for notified change")
+{
+	SharedMemory memory("memory", 1000, SharedMemory::CREATE_AND_DELETE);
+
+	std::thread thread([]() {
+		SharedMemory memory("memory", 0, SharedMemory::OPEN_ONLY);
+
+		SharedMemory::ScopedAccess access(&memory);
+		access.growMemory(4000);
+		*access.accessValue<int>("count") = 1;
+		access.notifyChange();
+	});
+
+	{
+		SharedMemory::ScopedAccess access(&memory);
+		while (*access.accessValue<int>("count") == 0)
+		{
+			access.waitForChange(10000);
+		}
+
+		REQUIRE(access.getMemorySize() == 5000);
+	}
+
+	thread.join();
+}
@@ -0,0 +1,85 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include "SourceLocationIntervalIndex.h"
+
+namespace
+{
+std::vector<Id> getLocationIds(
+	const std::vector<const SourceLocationIntervalIndex::Location*>& locations)
+{
+	std::vector<Id> ids;
+	for (const SourceLocationIntervalIndex::Location* location: locations)
+	{
+		ids.push_back(location->location.id);
+	}
+	return ids;
+}
+}	 // namespace
+
+TEST_CASE("SourceLocationIntervalIndex finds locations overlapping lines")
+{
+	SourceLocationIntervalIndex index;
+	const auto addLocation = [&index](Id id, size_t startLine, size_t endLine) {
+		index.addSourceLocation(
+			StorageSourceLocation(id, StorageSourceLocationData(7, startLine, 1, endLine, 2, 0)));
+	};
+
+	addLocation(1, 1, 100);
+	addLocation(2, 10, 10);
+	addLocation(3, 20, 30);
+	addLocation(4, 5, 12);
+	index.addOccurrence(StorageOccurrence(11, 2));
+	index.addOccurrence(StorageOccurrence(12, 2));
+	index.addOccurrence(StorageOccurrence(13, 99));
+	index.finishSetup();
+
+	REQUIRE(index.getLocationCount() == 4);
+	REQUIRE(getLocationIds(index.getLocationsInLines(10, 10)) == std::vector<Id>({1, 4, 2}));
+	REQUIRE(getLocationIds(index.getLocationsInLines(13, 19)) == std::vector<Id>({1}));
+	REQUIRE(getLocationIds(index.getLocationsInLines(25, 200)) == std::vector<Id>({1, 3}));
+	REQUIRE(getLocationIds(index.getLocationsInLines(101, 200)).empty());
+	REQUIRE(getLocationIds(index.getLocationsInLines(10, 9)).empty());
+
+	const std::vector<const SourceLocationIntervalIndex::Location*> locations =
+		index.getLocationsInLines(10, 10);
+	REQUIRE(locations[2]->elementIds == std::vector<Id>({11, 12}));
+	REQUIRE(locations[0]->elementIds.empty());
+}
+
+TEST_CASE("SourceLocationIntervalIndex finds the same locations as a linear scan")
+{
+	std::mt19937 random(42);
+	std::vector<StorageSourceLocation> locations;
+
+	SourceLocationIntervalIndex index;
+	for (Id id = 1; id <= 2000; id++)
+	{
+		const size_t startLine = random() % 1000 + 1;
+		const size_t endLine = startLine + (random() % 8 == 0 ? random() % 300 : random() % 3);
+		locations.emplace_back(id, StorageSourceLocationData(1, startLine, 1, endLine, 1, 0));
+		index.addSourceLocation(locations.back());
+	}
+	index.finishSetup();
+
+	for (size_t i = 0; i < 200; i++)
+	{
+		const size_t startLine = random() % 1400;
+		const size_t endLine = startLine + random() % 20;
+
+		std::vector<Id> expectedIds;
+		for (const StorageSourceLocation& location: locations)
+		{
+			if (location.startLine <= endLine && location.endLine >= startLine)
+			{
+				expectedIds.push_back(location.id);
+			}
+		}
+
+		std::vector<Id> ids = getLocationIds(index.getLocationsInLines(startLine, endLine));
+		std::sort(ids.begin(), ids.end());
+		REQUIRE(ids == expectedIds);
+	}
+}
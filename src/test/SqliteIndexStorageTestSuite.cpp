@@ -1,7 +1,70 @@
 #include "catch.hpp"
 
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "CppSQLite3.h"
 #include "FileSystem.h"
+#include "NameHierarchy.h"
 #include "SqliteIndexStorage.h"
+#include "TextAccess.h"
+#include "TimeStamp.h"
+
+namespace
+{
+std::wstring writeSourceFile(const std::wstring& fileName, const std::string& content)
+{
+	const FilePath filePath =
+		FilePath(L"data/SQLiteTestSuite/").getConcatenated(fileName).makeAbsolute();
+	std::ofstream file(filePath.str(), std::ios::binary);
+	file << content;
+	return filePath.wstr();
+}
+
+std::string createSourceText(size_t lineCount, size_t seed)
+{
+	std::string text;
+	for (size_t i = 0; i < lineCount; i++)
+	{
+		text += "\tint value" + std::to_string(i) + " = compute(" + std::to_string(seed) + ", " +
+			std::to_string(i % 97) + "); // line " + std::to_string(i + 1) + "\n";
+	}
+	return text;
+}
+
+std::wstring createSerializedName(const std::vector<std::wstring>& names)
+{
+	return NameHierarchy::serialize(NameHierarchy(names, L"::"));
+}
+
+std::string dumpTables(const FilePath& databasePath)
+{
+	CppSQLite3DB database;
+	database.open(databasePath.str().c_str());
+
+	std::string dump;
+	for (const char* table:
+		 {"element", "node", "edge", "file", "source_location", "occurrence", "error"})
+	{
+		dump += std::string(table) + ":\n";
+		CppSQLite3Query q = database.execQuery(
+			("SELECT * FROM " + std::string(table) + " ORDER BY 1;").c_str());
+		while (!q.eof())
+		{
+			for (int i = 0; i < q.numFields(); i++)
+			{
+				dump += std::string(q.fieldIsNull(i) ? "null" : q.fieldValue(i)) + " ";
+			}
+			dump += "\n";
+			q.nextRow();
+		}
+	}
+
+	database.close();
+	return dump;
+}
+}	 // namespace
 
 TEST_CASE("storage adds node successfully")
 {
@@ -76,3 +139,631 @@ TEST_CASE("storage removes edge successfully")
 
 	REQUIRE(0 == edgeCount);
 }
+
+TEST_CASE("storage bulk loads elements into empty database")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	int nodeCount = -1;
+	int edgeCount = -1;
+	int sourceLocationCount = -1;
+	Id edgeSourceId = 0;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_BULK_LOAD);
+		storage.beginTransaction();
+		Id sourceNodeId = storage.addNode(StorageNodeData(0, L"a"));
+		Id targetNodeId = storage.addNode(StorageNodeData(0, L"b"));
+		REQUIRE(storage.addNode(StorageNodeData(0, L"a")) == sourceNodeId);
+		Id edgeId = storage.addEdge(StorageEdgeData(0, sourceNodeId, targetNodeId));
+		REQUIRE(storage.addEdge(StorageEdgeData(0, sourceNodeId, targetNodeId)) == edgeId);
+		Id locationId = storage.addSourceLocation(
+			StorageSourceLocationData(sourceNodeId, 1, 1, 1, 2, 0));
+		storage.addOccurrence(StorageOccurrence(edgeId, locationId));
+		storage.commitTransaction();
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+
+		nodeCount = storage.getNodeCount();
+		edgeCount = storage.getEdgeCount();
+		sourceLocationCount = storage.getSourceLocationCount();
+		edgeSourceId = storage.getEdgeById(edgeId).sourceNodeId;
+		REQUIRE(storage.getOccurrencesForLocationId(locationId).size() == 1);
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(2 == nodeCount);
+	REQUIRE(1 == edgeCount);
+	REQUIRE(1 == sourceLocationCount);
+	REQUIRE(0 != edgeSourceId);
+}
+
+TEST_CASE("storage assigns the same ids when bulk loading")
+{
+	const auto load = [](SqliteIndexStorage::StorageModeType mode, const FilePath& databasePath) {
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.setMode(mode);
+		storage.beginTransaction();
+		const Id fileId = storage.addNode(StorageNodeData(0, L"file.cpp"));
+		storage.addFile(StorageFile(fileId, L"file.cpp", L"cpp", "", true, true));
+		const Id aId = storage.addNode(StorageNodeData(0, createSerializedName({L"a"})));
+		const std::vector<Id> locationIds = storage.addSourceLocations(
+			{StorageSourceLocation(0, fileId, 1, 1, 1, 2, 0),
+			 StorageSourceLocation(0, fileId, 2, 1, 2, 2, 0)});
+		storage.addOccurrence(StorageOccurrence(aId, locationIds[0]));
+
+		// elements added after source locations
+		const Id bId = storage.addNode(StorageNodeData(0, createSerializedName({L"a", L"b"})));
+		const Id edgeId = storage.addEdge(StorageEdgeData(0, aId, bId));
+		storage.addOccurrence(StorageOccurrence(edgeId, locationIds[1]));
+		const Id errorId = storage.addError(StorageErrorData(L"error", L"file.cpp", true, true)).id;
+		const Id errorLocationId = storage.addSourceLocation(
+			StorageSourceLocationData(fileId, 3, 1, 3, 2, 0));
+		storage.addOccurrence(StorageOccurrence(errorId, errorLocationId));
+		storage.commitTransaction();
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+	};
+
+	FilePath writePath(L"data/SQLiteTestSuite/test.sqlite");
+	FilePath bulkLoadPath(L"data/SQLiteTestSuite/test_bulk.sqlite");
+	load(SqliteIndexStorage::STORAGE_MODE_WRITE, writePath);
+	load(SqliteIndexStorage::STORAGE_MODE_BULK_LOAD, bulkLoadPath);
+	const std::string writeDump = dumpTables(writePath);
+	const std::string bulkLoadDump = dumpTables(bulkLoadPath);
+	FileSystem::remove(writePath);
+	FileSystem::remove(bulkLoadPath);
+
+	REQUIRE(writeDump == bulkLoadDump);
+}
+
+TEST_CASE("storage keeps write indices when bulk loading into database with elements")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	bool fileAddedTwice = true;
+	int filePathIndexCount = -1;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.addNode(StorageNodeData(0, L"a"));
+
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_BULK_LOAD);
+		const Id fileId = storage.addNode(StorageNodeData(0, L"file.cpp"));
+		storage.addFile(StorageFile(fileId, L"file.cpp", L"cpp", "", true, true));
+		fileAddedTwice = storage.addFile(StorageFile(fileId, L"file.cpp", L"cpp", "", true, true));
+
+		CppSQLite3DB database;
+		database.open(databasePath.str().c_str());
+		filePathIndexCount = database.execScalar(
+			"SELECT COUNT(*) FROM sqlite_master "
+			"WHERE type = 'index' AND name = 'file_path_index';");
+		database.close();
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(!fileAddedTwice);
+	REQUIRE(1 == filePathIndexCount);
+}
+
+TEST_CASE("storage queries large and nested id sets")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	size_t nodeCount = 0;
+	size_t nestedEdgeCount = 0;
+	size_t sourceEdgeCount = 0;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		std::vector<Id> nodeIds;
+		for (int i = 0; i < 3000; i++)
+		{
+			nodeIds.push_back(storage.addNode(StorageNodeData(0, L"node" + std::to_wstring(i))));
+		}
+		for (size_t i = 1; i < nodeIds.size(); i++)
+		{
+			storage.addEdge(StorageEdgeData(0, nodeIds[0], nodeIds[i]));
+		}
+		storage.commitTransaction();
+
+		std::vector<Id> queriedIds = nodeIds;
+		queriedIds.push_back(nodeIds[0]);
+		nodeCount = storage.getAllByIds<StorageNode>(queriedIds).size();
+
+		const std::vector<Id> firstNodeIds(nodeIds.begin(), nodeIds.begin() + 20);
+		storage.forEachByIds<StorageNode>(firstNodeIds, [&](StorageNode&& node) {
+			nestedEdgeCount += storage.getEdgesBySourceIds(std::vector<Id>(20, node.id)).size();
+		});
+
+		sourceEdgeCount = storage.getEdgesBySourceIds(nodeIds).size();
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(3000 == nodeCount);
+	REQUIRE(2999 == nestedEdgeCount);
+	REQUIRE(2999 == sourceEdgeCount);
+}
+
+TEST_CASE("storage keeps latest index time of each file")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	std::map<FilePath, size_t> indexTimes;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.setIndexTimes({{FilePath(L"/a.cpp"), 10}, {FilePath(L"/b.cpp"), 20}});
+		storage.setIndexTimes({{FilePath(L"/b.cpp"), 30}});
+		indexTimes = storage.getIndexTimes();
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(indexTimes.size() == 2);
+	REQUIRE(indexTimes[FilePath(L"/a.cpp")] == 10);
+	REQUIRE(indexTimes[FilePath(L"/b.cpp")] == 30);
+}
+
+TEST_CASE("storage sets files incomplete by path")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	StorageFile aFile;
+	StorageFile bFile;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		const Id aId = storage.addNode(StorageNodeData(0, L"a.cpp"));
+		const Id bId = storage.addNode(StorageNodeData(0, L"b.cpp"));
+		storage.addFile(StorageFile(aId, L"/a.cpp", L"cpp", "", true, true));
+		storage.addFile(StorageFile(bId, L"/b.cpp", L"cpp", "", true, true));
+
+		storage.setFilesIncomplete({FilePath(L"/b.cpp"), FilePath(L"/c.cpp")});
+		aFile = storage.getFileByPath(L"/a.cpp");
+		bFile = storage.getFileByPath(L"/b.cpp");
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(aFile.complete);
+	REQUIRE(bFile.id != 0);
+	REQUIRE(!bFile.complete);
+}
+
+TEST_CASE("storage keeps refresh transaction invisible to readers until committed")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	int nodeCountWhileWriting = -1;
+	int nodeCountAfterCommit = -1;
+	bool walEnabled = false;
+	bool walDisabled = false;
+	{
+		SqliteIndexStorage reader(databasePath);
+		reader.setup();
+		reader.beginTransaction();
+		reader.addNode(StorageNodeData(0, L"a"));
+		reader.commitTransaction();
+
+		{
+			SqliteIndexStorage writer(databasePath);
+			writer.setup();
+			walEnabled = writer.setWriteAheadLogging(true);
+			writer.beginTransaction();
+			writer.addNode(StorageNodeData(0, L"b"));
+
+			// nested transactions only roll back their own changes
+			writer.beginTransaction();
+			writer.addNode(StorageNodeData(0, L"c"));
+			writer.rollbackTransaction();
+
+			writer.beginTransaction();
+			writer.addNode(StorageNodeData(0, L"d"));
+			writer.commitTransaction();
+			REQUIRE(writer.isInTransaction());
+
+			nodeCountWhileWriting = reader.getNodeCount();
+			writer.commitTransaction();
+			REQUIRE(!writer.isInTransaction());
+		}
+
+		nodeCountAfterCommit = reader.getNodeCount();
+		walDisabled = reader.setWriteAheadLogging(false);
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(walEnabled);
+	REQUIRE(walDisabled);
+	REQUIRE(1 == nodeCountWhileWriting);
+	REQUIRE(3 == nodeCountAfterCommit);
+}
+
+TEST_CASE("storage clears elements of files that are cleared in several chunks")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	int nodeCount = -1;
+	int edgeCount = -1;
+	int fileCount = -1;
+	int sourceLocationCount = -1;
+	std::vector<int> progress;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_CLEAR);
+		storage.beginTransaction();
+
+		const auto addFile = [&storage](const std::wstring& path) {
+			const Id fileId = storage.addNode(StorageNodeData(0, path));
+			storage.addFile(StorageFile(fileId, path, L"cpp", "", true, true));
+			return fileId;
+		};
+		const auto addOccurrence = [&storage](Id elementId, Id fileId) {
+			const Id locationId = storage.addSourceLocation(
+				StorageSourceLocationData(fileId, 1, 1, 1, 2, 0));
+			storage.addOccurrence(StorageOccurrence(elementId, locationId));
+		};
+
+		// more files than fit into one chunk
+		std::vector<Id> clearedFileIds;
+		for (int i = 0; i < 300; i++)
+		{
+			clearedFileIds.push_back(addFile(L"file" + std::to_wstring(i) + L".cpp"));
+		}
+		const Id keptFileId = addFile(L"kept.cpp");
+
+		// the edge to the target is removed with the source, which is located in the last chunk
+		const Id targetId = storage.addNode(StorageNodeData(0, L"target"));
+		addOccurrence(targetId, clearedFileIds.front());
+		const Id sourceId = storage.addNode(StorageNodeData(0, L"source"));
+		addOccurrence(sourceId, clearedFileIds.back());
+		storage.addEdge(StorageEdgeData(0, sourceId, targetId));
+
+		const Id keptId = storage.addNode(StorageNodeData(0, L"kept"));
+		addOccurrence(keptId, clearedFileIds.front());
+		addOccurrence(keptId, keptFileId);
+
+		storage.removeElementsWithLocationInFiles(
+			clearedFileIds, [&progress](int value) { progress.push_back(value); });
+		storage.commitTransaction();
+
+		nodeCount = storage.getNodeCount();
+		edgeCount = storage.getEdgeCount();
+		fileCount = storage.getFileCount();
+		sourceLocationCount = storage.getSourceLocationCount();
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(302 == nodeCount);
+	REQUIRE(0 == edgeCount);
+	REQUIRE(301 == fileCount);
+	REQUIRE(1 == sourceLocationCount);
+
+	REQUIRE(progress.size() == 5);
+	REQUIRE(std::is_sorted(progress.begin(), progress.end()));
+	REQUIRE(progress.back() == 95);
+}
+
+TEST_CASE("storage shares compressed content of identical files")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+
+	// large enough to be split into several blocks
+	const std::string text = createSourceText(3000, 1);
+	const std::wstring aPath = writeSourceFile(L"content_a.cpp", text);
+	const std::wstring bPath = writeSourceFile(L"content_b.cpp", text);
+	const std::wstring cPath = writeSourceFile(L"content_c.cpp", createSourceText(10, 2));
+
+	int contentCount = -1;
+	int contentCountAfterRemove = -1;
+	int contentCountAfterClear = -1;
+	std::string aText;
+	std::string bText;
+	std::vector<std::string> lines;
+	std::vector<std::string> outOfRangeLines;
+	bool hasContent = false;
+	bool hasContentAfterClear = true;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+
+		const auto addFile = [&storage](const std::wstring& path) {
+			const Id fileId = storage.addNode(StorageNodeData(0, path));
+			storage.addFile(StorageFile(fileId, path, L"cpp", "", true, true));
+			return fileId;
+		};
+		const Id aId = addFile(aPath);
+		const Id bId = addFile(bPath);
+		const Id cId = addFile(cPath);
+		storage.commitTransaction();
+
+		contentCount = storage.getFileContentCount();
+		aText = storage.getFileContentById(aId)->getText();
+		bText = storage.getFileContentByPath(bPath)->getText();
+		lines = storage.getFileContentLinesByPath(bPath, 1499, 1502);
+		outOfRangeLines = storage.getFileContentLinesByPath(bPath, 3001, 3002);
+		hasContent = storage.hasFileContentByPath(cPath);
+
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_CLEAR);
+		storage.removeElement(aId);
+		contentCountAfterRemove = storage.getFileContentCount();
+		storage.removeElements({bId, cId});
+		contentCountAfterClear = storage.getFileContentCount();
+		hasContentAfterClear = storage.hasFileContentByPath(cPath);
+	}
+	FileSystem::remove(databasePath);
+	for (const std::wstring& path: {aPath, bPath, cPath})
+	{
+		FileSystem::remove(FilePath(path));
+	}
+
+	REQUIRE(2 == contentCount);
+	REQUIRE(text == aText);
+	REQUIRE(text == bText);
+	REQUIRE(lines == TextAccess::createFromString(text)->getLines(1499, 1502));
+	REQUIRE(outOfRangeLines.empty());
+	REQUIRE(hasContent);
+
+	REQUIRE(2 == contentCountAfterRemove);
+	REQUIRE(0 == contentCountAfterClear);
+	REQUIRE(!hasContentAfterClear);
+}
+
+TEST_CASE("storage interns serialized names of nodes")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	const std::wstring aName = createSerializedName({L"ns", L"a"});
+	const std::wstring bName = createSerializedName({L"ns", L"b"});
+	const std::wstring fileName = NameHierarchy::serialize(
+		NameHierarchy(L"/src/file.cpp", NAME_DELIMITER_FILE));
+
+	Id aId = 0;
+	Id bId = 0;
+	Id fileId = 0;
+	Id aIdAgain = 0;
+	int nameCount = -1;
+	int nameCountAfterClear = -1;
+	std::vector<StorageNode> nodes;
+	StorageNode bNode;
+	StorageNode fileNode;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		aId = storage.addNode(StorageNodeData(1, aName));
+		bId = storage.addNode(StorageNodeData(1, bName));
+		fileId = storage.addNode(StorageNodeData(1, fileName));
+		aIdAgain = storage.addNode(StorageNodeData(2, aName));
+
+		const Id locationId = storage.addSourceLocation(
+			StorageSourceLocationData(fileId, 1, 1, 1, 2, 0));
+		storage.addOccurrence(StorageOccurrence(bId, locationId));
+		storage.commitTransaction();
+
+		nameCount = storage.getNameCount();
+		nodes = storage.getAll<StorageNode>();
+		bNode = storage.getNodeBySerializedName(bName);
+		fileNode = storage.getNodeBySerializedName(fileName);
+
+		// cleared like files are, the file nodes are removed after their contents
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_CLEAR);
+		storage.removeElementsWithLocationInFiles({fileId}, nullptr);
+		storage.removeElements({fileId});
+		nameCountAfterClear = storage.getNameCount();
+	}
+
+	// names are loaded from the database
+	StorageNode aNode;
+	Id aIdAfterReopen = 0;
+	Id bIdAfterReopen = 0;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		aNode = storage.getNodeById(aId);
+
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+		aIdAfterReopen = storage.addNode(StorageNodeData(1, aName));
+		bIdAfterReopen = storage.addNode(StorageNodeData(1, bName));
+	}
+	FileSystem::remove(databasePath);
+
+	// the roots of both delimiters, ns, a, b and the file
+	REQUIRE(6 == nameCount);
+	REQUIRE(3 == nodes.size());
+	REQUIRE(aId == aIdAgain);
+	REQUIRE(aName == nodes[0].serializedName);
+	REQUIRE(2 == nodes[0].type);
+	REQUIRE(bName == nodes[1].serializedName);
+	REQUIRE(fileName == nodes[2].serializedName);
+	REQUIRE(bId == bNode.id);
+	REQUIRE(bName == bNode.serializedName);
+	REQUIRE(fileId == fileNode.id);
+
+	// the names of the file node are released with it
+	REQUIRE(3 == nameCountAfterClear);
+	REQUIRE(aName == aNode.serializedName);
+	REQUIRE(aId == aIdAfterReopen);
+	REQUIRE(bIdAfterReopen != 0);
+	REQUIRE(bIdAfterReopen != bId);
+}
+
+TEST_CASE("storage finds nodes stored with full names")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	const std::wstring aName = createSerializedName({L"ns", L"a"});
+	const std::wstring bName = createSerializedName({L"ns", L"b"});
+
+	Id aId = 0;
+	Id aIdAgain = 0;
+	Id bId = 0;
+	int fullNameCount = -1;
+	int internedNameCount = -1;
+	int nameCountAfterDisabling = -1;
+	Id foundAId = 0;
+	Id foundBId = 0;
+	std::vector<std::wstring> nameHierarchies;
+	std::vector<StorageNode> nodes;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.setNameInterningEnabled(false);
+		aId = storage.addNode(StorageNodeData(0, aName));
+		fullNameCount = storage.getNameCount();
+
+		storage.setNameInterningEnabled(true);
+		aIdAgain = storage.addNode(StorageNodeData(0, aName));
+		bId = storage.addNode(StorageNodeData(0, bName));
+		internedNameCount = storage.getNameCount();
+		foundAId = storage.getNodeBySerializedName(aName).id;
+		storage.forEachNodeNameHierarchy([&](Id, int, NameHierarchy&& nameHierarchy) {
+			nameHierarchies.push_back(NameHierarchy::serialize(nameHierarchy));
+		});
+
+		// other writers look up nodes by the serialized_name column
+		storage.setNameInterningEnabled(false);
+		nameCountAfterDisabling = storage.getNameCount();
+		foundBId = storage.getNodeBySerializedName(bName).id;
+		nodes = storage.getAll<StorageNode>();
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(0 == fullNameCount);
+	REQUIRE(aId == aIdAgain);
+	REQUIRE(3 == internedNameCount);
+	REQUIRE(aId == foundAId);
+	REQUIRE(std::vector<std::wstring>({aName, bName}) == nameHierarchies);
+
+	REQUIRE(0 == nameCountAfterDisabling);
+	REQUIRE(bId == foundBId);
+	REQUIRE(2 == nodes.size());
+	REQUIRE(aName == nodes[0].serializedName);
+	REQUIRE(bName == nodes[1].serializedName);
+}
+
+// run explicitly with "[benchmark]" to measure database size and snippet latency of file contents
+TEST_CASE("storage file content benchmark", "[.][benchmark]")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	const size_t fileCount = 500;
+	const size_t lineCount = 4000;
+
+	// every fourth file is a copy of another one, like generated or vendored code
+	std::vector<std::wstring> paths;
+	size_t textByteSize = 0;
+	for (size_t i = 0; i < fileCount; i++)
+	{
+		const std::string text = createSourceText(lineCount, i % 4 ? i : i + 1);
+		paths.push_back(writeSourceFile(L"bench_" + std::to_wstring(i) + L".cpp", text));
+		textByteSize += text.size();
+	}
+
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+
+		TimeStamp addStart = TimeStamp::now();
+		storage.beginTransaction();
+		for (const std::wstring& path: paths)
+		{
+			const Id fileId = storage.addNode(StorageNodeData(0, path));
+			storage.addFile(StorageFile(fileId, path, L"cpp", "", true, true));
+		}
+		storage.commitTransaction();
+		const size_t addMS = TimeStamp::now().deltaMS(addStart);
+
+		std::cout << "stored " << fileCount << " files of " << textByteSize / 1024 << " KB in "
+				  << addMS << " ms, database " << FileSystem::getFileByteSize(databasePath) / 1024
+				  << " KB, " << storage.getFileContentCount() << " contents" << std::endl;
+
+		TimeStamp snippetStart = TimeStamp::now();
+		size_t snippetLineCount = 0;
+		for (size_t i = 0; i < fileCount; i++)
+		{
+			const size_t firstLine = (i * 7919) % (lineCount - 5) + 1;
+			snippetLineCount +=
+				storage.getFileContentLinesByPath(paths[i], firstLine, firstLine + 4).size();
+		}
+		std::cout << fileCount << " snippets in " << TimeStamp::now().deltaMS(snippetStart) << " ms"
+				  << std::endl;
+
+		TimeStamp fullStart = TimeStamp::now();
+		size_t fullLineCount = 0;
+		for (size_t i = 0; i < fileCount; i++)
+		{
+			fullLineCount += storage.getFileContentByPath(paths[i])->getLineCount();
+		}
+		std::cout << fileCount << " full contents in " << TimeStamp::now().deltaMS(fullStart)
+				  << " ms" << std::endl;
+
+		REQUIRE(snippetLineCount == fileCount * 5);
+		REQUIRE(fullLineCount == fileCount * lineCount);
+	}
+
+	FileSystem::remove(databasePath);
+	for (const std::wstring& path: paths)
+	{
+		FileSystem::remove(FilePath(path));
+	}
+}
+
+// run explicitly with "[benchmark]" to compare interned with full node names
+TEST_CASE("storage node name benchmark", "[.][benchmark]")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+
+	// members of template instantiations, like in template heavy c++
+	std::vector<StorageNode> nodes;
+	for (size_t i = 0; i < 20; i++)
+	{
+		const std::wstring space = L"detail_" + std::to_wstring(i);
+		for (size_t j = 0; j < 100; j++)
+		{
+			const std::wstring record = L"basic_container_" + std::to_wstring(j) +
+				L"<std::pair<const std::basic_string<char>, std::vector<int>>>";
+			NameHierarchy recordName({L"boost", L"container", space, record}, L"::");
+			nodes.emplace_back(0, 1, NameHierarchy::serialize(recordName));
+
+			for (size_t k = 0; k < 50; k++)
+			{
+				NameHierarchy memberName = recordName;
+				memberName.push(NameElement(
+					L"method_" + std::to_wstring(k),
+					L"void",
+					L"(const std::vector<" + record + L">&, size_t) const"));
+				nodes.emplace_back(0, 2, NameHierarchy::serialize(memberName));
+			}
+		}
+	}
+
+	for (bool interned: {false, true})
+	{
+		{
+			SqliteIndexStorage storage(databasePath);
+			storage.setup();
+			storage.setNameInterningEnabled(interned);
+			storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+
+			TimeStamp addStart = TimeStamp::now();
+			storage.beginTransaction();
+			storage.addNodes(nodes);
+			storage.commitTransaction();
+			const size_t addMS = TimeStamp::now().deltaMS(addStart);
+
+			storage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+			TimeStamp readStart = TimeStamp::now();
+			const std::vector<StorageNode> storedNodes = storage.getAll<StorageNode>();
+			const size_t readMS = TimeStamp::now().deltaMS(readStart);
+
+			TimeStamp findStart = TimeStamp::now();
+			size_t foundCount = 0;
+			for (size_t i = 0; i < nodes.size(); i += 97)
+			{
+				foundCount += storage.getNodeBySerializedName(nodes[i].serializedName).id ? 1 : 0;
+			}
+			const size_t findMS = TimeStamp::now().deltaMS(findStart);
+
+			std::cout << (interned ? "interned" : "full") << " names of " << nodes.size()
+					  << " nodes: database " << FileSystem::getFileByteSize(databasePath) / 1024
+					  << " KB, added in " << addMS << " ms, read in " << readMS << " ms, "
+					  << foundCount << " found in " << findMS << " ms" << std::endl;
+
+			REQUIRE(storedNodes.size() == nodes.size());
+			REQUIRE(storedNodes.back().serializedName == nodes.back().serializedName);
+		}
+		FileSystem::remove(databasePath);
+	}
+}
@@ -0,0 +1,67 @@
+#include "catch.hpp"
+
+#include "StorageProvider.h"
+
+namespace
+{
+std::shared_ptr<IntermediateStorage> createStorage(size_t sourceLocationCount)
+{
+	std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
+	for (size_t i = 0; i < sourceLocationCount; i++)
+	{
+		storage->addSourceLocation(StorageSourceLocationData(1, i + 1, 1, i + 1, 2, 0));
+	}
+	return storage;
+}
+}	 // namespace
+
+TEST_CASE("storage provider hands out smallest storages for merging and largest for injection")
+{
+	StorageProvider provider;
+	provider.insert(createStorage(3));
+	provider.insert(createStorage(1));
+	provider.insert(createStorage(5));
+	provider.insert(createStorage(2));
+	REQUIRE(provider.getStorageCount() == 4);
+
+	const std::pair<std::shared_ptr<IntermediateStorage>, std::shared_ptr<IntermediateStorage>>
+		storages = provider.consumeSmallestStoragePair();
+	REQUIRE(storages.first->getSourceLocationCount() == 2);
+	REQUIRE(storages.second->getSourceLocationCount() == 1);
+
+	REQUIRE(provider.consumeLargestStorage()->getSourceLocationCount() == 5);
+	REQUIRE(provider.consumeLargestStorage()->getSourceLocationCount() == 3);
+	REQUIRE(!provider.consumeLargestStorage());
+}
+
+TEST_CASE("storage provider counts merging storages against the budget")
+{
+	const size_t storageByteSize = createStorage(10)->getByteSize(sizeof(std::wstring));
+	StorageProvider provider(3 * storageByteSize);
+	REQUIRE(!provider.isOverBudget());
+
+	provider.insert(createStorage(10));
+	provider.insert(createStorage(10));
+	provider.insert(createStorage(10));
+	REQUIRE(provider.getByteSizeInFlight() == 3 * storageByteSize);
+	REQUIRE(provider.isOverBudget());
+	REQUIRE(!provider.waitForByteSizeBelowBudget(10));
+
+	std::pair<std::shared_ptr<IntermediateStorage>, std::shared_ptr<IntermediateStorage>> storages =
+		provider.consumeSmallestStoragePair();
+	REQUIRE(provider.getStorageCount() == 1);
+	REQUIRE(provider.isOverBudget());
+
+	// the merged storage holds the same locations as one of its sources
+	provider.addMergeStats(10, 0.0f);
+	provider.insert(storages.first);
+	REQUIRE(provider.getByteSizeInFlight() == 2 * storageByteSize);
+	REQUIRE(provider.waitForByteSizeBelowBudget(10));
+
+	REQUIRE(provider.consumeLargestStorage());
+	REQUIRE(provider.getByteSizeInFlight() == storageByteSize);
+
+	provider.clear();
+	REQUIRE(provider.getStorageCount() == 0);
+	REQUIRE(provider.getByteSizeInFlight() == 0);
+}
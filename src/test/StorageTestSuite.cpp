@@ -2,9 +2,17 @@
 
 #include "utilityString.h"
 
+#include "ApplicationSettings.h"
+#include "CppSQLite3.h"
+#include "FileSystem.h"
+#include "FlatIntermediateStorage.h"
+#include "Graph.h"
 #include "IntermediateStorage.h"
 #include "ParseLocation.h"
 #include "PersistentStorage.h"
+#include "SourceLocationFile.h"
+#include "SqliteIndexStorage.h"
+#include "TextAccess.h"
 
 namespace
 {
@@ -92,6 +100,141 @@ TEST_CASE("storage saves node")
 	REQUIRE(storage.getNodeTypeForNodeWithId(storedId).getKind() == NODE_TYPEDEF);
 }
 
+TEST_CASE("storage injects database written by custom command in older layout")
+{
+	const FilePath databasePath(L"data/testCustomCommand.sqlite");
+	const std::wstring filePath = L"path/to/test.py";
+	const NameHierarchy a = createNameHierarchy(L"ns::type");
+
+	{
+		PersistentStorage customCommandStorage(databasePath, FilePath());
+		customCommandStorage.setupCustomCommandStorage();
+	}
+
+	// written the way indexers built against the older version do
+	int version = 0;
+	int addedTableCount = -1;
+	{
+		CppSQLite3DB database;
+		database.open(databasePath.str().c_str());
+		version = database.execScalar("SELECT value FROM meta WHERE key = 'storage_version';");
+		addedTableCount = database.execScalar(
+			"SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND "
+			"name IN ('name_part', 'name', 'node_name', 'compressed_content');");
+
+		const std::string fileName = utility::encodeToUtf8(
+			NameHierarchy::serialize(NameHierarchy(filePath, NAME_DELIMITER_FILE)));
+		const std::string typeName = utility::encodeToUtf8(NameHierarchy::serialize(a));
+		database.execDML("INSERT INTO element(id) VALUES(1);");
+		database.execDML(
+			("INSERT INTO node(id, type, serialized_name) VALUES(1, " +
+			 std::to_string(nodeKindToInt(NODE_FILE)) + ", '" + fileName + "');")
+				.c_str());
+		database.execDML(
+			"INSERT INTO file(id, path, language, modification_time, indexed, complete, "
+			"line_count) VALUES(1, 'path/to/test.py', 'python', '2020-01-01 00:00:00', 1, 1, 2);");
+		database.execDML(
+			"INSERT INTO filecontent(id, content) VALUES(1, 'class type:\n\tpass\n');");
+		database.execDML("INSERT INTO element(id) VALUES(2);");
+		database.execDML(
+			("INSERT INTO node(id, type, serialized_name) VALUES(2, " +
+			 std::to_string(nodeKindToInt(NODE_CLASS)) + ", '" + typeName + "');")
+				.c_str());
+		database.close();
+	}
+
+	TestStorage storage;
+	bool incompatible = true;
+	std::shared_ptr<TextAccess> content;
+	{
+		PersistentStorage customCommandStorage(databasePath, FilePath());
+		customCommandStorage.migrateCustomCommandStorage();
+		customCommandStorage.setup();
+		customCommandStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+		customCommandStorage.buildCaches();
+		storage.inject(&customCommandStorage);
+
+		incompatible = customCommandStorage.isIncompatible();
+		content = customCommandStorage.getFileContent(FilePath(filePath), false);
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(25 == version);
+	REQUIRE(0 == addedTableCount);
+	REQUIRE(!incompatible);
+	REQUIRE(2 == content->getLineCount());
+	REQUIRE("\tpass\n" == content->getLine(2));
+
+	const Id typeId = storage.getNodeIdForNameHierarchy(a);
+	REQUIRE(typeId != 0);
+	REQUIRE(storage.getNodeTypeForNodeWithId(typeId).getKind() == NODE_CLASS);
+	REQUIRE(storage.getNodeIdForNameHierarchy(NameHierarchy(filePath, NAME_DELIMITER_FILE)) != 0);
+}
+
+TEST_CASE("flat intermediate storage restores all stored data")
+{
+	IntermediateStorage storage;
+	const Id fileId = storage
+						  .addNode(StorageNodeData(
+							  nodeKindToInt(NODE_FILE),
+							  NameHierarchy::serialize(NameHierarchy(L"a.cpp", NAME_DELIMITER_FILE))))
+						  .first;
+	storage.addFile(StorageFile(fileId, L"a.cpp", L"cpp", "", true, false));
+	const Id nodeId = storage
+						  .addNode(StorageNodeData(
+							  nodeKindToInt(NODE_CLASS),
+							  NameHierarchy::serialize(createNameHierarchy(L"Foo::B\u00e4r"))))
+						  .first;
+	storage.addSymbol(StorageSymbol(nodeId, definitionKindToInt(DEFINITION_EXPLICIT)));
+	const Id edgeId = storage.addEdge(StorageEdgeData(0, fileId, nodeId));
+	const Id localSymbolId = storage.addLocalSymbol(StorageLocalSymbolData(L"a.cpp<1:2>"));
+	const Id locationId = storage.addSourceLocation(
+		StorageSourceLocationData(fileId, 1, 2, 3, 4, 0));
+	storage.addSourceLocation(StorageSourceLocationData(fileId, 1, 1, 3, 4, 0));
+	storage.addOccurrence(StorageOccurrence(nodeId, locationId));
+	storage.addOccurrence(StorageOccurrence(localSymbolId, locationId));
+	storage.addComponentAccess(StorageComponentAccess(nodeId, 1));
+	storage.addElementComponent(StorageElementComponent(edgeId, 0, L"data"));
+	storage.addError(StorageErrorData(L"error", L"a.cpp", true, false));
+
+	std::vector<char> data(FlatIntermediateStorage::getByteSize(storage));
+	REQUIRE(FlatIntermediateStorage::write(storage, data.data(), data.size()));
+
+	std::shared_ptr<IntermediateStorage> restored =
+		FlatIntermediateStorage(data.data(), data.size()).createIntermediateStorage();
+	REQUIRE(restored);
+
+	REQUIRE(restored->getNextId() == storage.getNextId());
+	REQUIRE(restored->getStorageNodes().size() == 2);
+	REQUIRE(restored->getStorageNodes()[1].id == nodeId);
+	REQUIRE(restored->getStorageNodes()[1].serializedName == storage.getStorageNodes()[1].serializedName);
+	REQUIRE(restored->getStorageFiles().size() == 1);
+	REQUIRE(restored->getStorageFiles()[0].filePath == L"a.cpp");
+	REQUIRE(restored->getStorageFiles()[0].languageIdentifier == L"cpp");
+	REQUIRE(!restored->getStorageFiles()[0].complete);
+	REQUIRE(restored->getStorageSymbols().size() == 1);
+	REQUIRE(restored->getStorageEdges().size() == 1);
+	REQUIRE(restored->getStorageEdges()[0].targetNodeId == nodeId);
+	REQUIRE(restored->getStorageLocalSymbols().size() == 1);
+	REQUIRE(restored->getStorageLocalSymbols().begin()->name == L"a.cpp<1:2>");
+	REQUIRE(restored->getStorageSourceLocations().size() == 2);
+	REQUIRE(restored->getStorageSourceLocations().begin()->startCol == 1);
+	REQUIRE(restored->getStorageOccurrences().size() == 2);
+	REQUIRE(restored->getComponentAccesses().size() == 1);
+	REQUIRE(restored->getElementComponents().size() == 1);
+	REQUIRE(restored->getElementComponents().begin()->data == L"data");
+	REQUIRE(restored->getErrors().size() == 1);
+	REQUIRE(restored->getErrors()[0].fatal);
+	REQUIRE(restored->getErrors()[0].translationUnit == L"a.cpp");
+}
+
+TEST_CASE("flat intermediate storage rejects invalid data")
+{
+	std::vector<char> data(16, 0);
+	REQUIRE(!FlatIntermediateStorage(data.data(), data.size()).isValid());
+	REQUIRE(!FlatIntermediateStorage(data.data(), data.size()).createIntermediateStorage());
+}
+
 TEST_CASE("storage saves field as member")
 {
 	NameHierarchy a = createNameHierarchy(L"Struct");
@@ -283,3 +426,187 @@ TEST_CASE("storage finds and removes depending file nodes")
 	// TS_ASSERT(!storage.getEdgeWithId(id4));
 	// TS_ASSERT(!storage.getEdgeWithId(id5));
 }
+
+TEST_CASE("storage finds only shortest trails between two symbols")
+{
+	TestStorage storage;
+
+	std::shared_ptr<IntermediateStorage> intermediateStorage = std::make_shared<IntermediateStorage>();
+
+	std::map<std::wstring, Id> ids;
+	for (const std::wstring name: {L"a", L"b", L"c", L"d", L"e", L"f"})
+	{
+		ids[name] = intermediateStorage
+						->addNode(StorageNodeData(
+							nodeKindToInt(NODE_FUNCTION),
+							NameHierarchy::serialize(createNameHierarchy(name))))
+						.first;
+		intermediateStorage->addSymbol(StorageSymbol(ids[name], DEFINITION_EXPLICIT));
+	}
+
+	// a calls d through b and c, and on a longer way through e and f
+	const std::vector<std::pair<std::wstring, std::wstring>> calls = {
+		{L"a", L"b"}, {L"a", L"c"}, {L"b", L"d"}, {L"c", L"d"},
+		{L"a", L"e"}, {L"e", L"f"}, {L"f", L"d"}};
+	for (const std::pair<std::wstring, std::wstring>& call: calls)
+	{
+		intermediateStorage->addEdge(StorageEdgeData(
+			Edge::typeToInt(Edge::EDGE_CALL), ids[call.first], ids[call.second]));
+	}
+
+	storage.inject(intermediateStorage.get());
+	storage.buildCaches();
+
+	auto getTrailNodeNames = [&storage](bool shortestPath, size_t depth) {
+		std::shared_ptr<Graph> graph = storage.getGraphForTrail(
+			storage.getNodeIdForNameHierarchy(createNameHierarchy(L"a")),
+			storage.getNodeIdForNameHierarchy(createNameHierarchy(L"d")),
+			NODE_FUNCTION,
+			Edge::EDGE_CALL,
+			true,
+			depth,
+			true,
+			shortestPath);
+
+		std::set<std::wstring> names;
+		graph->forEachNode([&names](Node* node) { names.insert(node->getFullName()); });
+		return names;
+	};
+
+	const bool adjacencyCacheEnabled =
+		ApplicationSettings::getInstance()->getGraphAdjacencyCacheEnabled();
+
+	for (const bool useAdjacencyCache: {true, false})
+	{
+		ApplicationSettings::getInstance()->setGraphAdjacencyCacheEnabled(useAdjacencyCache);
+
+		REQUIRE(
+			getTrailNodeNames(false, 0) ==
+			std::set<std::wstring>({L"a", L"b", L"c", L"d", L"e", L"f"}));
+		REQUIRE(getTrailNodeNames(true, 0) == std::set<std::wstring>({L"a", L"b", L"c", L"d"}));
+		REQUIRE(getTrailNodeNames(true, 1) == std::set<std::wstring>({L"a"}));
+	}
+
+	ApplicationSettings::getInstance()->setGraphAdjacencyCacheEnabled(adjacencyCacheEnabled);
+}
+
+TEST_CASE("storage hides namespaces and member edges on shortest trails")
+{
+	TestStorage storage;
+
+	std::shared_ptr<IntermediateStorage> intermediateStorage = std::make_shared<IntermediateStorage>();
+
+	std::map<std::wstring, Id> ids;
+	for (const std::wstring name: {L"a", L"b", L"c", L"n", L"n::d"})
+	{
+		const NodeKind kind = name == L"n" ? NODE_NAMESPACE : NODE_FUNCTION;
+		ids[name] = intermediateStorage
+						->addNode(StorageNodeData(
+							nodeKindToInt(kind),
+							NameHierarchy::serialize(createNameHierarchy(name))))
+						.first;
+		intermediateStorage->addSymbol(StorageSymbol(ids[name], DEFINITION_EXPLICIT));
+	}
+
+	// a calls d through b and c, and the shorter way uses the namespace that d is a member of
+	intermediateStorage->addEdge(
+		StorageEdgeData(Edge::typeToInt(Edge::EDGE_CALL), ids[L"a"], ids[L"b"]));
+	intermediateStorage->addEdge(
+		StorageEdgeData(Edge::typeToInt(Edge::EDGE_CALL), ids[L"b"], ids[L"c"]));
+	intermediateStorage->addEdge(
+		StorageEdgeData(Edge::typeToInt(Edge::EDGE_CALL), ids[L"c"], ids[L"n::d"]));
+	intermediateStorage->addEdge(
+		StorageEdgeData(Edge::typeToInt(Edge::EDGE_USAGE), ids[L"a"], ids[L"n"]));
+	intermediateStorage->addEdge(
+		StorageEdgeData(Edge::typeToInt(Edge::EDGE_MEMBER), ids[L"n"], ids[L"n::d"]));
+
+	storage.inject(intermediateStorage.get());
+	storage.buildCaches();
+
+	const bool adjacencyCacheEnabled =
+		ApplicationSettings::getInstance()->getGraphAdjacencyCacheEnabled();
+
+	for (const bool useAdjacencyCache: {true, false})
+	{
+		ApplicationSettings::getInstance()->setGraphAdjacencyCacheEnabled(useAdjacencyCache);
+
+		std::shared_ptr<Graph> graph = storage.getGraphForTrail(
+			ids[L"a"],
+			ids[L"n::d"],
+			NODE_FUNCTION | NODE_NAMESPACE,
+			Edge::EDGE_CALL | Edge::EDGE_USAGE | Edge::EDGE_MEMBER,
+			true,
+			0,
+			false,
+			true);
+
+		std::set<std::wstring> names;
+		graph->forEachNode([&names](Node* node) { names.insert(node->getFullName()); });
+
+		REQUIRE(names == std::set<std::wstring>({L"a", L"n::d"}));
+		REQUIRE(0 == graph->getEdgeCount());
+	}
+
+	ApplicationSettings::getInstance()->setGraphAdjacencyCacheEnabled(adjacencyCacheEnabled);
+}
+
+TEST_CASE("storage finds source locations in lines of file")
+{
+	TestStorage storage;
+
+	const std::wstring filePath = L"path/to/test.cpp";
+	std::shared_ptr<IntermediateStorage> intermediateStorage = std::make_shared<IntermediateStorage>();
+	const NameHierarchy fileName(filePath, NAME_DELIMITER_FILE);
+	const Id fileId = intermediateStorage
+						  ->addNode(StorageNodeData(
+							  nodeKindToInt(NODE_FILE), NameHierarchy::serialize(fileName)))
+						  .first;
+	intermediateStorage->addFile(StorageFile(fileId, filePath, L"cpp", "someTime", true, true));
+
+	const Id symbolId = intermediateStorage
+							->addNode(StorageNodeData(
+								nodeKindToInt(NODE_FUNCTION),
+								NameHierarchy::serialize(createNameHierarchy(L"a"))))
+							.first;
+	for (size_t line = 1; line <= 100; line++)
+	{
+		const Id locationId = intermediateStorage->addSourceLocation(
+			StorageSourceLocationData(fileId, line, 2, line, 4, locationTypeToInt(LOCATION_TOKEN)));
+		intermediateStorage->addOccurrence(StorageOccurrence(symbolId, locationId));
+	}
+	intermediateStorage->addSourceLocation(
+		StorageSourceLocationData(fileId, 20, 1, 60, 1, locationTypeToInt(LOCATION_SCOPE)));
+
+	storage.inject(intermediateStorage.get());
+	storage.buildCaches();
+
+	// the second query is answered by the interval index of the file
+	for (size_t i = 0; i < 2; i++)
+	{
+		std::shared_ptr<SourceLocationFile> file = storage.getSourceLocationsForLinesInFile(
+			FilePath(filePath), 50, 52);
+		REQUIRE(file->getFilePath() == FilePath(filePath));
+		REQUIRE(file->getLanguage() == L"cpp");
+		REQUIRE(file->isComplete());
+
+		std::vector<size_t> lineNumbers;
+		size_t scopeLocationCount = 0;
+		file->forEachSourceLocation([&](SourceLocation* location) {
+			if (location->getType() == LOCATION_SCOPE)
+			{
+				scopeLocationCount++;
+			}
+			else if (location->isStartLocation())
+			{
+				REQUIRE(location->getTokenIds() == std::vector<Id>({symbolId}));
+				lineNumbers.push_back(location->getLineNumber());
+			}
+		});
+		REQUIRE(lineNumbers == std::vector<size_t>({50, 51, 52}));
+		REQUIRE(scopeLocationCount == 0);
+	}
+
+	REQUIRE(
+		storage.getSourceLocationsForLinesInFile(FilePath(L"other.cpp"), 1, 10)
+			->getSourceLocationCount() == 0);
+}
@@ -0,0 +1,186 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cwctype>
+#include <iostream>
+#include <random>
+
+#include "SuffixArray.h"
+#include "TimeStamp.h"
+
+namespace
+{
+std::vector<int> findAll(const std::wstring& text, const std::wstring& term)
+{
+	std::wstring lowerText = text;
+	std::wstring lowerTerm = term;
+	std::transform(lowerText.begin(), lowerText.end(), lowerText.begin(), ::towlower);
+	std::transform(lowerTerm.begin(), lowerTerm.end(), lowerTerm.begin(), ::towlower);
+
+	std::vector<int> positions;
+	for (size_t pos = lowerText.find(lowerTerm); pos != std::wstring::npos;
+		 pos = lowerText.find(lowerTerm, pos + 1))
+	{
+		positions.push_back(static_cast<int>(pos));
+	}
+	return positions;
+}
+
+std::wstring getRandomText(size_t length, const std::wstring& alphabet, unsigned int seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<size_t> distribution(0, alphabet.size() - 1);
+
+	std::wstring text;
+	for (size_t i = 0; i < length; i++)
+	{
+		text.push_back(alphabet[distribution(generator)]);
+	}
+	return text;
+}
+
+// prefix doubling construction the suffix array used before, O(n log^2 n) on the wide text
+std::vector<int> buildSuffixArrayByPrefixDoubling(const std::wstring& text)
+{
+	struct Suffix
+	{
+		int index;
+		int rank[2];
+	};
+	const auto cmp = [](const Suffix& a, const Suffix& b) {
+		return (a.rank[0] == b.rank[0]) ? (a.rank[1] < b.rank[1]) : (a.rank[0] < b.rank[0]);
+	};
+
+	const int n = static_cast<int>(text.length());
+	std::vector<Suffix> suffixes(n);
+	for (int i = 0; i < n; i++)
+	{
+		suffixes[i].index = i;
+		suffixes[i].rank[0] = text[i];
+		suffixes[i].rank[1] = ((i + 1) < n) ? (text[i + 1]) : -1;
+	}
+	std::sort(suffixes.begin(), suffixes.end(), cmp);
+
+	std::vector<int> ind(n, 0);
+	for (int k = 4; k < 2 * n; k = k * 2)
+	{
+		int rank = 0;
+		int prevRank = suffixes[0].rank[0];
+		suffixes[0].rank[0] = rank;
+		ind[suffixes[0].index] = 0;
+
+		for (int i = 1; i < n; i++)
+		{
+			if (suffixes[i].rank[0] != prevRank || suffixes[i].rank[1] != suffixes[i - 1].rank[1])
+			{
+				rank++;
+			}
+			prevRank = suffixes[i].rank[0];
+			suffixes[i].rank[0] = rank;
+			ind[suffixes[i].index] = i;
+		}
+
+		for (int i = 0; i < n; i++)
+		{
+			int nextIndex = suffixes[i].index + k / 2;
+			suffixes[i].rank[1] = (nextIndex < n) ? suffixes[ind[nextIndex]].rank[0] : -1;
+		}
+		std::sort(suffixes.begin(), suffixes.end(), cmp);
+	}
+
+	std::vector<int> array(n);
+	for (int i = 0; i < n; i++)
+	{
+		array[i] = suffixes[i].index;
+	}
+	return array;
+}
+}	 // namespace
+
+TEST_CASE("suffix array finds all occurrences case insensitive")
+{
+	SuffixArray array(L"int foo; Foo bar; foobar");
+
+	REQUIRE(array.searchForTerm(L"foo") == std::vector<int>({4, 9, 18}));
+	REQUIRE(array.searchForTerm(L"BAR") == std::vector<int>({13, 21}));
+	REQUIRE(array.searchForTerm(L"int foo; Foo bar; foobar") == std::vector<int>({0}));
+	REQUIRE(array.searchForTerm(L"foobarbaz").empty());
+	REQUIRE(array.getCharOffsetCount() == 0);
+}
+
+TEST_CASE("suffix array returns character positions for non ascii text")
+{
+	const std::wstring text = L"// Grüße aus Zürich: 日本 zürich \U0001F600 ZüRICH";
+	SuffixArray array(text);
+
+	REQUIRE(array.size() > text.size());
+	REQUIRE(array.getCharOffsetCount() > 0);
+	REQUIRE(array.searchForTerm(L"zürich") == findAll(text, L"zürich"));
+	REQUIRE(array.searchForTerm(L"zürich").size() == 3);
+	REQUIRE(array.searchForTerm(L"本") == findAll(text, L"本"));
+	REQUIRE(array.searchForTerm(L"\U0001F600 z") == findAll(text, L"\U0001F600 z"));
+}
+
+TEST_CASE("suffix array matches naive search on random text")
+{
+	const std::wstring alphabet = L"abAB äÄ日";
+	for (unsigned int seed = 0; seed < 20; seed++)
+	{
+		const std::wstring text = getRandomText(500 + seed * 97, alphabet, seed);
+		SuffixArray array(text);
+
+		for (size_t termLength = 1; termLength < 6; termLength++)
+		{
+			const size_t termStart = seed * 7 % (text.size() - termLength);
+			const std::wstring term = text.substr(termStart, termLength);
+			REQUIRE(array.searchForTerm(term) == findAll(text, term));
+		}
+	}
+}
+
+TEST_CASE("suffix array of repetitive text is sorted")
+{
+	const std::wstring text(5000, L'a');
+	SuffixArray array(text);
+
+	REQUIRE(array.searchForTerm(L"aaaa").size() == 4997);
+
+	const int* suffixes = array.getArray();
+	for (size_t i = 0; i + 1 < array.size(); i++)
+	{
+		REQUIRE(suffixes[i] == static_cast<int>(array.size() - i - 1));
+		REQUIRE(array.getLCP()[i] == static_cast<int>(i + 1));
+	}
+}
+
+// run explicitly with "[benchmark]" to compare against the prefix doubling construction
+TEST_CASE("suffix array construction benchmark", "[.][benchmark]")
+{
+	const std::wstring alphabet = L"abcdefghijklmnopqrstuvwxyz0123456789_ \n(){};,.<>=*&";
+	const std::wstring line = getRandomText(2000, alphabet, 1);
+	std::wstring text;
+	while (text.size() < 2000000)
+	{
+		// source code repeats a lot, which is the worst case for prefix doubling
+		text += line.substr(text.size() % 1000, 1000);
+	}
+
+	TimeStamp doublingStart = TimeStamp::now();
+	const std::vector<int> doublingArray = buildSuffixArrayByPrefixDoubling(text);
+	const size_t doublingMS = TimeStamp::now().deltaMS(doublingStart);
+
+	TimeStamp inducedStart = TimeStamp::now();
+	SuffixArray array(text);
+	const size_t inducedMS = TimeStamp::now().deltaMS(inducedStart);
+
+	const size_t doublingBytes = text.size() * (sizeof(wchar_t) + 2 * sizeof(int));
+	const size_t inducedBytes = array.size() * (1 + 2 * sizeof(int)) +
+		array.getCharOffsetCount() * sizeof(int);
+
+	std::cout << "built suffix array of " << text.size() << " characters: prefix doubling "
+			  << doublingMS << " ms, " << double(doublingBytes) / text.size()
+			  << " bytes/char, induced sorting " << inducedMS << " ms, "
+			  << double(inducedBytes) / text.size() << " bytes/char" << std::endl;
+
+	REQUIRE(std::equal(doublingArray.begin(), doublingArray.end(), array.getArray()));
+}
@@ -7,6 +7,7 @@
 #include "Task.h"
 #include "TaskGroupSelector.h"
 #include "TaskGroupSequence.h"
+#include "TaskLambda.h"
 #include "TaskScheduler.h"
 
 namespace
@@ -164,6 +165,19 @@ TEST_CASE("scheduled tasks get processed with callbacks in correct order")
 	REQUIRE(3 == task->exitCallOrder);
 }
 
+TEST_CASE("lambda task passes values on the blackboard to later tasks")
+{
+	std::shared_ptr<Blackboard> blackboard = std::make_shared<Blackboard>();
+
+	int count = 0;
+	TaskLambda setTask([](std::shared_ptr<Blackboard> blackboard) { blackboard->set("count", 3); });
+	TaskLambda getTask([&count, blackboard]() { blackboard->get("count", count); });
+
+	REQUIRE(setTask.update(blackboard) == Task::STATE_SUCCESS);
+	REQUIRE(getTask.update(blackboard) == Task::STATE_SUCCESS);
+	REQUIRE(count == 3);
+}
+
 TEST_CASE("sequential task group to process tasks in correct order")
 {
 	TaskScheduler scheduler(0);
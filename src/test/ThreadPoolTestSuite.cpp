@@ -0,0 +1,58 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "ThreadPool.h"
+
+TEST_CASE("thread pool calls function for every index once")
+{
+	ThreadPool pool(4);
+
+	std::vector<int> calls(1000, 0);
+	pool.parallelFor(calls.size(), [&calls](size_t i) { calls[i]++; });
+
+	REQUIRE(std::count(calls.begin(), calls.end(), 1) == 1000);
+}
+
+TEST_CASE("thread pool reuses its threads between loops")
+{
+	ThreadPool pool(4);
+
+	std::mutex threadIdsMutex;
+	std::set<std::thread::id> threadIds;
+	for (int i = 0; i < 20; i++)
+	{
+		pool.parallelFor(100, [&](size_t) {
+			std::lock_guard<std::mutex> lock(threadIdsMutex);
+			threadIds.insert(std::this_thread::get_id());
+		});
+	}
+
+	REQUIRE(threadIds.size() <= pool.getThreadCount());
+}
+
+TEST_CASE("thread pool runs nested loops")
+{
+	ThreadPool pool(3);
+
+	std::atomic<int> sum(0);
+	pool.parallelFor(10, [&](size_t i) {
+		pool.parallelFor(10, [&](size_t j) { sum += static_cast<int>(i * 10 + j); });
+	});
+
+	REQUIRE(sum == 4950);
+}
+
+TEST_CASE("thread pool with single thread runs on calling thread")
+{
+	ThreadPool pool(1);
+
+	std::thread::id threadId;
+	pool.parallelFor(5, [&threadId](size_t) { threadId = std::this_thread::get_id(); });
+
+	REQUIRE(threadId == std::this_thread::get_id());
+}
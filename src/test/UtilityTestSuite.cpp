@@ -1,6 +1,7 @@
 #include "catch.hpp"
 
 #include "utility.h"
+#include "utilityHash.h"
 
 TEST_CASE("trim blank spaces of string")
 {
@@ -11,3 +12,16 @@ TEST_CASE("trim blank spaces of wstring")
 {
 	REQUIRE(utility::trim(L" foo  ") == L"foo");
 }
+
+TEST_CASE("fnv-1a hash matches the reference values")
+{
+	REQUIRE(0xcbf29ce484222325ull == utility::hashFnv1a(std::string()));
+	REQUIRE(0xaf63dc4c8601ec8cull == utility::hashFnv1a(std::string("a")));
+}
+
+TEST_CASE("fnv-1a hash of wstring hashes the utf-8 encoding")
+{
+	REQUIRE(
+		utility::hashFnv1a(std::string("a\xc3\xa4")) ==
+		utility::hashFnv1a(std::wstring(L"a\u00e4")));
+}